@@ -52,6 +52,7 @@
 #include <queue>
 #include <map>
 #include <set>
+#include <cwchar>
 
 #include "../include/core/Interface.h"
 
@@ -262,6 +263,72 @@ namespace amf
 typedef std::basic_string<char, std::char_traits<char>, amf::amf_allocator<char> > amf_string;
 typedef std::basic_string<wchar_t, std::char_traits<wchar_t>, amf::amf_allocator<wchar_t> > amf_wstring;
 
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Map keyed by wide strings, stored as a vector sorted by key.
+    // Lookups by const wchar_t* do a binary search without building a temporary amf_wstring, and
+    // iteration order matches amf_map<amf_wstring, _Ty>, but iterators are random access so positional
+    // access is O(1). Insertion is O(n): meant for property tables that are filled once and read often.
+    //-------------------------------------------------------------------------------------------------
+    template<class _Ty>
+    class amf_wstring_flat_map
+    {
+    public:
+        typedef std::pair<amf_wstring, _Ty>                     value_type;
+        typedef amf_vector<value_type>                          container_type;
+        typedef typename container_type::iterator               iterator;
+        typedef typename container_type::const_iterator         const_iterator;
+        typedef typename container_type::size_type              size_type;
+
+        amf_wstring_flat_map() : m_items() {}
+
+        iterator        begin()         { return m_items.begin(); }
+        iterator        end()           { return m_items.end(); }
+        const_iterator  begin() const   { return m_items.begin(); }
+        const_iterator  end() const     { return m_items.end(); }
+        size_type       size() const    { return m_items.size(); }
+        bool            empty() const   { return m_items.empty(); }
+        void            clear()         { m_items.clear(); }
+        iterator        erase(iterator it) { return m_items.erase(it); }
+
+        iterator find(const wchar_t* key)
+        {
+            iterator it = lower_bound(key);
+            return (it != m_items.end() && wcscmp(it->first.c_str(), key) == 0) ? it : m_items.end();
+        }
+        const_iterator find(const wchar_t* key) const
+        {
+            return const_cast<amf_wstring_flat_map*>(this)->find(key);
+        }
+        iterator        find(const amf_wstring& key)        { return find(key.c_str()); }
+        const_iterator  find(const amf_wstring& key) const  { return find(key.c_str()); }
+
+        _Ty& operator[](const wchar_t* key)
+        {
+            iterator it = lower_bound(key);
+            if (it == m_items.end() || wcscmp(it->first.c_str(), key) != 0)
+            {
+                it = m_items.insert(it, value_type(amf_wstring(key), _Ty()));
+            }
+            return it->second;
+        }
+        _Ty& operator[](const amf_wstring& key) { return (*this)[key.c_str()]; }
+
+    private:
+        struct KeyLess
+        {
+            bool operator()(const value_type& item, const wchar_t* key) const { return wcscmp(item.first.c_str(), key) < 0; }
+        };
+        iterator lower_bound(const wchar_t* key)
+        {
+            return std::lower_bound(m_items.begin(), m_items.end(), key, KeyLess());
+        }
+
+        container_type m_items;
+    };
+}
+
 namespace amf
 {
     //-------------------------------------------------------------------------------------------------
@@ -37,32 +37,57 @@
 
 #pragma once
 #include "../include/core/Platform.h"
+#include <string.h>
 #define    INIT_ARRAY_SIZE 1024
 //------------------------------------------------------------------------
+// optional storage provider, e.g. a pool shared by arrays that are resized every frame
+class AMFByteArrayAllocator
+{
+public:
+    virtual amf_uint8*  Alloc(amf_size size) = 0;
+    virtual void        Free(amf_uint8* pData, amf_size size) = 0;
+protected:
+    virtual ~AMFByteArrayAllocator() {}
+};
+//------------------------------------------------------------------------
+// Capacity grows geometrically. Bytes past GetSize() read as zero after SetSize(), as before;
+// SetSizeUninitialized() and Reserve() skip that for callers that overwrite the data anyway.
+// m_iDirtySize tracks how far the buffer may hold non-zero bytes so zeroing is done only where needed.
+//------------------------------------------------------------------------
 class AMFByteArray
 {
 protected:
     amf_uint8        *m_pData;
     amf_size         m_iSize;
     amf_size         m_iMaxSize;
+    amf_size         m_iDirtySize;      // bytes at and past this offset are zero
+    AMFByteArrayAllocator *m_pAllocator;
 public:
-    AMFByteArray() : m_pData(0), m_iSize(0), m_iMaxSize(0)
+    AMFByteArray() : m_pData(0), m_iSize(0), m_iMaxSize(0), m_iDirtySize(0), m_pAllocator(0)
     {
     }
-    AMFByteArray(const AMFByteArray &other) : m_pData(0), m_iSize(0), m_iMaxSize(0)
+    explicit AMFByteArray(AMFByteArrayAllocator *pAllocator) : m_pData(0), m_iSize(0), m_iMaxSize(0), m_iDirtySize(0), m_pAllocator(pAllocator)
+    {
+    }
+    AMFByteArray(const AMFByteArray &other) : m_pData(0), m_iSize(0), m_iMaxSize(0), m_iDirtySize(0), m_pAllocator(0)
     {
         *this = other;
     }
-    AMFByteArray(amf_size num) : m_pData(0), m_iSize(0), m_iMaxSize(0)
+    AMFByteArray(AMFByteArray &&other) : m_pData(other.m_pData), m_iSize(other.m_iSize), m_iMaxSize(other.m_iMaxSize),
+        m_iDirtySize(other.m_iDirtySize), m_pAllocator(other.m_pAllocator)
+    {
+        other.m_pData = 0;
+        other.m_iSize = 0;
+        other.m_iMaxSize = 0;
+        other.m_iDirtySize = 0;
+    }
+    AMFByteArray(amf_size num) : m_pData(0), m_iSize(0), m_iMaxSize(0), m_iDirtySize(0), m_pAllocator(0)
     {
         SetSize(num);
     }
     virtual ~AMFByteArray()
     {
-        if (m_pData != 0)
-        {
-            delete[] m_pData;
-        }
+        Free();
     }
     void  SetSize(amf_size num)
     {
@@ -72,36 +97,54 @@ public:
         }
         if (num < m_iSize)
         {
-            memset(m_pData + num, 0, m_iMaxSize - num);
+            memset(m_pData + num, 0, m_iDirtySize - num);
+            m_iDirtySize = num;
         }
-        else if (num > m_iMaxSize)
+        else
         {
-            m_iMaxSize = (num / INIT_ARRAY_SIZE) * INIT_ARRAY_SIZE + INIT_ARRAY_SIZE;
-            amf_uint8 *pNewData = new amf_uint8[m_iMaxSize];
-            memset(pNewData, 0, m_iMaxSize);
-            if (m_pData != NULL)
+            Reserve(num);
+            // also clears the tail past num that Reserve() or SetSizeUninitialized() left dirty
+            if (m_iDirtySize > m_iSize)
             {
-                memcpy(pNewData, m_pData, m_iSize);
-                delete[] m_pData;
+                memset(m_pData + m_iSize, 0, m_iDirtySize - m_iSize);
             }
-            m_pData = pNewData;
+            m_iDirtySize = num;
         }
         m_iSize = num;
     }
+    // as SetSize() but the bytes gained are not zeroed and a shrink leaves the tail as is
+    void  SetSizeUninitialized(amf_size num)
+    {
+        Reserve(num);
+        m_iSize = num;
+        m_iDirtySize = AMF_MAX(m_iDirtySize, num);
+    }
+    // makes room for num bytes without changing the size
+    void  Reserve(amf_size num)
+    {
+        if (num <= m_iMaxSize)
+        {
+            return;
+        }
+        amf_size maxSize = AMF_MAX(num, m_iMaxSize + m_iMaxSize / 2);
+        maxSize = (maxSize + INIT_ARRAY_SIZE - 1) / INIT_ARRAY_SIZE * INIT_ARRAY_SIZE;
+        amf_uint8 *pNewData = Alloc(maxSize);
+        if (m_pData != NULL)
+        {
+            memcpy(pNewData, m_pData, m_iSize);
+            Free();
+        }
+        m_pData = pNewData;
+        m_iMaxSize = maxSize;
+        m_iDirtySize = maxSize; // fresh memory is not zeroed
+    }
     void Copy(const AMFByteArray &old)
     {
-        if (m_iMaxSize < old.m_iSize)
+        SetSizeUninitialized(old.m_iSize);
+        if (m_iSize > 0)
         {
-            m_iMaxSize = old.m_iMaxSize;
-            if (m_pData != NULL)
-            {
-                delete[] m_pData;
-            }
-            m_pData = new amf_uint8[m_iMaxSize];
-            memset(m_pData, 0, m_iMaxSize);
+            memcpy(m_pData, old.m_pData, old.m_iSize);
         }
-        memcpy(m_pData, old.m_pData, old.m_iSize);
-        m_iSize = old.m_iSize;
     }
     amf_uint8    operator[] (amf_size iPos) const
     {
@@ -113,14 +156,55 @@ public:
     }
     AMFByteArray&    operator=(const AMFByteArray &other)
     {
-        SetSize(other.GetSize());
-        if (GetSize() > 0)
+        if (this != &other)
+        {
+            SetSize(other.GetSize());
+            if (GetSize() > 0)
+            {
+                memcpy(GetData(), other.GetData(), GetSize());
+            }
+        }
+        return *this;
+    }
+    AMFByteArray&    operator=(AMFByteArray &&other)
+    {
+        if (this != &other)
         {
-            memcpy(GetData(), other.GetData(), GetSize());
+            Free();
+            m_pData = other.m_pData;
+            m_iSize = other.m_iSize;
+            m_iMaxSize = other.m_iMaxSize;
+            m_iDirtySize = other.m_iDirtySize;
+            m_pAllocator = other.m_pAllocator;
+            other.m_pData = 0;
+            other.m_iSize = 0;
+            other.m_iMaxSize = 0;
+            other.m_iDirtySize = 0;
         }
         return *this;
     }
     amf_uint8 *GetData() const { return m_pData; }
     amf_size GetSize() const { return m_iSize; }
+    amf_size GetCapacity() const { return m_iMaxSize; }
+private:
+    amf_uint8* Alloc(amf_size size)
+    {
+        return m_pAllocator != NULL ? m_pAllocator->Alloc(size) : new amf_uint8[size];
+    }
+    void Free()
+    {
+        if (m_pData != 0)
+        {
+            if (m_pAllocator != NULL)
+            {
+                m_pAllocator->Free(m_pData, m_iMaxSize);
+            }
+            else
+            {
+                delete[] m_pData;
+            }
+            m_pData = 0;
+        }
+    }
 };
 #endif // AMF_ByteArray_h
\ No newline at end of file
@@ -49,6 +49,9 @@
     #define amf_seek64 _lseeki64
 #elif defined(__linux)// Linux
     #include <unistd.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <errno.h>
     #define amf_close        close
     #define amf_read         read
     #define amf_write        write
@@ -67,14 +70,27 @@ using namespace amf;
 
 #define AMF_FILE_PROTOCOL L"file"
 
+#define AMF_DIRECT_IO_ALIGNMENT     4096
+#define AMF_DIRECT_IO_CHUNK         (1024 * 1024)
+#define AMF_DROP_BEHIND_CHUNK       (8 * 1024 * 1024)
+
 //-------------------------------------------------------------------------------------------------
 AMFDataStreamFileImpl::AMFDataStreamFileImpl()
-    : m_iFileDescriptor(-1), m_Path()
+    : m_iFileDescriptor(-1), m_Path(),
+    m_bDirectIO(false),
+    m_bDirectIORequested(false),
+    m_eAccessHint(AMFFAH_NORMAL),
+    m_pDirectBuffer(NULL),
+    m_iWriteBackPos(0),
+    m_iDropBehindPos(0)
 {}
 //-------------------------------------------------------------------------------------------------
 AMFDataStreamFileImpl::~AMFDataStreamFileImpl()
 {
     Close();
+#if defined(__linux)
+    free(m_pDirectBuffer);
+#endif
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Close()
@@ -89,6 +105,9 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Close()
         }
         m_iFileDescriptor = -1;
     }
+    m_bDirectIO = false;
+    m_iWriteBackPos = 0;
+    m_iDropBehindPos = 0;
     return err;
 }
 //-------------------------------------------------------------------------------------------------
@@ -97,11 +116,21 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Read(void* pData, amf_size iSize,
     AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"Read() - File not open");
     AMF_RESULT err = AMF_OK;
 
-    int ready = amf_read(m_iFileDescriptor, pData, (amf_uint)iSize);
+    amf_int64 ready = 0;
+#if defined(__linux)
+    if(m_bDirectIO)
+    {
+        ready = DirectTransfer(pData, iSize, false);
+    }
+    else
+#endif
+    {
+        ready = amf_read(m_iFileDescriptor, pData, (amf_uint)iSize);
+    }
 
     if(pRead != NULL)
     {
-        *pRead = ready;
+        *pRead = ready > 0 ? (amf_size)ready : 0;
     }
     if(ready == 0)  // eof
     {
@@ -118,16 +147,32 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Write(const void* pData, amf_size
 {
     AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"Write() - File not Open");
     AMF_RESULT err = AMF_OK;
-    amf_uint32 written = amf_write(m_iFileDescriptor, pData, (amf_uint)iSize);
+    amf_int64 written = 0;
+#if defined(__linux)
+    if(m_bDirectIO)
+    {
+        written = DirectTransfer(const_cast<void*>(pData), iSize, true);
+    }
+    else
+#endif
+    {
+        written = amf_write(m_iFileDescriptor, pData, (amf_uint)iSize);
+    }
 
     if(pWritten != NULL)
     {
-        *pWritten = written;
+        *pWritten = written > 0 ? (amf_size)written : 0;
     }
-    if(written != iSize) // check errors
+    if(written != (amf_int64)iSize) // check errors
     {
         err = AMF_FAIL;
     }
+#if defined(__linux)
+    else if(m_eAccessHint == AMFFAH_SEQUENTIAL && !m_bDirectIO)
+    {
+        DropBehind();
+    }
+#endif
     return err;
 }
 //-------------------------------------------------------------------------------------------------
@@ -259,13 +304,158 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Open(const wchar_t* pFilePath, AM
     m_iFileDescriptor = _wsopen(m_Path.c_str(), access, shflag, 0666);
 #else
     amf_string str = amf_from_unicode_to_utf8(m_Path);
-    m_iFileDescriptor = open(str.c_str(), access, 0666);
+#if defined(__linux)
+    if(m_bDirectIORequested)
+    {
+        m_iFileDescriptor = open(str.c_str(), access | O_DIRECT, 0666);
+        if(m_iFileDescriptor == -1 && errno == EINVAL)
+        {
+            AMFTraceWarning(AMF_FACILITY, L"Open() - O_DIRECT is not supported for %s, using buffered I/O", m_Path.c_str());
+        }
+        else
+        {
+            m_bDirectIO = m_iFileDescriptor != -1;
+        }
+    }
+    if(m_iFileDescriptor == -1)
+#endif
+    {
+        m_iFileDescriptor = open(str.c_str(), access, 0666);
+    }
 #endif
 
     if(m_iFileDescriptor == -1)
     {
         return AMF_FAIL;
     }
+#if defined(__linux)
+    if(m_bDirectIO && m_pDirectBuffer == NULL)
+    {
+        void* pBuffer = NULL;
+        if(posix_memalign(&pBuffer, AMF_DIRECT_IO_ALIGNMENT, AMF_DIRECT_IO_CHUNK) != 0)
+        {
+            Close();
+            return AMF_OUT_OF_MEMORY;
+        }
+        m_pDirectBuffer = (amf_uint8*)pBuffer;
+    }
+    switch(m_eAccessHint)
+    {
+    case AMFFAH_SEQUENTIAL:
+        posix_fadvise(m_iFileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+        break;
+    case AMFFAH_RANDOM:
+        posix_fadvise(m_iFileDescriptor, 0, 0, POSIX_FADV_RANDOM);
+        break;
+    default:
+        break;
+    }
+#endif
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::SetDirectIO(bool bDirect)
+{
+#if defined(__linux)
+    m_bDirectIORequested = bDirect;
+    return AMF_OK;
+#else
+    return bDirect ? AMF_NOT_SUPPORTED : AMF_OK;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::SetAccessHint(AMF_FILE_ACCESS_HINT eHint)
+{
+    m_eAccessHint = eHint;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+#if defined(__linux)
+// O_DIRECT needs the file offset, the memory and the size aligned to the block size: whole blocks
+// go direct (through m_pDirectBuffer when the caller's memory is unaligned), unaligned heads and
+// tails go through the page cache with O_DIRECT cleared for that one call
+amf_int64 AMFDataStreamFileImpl::DirectTransfer(void* pData, amf_size iSize, bool bWrite)
+{
+    amf_uint8* pBytes = static_cast<amf_uint8*>(pData);
+    amf_int64 done = 0;
+    while(iSize > 0)
+    {
+        const amf_int64 pos = amf_seek64(m_iFileDescriptor, 0, SEEK_CUR);
+        if(pos == -1L)
+        {
+            return done > 0 ? done : -1;
+        }
+        const amf_size offset = (amf_size)(pos & (AMF_DIRECT_IO_ALIGNMENT - 1));
+        const amf_size blocks = AMF_MIN(iSize, (amf_size)AMF_DIRECT_IO_CHUNK) & ~(amf_size)(AMF_DIRECT_IO_ALIGNMENT - 1);
+
+        amf_size requested = 0;
+        ssize_t result = 0;
+        if(offset == 0 && blocks > 0)
+        {
+            const bool bAligned = ((amf_size)pBytes & (AMF_DIRECT_IO_ALIGNMENT - 1)) == 0;
+            void* pIO = bAligned ? pBytes : m_pDirectBuffer;
+            requested = blocks;
+            if(bWrite)
+            {
+                if(!bAligned)
+                {
+                    memcpy(m_pDirectBuffer, pBytes, blocks);
+                }
+                result = amf_write(m_iFileDescriptor, pIO, blocks);
+            }
+            else
+            {
+                result = amf_read(m_iFileDescriptor, pIO, blocks);
+                if(result > 0 && !bAligned)
+                {
+                    memcpy(pBytes, m_pDirectBuffer, result);
+                }
+            }
+        }
+        else
+        {
+            // up to the next block boundary
+            requested = offset != 0 ? AMF_MIN(iSize, AMF_DIRECT_IO_ALIGNMENT - offset) : iSize;
+            const int flags = fcntl(m_iFileDescriptor, F_GETFL);
+            fcntl(m_iFileDescriptor, F_SETFL, flags & ~O_DIRECT);
+            result = bWrite ? amf_write(m_iFileDescriptor, pBytes, requested) : amf_read(m_iFileDescriptor, pBytes, requested);
+            fcntl(m_iFileDescriptor, F_SETFL, flags);
+        }
+        if(result < 0)
+        {
+            return done > 0 ? done : -1;
+        }
+        done += result;
+        pBytes += result;
+        iSize -= result;
+        if((amf_size)result < requested) // eof
+        {
+            break;
+        }
+    }
+    return done;
+}
+//-------------------------------------------------------------------------------------------------
+// streaming writes: start write-back of each new chunk and evict the previous one once it is on
+// disk, so long recordings don't push everything else out of the page cache
+void AMFDataStreamFileImpl::DropBehind()
+{
+    const amf_int64 pos = amf_seek64(m_iFileDescriptor, 0, SEEK_CUR);
+    if(pos == -1L || pos - m_iWriteBackPos < AMF_DROP_BEHIND_CHUNK)
+    {
+        return;
+    }
+    const amf_int64 length = (pos - m_iWriteBackPos) & ~(amf_int64)(AMF_DIRECT_IO_ALIGNMENT - 1);
+    sync_file_range(m_iFileDescriptor, m_iWriteBackPos, length, SYNC_FILE_RANGE_WRITE);
+    if(m_iWriteBackPos > m_iDropBehindPos)
+    {
+        const amf_int64 dropLength = m_iWriteBackPos - m_iDropBehindPos;
+        sync_file_range(m_iFileDescriptor, m_iDropBehindPos, dropLength,
+            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(m_iFileDescriptor, m_iDropBehindPos, dropLength, POSIX_FADV_DONTNEED);
+        m_iDropBehindPos = m_iWriteBackPos;
+    }
+    m_iWriteBackPos += length;
+}
+#endif
+//-------------------------------------------------------------------------------------------------
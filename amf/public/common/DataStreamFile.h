@@ -42,6 +42,14 @@
 
 namespace amf
 {
+    //----------------------------------------------------------------------------------------------
+    enum AMF_FILE_ACCESS_HINT
+    {
+        AMFFAH_NORMAL           = 0,
+        AMFFAH_SEQUENTIAL       = 1,    // aggressive read-ahead; written data is dropped from the page cache behind the writer
+        AMFFAH_RANDOM           = 2,    // no read-ahead
+    };
+    //----------------------------------------------------------------------------------------------
     class AMFDataStreamFileImpl : public AMFInterfaceImpl<AMFDataStream>
     {
     public:
@@ -59,9 +67,25 @@ namespace amf
         // local
         // aways pass full URL just in case
         virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* pFilePath, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType);
+
+        // take effect on the next Open(); direct I/O is supported on Linux only
+        AMF_RESULT AMF_STD_CALL SetDirectIO(bool bDirect);
+        AMF_RESULT AMF_STD_CALL SetAccessHint(AMF_FILE_ACCESS_HINT eHint);
     protected:
+        amf_int64 DirectTransfer(void* pData, amf_size iSize, bool bWrite);
+        void      DropBehind();
+
         int m_iFileDescriptor;
         amf_wstring m_Path;
+        bool m_bDirectIO;
+        bool m_bDirectIORequested;
+        AMF_FILE_ACCESS_HINT m_eAccessHint;
+        amf_uint8* m_pDirectBuffer;     // aligned bounce buffer for O_DIRECT transfers
+        amf_int64 m_iWriteBackPos;      // written data before this offset is queued for write-back
+        amf_int64 m_iDropBehindPos;     // written data before this offset is dropped from the page cache
+    private:
+        AMFDataStreamFileImpl(const AMFDataStreamFileImpl&);
+        AMFDataStreamFileImpl& operator=(const AMFDataStreamFileImpl&);
     };
 } //namespace amf
 #endif // AMF_DataStreamFile_h
\ No newline at end of file
@@ -70,6 +70,19 @@
 #include <sys/types.h>
 #include <semaphore.h>
 #include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#if !defined(__APPLE__)
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux) && !defined(__ANDROID__)
+    #define AMF_FUTEX_SYNC
+    #include <atomic>
+    #include <climits>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+#endif
 
 #include "../AMFSTL.h"
 
@@ -104,6 +117,122 @@ amf_uint32 AMF_STD_CALL get_current_thread_id()
 }
 #endif
 
+//----------------------------------------------------------------------------------------
+// thread placement and scheduling
+//----------------------------------------------------------------------------------------
+#if !defined(__APPLE__)
+// parses a sysfs cpu list like "0-7,16-23"
+static bool amf_read_numa_node_cpus(amf_int32 node, cpu_set_t* pSet)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", (int)node);
+    FILE* pFile = fopen(path, "r");
+    if(pFile == NULL)
+    {
+        return false;
+    }
+    char list[4096];
+    const bool read = fgets(list, sizeof(list), pFile) != NULL;
+    fclose(pFile);
+    if(!read)
+    {
+        return false;
+    }
+    bool found = false;
+    for(char* pos = list; *pos != 0 && *pos != '\n';)
+    {
+        char* end = NULL;
+        long first = strtol(pos, &end, 10);
+        if(end == pos)
+        {
+            break;
+        }
+        long last = first;
+        if(*end == '-')
+        {
+            pos = end + 1;
+            last = strtol(pos, &end, 10);
+        }
+        for(long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+        {
+            CPU_SET(cpu, pSet);
+            found = true;
+        }
+        pos = *end == ',' ? end + 1 : end;
+    }
+    return found;
+}
+#endif
+//----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_set_current_thread_attributes(const amf::AMFThreadAttributes* pAttributes)
+{
+    if(pAttributes == NULL)
+    {
+        return false;
+    }
+    bool result = true;
+
+#if defined(__APPLE__)
+    // macOS has no affinity or NUMA API and names only the calling thread
+    if(pAttributes->name[0] != 0)
+    {
+        result = pthread_setname_np(pAttributes->name) == 0 && result;
+    }
+#else
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    bool restrict = false;
+    if(pAttributes->HasCpuMask())
+    {
+        for(amf_int32 cpu = 0; cpu < AMF_THREAD_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+        {
+            if(pAttributes->HasCpu(cpu))
+            {
+                CPU_SET(cpu, &cpus);
+                restrict = true;
+            }
+        }
+    }
+    else if(pAttributes->numaNode != AMF_THREAD_ANY_NUMA_NODE)
+    {
+        restrict = amf_read_numa_node_cpus(pAttributes->numaNode, &cpus);
+        result = restrict && result;
+    }
+    if(restrict)
+    {
+        result = sched_setaffinity(0, sizeof(cpus), &cpus) == 0 && result;
+    }
+
+#if defined(SYS_set_mempolicy)
+    if(pAttributes->preferNumaMemory && pAttributes->numaNode != AMF_THREAD_ANY_NUMA_NODE && pAttributes->numaNode < 64)
+    {
+        // MPOL_PREFERRED: allocate on the node while it has memory, fall back to others
+        const int mpolPreferred = 1;
+        unsigned long nodeMask = 1UL << pAttributes->numaNode;
+        result = syscall(SYS_set_mempolicy, mpolPreferred, &nodeMask, sizeof(nodeMask) * 8) == 0 && result;
+    }
+#endif
+
+    if(pAttributes->scheduling != amf::AMF_THREAD_SCHEDULING_DEFAULT)
+    {
+        const int policy = pAttributes->scheduling == amf::AMF_THREAD_SCHEDULING_FIFO ? SCHED_FIFO : SCHED_RR;
+        sched_param param = {};
+        param.sched_priority = AMF_CLAMP(pAttributes->priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+        result = pthread_setschedparam(pthread_self(), policy, &param) == 0 && result;
+    }
+    else if(pAttributes->niceLevel != 0)
+    {
+        // on Linux the nice level of a thread id applies to that thread only
+        result = setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), pAttributes->niceLevel) == 0 && result;
+    }
+
+    if(pAttributes->name[0] != 0)
+    {
+        result = pthread_setname_np(pthread_self(), pAttributes->name) == 0 && result;
+    }
+#endif
+    return result;
+}
 
 // int clock_gettime(clockid_t clk_id, struct timespec *tp);
 //----------------------------------------------------------------------------------------
@@ -118,6 +247,412 @@ amf_long AMF_STD_CALL amf_atomic_dec(amf_long* X)
 {
     return __sync_sub_and_fetch(X, 1);
 }
+#if defined(AMF_FUTEX_SYNC)
+//----------------------------------------------------------------------------------------
+// futex based synchronization: uncontended paths stay in user space, the kernel is
+// entered only to sleep or to wake sleepers; all timeouts run on CLOCK_MONOTONIC
+//----------------------------------------------------------------------------------------
+#define AMF_FUTEX_MAX_SPIN      100
+
+static inline int amf_futex_wait(std::atomic<int>* addr, int expected, const timespec* relTimeout)
+{
+    return (int)syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAIT_PRIVATE, expected, relTimeout, NULL, 0);
+}
+//----------------------------------------------------------------------------------------
+static inline void amf_futex_wake(std::atomic<int>* addr, int count)
+{
+    syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+//----------------------------------------------------------------------------------------
+static inline void amf_cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+//----------------------------------------------------------------------------------------
+// spinning only pays off when the thread being waited for can run meanwhile
+static inline amf_int32 amf_futex_max_spin()
+{
+    static const amf_int32 maxSpin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? AMF_FUTEX_MAX_SPIN : 0;
+    return maxSpin;
+}
+//----------------------------------------------------------------------------------------
+static inline amf_int64 amf_monotonic_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (amf_int64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+//----------------------------------------------------------------------------------------
+// sleeps on *addr while it holds expected; returns false once the deadline has passed
+static bool amf_futex_wait_until(std::atomic<int>* addr, int expected, amf_ulong timeout, amf_int64 deadline)
+{
+    if(timeout == AMF_INFINITE)
+    {
+        amf_futex_wait(addr, expected, NULL);
+        return true;
+    }
+    const amf_int64 remaining = deadline - amf_monotonic_ns();
+    if(remaining <= 0)
+    {
+        return false;
+    }
+    timespec rel;
+    rel.tv_sec = (time_t)(remaining / 1000000000LL);
+    rel.tv_nsec = (long)(remaining % 1000000000LL);
+    // FUTEX_WAIT measures a relative timeout against CLOCK_MONOTONIC
+    amf_futex_wait(addr, expected, &rel);
+    return true;
+}
+//----------------------------------------------------------------------------------------
+static inline amf_int64 amf_futex_deadline(amf_ulong timeout)
+{
+    return timeout == AMF_INFINITE ? 0 : amf_monotonic_ns() + (amf_int64)timeout * 1000000LL;
+}
+//----------------------------------------------------------------------------------------
+// recursive lock; m_state is 0 - free, 1 - locked, 2 - locked with possible sleepers
+struct AMFFutexLock
+{
+    std::atomic<int>        m_state;
+    std::atomic<pid_t>      m_owner;
+    amf_int32               m_recursion;
+    std::atomic<int>        m_spins;        // adaptive spin estimate, updated like glibc's adaptive mutex
+};
+//----------------------------------------------------------------------------------------
+static inline pid_t amf_futex_thread_id()
+{
+    static thread_local pid_t tid = (pid_t)syscall(SYS_gettid);
+    return tid;
+}
+//----------------------------------------------------------------------------------------
+static AMFFutexLock* amf_futex_lock_create()
+{
+    AMFFutexLock* lock = new AMFFutexLock;
+    lock->m_state.store(0, std::memory_order_relaxed);
+    lock->m_owner.store(0, std::memory_order_relaxed);
+    lock->m_recursion = 0;
+    lock->m_spins.store(0, std::memory_order_relaxed);
+    return lock;
+}
+//----------------------------------------------------------------------------------------
+static bool amf_futex_lock_acquire(AMFFutexLock* lock, amf_ulong timeout)
+{
+    const pid_t self = amf_futex_thread_id();
+    if(lock->m_owner.load(std::memory_order_relaxed) == self)
+    {
+        lock->m_recursion++;
+        return true;
+    }
+
+    int state = 0;
+    if(!lock->m_state.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        // spin for a while when the lock is held briefly; the estimate follows recent history
+        const amf_int32 spins = lock->m_spins.load(std::memory_order_relaxed);
+        const amf_int32 maxSpin = AMF_MIN(amf_futex_max_spin(), spins * 2 + 10);
+        amf_int32 spin = 0;
+        bool acquired = false;
+        for(; spin < maxSpin; spin++)
+        {
+            amf_cpu_relax();
+            state = 0;
+            if(lock->m_state.load(std::memory_order_relaxed) == 0 &&
+                lock->m_state.compare_exchange_weak(state, 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                acquired = true;
+                break;
+            }
+        }
+        lock->m_spins.store(spins + (spin - spins) / 8, std::memory_order_relaxed);
+
+        if(!acquired)
+        {
+            const amf_int64 deadline = amf_futex_deadline(timeout);
+            while(lock->m_state.exchange(2, std::memory_order_acquire) != 0)
+            {
+                if(!amf_futex_wait_until(&lock->m_state, 2, timeout, deadline))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    lock->m_owner.store(self, std::memory_order_relaxed);
+    lock->m_recursion = 1;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+static bool amf_futex_lock_release(AMFFutexLock* lock)
+{
+    if(lock->m_owner.load(std::memory_order_relaxed) != amf_futex_thread_id())
+    {
+        return false;
+    }
+    if(--lock->m_recursion > 0)
+    {
+        return true;
+    }
+    lock->m_owner.store(0, std::memory_order_relaxed);
+    if(lock->m_state.exchange(0, std::memory_order_release) == 2)
+    {
+        amf_futex_wake(&lock->m_state, 1);
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------
+amf_handle AMF_STD_CALL amf_create_critical_section()
+{
+    return (amf_handle)amf_futex_lock_create();
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_delete_critical_section(amf_handle cs)
+{
+    delete (AMFFutexLock*)cs;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_enter_critical_section(amf_handle cs)
+{
+    return amf_futex_lock_acquire((AMFFutexLock*)cs, AMF_INFINITE);
+}
+//----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_wait_critical_section(amf_handle cs, amf_ulong ulTimeout)
+{
+    return amf_futex_lock_acquire((AMFFutexLock*)cs, ulTimeout);
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_leave_critical_section(amf_handle cs)
+{
+    return amf_futex_lock_release((AMFFutexLock*)cs);
+}
+//----------------------------------------------------------------------------------------
+// m_state is the futex word: 1 - signaled, 0 - not signaled
+struct AMFFutexEvent
+{
+    std::atomic<int>        m_state;
+    std::atomic<int>        m_waiters;
+    bool                    m_manual_reset;
+};
+//----------------------------------------------------------------------------------------
+amf_handle AMF_STD_CALL amf_create_event(bool initially_owned, bool manual_reset, const wchar_t* name)
+{
+    // Linux does not natively support named events
+    if(name != NULL)
+    {
+        perror("Named Events not supported under Linux yet");
+        exit(1);
+    }
+    AMFFutexEvent* event = new AMFFutexEvent;
+    event->m_state.store(initially_owned ? 1 : 0, std::memory_order_relaxed);
+    event->m_waiters.store(0, std::memory_order_relaxed);
+    event->m_manual_reset = manual_reset;
+    return (amf_handle)event;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_delete_event(amf_handle hevent)
+{
+    delete (AMFFutexEvent*)hevent;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_set_event(amf_handle hevent)
+{
+    AMFFutexEvent* event = (AMFFutexEvent*)hevent;
+    // seq_cst pairs with the waiter incrementing m_waiters before it sleeps
+    if(event->m_state.exchange(1) == 0 && event->m_waiters.load() > 0)
+    {
+        amf_futex_wake(&event->m_state, event->m_manual_reset ? INT_MAX : 1);
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_reset_event(amf_handle hevent)
+{
+    AMFFutexEvent* event = (AMFFutexEvent*)hevent;
+    event->m_state.store(0, std::memory_order_release);
+    return true;
+}
+//----------------------------------------------------------------------------------------
+static inline bool amf_futex_event_try(AMFFutexEvent* event)
+{
+    if(event->m_manual_reset)
+    {
+        return event->m_state.load(std::memory_order_acquire) == 1;
+    }
+    int state = 1;
+    return event->m_state.compare_exchange_strong(state, 0, std::memory_order_acquire, std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------------------
+static bool AMF_STD_CALL amf_wait_for_event_int(amf_handle hevent, unsigned long timeout, bool bTimeoutErr)
+{
+    AMFFutexEvent* event = (AMFFutexEvent*)hevent;
+    if(amf_futex_event_try(event))
+    {
+        return true;
+    }
+    for(amf_int32 spin = 0, maxSpin = amf_futex_max_spin(); spin < maxSpin; spin++)
+    {
+        amf_cpu_relax();
+        if(event->m_state.load(std::memory_order_relaxed) == 1 && amf_futex_event_try(event))
+        {
+            return true;
+        }
+    }
+    const amf_int64 deadline = amf_futex_deadline(timeout);
+    for(;;)
+    {
+        event->m_waiters.fetch_add(1);
+        const bool inTime = amf_futex_wait_until(&event->m_state, 0, timeout, deadline);
+        event->m_waiters.fetch_sub(1);
+        if(amf_futex_event_try(event))
+        {
+            return true;
+        }
+        if(!inTime)
+        {
+            return !bTimeoutErr;
+        }
+    }
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_wait_for_event(amf_handle hevent, unsigned long timeout)
+{
+    return amf_wait_for_event_int(hevent, timeout, true);
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_wait_for_event_timeout(amf_handle hevent, amf_ulong ulTimeout)
+{
+    return amf_wait_for_event_int(hevent, ulTimeout, false);
+}
+//----------------------------------------------------------------------------------------
+amf_handle AMF_STD_CALL amf_create_mutex(bool initially_owned, const wchar_t* /*name*/)
+{
+    AMFFutexLock* lock = amf_futex_lock_create();
+    if(initially_owned)
+    {
+        amf_futex_lock_acquire(lock, AMF_INFINITE);
+    }
+    return (amf_handle)lock;
+}
+//----------------------------------------------------------------------------------------
+amf_handle AMF_STD_CALL amf_open_mutex(const wchar_t* /*pName*/)
+{
+    assert(false);
+    return 0;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_delete_mutex(amf_handle hmutex)
+{
+    delete (AMFFutexLock*)hmutex;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_wait_for_mutex(amf_handle hmutex, unsigned long timeout)
+{
+    return amf_futex_lock_acquire((AMFFutexLock*)hmutex, timeout);
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_release_mutex(amf_handle hmutex)
+{
+    return amf_futex_lock_release((AMFFutexLock*)hmutex);
+}
+//----------------------------------------------------------------------------------------
+// m_count is the futex word; sleepers wait for it to leave zero
+struct AMFFutexSemaphore
+{
+    std::atomic<int>        m_count;
+    std::atomic<int>        m_waiters;
+};
+//----------------------------------------------------------------------------------------
+amf_handle AMF_STD_CALL amf_create_semaphore(amf_long iInitCount, amf_long iMaxCount, const wchar_t* /*pName*/)
+{
+    if(iMaxCount == 0 || iInitCount > iMaxCount)
+    {
+        return NULL;
+    }
+    AMFFutexSemaphore* semaphore = new AMFFutexSemaphore;
+    semaphore->m_count.store((int)iInitCount, std::memory_order_relaxed);
+    semaphore->m_waiters.store(0, std::memory_order_relaxed);
+    return (amf_handle)semaphore;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_delete_semaphore(amf_handle hsemaphore)
+{
+    delete (AMFFutexSemaphore*)hsemaphore;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+static inline bool amf_futex_semaphore_try(AMFFutexSemaphore* semaphore)
+{
+    int count = semaphore->m_count.load(std::memory_order_relaxed);
+    while(count > 0)
+    {
+        if(semaphore->m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_wait_for_semaphore(amf_handle hsemaphore, amf_ulong timeout)
+{
+    if(hsemaphore == NULL)
+    {
+        return true;
+    }
+    AMFFutexSemaphore* semaphore = (AMFFutexSemaphore*)hsemaphore;
+    if(amf_futex_semaphore_try(semaphore))
+    {
+        return true;
+    }
+    for(amf_int32 spin = 0, maxSpin = amf_futex_max_spin(); spin < maxSpin; spin++)
+    {
+        amf_cpu_relax();
+        if(amf_futex_semaphore_try(semaphore))
+        {
+            return true;
+        }
+    }
+    const amf_int64 deadline = amf_futex_deadline(timeout);
+    for(;;)
+    {
+        semaphore->m_waiters.fetch_add(1);
+        const bool inTime = amf_futex_wait_until(&semaphore->m_count, 0, timeout, deadline);
+        semaphore->m_waiters.fetch_sub(1);
+        if(amf_futex_semaphore_try(semaphore))
+        {
+            return true;
+        }
+        if(!inTime)
+        {
+            return false;
+        }
+    }
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_release_semaphore(amf_handle hsemaphore, amf_long iCount, amf_long* iOldCount)
+{
+    if(hsemaphore == NULL)
+    {
+        return true;
+    }
+    AMFFutexSemaphore* semaphore = (AMFFutexSemaphore*)hsemaphore;
+    const int old = semaphore->m_count.fetch_add((int)iCount);
+    if(iOldCount != NULL)
+    {
+        *iOldCount = old;
+    }
+    if(semaphore->m_waiters.load() > 0)
+    {
+        amf_futex_wake(&semaphore->m_count, (int)iCount);
+    }
+    return true;
+}
+#else // AMF_FUTEX_SYNC
 //----------------------------------------------------------------------------------------
 amf_handle AMF_STD_CALL amf_create_critical_section()
 {
@@ -512,6 +1047,7 @@ bool AMF_STD_CALL amf_release_semaphore(amf_handle hsemaphore, amf_long iCount,
     }
     return true;
 }
+#endif // AMF_FUTEX_SYNC
 //------------------------------------------------------------------------------
 /*
  * Delay is specified in milliseconds.
@@ -678,8 +1214,9 @@ amf_int64 AMF_STD_CALL get_time_in_seconds_with_fraction()
 amf_pts AMF_STD_CALL amf_high_precision_clock()
 {
     timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    return ts.tv_sec * 10000000LL + ts.tv_nsec / 100.; //to nanosec
+    // monotonic like QueryPerformanceCounter on Windows; not affected by wall clock steps
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 10000000LL + ts.tv_nsec / 100; //to 100 nanosec
 }
 //--------------------------------------------------------------------------------
 // the end
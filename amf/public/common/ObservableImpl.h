@@ -41,98 +41,186 @@
 #pragma once
 
 #include "Thread.h"
-#include <list>
+#include <vector>
 
 namespace amf
 {
+    //---------------------------------------------------------------------------------------------
+    // Observers are published as an immutable, ref-counted snapshot that is replaced on Add/Remove.
+    // NotifyObservers() takes a reference to the current snapshot without locking or allocating;
+    // the writer waits for readers that are still picking up the old pointer before releasing it.
+    //---------------------------------------------------------------------------------------------
     template<typename Observer>
     class AMFObservableImpl
     {
     private:
-        typedef std::list<Observer*> ObserversList;
-        ObserversList m_observers;
+        typedef std::vector<Observer*> ObserversList;
+
+        struct ObserversSnapshot
+        {
+            std::atomic<amf_long>   refCount;
+            ObserversList           observers;
+
+            ObserversSnapshot() : refCount(1), observers() {}
+        };
+
+        std::atomic<ObserversSnapshot*> m_pSnapshot;    // NULL when there are no observers
+        std::atomic<amf_long>           m_iReaders;     // readers between load and AddRef
     public:
-        AMFObservableImpl() : m_observers()
+        AMFObservableImpl() : m_pSnapshot(NULL), m_iReaders(0)
         {}
         virtual ~AMFObservableImpl()
         {
-            assert(m_observers.size() == 0);
+            assert(m_pSnapshot.load() == NULL);
+            Publish(NULL);
         }
         virtual void AMF_STD_CALL AddObserver(Observer* pObserver)
         {
-            amf_bool found = false;
             AMFLock lock(&m_sc);
-            
-            for (typename ObserversList::iterator it = m_observers.begin(); it != m_observers.end(); it++)
+
+            ObserversSnapshot* pCurrent = m_pSnapshot.load();
+            if (pCurrent != NULL)
             {
-                if (*it == pObserver)
+                for (typename ObserversList::const_iterator it = pCurrent->observers.begin(); it != pCurrent->observers.end(); it++)
                 {
-                    found = true;
-                    break;
+                    if (*it == pObserver)
+                    {
+                        return;
+                    }
                 }
             }
-            if (found == false)
+            ObserversSnapshot* pNew = new ObserversSnapshot();
+            if (pCurrent != NULL)
             {
-                m_observers.push_back(pObserver);
+                pNew->observers.reserve(pCurrent->observers.size() + 1);
+                pNew->observers = pCurrent->observers;
             }
+            pNew->observers.push_back(pObserver);
+            Publish(pNew);
         }
 
         virtual void AMF_STD_CALL RemoveObserver(Observer* pObserver)
         {
             AMFLock lock(&m_sc);
-            m_observers.remove(pObserver);
+
+            ObserversSnapshot* pCurrent = m_pSnapshot.load();
+            if (pCurrent == NULL)
+            {
+                return;
+            }
+            ObserversSnapshot* pNew = new ObserversSnapshot();
+            for (typename ObserversList::const_iterator it = pCurrent->observers.begin(); it != pCurrent->observers.end(); it++)
+            {
+                if (*it != pObserver)
+                {
+                    pNew->observers.push_back(*it);
+                }
+            }
+            if (pNew->observers.size() == pCurrent->observers.size())
+            {
+                delete pNew;
+                return;
+            }
+            if (pNew->observers.empty())
+            {
+                delete pNew;
+                pNew = NULL;
+            }
+            Publish(pNew);
         }
 
     protected:
         void AMF_STD_CALL ClearObservers()
         {
             AMFLock lock(&m_sc);
-            m_observers.clear();
+            Publish(NULL);
         }
 
         void AMF_STD_CALL NotifyObservers(void  (AMF_STD_CALL Observer::* pEvent)())
         {
-            ObserversList tempList;
+            ObserversSnapshot* pSnapshot = AcquireSnapshot();
+            if (pSnapshot == NULL)
             {
-                AMFLock lock(&m_sc);
-                tempList = m_observers;
+                return;
             }
-            for (typename ObserversList::iterator it = tempList.begin(); it != tempList.end(); ++it)
+            for (typename ObserversList::const_iterator it = pSnapshot->observers.begin(); it != pSnapshot->observers.end(); ++it)
             {
                 Observer* pObserver = *it;
                 (pObserver->*pEvent)();
             }
+            ReleaseSnapshot(pSnapshot);
         }
 
         template<typename TArg0>
         void AMF_STD_CALL NotifyObservers(void (AMF_STD_CALL Observer::* pEvent)(TArg0), TArg0 arg0)
         {
-            ObserversList tempList;
+            ObserversSnapshot* pSnapshot = AcquireSnapshot();
+            if (pSnapshot == NULL)
             {
-                AMFLock lock(&m_sc);
-                tempList = m_observers;
+                return;
             }
-            for (typename ObserversList::iterator it = tempList.begin(); it != tempList.end(); ++it)
+            for (typename ObserversList::const_iterator it = pSnapshot->observers.begin(); it != pSnapshot->observers.end(); ++it)
             {
                 Observer* pObserver = *it;
                 (pObserver->*pEvent)(arg0);
             }
+            ReleaseSnapshot(pSnapshot);
         }
         template<typename TArg0, typename TArg1>
         void AMF_STD_CALL NotifyObservers(void (AMF_STD_CALL Observer::* pEvent)(TArg0, TArg1), TArg0 arg0, TArg1 arg1)
         {
-            ObserversList tempList;
+            ObserversSnapshot* pSnapshot = AcquireSnapshot();
+            if (pSnapshot == NULL)
             {
-                AMFLock lock(&m_sc);
-                tempList = m_observers;
+                return;
             }
-            for (typename ObserversList::iterator it = tempList.begin(); it != tempList.end(); it++)
+            for (typename ObserversList::const_iterator it = pSnapshot->observers.begin(); it != pSnapshot->observers.end(); it++)
             {
                 Observer* pObserver = *it;
                 (pObserver->*pEvent)(arg0, arg1);
             }
+            ReleaseSnapshot(pSnapshot);
         }
     private:
+        ObserversSnapshot* AcquireSnapshot()
+        {
+            // fast path for the common case of no observers
+            if (m_pSnapshot.load(std::memory_order_acquire) == NULL)
+            {
+                return NULL;
+            }
+            m_iReaders++;
+            ObserversSnapshot* pSnapshot = m_pSnapshot.load();
+            if (pSnapshot != NULL)
+            {
+                pSnapshot->refCount++;
+            }
+            m_iReaders--;
+            return pSnapshot;
+        }
+        static void ReleaseSnapshot(ObserversSnapshot* pSnapshot)
+        {
+            if (--pSnapshot->refCount == 0)
+            {
+                delete pSnapshot;
+            }
+        }
+        // call under m_sc
+        void Publish(ObserversSnapshot* pNew)
+        {
+            ObserversSnapshot* pOld = m_pSnapshot.exchange(pNew);
+            if (pOld == NULL)
+            {
+                return;
+            }
+            // a reader may have loaded pOld but not yet referenced it; the window is a few instructions
+            while (m_iReaders.load() != 0)
+            {
+                amf_sleep(0);
+            }
+            ReleaseSnapshot(pOld);
+        }
+
         AMFCriticalSection m_sc;
     };
 }
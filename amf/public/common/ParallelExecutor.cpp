@@ -0,0 +1,252 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "ParallelExecutor.h"
+#include <thread>
+
+using namespace amf;
+
+#define AMF_PARALLEL_BANDS_PER_THREAD 4
+
+static AMFCriticalSection   s_SharedExecutorCS;
+static AMFParallelExecutor* s_pSharedExecutor = NULL;
+static amf_long             s_lSharedExecutorRefs = 0;
+
+//-------------------------------------------------------------------------------------------------
+AMFParallelExecutor::AMFParallelExecutor(amf_int32 iThreadCount) :
+    m_Queues(),
+    m_Workers(),
+    m_WorkSemaphore(0, 0x7FFFFFFF),
+    m_iSleepingWorkers(0),
+    m_uiNextQueue(0),
+    m_bStop(false)
+{
+    if (iThreadCount <= 0)
+    {
+        // the calling thread processes bands too
+        iThreadCount = (amf_int32)std::thread::hardware_concurrency() - 1;
+        if (iThreadCount < 1)
+        {
+            iThreadCount = 1;
+        }
+    }
+    for (amf_int32 i = 0; i < iThreadCount; i++)
+    {
+        m_Queues.push_back(new WorkQueue());
+    }
+    for (amf_int32 i = 0; i < iThreadCount; i++)
+    {
+        WorkerThread* pWorker = new WorkerThread(this, i);
+        m_Workers.push_back(pWorker);
+        pWorker->Start();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMFParallelExecutor::~AMFParallelExecutor()
+{
+    m_bStop = true;
+    for (size_t i = 0; i < m_Workers.size(); i++)
+    {
+        m_Workers[i]->RequestStop();
+    }
+    for (size_t i = 0; i < m_Workers.size(); i++)
+    {
+        m_WorkSemaphore.Unlock();
+    }
+    for (size_t i = 0; i < m_Workers.size(); i++)
+    {
+        m_Workers[i]->WaitForStop();
+        delete m_Workers[i];
+    }
+    m_Workers.clear();
+    for (size_t i = 0; i < m_Queues.size(); i++)
+    {
+        delete m_Queues[i];
+    }
+    m_Queues.clear();
+}
+//-------------------------------------------------------------------------------------------------
+AMFParallelExecutor* AMF_STD_CALL AMFParallelExecutor::AcquireShared()
+{
+    AMFLock lock(&s_SharedExecutorCS);
+    if (s_pSharedExecutor == NULL)
+    {
+        s_pSharedExecutor = new AMFParallelExecutor();
+    }
+    s_lSharedExecutorRefs++;
+    return s_pSharedExecutor;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL AMFParallelExecutor::ReleaseShared()
+{
+    AMFLock lock(&s_SharedExecutorCS);
+    if (s_lSharedExecutorRefs > 0 && --s_lSharedExecutorRefs == 0)
+    {
+        delete s_pSharedExecutor;
+        s_pSharedExecutor = NULL;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMFParallelExecutor::Run(amf_int32 lineCount, amf_int32 iMinLinesPerBand, Task* pTask)
+{
+    if (lineCount <= 0)
+    {
+        return;
+    }
+    if (iMinLinesPerBand < 1)
+    {
+        iMinLinesPerBand = 1;
+    }
+    amf_int32 bandCount = lineCount / iMinLinesPerBand;
+    amf_int32 maxBands = (GetThreadCount() + 1) * AMF_PARALLEL_BANDS_PER_THREAD;
+    if (bandCount > maxBands)
+    {
+        bandCount = maxBands;
+    }
+    if (bandCount <= 1 || m_Workers.empty())
+    {
+        pTask->Run(0, lineCount);
+        return;
+    }
+
+    Job job;
+    job.pTask = pTask;
+    job.lRemaining = bandCount;
+
+    // neighbouring bands go to the same queue so a worker walks through adjacent memory
+    const amf_int32 queueCount = (amf_int32)m_Queues.size();
+    const amf_int32 firstQueue = (amf_int32)(m_uiNextQueue++ % (amf_uint32)queueCount);
+    for (amf_int32 i = 0; i < bandCount; i++)
+    {
+        Band band = { &job, (amf_int32)((amf_int64)lineCount * i / bandCount), (amf_int32)((amf_int64)lineCount * (i + 1) / bandCount) };
+        WorkQueue* pQueue = m_Queues[(firstQueue + (amf_int64)i * queueCount / bandCount) % queueCount];
+        AMFLock lock(&pQueue->cs);
+        pQueue->bands.push_back(band);
+    }
+
+    // pairs with the fence in WorkerLoop() so a worker going to sleep either sees the bands or is woken
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    amf_int32 toWake = m_iSleepingWorkers.load();
+    if (toWake > bandCount)
+    {
+        toWake = bandCount;
+    }
+    for (amf_int32 i = 0; i < toWake; i++)
+    {
+        m_WorkSemaphore.Unlock();
+    }
+
+    Band band;
+    while (PopBand(-1, band))
+    {
+        ProcessBand(band);
+    }
+    job.doneEvent.Lock();
+    // the last worker signals under the lock - wait for it to leave before the job goes out of scope
+    AMFLock lock(&job.cs);
+}
+//-------------------------------------------------------------------------------------------------
+void AMFParallelExecutor::WorkerLoop(amf_int32 index)
+{
+    while (!m_bStop)
+    {
+        Band band;
+        if (PopBand(index, band))
+        {
+            ProcessBand(band);
+            continue;
+        }
+        m_iSleepingWorkers++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (PopBand(index, band))
+        {
+            m_iSleepingWorkers--;
+            ProcessBand(band);
+            continue;
+        }
+        m_WorkSemaphore.Lock();
+        m_iSleepingWorkers--;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFParallelExecutor::PopBand(amf_int32 index, Band& band)
+{
+    const amf_int32 queueCount = (amf_int32)m_Queues.size();
+    amf_int32 start = 0;
+    if (index >= 0)
+    {
+        WorkQueue* pQueue = m_Queues[index];
+        AMFLock lock(&pQueue->cs);
+        if (!pQueue->bands.empty())
+        {
+            band = pQueue->bands.front();
+            pQueue->bands.pop_front();
+            return true;
+        }
+        start = index + 1;
+    }
+    else
+    {
+        start = (amf_int32)(m_uiNextQueue++ % (amf_uint32)queueCount);
+    }
+    // steal from the far end of the other queues
+    for (amf_int32 i = 0; i < queueCount; i++)
+    {
+        amf_int32 victim = (start + i) % queueCount;
+        if (victim == index)
+        {
+            continue;
+        }
+        WorkQueue* pQueue = m_Queues[victim];
+        AMFLock lock(&pQueue->cs);
+        if (!pQueue->bands.empty())
+        {
+            band = pQueue->bands.back();
+            pQueue->bands.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFParallelExecutor::ProcessBand(const Band& band)
+{
+    Job* pJob = band.pJob;
+    pJob->pTask->Run(band.lineStart, band.lineEnd);
+
+    AMFLock lock(&pJob->cs);
+    if (--pJob->lRemaining == 0)
+    {
+        pJob->doneEvent.SetEvent();
+    }
+}
+//-------------------------------------------------------------------------------------------------
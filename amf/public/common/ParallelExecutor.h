@@ -0,0 +1,136 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef AMF_ParallelExecutor_h
+#define AMF_ParallelExecutor_h
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "Thread.h"
+
+namespace amf
+{
+    //----------------------------------------------------------------
+    // Splits a range of rows into bands and processes them on a pool of worker threads.
+    // Bands are spread over per-worker queues; idle workers steal bands from the other queues
+    // and the calling thread processes bands as well until the whole range is done.
+    //----------------------------------------------------------------
+    class AMFParallelExecutor
+    {
+    public:
+        class Task
+        {
+        public:
+            virtual ~Task() {}
+            // processes rows [lineStart, lineEnd)
+            virtual void Run(amf_int32 lineStart, amf_int32 lineEnd) = 0;
+        };
+
+        // iThreadCount == 0 - one worker per hardware thread minus the calling thread
+        explicit AMFParallelExecutor(amf_int32 iThreadCount = 0);
+        virtual ~AMFParallelExecutor();
+
+        // process wide executor shared by components, every Acquire must be paired with Release
+        static AMFParallelExecutor* AMF_STD_CALL AcquireShared();
+        static void AMF_STD_CALL ReleaseShared();
+
+        amf_int32 GetThreadCount() const { return (amf_int32)m_Workers.size(); }
+
+        // blocks until all rows in [0, lineCount) are processed; bands are at least iMinLinesPerBand rows
+        void Run(amf_int32 lineCount, amf_int32 iMinLinesPerBand, Task* pTask);
+
+        template<typename _Func>
+        void ForEachBand(amf_int32 lineCount, amf_int32 iMinLinesPerBand, _Func func)
+        {
+            FuncTask<_Func> task(func);
+            Run(lineCount, iMinLinesPerBand, &task);
+        }
+
+    private:
+        template<typename _Func>
+        class FuncTask : public Task
+        {
+        public:
+            FuncTask(_Func& func) : m_Func(func) {}
+            virtual void Run(amf_int32 lineStart, amf_int32 lineEnd) { m_Func(lineStart, lineEnd); }
+        private:
+            _Func& m_Func;
+        };
+
+        struct Job
+        {
+            Task*              pTask;
+            amf_long           lRemaining;
+            AMFCriticalSection cs;
+            AMFEvent           doneEvent;
+            Job() : pTask(NULL), lRemaining(0), cs(), doneEvent(false, true) {}
+        };
+        struct Band
+        {
+            Job*      pJob;
+            amf_int32 lineStart;
+            amf_int32 lineEnd;
+        };
+        struct WorkQueue
+        {
+            AMFCriticalSection cs;
+            std::deque<Band>   bands;
+        };
+        class WorkerThread : public AMFThread
+        {
+        public:
+            WorkerThread(AMFParallelExecutor* pExecutor, amf_int32 index) : m_pExecutor(pExecutor), m_iIndex(index) {}
+            virtual void Run() { m_pExecutor->WorkerLoop(m_iIndex); }
+        private:
+            AMFParallelExecutor* m_pExecutor;
+            amf_int32            m_iIndex;
+        };
+
+        void WorkerLoop(amf_int32 index);
+        bool PopBand(amf_int32 index, Band& band);
+        void ProcessBand(const Band& band);
+
+        std::vector<WorkQueue*>    m_Queues;
+        std::vector<WorkerThread*> m_Workers;
+        AMFSemaphore               m_WorkSemaphore;
+        std::atomic<amf_int32>     m_iSleepingWorkers;
+        std::atomic<amf_uint32>    m_uiNextQueue;
+        std::atomic<bool>          m_bStop;
+
+        AMFParallelExecutor(const AMFParallelExecutor&);
+        AMFParallelExecutor& operator=(const AMFParallelExecutor&);
+    };
+}
+
+#endif // AMF_ParallelExecutor_h
@@ -86,7 +86,7 @@ namespace amf
         virtual void  OnPropertyChanged() { }
     };
 
-    typedef amf_map<amf_wstring, std::shared_ptr<AMFPropertyInfoImpl> >  PropertyInfoMap;
+    typedef amf_wstring_flat_map<std::shared_ptr<AMFPropertyInfoImpl> >  PropertyInfoMap;
 
     //---------------------------------------------------------------------------------------------
     template<typename _TBase> class AMFPropertyStorageExImpl :
@@ -217,11 +217,7 @@ namespace amf
             AMF_RETURN_IF_FALSE(nameSize != 0, AMF_INVALID_ARG);
             AMF_RETURN_IF_FALSE(index < m_PropertiesInfo.size(), AMF_INVALID_ARG);
 
-            PropertyInfoMap::const_iterator found = m_PropertiesInfo.begin();
-            for (amf_size i = 0; i < index; i++)
-            {
-                found++;
-            }
+            PropertyInfoMap::const_iterator found = m_PropertiesInfo.begin() + index;
 
             size_t copySize = AMF_MIN(nameSize-1, found->first.length());
             memcpy(name, found->first.c_str(), copySize * sizeof(wchar_t));
@@ -240,13 +236,7 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(ppParamInfo);
             AMF_RETURN_IF_FALSE(szInd < m_PropertiesInfo.size(), AMF_INVALID_ARG);
 
-            PropertyInfoMap::const_iterator it = m_PropertiesInfo.begin();
-            for (; szInd > 0; --szInd)
-            {
-                it++;
-            }
-
-            *ppParamInfo = it->second.get();
+            *ppParamInfo = (m_PropertiesInfo.begin() + szInd)->second.get();
             return AMF_OK;
         }
         //-------------------------------------------------------------------------------------------------
@@ -80,8 +80,7 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(pName);
             AMF_RETURN_IF_INVALID_POINTER(pValue);
 
-            amf_wstring name(pName);
-            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.find(name);
+            PropertyValueMap::const_iterator found = m_PropertyValues.find(pName);
             if(found != m_PropertyValues.end())
             {
                 AMFVariantCopy(pValue, &found->second);
@@ -106,19 +105,11 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(pName);
             AMF_RETURN_IF_INVALID_POINTER(pValue);
             AMF_RETURN_IF_FALSE(nameSize != 0, AMF_INVALID_ARG);
-            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.begin();
-            if(found == m_PropertyValues.end())
+            if(index >= m_PropertyValues.size())
             {
                 return AMF_INVALID_ARG;
             }
-            for( amf_size i = 0; i < index; i++)
-            {
-                found++;
-                if(found == m_PropertyValues.end())
-                {
-                    return AMF_INVALID_ARG;
-                }
-            }
+            PropertyValueMap::const_iterator found = m_PropertyValues.begin() + index;
             size_t copySize = AMF_MIN(nameSize-1, found->first.length());
             memcpy(pName, found->first.c_str(), copySize * sizeof(wchar_t));
             pName[copySize] = 0;
@@ -136,7 +127,7 @@ namespace amf
         {
             AMF_RETURN_IF_INVALID_POINTER(pDest);
             AMF_RESULT err = AMF_OK;
-            amf_map<amf_wstring, AMFVariant>::const_iterator it = m_PropertyValues.begin();
+            PropertyValueMap::const_iterator it = m_PropertyValues.begin();
 
             for(; it != m_PropertyValues.end(); it++)
             {
@@ -186,7 +177,8 @@ namespace amf
         //-------------------------------------------------------------------------------------------------
     protected:
         //-------------------------------------------------------------------------------------------------
-        amf_map<amf_wstring, AMFVariant> m_PropertyValues;
+        typedef amf_wstring_flat_map<AMFVariant> PropertyValueMap;
+        PropertyValueMap m_PropertyValues;
     };
     //---------------------------------------------------------------------------------------------
     //---------------------------------------------------------------------------------------------
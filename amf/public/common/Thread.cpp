@@ -367,6 +367,7 @@ namespace amf
         }
         virtual bool Init()
         {
+            amf_set_current_thread_attributes(&m_pOwner->m_attributes);
             return m_pOwner->Init();
         }
         virtual bool Terminate()
@@ -471,7 +472,11 @@ namespace amf
 
         // this is executed in the thread and overloaded by implementor
         virtual void Run() { m_pOwner->Run(); }
-        virtual bool Init(){ return m_pOwner->Init(); }
+        virtual bool Init()
+        {
+            amf_set_current_thread_attributes(&m_pOwner->m_attributes);
+            return m_pOwner->Init();
+        }
         virtual bool Terminate(){ return m_pOwner->Terminate();}
 
     private:
@@ -588,7 +593,7 @@ namespace amf
 
 #endif //#if defined(__linux)
 
-    AMFThread::AMFThread() : m_thread()
+    AMFThread::AMFThread() : m_thread(), m_attributes()
     {
         m_thread = new AMFThreadObj(this);
     }
@@ -621,4 +626,10 @@ namespace amf
     {
         return m_thread->IsRunning();
     }
+
+    bool AMFThread::SetAttributes(const AMFThreadAttributes& attributes)
+    {
+        m_attributes = attributes;
+        return true;
+    }
 } //namespace
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <cassert>
+#include <atomic>
 #include <list>
 #include <vector>
 
@@ -44,6 +45,67 @@
 #include <pthread.h>
 #endif
 
+namespace amf
+{
+    #define AMF_THREAD_MAX_CPUS         1024
+    #define AMF_THREAD_ANY_NUMA_NODE    (-1)
+
+    enum AMF_THREAD_SCHEDULING
+    {
+        AMF_THREAD_SCHEDULING_DEFAULT = 0,  // time sharing, niceLevel applies
+        AMF_THREAD_SCHEDULING_FIFO,         // real time, runs until it blocks or yields, priority applies
+        AMF_THREAD_SCHEDULING_RR,           // real time, round robin among equal priorities, priority applies
+    };
+    //----------------------------------------------------------------
+    // placement and scheduling of a thread; applied by the thread itself before Init(),
+    // settings the OS refuses (e.g. real time without privileges) are skipped
+    struct AMFThreadAttributes
+    {
+        amf_uint64              cpuMask[AMF_THREAD_MAX_CPUS / 64];  // allowed logical CPUs; empty - no restriction
+        amf_int32               numaNode;           // AMF_THREAD_ANY_NUMA_NODE or node to run on when cpuMask is empty
+        bool                    preferNumaMemory;   // allocations of the thread prefer numaNode memory
+        AMF_THREAD_SCHEDULING   scheduling;
+        amf_int32               priority;           // 1..99 for FIFO and RR
+        amf_int32               niceLevel;          // -20..19 for DEFAULT, 0 - unchanged
+        char                    name[16];           // empty - unchanged, OS limit is 15 characters
+
+        AMFThreadAttributes() : cpuMask(), numaNode(AMF_THREAD_ANY_NUMA_NODE), preferNumaMemory(false),
+            scheduling(AMF_THREAD_SCHEDULING_DEFAULT), priority(0), niceLevel(0), name()
+        {}
+        void AddCpu(amf_int32 cpu)
+        {
+            if(cpu >= 0 && cpu < AMF_THREAD_MAX_CPUS)
+            {
+                cpuMask[cpu / 64] |= 1ULL << (cpu % 64);
+            }
+        }
+        bool HasCpu(amf_int32 cpu) const
+        {
+            return cpu >= 0 && cpu < AMF_THREAD_MAX_CPUS && (cpuMask[cpu / 64] & (1ULL << (cpu % 64))) != 0;
+        }
+        bool HasCpuMask() const
+        {
+            for(size_t i = 0; i < sizeof(cpuMask) / sizeof(cpuMask[0]); i++)
+            {
+                if(cpuMask[i] != 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+        void SetName(const char* pName)
+        {
+            size_t i = 0;
+            for(; pName != NULL && pName[i] != 0 && i < sizeof(name) - 1; i++)
+            {
+                name[i] = pName[i];
+            }
+            name[i] = 0;
+        }
+    };
+}
+
 extern "C"
 {
     // threads
@@ -86,6 +148,9 @@ extern "C"
     void        AMF_CDECL_CALL amf_sleep(amf_ulong delay);
     amf_pts     AMF_CDECL_CALL amf_high_precision_clock();    // in 100 of nanosec
 
+    // threads: placement and scheduling of the calling thread
+    bool        AMF_CDECL_CALL amf_set_current_thread_attributes(const amf::AMFThreadAttributes* pAttributes);
+
     void        AMF_CDECL_CALL amf_increase_timer_precision();
     void        AMF_CDECL_CALL amf_restore_timer_precision();
 
@@ -316,6 +381,10 @@ namespace amf
         virtual bool StopRequested();
         virtual bool IsRunning() const;
 
+        // takes effect at the next Start()
+        virtual bool SetAttributes(const AMFThreadAttributes& attributes);
+        const AMFThreadAttributes& GetAttributes() const { return m_attributes; }
+
         // this is executed in the thread and overloaded by implementor
         virtual void Run() = 0;
         virtual bool Init()
@@ -327,7 +396,10 @@ namespace amf
             return true;
         }
     private:
-        AMFThreadObj* m_thread;
+        friend class AMFThreadObj;
+
+        AMFThreadObj*       m_thread;
+        AMFThreadAttributes m_attributes;
 
         AMFThread(const AMFThread&);
         AMFThread& operator=(const AMFThread&);
@@ -335,8 +407,24 @@ namespace amf
 
     void ExitThread();
     //----------------------------------------------------------------
+    // Queue interface implemented by AMFQueue and AMFRingQueue; AMFQueueThread and
+    // AMFQueueThreadPipeline accept either through it.
+    template<typename T>
+    class AMFQueueBase
+    {
+    public:
+        virtual ~AMFQueueBase(){}
+
+        virtual bool SetQueueSize(amf_int32 iQueueSize) = 0;
+        virtual amf_int32 GetQueueSize() = 0;
+        virtual bool Add(amf_ulong ulID, const T& item, amf_long ulPriority = 0, amf_ulong ulTimeout = AMF_INFINITE) = 0;
+        virtual bool Get(amf_ulong& ulID, T& item, amf_ulong ulTimeout) = 0;
+        virtual void Clear() = 0;
+        virtual amf_size GetSize() = 0;
+    };
+    //----------------------------------------------------------------
     template<typename T>
-    class AMFQueue
+    class AMFQueue : public AMFQueueBase<T>
     {
     protected:
         class ItemData
@@ -457,6 +545,317 @@ namespace amf
         }
     };
     //----------------------------------------------------------------
+    // Bounded ring-buffer queue with the AMFQueue interface: no per-item allocation and no kernel
+    // objects on the fast path - events are signalled only when the other side is waiting.
+    // Implements AMFQueueBase only, so none of AMFQueue's list, lock or semaphore is created.
+    // bMultiThreaded = false selects the single-producer / single-consumer path (no CAS).
+    // iPriorityLevels > 1 keeps one ring per level: ulPriority is clamped to [0, iPriorityLevels - 1],
+    // higher levels are returned first, FIFO order is kept within a level; each level holds iQueueSize items.
+    // A ring cannot grow, so iQueueSize == 0 selects AMF_RING_QUEUE_DEFAULT_SIZE items.
+    // SetQueueSize() reallocates the rings and must not be called while the queue is in use.
+    #define AMF_RING_QUEUE_DEFAULT_SIZE 256
+
+    template<typename T>
+    class AMFRingQueue : public AMFQueueBase<T>
+    {
+    protected:
+        struct ItemData
+        {
+            T data;
+            amf_ulong ulID;
+            amf_long ulPriority;
+            ItemData() : data(), ulID(), ulPriority(){}
+        };
+
+        struct Cell
+        {
+            std::atomic<amf_size> sequence;
+            ItemData item;
+        };
+        class Ring
+        {
+        public:
+            Ring() : m_pCells(NULL), m_Capacity(0), m_Head(0), m_Tail(0) {}
+            ~Ring() { delete [] m_pCells; }
+
+            void Allocate(amf_size capacity)
+            {
+                delete [] m_pCells;
+                m_pCells = new Cell[capacity];
+                for(amf_size i = 0; i < capacity; i++)
+                {
+                    m_pCells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                m_Capacity = capacity;
+                m_Head.store(0, std::memory_order_relaxed);
+                m_Tail.store(0, std::memory_order_relaxed);
+            }
+            bool Push(const ItemData& item, bool bMultiThreaded)
+            {
+                amf_size pos = m_Tail.load(std::memory_order_relaxed);
+                Cell* pCell = NULL;
+                for(;;)
+                {
+                    pCell = &m_pCells[pos % m_Capacity];
+                    amf_int64 diff = (amf_int64)(pCell->sequence.load(std::memory_order_acquire) - pos);
+                    if(diff < 0)
+                    {
+                        return false; // full
+                    }
+                    if(diff == 0)
+                    {
+                        if(!bMultiThreaded)
+                        {
+                            m_Tail.store(pos + 1, std::memory_order_relaxed);
+                            break;
+                        }
+                        if(m_Tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        pos = m_Tail.load(std::memory_order_relaxed);
+                    }
+                }
+                pCell->item = item;
+                pCell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+            bool Pop(ItemData& item, bool bMultiThreaded)
+            {
+                amf_size pos = m_Head.load(std::memory_order_relaxed);
+                Cell* pCell = NULL;
+                for(;;)
+                {
+                    pCell = &m_pCells[pos % m_Capacity];
+                    amf_int64 diff = (amf_int64)(pCell->sequence.load(std::memory_order_acquire) - (pos + 1));
+                    if(diff < 0)
+                    {
+                        return false; // empty
+                    }
+                    if(diff == 0)
+                    {
+                        if(!bMultiThreaded)
+                        {
+                            m_Head.store(pos + 1, std::memory_order_relaxed);
+                            break;
+                        }
+                        if(m_Head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        pos = m_Head.load(std::memory_order_relaxed);
+                    }
+                }
+                item = pCell->item;
+                pCell->item = ItemData(); // release reference now, not when the cell is reused
+                pCell->sequence.store(pos + m_Capacity, std::memory_order_release);
+                return true;
+            }
+            amf_size GetSize() const
+            {
+                amf_size tail = m_Tail.load(std::memory_order_acquire);
+                amf_size head = m_Head.load(std::memory_order_acquire);
+                return tail > head ? tail - head : 0;
+            }
+        private:
+            Ring(const Ring&);
+            Ring& operator=(const Ring&);
+
+            Cell*                   m_pCells;
+            amf_size                m_Capacity;
+            char                    m_Pad0[64]; // keep producer and consumer indexes on separate cache lines
+            std::atomic<amf_size>   m_Head;
+            char                    m_Pad1[64];
+            std::atomic<amf_size>   m_Tail;
+            char                    m_Pad2[64];
+        };
+
+        std::vector<Ring*>      m_Rings;
+        bool                    m_bMultiThreaded;
+        amf_int32               m_iQueueSize;
+        AMFEvent                m_SomethingInQueueEvent;
+        AMFEvent                m_SpaceInQueueEvent;
+        std::atomic<amf_int32>  m_iWaitingConsumers;
+        std::atomic<amf_int32>  m_iWaitingProducers;
+
+        static amf_ulong GetRemainingTime(amf_pts start, amf_ulong ulTimeout)
+        {
+            if(ulTimeout == AMF_INFINITE)
+            {
+                return AMF_INFINITE;
+            }
+            amf_pts elapsed = (amf_high_precision_clock() - start) / 10000; // to ms
+            return elapsed >= (amf_pts)ulTimeout ? 0 : ulTimeout - (amf_ulong)elapsed;
+        }
+        bool TryAdd(const ItemData& itemdata)
+        {
+            amf_long level = itemdata.ulPriority;
+            if(level < 0)
+            {
+                level = 0;
+            }
+            if(level >= (amf_long)m_Rings.size())
+            {
+                level = (amf_long)m_Rings.size() - 1;
+            }
+            if(!m_Rings[level]->Push(itemdata, m_bMultiThreaded))
+            {
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(m_iWaitingConsumers.load(std::memory_order_relaxed) > 0)
+            {
+                m_SomethingInQueueEvent.SetEvent();
+            }
+            return true;
+        }
+        bool TryGet(amf_ulong& ulID, T& item)
+        {
+            ItemData itemdata;
+            for(amf_size i = m_Rings.size(); i > 0; i--)
+            {
+                if(m_Rings[i - 1]->Pop(itemdata, m_bMultiThreaded))
+                {
+                    ulID = itemdata.ulID;
+                    item = itemdata.data;
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if(m_iWaitingProducers.load(std::memory_order_relaxed) > 0)
+                    {
+                        m_SpaceInQueueEvent.SetEvent();
+                    }
+                    if(m_iWaitingConsumers.load(std::memory_order_relaxed) > 0 && GetSize() > 0)
+                    {
+                        m_SomethingInQueueEvent.SetEvent(); // auto-reset event wakes one waiter - pass it on
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+    public:
+        AMFRingQueue(amf_int32 iQueueSize = 0, bool bMultiThreaded = true, amf_int32 iPriorityLevels = 1)
+            : m_Rings(),
+            m_bMultiThreaded(bMultiThreaded),
+            m_iQueueSize(0),
+            m_SomethingInQueueEvent(false, false),
+            m_SpaceInQueueEvent(false, false),
+            m_iWaitingConsumers(0),
+            m_iWaitingProducers(0)
+        {
+            for(amf_int32 i = 0; i < (iPriorityLevels > 0 ? iPriorityLevels : 1); i++)
+            {
+                m_Rings.push_back(new Ring());
+            }
+            SetQueueSize(iQueueSize);
+        }
+        virtual ~AMFRingQueue()
+        {
+            for(amf_size i = 0; i < m_Rings.size(); i++)
+            {
+                delete m_Rings[i];
+            }
+        }
+        virtual bool SetQueueSize(amf_int32 iQueueSize)
+        {
+            amf_size capacity = iQueueSize > 0 ? (amf_size)iQueueSize : AMF_RING_QUEUE_DEFAULT_SIZE;
+            for(amf_size i = 0; i < m_Rings.size(); i++)
+            {
+                m_Rings[i]->Allocate(capacity);
+            }
+            m_iQueueSize = iQueueSize;
+            return true;
+        }
+        virtual amf_int32 GetQueueSize()
+        {
+            return m_iQueueSize;
+        }
+        virtual bool Add(amf_ulong ulID, const T& item, amf_long ulPriority = 0, amf_ulong ulTimeout = AMF_INFINITE)
+        {
+            ItemData itemdata;
+            itemdata.ulID = ulID;
+            itemdata.data = item;
+            itemdata.ulPriority = ulPriority;
+
+            if(TryAdd(itemdata))
+            {
+                return true;
+            }
+            amf_pts start = amf_high_precision_clock();
+            for(;;)
+            {
+                amf_ulong remaining = GetRemainingTime(start, ulTimeout);
+                if(remaining == 0)
+                {
+                    return TryAdd(itemdata);
+                }
+                m_iWaitingProducers.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool bAdded = TryAdd(itemdata);
+                if(!bAdded)
+                {
+                    m_SpaceInQueueEvent.Lock(remaining);
+                }
+                m_iWaitingProducers.fetch_sub(1);
+                if(bAdded || TryAdd(itemdata))
+                {
+                    return true;
+                }
+            }
+        }
+        virtual bool Get(amf_ulong& ulID, T& item, amf_ulong ulTimeout)
+        {
+            if(TryGet(ulID, item))
+            {
+                return true;
+            }
+            amf_pts start = amf_high_precision_clock();
+            for(;;)
+            {
+                amf_ulong remaining = GetRemainingTime(start, ulTimeout);
+                if(remaining == 0)
+                {
+                    return TryGet(ulID, item);
+                }
+                m_iWaitingConsumers.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool bGot = TryGet(ulID, item);
+                if(!bGot)
+                {
+                    m_SomethingInQueueEvent.Lock(remaining);
+                }
+                m_iWaitingConsumers.fetch_sub(1);
+                if(bGot || TryGet(ulID, item))
+                {
+                    return true;
+                }
+            }
+        }
+        virtual void Clear()
+        {
+            amf_ulong ulID;
+            T item;
+            while(TryGet(ulID, item))
+            {
+                item = T();
+            }
+        }
+        virtual amf_size GetSize()
+        {
+            amf_size size = 0;
+            for(amf_size i = 0; i < m_Rings.size(); i++)
+            {
+                size += m_Rings[i]->GetSize();
+            }
+            return size;
+        }
+    };
+    //----------------------------------------------------------------
     template<class inT, class outT>
     class AMFQueueThread : public AMFThread
     {
@@ -465,8 +864,8 @@ namespace amf
         AMFQueueThread& operator=(const AMFQueueThread&);
 
     protected:
-        AMFQueue<inT>* m_pInQueue;
-        AMFQueue<outT>* m_pOutQueue;
+        AMFQueueBase<inT>* m_pInQueue;
+        AMFQueueBase<outT>* m_pOutQueue;
         AMFMutex m_mutexInProcess;  ///< This mutex shows other threads that the thread function allocates
         ///< some objects on stack and it is unsafe state. To manipulate objects owned by descendant classes
         ///< client must lock this mutex by calling BlockProcessing member function. When client finished its work
@@ -475,8 +874,8 @@ namespace amf
         bool m_blockProcessingRequested;
         AMFCriticalSection m_csBlockingRequest;
     public:
-        AMFQueueThread(AMFQueue<inT>* pInQueue,
-            AMFQueue<outT>* pOutQueue) : m_pInQueue(pInQueue), m_pOutQueue(pOutQueue), m_mutexInProcess(),
+        AMFQueueThread(AMFQueueBase<inT>* pInQueue,
+            AMFQueueBase<outT>* pOutQueue) : m_pInQueue(pInQueue), m_pOutQueue(pOutQueue), m_mutexInProcess(),
             m_blockProcessingRequested(false), m_csBlockingRequest()
         {}
         virtual bool Process(amf_ulong& ulID, inT& inData, outT& outData) = 0;
@@ -572,11 +971,11 @@ namespace amf
         AMFQueueThreadPipeline& operator=(const AMFQueueThreadPipeline&);
 
     public:
-        AMFQueue<inT>* m_pInQueue;
-        AMFQueue<outT>* m_pOutQueue;
+        AMFQueueBase<inT>* m_pInQueue;
+        AMFQueueBase<outT>* m_pOutQueue;
         std::vector<_Thread*>    m_ThreadPool;
 
-        AMFQueueThreadPipeline(AMFQueue<inT>* pInQueue, AMFQueue<outT>* pOutQueue)
+        AMFQueueThreadPipeline(AMFQueueBase<inT>* pInQueue, AMFQueueBase<outT>* pOutQueue)
             : m_pInQueue(pInQueue),
             m_pOutQueue(pOutQueue),
             m_ThreadPool()
@@ -586,6 +985,11 @@ namespace amf
             Stop();
         }
         void Start(int iNumberOfThreads, ThreadParam param)
+        {
+            Start(iNumberOfThreads, param, std::vector<AMFThreadAttributes>());
+        }
+        // thread i gets attributes[i % attributes.size()], e.g. one entry per core or NUMA node
+        void Start(int iNumberOfThreads, ThreadParam param, const std::vector<AMFThreadAttributes>& attributes)
         {
             if((long)m_ThreadPool.size() >= iNumberOfThreads)
             {
@@ -597,6 +1001,10 @@ namespace amf
             {
                 _Thread* pThread = new _Thread(m_pInQueue, m_pOutQueue, param);
                 m_ThreadPool.push_back(pThread);
+                if(!attributes.empty())
+                {
+                    pThread->SetAttributes(attributes[i % attributes.size()]);
+                }
                 pThread->Start();
             }
         }
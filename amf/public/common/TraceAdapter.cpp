@@ -72,6 +72,616 @@ static AMFTrace *GetTrace()
     return s_pTrace;
 }
 //------------------------------------------------------------------------------------------------
+// deferred trace capture
+//------------------------------------------------------------------------------------------------
+namespace
+{
+    #define AMF_TRACE_CAPTURE_MAX_ARGS      16
+    #define AMF_TRACE_CAPTURE_TEXT_SIZE     384     // in wchar_t: path, scope, format and string arguments
+    #define AMF_TRACE_CAPTURE_RING_SIZE     128     // records per thread, power of 2
+
+    enum TraceArgKind
+    {
+        TRACE_ARG_INT = 0,
+        TRACE_ARG_DOUBLE,
+        TRACE_ARG_POINTER,
+        TRACE_ARG_STRING,   // offset of a copy in TraceRecord::text
+    };
+
+    struct TraceArg
+    {
+        amf_int32   kind;
+        union
+        {
+            amf_int64   i;
+            double      d;
+            const void* p;
+            amf_int32   offset;
+        };
+    };
+
+    struct TraceRecord
+    {
+        amf_pts     timestamp;
+        amf_int32   level;
+        amf_int32   line;
+        amf_int32   argCount;
+        amf_int32   scopeOffset;
+        amf_int32   formatOffset;   // format string, or the finished message when bFormatted is set
+        bool        bFormatted;
+        TraceArg    args[AMF_TRACE_CAPTURE_MAX_ARGS];
+        wchar_t     text[AMF_TRACE_CAPTURE_TEXT_SIZE];
+    };
+
+    // single producer (the owning thread), single consumer (the formatter)
+    struct TraceRing
+    {
+        std::atomic<amf_uint32> head;
+        std::atomic<amf_uint32> tail;
+        std::atomic<bool>       bOwned;
+        TraceRecord             records[AMF_TRACE_CAPTURE_RING_SIZE];
+
+        TraceRing() : head(0), tail(0), bOwned(true) {}
+    };
+
+    //--------------------------------------------------------------------------------------------
+    // parsed conversion specification, just enough of printf to know the argument types
+    struct TraceSpec
+    {
+        const wchar_t*  pStart;     // at '%'
+        const wchar_t*  pEnd;       // past the conversion character
+        wchar_t         conversion;
+        amf_int32       length;     // 0 default, 1 h/hh, 2 l, 3 ll/I64/j/q, 4 z/t/I, 5 L
+        bool            bWideString;
+    };
+
+    // returns false for specifications the capture cannot represent
+    static bool ParseTraceSpec(const wchar_t* p, TraceSpec& spec)
+    {
+        spec.pStart = p++;
+        while (*p == L'-' || *p == L'+' || *p == L' ' || *p == L'#' || *p == L'0' || *p == L'\'')
+        {
+            p++;
+        }
+        while (*p >= L'0' && *p <= L'9')
+        {
+            p++;
+        }
+        if (*p == L'.')
+        {
+            p++;
+            while (*p >= L'0' && *p <= L'9')
+            {
+                p++;
+            }
+        }
+        if (*p == L'*')
+        {
+            return false;
+        }
+        spec.length = 0;
+        if (*p == L'h')
+        {
+            spec.length = 1;
+            p += (p[1] == L'h') ? 2 : 1;
+        }
+        else if (*p == L'l')
+        {
+            spec.length = (p[1] == L'l') ? 3 : 2;
+            p += (p[1] == L'l') ? 2 : 1;
+        }
+        else if (*p == L'j' || *p == L'q')
+        {
+            spec.length = 3;
+            p++;
+        }
+        else if (*p == L'I' && p[1] == L'6' && p[2] == L'4')
+        {
+            spec.length = 3;
+            p += 3;
+        }
+        else if (*p == L'I' && p[1] == L'3' && p[2] == L'2')
+        {
+            p += 3;
+        }
+        else if (*p == L'z' || *p == L't' || *p == L'I')
+        {
+            spec.length = 4;
+            p++;
+        }
+        else if (*p == L'L')
+        {
+            spec.length = 5;
+            p++;
+        }
+        spec.conversion = *p;
+        if (spec.conversion == 0)
+        {
+            return false;
+        }
+        spec.pEnd = p + 1;
+        // AMF formats follow the Windows wide printf convention: %s is wide, %S and %hs are narrow
+        spec.bWideString = (spec.conversion == L's' && spec.length != 1) || (spec.conversion == L'S' && spec.length == 2);
+        return spec.length != 5;
+    }
+
+    //--------------------------------------------------------------------------------------------
+    static bool AppendTraceText(TraceRecord& record, amf_int32& pos, const wchar_t* pText)
+    {
+        if (pText == NULL)
+        {
+            pText = L"(null)";
+        }
+        const size_t length = wcslen(pText);
+        if (pos + length + 1 > AMF_TRACE_CAPTURE_TEXT_SIZE)
+        {
+            return false;
+        }
+        memcpy(record.text + pos, pText, (length + 1) * sizeof(wchar_t));
+        pos += amf_int32(length + 1);
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // returns the next code point of a UTF-8 string, U+FFFD for a malformed or overlong sequence
+    static amf_uint32 DecodeUtf8(const amf_uint8*& p)
+    {
+        static const amf_uint32 s_MinCodePoint[4] = { 0, 0x80, 0x800, 0x10000 };
+
+        amf_uint32 codePoint = *p++;
+        amf_int32 extra = 0;
+        if (codePoint < 0x80)
+        {
+            return codePoint;
+        }
+        else if (codePoint >= 0xC2 && codePoint < 0xE0)
+        {
+            extra = 1;
+            codePoint &= 0x1F;
+        }
+        else if (codePoint >= 0xE0 && codePoint < 0xF0)
+        {
+            extra = 2;
+            codePoint &= 0x0F;
+        }
+        else if (codePoint >= 0xF0 && codePoint < 0xF5)
+        {
+            extra = 3;
+            codePoint &= 0x07;
+        }
+        else
+        {
+            return 0xFFFD; // continuation byte without a lead byte, or a lead byte UTF-8 never uses
+        }
+        for (amf_int32 i = 0; i < extra; i++)
+        {
+            if ((*p & 0xC0) != 0x80)
+            {
+                return 0xFFFD; // truncated, the byte that ended it starts the next character
+            }
+            codePoint = (codePoint << 6) | (*p++ & 0x3F);
+        }
+        if (codePoint < s_MinCodePoint[extra] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint < 0xE000))
+        {
+            return 0xFFFD;
+        }
+        return codePoint;
+    }
+    //--------------------------------------------------------------------------------------------
+    // narrow strings are UTF-8, decoded in place as the capture path must not allocate
+    static bool AppendTraceText(TraceRecord& record, amf_int32& pos, const char* pText)
+    {
+        if (pText == NULL)
+        {
+            pText = "(null)";
+        }
+        const amf_uint8* p = reinterpret_cast<const amf_uint8*>(pText);
+        amf_int32 end = pos;
+        while (*p != 0)
+        {
+            const amf_uint32 codePoint = DecodeUtf8(p);
+            const amf_int32 units = (sizeof(wchar_t) == 2 && codePoint >= 0x10000) ? 2 : 1;
+            if (end + units + 1 > AMF_TRACE_CAPTURE_TEXT_SIZE)
+            {
+                return false;
+            }
+            if (units == 2)
+            {
+                record.text[end++] = wchar_t(0xD800 + ((codePoint - 0x10000) >> 10));
+                record.text[end++] = wchar_t(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+            }
+            else
+            {
+                record.text[end++] = wchar_t(codePoint);
+            }
+        }
+        if (end + 1 > AMF_TRACE_CAPTURE_TEXT_SIZE)
+        {
+            return false;
+        }
+        record.text[end++] = 0;
+        pos = end;
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    static bool FillTraceRecord(TraceRecord& record, const wchar_t* src_path, amf_int32 line, amf_int32 level,
+        const wchar_t* scope, amf_int32 countArgs, const wchar_t* format, va_list* pArgs)
+    {
+        record.timestamp = amf_high_precision_clock();
+        record.level = level;
+        record.line = line;
+        record.argCount = 0;
+        record.bFormatted = countArgs <= 0;
+
+        amf_int32 pos = 0;
+        if (!AppendTraceText(record, pos, src_path))
+        {
+            return false;
+        }
+        record.scopeOffset = pos;
+        if (!AppendTraceText(record, pos, scope))
+        {
+            return false;
+        }
+        record.formatOffset = pos;
+        if (!AppendTraceText(record, pos, format))
+        {
+            return false;
+        }
+        if (record.bFormatted)
+        {
+            return true;
+        }
+
+        for (const wchar_t* p = format; *p != 0; p++)
+        {
+            if (*p != L'%')
+            {
+                continue;
+            }
+            if (p[1] == L'%')
+            {
+                p++;
+                continue;
+            }
+            TraceSpec spec;
+            if (!ParseTraceSpec(p, spec) || record.argCount == AMF_TRACE_CAPTURE_MAX_ARGS)
+            {
+                return false;
+            }
+            p = spec.pEnd - 1;
+
+            TraceArg& arg = record.args[record.argCount++];
+            switch (spec.conversion)
+            {
+            case L'd': case L'i': case L'u': case L'o': case L'x': case L'X': case L'c': case L'C':
+                arg.kind = TRACE_ARG_INT;
+                if (spec.length == 3)
+                {
+                    arg.i = va_arg(*pArgs, long long);
+                }
+                else if (spec.length == 4)
+                {
+                    arg.i = amf_int64(va_arg(*pArgs, size_t));
+                }
+                else if (spec.length == 2 && spec.conversion != L'c' && spec.conversion != L'C')
+                {
+                    arg.i = va_arg(*pArgs, long);
+                }
+                else
+                {
+                    arg.i = va_arg(*pArgs, int);
+                }
+                break;
+            case L'f': case L'F': case L'e': case L'E': case L'g': case L'G': case L'a': case L'A':
+                arg.kind = TRACE_ARG_DOUBLE;
+                arg.d = va_arg(*pArgs, double);
+                break;
+            case L'p':
+                arg.kind = TRACE_ARG_POINTER;
+                arg.p = va_arg(*pArgs, const void*);
+                break;
+            case L's': case L'S':
+                arg.kind = TRACE_ARG_STRING;
+                arg.offset = pos;
+                if (spec.bWideString ? !AppendTraceText(record, pos, va_arg(*pArgs, const wchar_t*))
+                                     : !AppendTraceText(record, pos, va_arg(*pArgs, const char*)))
+                {
+                    return false;
+                }
+                break;
+            default: // %n and unknown conversions
+                return false;
+            }
+        }
+        return true;
+    }
+    //--------------------------------------------------------------------------------------------
+    // formats one conversion at a time with the argument captured for it
+    static void FormatTraceRecord(const TraceRecord& record, amf_wstring& message)
+    {
+        const wchar_t* format = record.text + record.formatOffset;
+        message.clear();
+        if (record.bFormatted)
+        {
+            message = format;
+            return;
+        }
+
+        wchar_t specText[64];
+        wchar_t buf[512];
+        amf_int32 argIndex = 0;
+        for (const wchar_t* p = format; *p != 0; p++)
+        {
+            if (*p != L'%')
+            {
+                message.push_back(*p);
+                continue;
+            }
+            if (p[1] == L'%')
+            {
+                message.push_back(L'%');
+                p++;
+                continue;
+            }
+            TraceSpec spec;
+            ParseTraceSpec(p, spec);
+            p = spec.pEnd - 1;
+            const TraceArg& arg = record.args[argIndex++];
+
+            // flags, width and precision are kept; the length is rewritten for the captured type
+            size_t prefix = 1;
+            while (spec.pStart + prefix < spec.pEnd && wcschr(L"-+ #0'.0123456789", spec.pStart[prefix]) != NULL && spec.pStart[prefix] != 0)
+            {
+                prefix++;
+            }
+            if (prefix > 32)
+            {
+                prefix = 32;
+            }
+            memcpy(specText, spec.pStart, prefix * sizeof(wchar_t));
+            wchar_t* pTail = specText + prefix;
+            int written = 0;
+            switch (arg.kind)
+            {
+            case TRACE_ARG_INT:
+                if (spec.conversion == L'c' || spec.conversion == L'C')
+                {
+                    *pTail++ = L'l';
+                    *pTail++ = L'c';
+                    *pTail = 0;
+                    written = swprintf(buf, amf_countof(buf), specText, wint_t(arg.i));
+                }
+                else
+                {
+                    *pTail++ = L'l';
+                    *pTail++ = L'l';
+                    *pTail++ = spec.conversion;
+                    *pTail = 0;
+                    amf_int64 value = arg.i;
+                    // unsigned conversions of narrower arguments must not see the sign extension
+                    if (spec.conversion != L'd' && spec.conversion != L'i')
+                    {
+                        if (spec.length == 0 || (spec.length == 2 && sizeof(long) == 4))
+                        {
+                            value = amf_int64(amf_uint32(value));
+                        }
+                        else if (spec.length == 1)
+                        {
+                            value = amf_int64(spec.pEnd[-2] == L'h' && spec.pEnd[-3] == L'h' ? amf_uint8(value) : amf_uint16(value));
+                        }
+                    }
+                    written = swprintf(buf, amf_countof(buf), specText, (long long)value);
+                }
+                break;
+            case TRACE_ARG_DOUBLE:
+                *pTail++ = spec.conversion;
+                *pTail = 0;
+                written = swprintf(buf, amf_countof(buf), specText, arg.d);
+                break;
+            case TRACE_ARG_POINTER:
+                *pTail++ = L'p';
+                *pTail = 0;
+                written = swprintf(buf, amf_countof(buf), specText, arg.p);
+                break;
+            default:
+                *pTail++ = L'l';
+                *pTail++ = L's';
+                *pTail = 0;
+                written = swprintf(buf, amf_countof(buf), specText, record.text + arg.offset);
+                if (written < 0)
+                {
+                    // longer than buf: the string itself still fits into the message
+                    message += record.text + arg.offset;
+                    written = 0;
+                }
+                break;
+            }
+            if (written > 0)
+            {
+                message.append(buf, written);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------
+    class TraceCapture : public AMFThread
+    {
+    public:
+        TraceCapture() : m_bEnabled(false), m_iBudget(0), m_iBudgetGeneration(1), m_iAllocated(0), m_iDropped(0) {}
+
+        bool IsEnabled() const { return m_bEnabled.load(std::memory_order_relaxed); }
+
+        // called on the tracing thread; returns false when the message has to go the synchronous way
+        bool Capture(const wchar_t* src_path, amf_int32 line, amf_int32 level, const wchar_t* scope,
+            amf_int32 countArgs, const wchar_t* format, va_list* pArgs)
+        {
+            TraceRing* pRing = GetThreadRing();
+            if (pRing == NULL)
+            {
+                return false;
+            }
+            const amf_uint32 tail = pRing->tail.load(std::memory_order_relaxed);
+            if (tail - pRing->head.load(std::memory_order_acquire) >= AMF_TRACE_CAPTURE_RING_SIZE)
+            {
+                m_iDropped++;
+                return true;
+            }
+            TraceRecord& record = pRing->records[tail & (AMF_TRACE_CAPTURE_RING_SIZE - 1)];
+            if (!FillTraceRecord(record, src_path, line, level, scope, countArgs, format, pArgs))
+            {
+                return false;
+            }
+            pRing->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        AMF_RESULT Enable(bool enable, amf_size memoryBudget)
+        {
+            AMFLock lock(&m_enableSync);
+            if (enable)
+            {
+                {
+                    AMFLock ringsLock(&m_sync);
+                    m_iBudget = memoryBudget;
+                    m_iBudgetGeneration++;  // threads turned away under the old budget try again
+                }
+                if (!m_bEnabled)
+                {
+                    AMF_RETURN_IF_FALSE(Start(), AMF_FAIL, L"AMFTraceEnableCapture() - failed to start the formatter thread");
+                    m_bEnabled = true;
+                }
+            }
+            else if (m_bEnabled)
+            {
+                m_bEnabled = false;
+                RequestStop();
+                WaitForStop();
+                Drain();
+            }
+            return AMF_OK;
+        }
+
+        amf_int64 GetDroppedCount() const { return m_iDropped.load(); }
+
+        // writes every captured message in timestamp order; returns the number written
+        amf_size Drain()
+        {
+            AMFLock lock(&m_drainSync);
+            amf_vector<TraceRing*> rings;
+            {
+                AMFLock ringsLock(&m_sync);
+                rings = m_Rings;
+            }
+            amf_size written = 0;
+            while (true)
+            {
+                TraceRing* pOldest = NULL;
+                for (amf_vector<TraceRing*>::iterator it = rings.begin(); it != rings.end(); ++it)
+                {
+                    TraceRing* pRing = *it;
+                    const amf_uint32 head = pRing->head.load(std::memory_order_relaxed);
+                    if (head == pRing->tail.load(std::memory_order_acquire))
+                    {
+                        continue;
+                    }
+                    if (pOldest == NULL ||
+                        pRing->records[head & (AMF_TRACE_CAPTURE_RING_SIZE - 1)].timestamp <
+                        pOldest->records[pOldest->head.load(std::memory_order_relaxed) & (AMF_TRACE_CAPTURE_RING_SIZE - 1)].timestamp)
+                    {
+                        pOldest = pRing;
+                    }
+                }
+                if (pOldest == NULL)
+                {
+                    break;
+                }
+                const amf_uint32 head = pOldest->head.load(std::memory_order_relaxed);
+                const TraceRecord& record = pOldest->records[head & (AMF_TRACE_CAPTURE_RING_SIZE - 1)];
+                FormatTraceRecord(record, m_Message);
+                GetTrace()->Trace(record.text, record.line, record.level, record.text + record.scopeOffset, m_Message.c_str(), NULL);
+                pOldest->head.store(head + 1, std::memory_order_release);
+                written++;
+            }
+            return written;
+        }
+
+    protected:
+        virtual void Run()
+        {
+            while (!StopRequested())
+            {
+                if (Drain() == 0)
+                {
+                    amf_sleep(1);
+                }
+            }
+        }
+
+    private:
+        // releases the ring of an exiting thread so that a new thread can take it over
+        struct ThreadRingOwner
+        {
+            TraceRing* pRing;
+            ThreadRingOwner() : pRing(NULL) {}
+            ~ThreadRingOwner()
+            {
+                if (pRing != NULL)
+                {
+                    pRing->bOwned = false;
+                }
+            }
+        };
+
+        TraceRing* GetThreadRing()
+        {
+            static thread_local ThreadRingOwner s_owner;
+            static thread_local amf_uint32 s_iOverBudgetGeneration = 0;   // budget this thread did not fit into
+            if (s_owner.pRing != NULL || s_iOverBudgetGeneration == m_iBudgetGeneration.load(std::memory_order_relaxed))
+            {
+                return s_owner.pRing;
+            }
+
+            AMFLock lock(&m_sync);
+            for (amf_vector<TraceRing*>::iterator it = m_Rings.begin(); it != m_Rings.end(); ++it)
+            {
+                bool bOwned = false;
+                if ((*it)->bOwned.compare_exchange_strong(bOwned, true))
+                {
+                    s_owner.pRing = *it;
+                    return s_owner.pRing;
+                }
+            }
+            if (m_iAllocated + sizeof(TraceRing) > m_iBudget)
+            {
+                s_iOverBudgetGeneration = m_iBudgetGeneration.load(std::memory_order_relaxed);
+                return NULL;
+            }
+            // rings live until the process exits: a thread may still be writing into one while capture is disabled
+            s_owner.pRing = new TraceRing();
+            m_iAllocated += sizeof(TraceRing);
+            m_Rings.push_back(s_owner.pRing);
+            return s_owner.pRing;
+        }
+
+        std::atomic<bool>       m_bEnabled;
+        AMFCriticalSection      m_enableSync;
+        AMFCriticalSection      m_sync;         // ring list and budget
+        AMFCriticalSection      m_drainSync;
+        amf_vector<TraceRing*>  m_Rings;
+        amf_size                m_iBudget;
+        std::atomic<amf_uint32> m_iBudgetGeneration;
+        amf_size                m_iAllocated;
+        std::atomic<amf_int64>  m_iDropped;
+        amf_wstring             m_Message;
+    };
+
+    static TraceCapture& GetTraceCapture()
+    {
+        static TraceCapture* s_pCapture = new TraceCapture();  // not destroyed: traces may come from static destructors
+        return *s_pCapture;
+    }
+}
+//------------------------------------------------------------------------------------------------
 static AMFDebug *s_pDebug = NULL;
 //------------------------------------------------------------------------------------------------
 static AMFDebug *GetDebug()
@@ -114,12 +724,37 @@ AMF_RESULT AMF_CDECL_CALL amf::AMFTraceEnableAsync(bool enable)
 //------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_CDECL_CALL amf::AMFTraceFlush()
 {
+    GetTraceCapture().Drain();
     return GetTrace()->TraceFlush();
 }
 //------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_CDECL_CALL amf::AMFTraceEnableCapture(bool enable, amf_size memoryBudget)
+{
+    return GetTraceCapture().Enable(enable, memoryBudget);
+}
+//------------------------------------------------------------------------------------------------
+amf_int64 AMF_CDECL_CALL amf::AMFTraceGetDroppedCount()
+{
+    return GetTraceCapture().GetDroppedCount();
+}
+//------------------------------------------------------------------------------------------------
 void AMF_CDECL_CALL amf::AMFTraceW(const wchar_t* src_path, amf_int32 line, amf_int32 level, const wchar_t* scope,
             amf_int32 countArgs, const wchar_t* format, ...) // if countArgs <= 0 -> no args, formatting could be optimized then
 {
+    TraceCapture& capture = GetTraceCapture();
+    // messages above the global level are dropped by the tracer anyway, don't spend ring space on them
+    if (capture.IsEnabled() && level <= GetTrace()->GetGlobalLevel())
+    {
+        va_list vl;
+        va_start(vl, format);
+        const bool bCaptured = capture.Capture(src_path, line, level, scope, countArgs, format, &vl);
+        va_end(vl);
+        if (bCaptured)
+        {
+            return;
+        }
+    }
+
     if(countArgs <= 0)
     {
         GetTrace()->Trace(src_path, line, level, scope, format, NULL);
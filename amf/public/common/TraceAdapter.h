@@ -98,6 +98,38 @@ extern "C"
 {
 AMF_RESULT AMF_CDECL_CALL AMFTraceEnableAsync(bool enable);
 
+/**
+*******************************************************************************
+*   AMFTraceEnableCapture
+*
+*   @brief
+*       Enable or disable deferred formatting of traces issued through AMFTraceW in this module
+*
+*  When enabled, AMFTraceW copies the format, the arguments and a timestamp into a lock-free
+*  ring owned by the calling thread and returns; a background thread formats the messages in
+*  timestamp order and passes them to the registered writers.
+*  memoryBudget bounds the total size of all rings. Threads that do not fit into the budget and
+*  messages the capture cannot represent (%n, '*' width or precision, long double, oversized text)
+*  go through the synchronous path; enabling again with a new budget lets those threads retry.
+*  Messages above the global trace level are not captured. Messages that arrive while the ring
+*  of their thread is full are dropped and counted, see AMFTraceGetDroppedCount.
+*  Writers see the time and thread of the formatter rather than those of the caller.
+*  AMFTraceFlush drains the rings first. Disable capture before quitting the application.
+*******************************************************************************
+*/
+AMF_RESULT AMF_CDECL_CALL AMFTraceEnableCapture(bool enable, amf_size memoryBudget);
+
+/**
+*******************************************************************************
+*   AMFTraceGetDroppedCount
+*
+*   @brief
+*       Returns the number of messages dropped by the capture since start of the process
+*
+*******************************************************************************
+*/
+amf_int64 AMF_CDECL_CALL AMFTraceGetDroppedCount();
+
 /**
 *******************************************************************************
 *   AMFDebugSetDebugger
@@ -295,6 +295,71 @@ amf_pts AMF_CDECL_CALL amf_high_precision_clock()
 
 #endif
 }
+//----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_set_current_thread_attributes(const amf::AMFThreadAttributes* pAttributes)
+{
+    if(pAttributes == NULL)
+    {
+        return false;
+    }
+#if defined(METRO_APP)
+    return false;
+#else
+    bool result = true;
+    HANDLE hThread = GetCurrentThread();
+
+    // only processor group 0 is addressed; the system places memory on the node of the running CPU
+    ULONGLONG mask = pAttributes->cpuMask[0];
+    if(mask == 0 && pAttributes->numaNode != AMF_THREAD_ANY_NUMA_NODE)
+    {
+        result = GetNumaNodeProcessorMask((UCHAR)pAttributes->numaNode, &mask) != FALSE && result;
+    }
+    if(mask != 0)
+    {
+        result = SetThreadAffinityMask(hThread, (DWORD_PTR)mask) != 0 && result;
+    }
+
+    int priority = THREAD_PRIORITY_NORMAL;
+    if(pAttributes->scheduling != amf::AMF_THREAD_SCHEDULING_DEFAULT)
+    {
+        priority = pAttributes->priority >= 50 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+    }
+    else if(pAttributes->niceLevel <= -15)
+    {
+        priority = THREAD_PRIORITY_HIGHEST;
+    }
+    else if(pAttributes->niceLevel < 0)
+    {
+        priority = THREAD_PRIORITY_ABOVE_NORMAL;
+    }
+    else if(pAttributes->niceLevel >= 15)
+    {
+        priority = THREAD_PRIORITY_LOWEST;
+    }
+    else if(pAttributes->niceLevel > 0)
+    {
+        priority = THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    if(priority != THREAD_PRIORITY_NORMAL)
+    {
+        result = SetThreadPriority(hThread, priority) != FALSE && result;
+    }
+
+    if(pAttributes->name[0] != 0)
+    {
+        // SetThreadDescription is available starting Windows 10 1607
+        typedef HRESULT (WINAPI *SetThreadDescription_Fn)(HANDLE, PCWSTR);
+        SetThreadDescription_Fn pSetThreadDescription = (SetThreadDescription_Fn)GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription");
+        if(pSetThreadDescription != NULL)
+        {
+            wchar_t name[sizeof(pAttributes->name)];
+            MultiByteToWideChar(CP_UTF8, 0, pAttributes->name, -1, name, (int)(sizeof(name) / sizeof(name[0])));
+            result = SUCCEEDED(pSetThreadDescription(hThread, name)) && result;
+        }
+    }
+    return result;
+#endif
+}
 //-------------------------------------------------------------------------------------------------
 #pragma comment (lib, "Winmm.lib")
 static amf_uint32 timerPrecision = 1;
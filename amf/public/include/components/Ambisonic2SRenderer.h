@@ -49,6 +49,12 @@ enum AMF_AMBISONIC2SRENDERER_MODE_ENUM
     AMF_AMBISONIC2SRENDERER_MODE_HRTF_MIT1         = 2,
 };
 
+enum AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM 
+{
+    AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN        = 0,
+    AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT    = 1,
+};
+
 
 // static properties 
 #define AMF_AMBISONIC2SRENDERER_IN_AUDIO_SAMPLE_RATE        L"InSampleRate"         // amf_int64 (default = 0)
@@ -60,6 +66,7 @@ enum AMF_AMBISONIC2SRENDERER_MODE_ENUM
 #define AMF_AMBISONIC2SRENDERER_OUT_AUDIO_CHANNEL_LAYOUT    L"OutChannelLayout"     // amf_int64 (only = 3 - defalut stereo L R)
 
 #define AMF_AMBISONIC2SRENDERER_MODE                        L"StereoMode"               //TODO: AMF_AMBISONIC2SRENDERER_MODE_ENUM(default=AMF_AMBISONIC2SRENDERER_MODE_HRTF)
+#define AMF_AMBISONIC2SRENDERER_CONVOLUTION                 L"Convolution"              // AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM(default=AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN) - HRTF convolution engine
 
 
 // dynamic properties
@@ -51,8 +51,31 @@
 //#define FFMPEG_DEMUXER_SYNC_AV                  L"SyncAV"                   // bool (default = false)
 #define FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE   L"StreamMode"               // bool (default = true)
 #define FFMPEG_DEMUXER_LISTEN                   L"Listen"                   // bool (default = false)
+#define FFMPEG_DEMUXER_ZERO_COPY                L"ZeroCopy"                 // bool (default = false) - output buffers wrap packet memory instead of copying it
+#define FFMPEG_DEMUXER_DATA_STREAM              L"DataStream"               // AMFInterface* (AMFDataStream, default = NULL) - read from this stream instead of Path
+#define FFMPEG_DEMUXER_IO_BUFFER_SIZE           L"IOBufferSize"             // amf_int64 (default = 0) - I/O buffer size in bytes, e.g. 4-16 MB; non-zero reads Path through AMFDataStream
+#define FFMPEG_DEMUXER_DIRECT_IO                L"DirectIO"                 // bool (default = false) - read Path with O_DIRECT, bypassing the page cache (Linux)
+#define FFMPEG_DEMUXER_FAST_OPEN                L"FastOpen"                 // bool (default = false) - probe with small limits and skip the H.264 MVC scan
+#define FFMPEG_DEMUXER_PROBE_SIZE               L"ProbeSize"                // amf_int64 (default = 0) - bytes read to detect streams, 0 = FFmpeg default (1 MB in fast open)
+#define FFMPEG_DEMUXER_ANALYZE_DURATION         L"AnalyzeDuration"          // amf_int64 (default = 0) - media time analyzed to detect streams in 100 ns, 0 = FFmpeg default (0.5 s in fast open)
+#define FFMPEG_DEMUXER_STREAM_INFO_CACHE        L"StreamInfoCache"          // string (default = "") - folder for cached stream parameters of local files, keyed by path, size and time; empty = off
+#define FFMPEG_DEMUXER_KEYFRAME_INDEX           L"KeyframeIndex"            // bool (default = false) - index video keyframes of Path in the background; Seek() then lands on the exact keyframe
+#define FFMPEG_DEMUXER_KEYFRAME_INDEX_PATH      L"KeyframeIndexPath"        // string (default = "") - sidecar file keeping the index between opens, empty = Path + ".kfi"
+#define FFMPEG_DEMUXER_SEEK_DECODE_FRAMES       L"SeekDecodeFrames"         // amf_int64 (read) - packets to decode after the last Seek() before its position is reached, -1 = unknown
+#define FFMPEG_DEMUXER_STREAM_SELECTION         L"StreamSelection"          // amf_int64 (AMF_DEMUXER_STREAM_SELECTION_ENUM, default = AMF_DEMUXER_STREAM_SELECTION_MAIN) - streams exposed as outputs, all read in one pass
+#define FFMPEG_DEMUXER_STREAM_LIST              L"StreamList"               // string (default = "") - comma separated FFmpeg stream indexes for AMF_DEMUXER_STREAM_SELECTION_LIST
+#define FFMPEG_DEMUXER_STREAM_CACHE_SIZE        L"StreamCacheSize"          // amf_int64 (default = 1024) - packets an enabled output may hold for its reader; when full, other outputs get AMF_REPEAT until it is drained, 0 - unlimited
+
+enum AMF_DEMUXER_STREAM_SELECTION_ENUM
+{
+    AMF_DEMUXER_STREAM_SELECTION_MAIN     = 0,    // the largest video and the audio with the highest sample rate
+    AMF_DEMUXER_STREAM_SELECTION_ALL      = 1,    // every video, audio and subtitle stream except cover art
+    AMF_DEMUXER_STREAM_SELECTION_LIST     = 2,    // the streams in FFMPEG_DEMUXER_STREAM_LIST
+};
 
 // for common, video and audio properties see Component.h
+#define FFMPEG_DEMUXER_STREAM_INDEX             L"StreamIndex"              // amf_int64 - FFmpeg index of the stream behind the output
+#define FFMPEG_DEMUXER_STREAM_LANGUAGE          L"Language"                 // string (default = "") - language tag from the container, e.g. "eng"
 
 
 // video stream properties
@@ -50,5 +50,17 @@
 #define FFMPEG_MUXER_CURRENT_TIME_INTERFACE   L"CurrentTimeInterface"
 #define FFMPEG_MUXER_VIDEO_ROTATION           L"VideoRotation"            // amf_int64 (0, 90, 180, 270, default = 0)
 #define FFMPEG_MUXER_USAGE_IS_TRIM            L"UsageIsTrim"              // bool (default = false)
+#define FFMPEG_MUXER_WRITE_BEHIND             L"WriteBehind"              // bool (default = false) - packets are queued and written to the file by a dedicated I/O thread
+#define FFMPEG_MUXER_WRITE_QUEUE_DEPTH        L"WriteQueueDepth"          // amf_int64 (default = 256) - write-behind queue limit in packets
+#define FFMPEG_MUXER_WRITE_QUEUE_MEMORY       L"WriteQueueMemory"         // amf_int64 (default = 64 MB) - write-behind queue limit in bytes
+#define FFMPEG_MUXER_DATA_STREAM              L"DataStream"               // AMFInterface* (AMFDataStream, default = NULL) - write to this stream; Path still selects the container format
+#define FFMPEG_MUXER_IO_BUFFER_SIZE           L"IOBufferSize"             // amf_int64 (default = 0) - I/O buffer size in bytes, e.g. 4-16 MB; non-zero writes Path through AMFDataStream
+#define FFMPEG_MUXER_DIRECT_IO                L"DirectIO"                 // bool (default = false) - write Path with O_DIRECT, bypassing the page cache (Linux)
+
+// statistics - read only
+#define FFMPEG_MUXER_STAT_QUEUE_DEPTH         L"StatQueueDepth"           // amf_int64 - packets waiting in the write-behind queue
+#define FFMPEG_MUXER_STAT_QUEUE_BYTES         L"StatQueueBytes"           // amf_int64 - bytes waiting in the write-behind queue
+#define FFMPEG_MUXER_STAT_WRITE_STALLS        L"StatWriteStalls"          // amf_int64 - number of submits blocked by a full write-behind queue
+#define FFMPEG_MUXER_STAT_WRITE_STALL_TIME    L"StatWriteStallTime"       // amf_int64 - total time submits were blocked, in 100 ns units
 
 #endif //#ifndef AMF_FileMuxerFFMPEG_h
@@ -47,6 +47,17 @@
 #define VIDEO_DECODER_BITRATE              L"BitRate"          // amf_int64 (default = 0)
 #define VIDEO_DECODER_FRAMERATE            L"FrameRate"        // AMFRate
 #define VIDEO_DECODER_SEEK_POSITION        L"SeekPosition"     // amf_int64 (default = 0)
+#define VIDEO_DECODER_PARALLEL_COPY_THRESHOLD L"ParallelCopyThreshold" // amf_int64 (default = 1280*720) - frames with at least this many luma pixels are copied to the output surface by the shared thread pool, 0 - never
+#define VIDEO_DECODER_THREAD_COUNT         L"ThreadCount"      // amf_int64 (default = 0) - number of decoding threads, 0 - chosen from the CPU core count
+#define VIDEO_DECODER_THREAD_TYPE          L"ThreadType"       // amf_int64 (AMF_VIDEO_DECODER_THREAD_TYPE_ENUM, default = AMF_VIDEO_DECODER_THREAD_TYPE_AUTO) - FFmpeg threading model
+#define VIDEO_DECODER_DIRECT_OUTPUT        L"DirectOutput"     // bool (default = true) - decode NV12 / YUV420P / RGBA pictures straight into host buffers that are output as surfaces without a copy
+
+enum AMF_VIDEO_DECODER_THREAD_TYPE_ENUM
+{
+    AMF_VIDEO_DECODER_THREAD_TYPE_AUTO     = 0,    // frame threads when the codec has them, slice threads for still images
+    AMF_VIDEO_DECODER_THREAD_TYPE_FRAME    = 1,
+    AMF_VIDEO_DECODER_THREAD_TYPE_SLICE    = 2,
+};
 
 #define VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC L"ColorTransferChar"    // amf_int64(AMF_COLOR_TRANSFER_CHARACTERISTIC_ENUM); default = AMF_COLOR_TRANSFER_CHARACTERISTIC_UNDEFINED, ISO/IEC 23001-8_2013   7.2
 
@@ -0,0 +1,194 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// this sample compares the two HRTF convolution engines of the Ambisonic renderer:
+// convolution::timeDomainCPU against the uniformly partitioned fftConvolution, with the renderer's
+// layout of 4 inputs (W, X, Y, Z), 2 outputs and a 128 sample hop, for 256 to 4096 tap responses
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "public/common/Thread.h"
+#include "public/src/components/AmbisonicRenderer/convolution.h"
+#include "public/src/components/AmbisonicRenderer/fftConvolution.h"
+
+static const int INPUTS = 4;
+static const int OUTPUTS = 2;
+static const int BLOCK_SIZE = 128;
+static const int SAMPLE_RATE = 48000;
+static const int TAPS[] = { 256, 512, 1024, 2048, 4096 };
+static const int DEFAULT_BLOCKS = 500;
+static const int VERIFY_BLOCKS = 16;
+
+//-------------------------------------------------------------------------------------------------
+static float RandomSample()
+{
+    return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+//-------------------------------------------------------------------------------------------------
+// direct linear convolution of one block, used to check the FFT engine output
+static void ReferenceBlock(const std::vector<float>* signal, const std::vector<float>* responses, int taps, int block, int output, float* out)
+{
+    for (int j = 0; j < BLOCK_SIZE; j++)
+    {
+        const int pos = block * BLOCK_SIZE + j;
+        double acc = 0.0;
+        for (int i = 0; i < INPUTS; i++)
+        {
+            const std::vector<float>& h = responses[output * INPUTS + i];
+            for (int k = 0; k < taps && k <= pos; k++)
+            {
+                acc += (double)signal[i][pos - k] * h[k];
+            }
+        }
+        out[j] = (float)acc;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RunTest(int taps, int blocks)
+{
+    std::vector<float> signal[INPUTS];
+    for (int i = 0; i < INPUTS; i++)
+    {
+        signal[i].resize(blocks * BLOCK_SIZE);
+        for (size_t s = 0; s < signal[i].size(); s++)
+        {
+            signal[i][s] = RandomSample();
+        }
+    }
+    // decaying noise is close enough to an HRTF for timing purposes
+    std::vector<float> responses[INPUTS * OUTPUTS];
+    for (int r = 0; r < INPUTS * OUTPUTS; r++)
+    {
+        responses[r].resize(taps);
+        for (int k = 0; k < taps; k++)
+        {
+            responses[r][k] = RandomSample() * expf(-4.0f * k / taps);
+        }
+    }
+    std::vector<float> outTime(BLOCK_SIZE * INPUTS * OUTPUTS);
+    std::vector<float> outFFT(BLOCK_SIZE * OUTPUTS);
+
+    // time domain: one call per response, the renderer does the same for its 8 W/X/Y/Z responses
+    convolution timeDomain(INPUTS * OUTPUTS, taps);
+    timeDomain.init();
+    amf_pts start = amf_high_precision_clock();
+    for (int b = 0; b < blocks; b++)
+    {
+        for (int r = 0; r < INPUTS * OUTPUTS; r++)
+        {
+            timeDomain.timeDomainCPU(&responses[r][0], 0, taps, &signal[r % INPUTS][b * BLOCK_SIZE], &outTime[r * BLOCK_SIZE], r,
+                BLOCK_SIZE, taps);
+        }
+    }
+    const amf_pts timeDomainTime = amf_high_precision_clock() - start;
+
+    // partitioned FFT, response spectra are prepared once outside of the timed loop
+    fftConvolution fft(INPUTS, OUTPUTS, BLOCK_SIZE, taps);
+    if (!fft.init())
+    {
+        printf("%5d taps: fftConvolution init failed\n", taps);
+        return;
+    }
+    const int spectrumLength = fft.getSpectrumLength();
+    std::vector<float> spectra(2 * INPUTS * OUTPUTS * spectrumLength);
+    float* respRe[INPUTS * OUTPUTS];
+    float* respIm[INPUTS * OUTPUTS];
+    for (int r = 0; r < INPUTS * OUTPUTS; r++)
+    {
+        respRe[r] = &spectra[(2 * r) * spectrumLength];
+        respIm[r] = &spectra[(2 * r + 1) * spectrumLength];
+        fft.transformResponse(&responses[r][0], taps, respRe[r], respIm[r]);
+    }
+
+    std::vector<float> reference(BLOCK_SIZE);
+    double maxError = 0.0;
+    start = amf_high_precision_clock();
+    amf_pts verifyTime = 0;
+    for (int b = 0; b < blocks; b++)
+    {
+        float* in[INPUTS];
+        for (int i = 0; i < INPUTS; i++)
+        {
+            in[i] = &signal[i][b * BLOCK_SIZE];
+        }
+        float* out[OUTPUTS] = { &outFFT[0], &outFFT[BLOCK_SIZE] };
+        fft.process(in, respRe, respIm, out);
+
+        if (b < VERIFY_BLOCKS)
+        {
+            // the reference is slow, keep it out of the measurement
+            const amf_pts verifyStart = amf_high_precision_clock();
+            for (int o = 0; o < OUTPUTS; o++)
+            {
+                ReferenceBlock(signal, responses, taps, b, o, &reference[0]);
+                for (int j = 0; j < BLOCK_SIZE; j++)
+                {
+                    maxError = (std::max)(maxError, (double)fabsf(out[o][j] - reference[j]));
+                }
+            }
+            verifyTime += amf_high_precision_clock() - verifyStart;
+        }
+    }
+    const amf_pts fftTime = amf_high_precision_clock() - start - verifyTime;
+
+    // real time budget of one block at 48 kHz
+    const double blockBudgetUs = 1000000.0 * BLOCK_SIZE / SAMPLE_RATE;
+    const double timeDomainUs = (double)timeDomainTime / AMF_MICROSECOND / blocks;
+    const double fftUs = (double)fftTime / AMF_MICROSECOND / blocks;
+    printf("%5d taps: time domain %9.1f us/block (%6.2fx real time)  fft %7.1f us/block (%7.2fx real time)  speedup %6.1fx  fft max error %.2e\n",
+        taps, timeDomainUs, blockBudgetUs / timeDomainUs, fftUs, blockBudgetUs / fftUs, timeDomainUs / fftUs, maxError);
+}
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    int blocks = DEFAULT_BLOCKS;
+    if (argc > 1)
+    {
+        blocks = atoi(argv[1]);
+    }
+    if (blocks < VERIFY_BLOCKS)
+    {
+        printf("Usage: %s [blocks >= %d]\n", argv[0], VERIFY_BLOCKS);
+        return -1;
+    }
+    printf("%d inputs, %d outputs, %d sample blocks, %d blocks per run\n", INPUTS, OUTPUTS, BLOCK_SIZE, blocks);
+    srand(1);
+    for (size_t t = 0; t < amf_countof(TAPS); t++)
+    {
+        RunTest(TAPS[t], blocks);
+    }
+    return 0;
+}
@@ -0,0 +1,315 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// this sample is a smoke check of the Linux display capture: it grabs the X root window through
+// AMFDisplayCapture (MIT-SHM, XDamage, RandR) and the cursor through AMFCursorCaptureLinux (XFixes).
+// It expects a dedicated X server that nothing else draws on, e.g.
+//     xvfb-run -s "-screen 0 1280x720x24" DisplayCaptureCheck
+
+#include <stdio.h>
+#include <string.h>
+#include "public/common/AMFFactory.h"
+#include "public/common/Thread.h"
+#include "public/include/components/DisplayCapture.h"
+#include "public/src/components/CursorCapture/CursorCaptureLinux.h"
+#include <X11/cursorfont.h>
+
+using namespace amf;
+
+static const amf_pts   FRAME_TIMEOUT = AMF_SECOND;
+static const amf_pts   IDLE_TIME = 200 * AMF_MILLISECOND;
+static const AMFRect   DRAWN_RECT = { 32, 48, 96, 88 };    // left, top, right, bottom
+static const amf_uint32 DRAWN_RED = 0xFF, DRAWN_GREEN = 0x80, DRAWN_BLUE = 0x00;
+
+//-------------------------------------------------------------------------------------------------
+// polls the capture until it returns a frame; AMF_REPEAT means nothing changed on the monitor
+static AMF_RESULT QueryFrame(AMFComponent* pCapture, amf_pts timeout, AMFSurface** ppSurface)
+{
+    const amf_pts deadline = amf_high_precision_clock() + timeout;
+    while (true)
+    {
+        AMFDataPtr pData;
+        AMF_RESULT res = pCapture->QueryOutput(&pData);
+        if (res == AMF_OK && pData != NULL)
+        {
+            AMFSurfacePtr pSurface(pData);
+            if (pSurface == NULL)
+            {
+                return AMF_INVALID_DATA_TYPE;
+            }
+            *ppSurface = pSurface.Detach();
+            return AMF_OK;
+        }
+        if (res != AMF_OK && res != AMF_REPEAT)
+        {
+            return res;
+        }
+        if (amf_high_precision_clock() >= deadline)
+        {
+            return AMF_REPEAT;
+        }
+        amf_sleep(1);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static AMFRect GetDirtyBounds(AMFSurface* pSurface, amf_size& count)
+{
+    AMFRect bounds = {};
+    count = 0;
+    AMFInterfacePtr pInterface;
+    if (pSurface->GetProperty(AMF_DISPLAYCAPTURE_DIRTY_RECTS, &pInterface) != AMF_OK)
+    {
+        return bounds;
+    }
+    AMFBufferPtr pBuffer(pInterface);
+    if (pBuffer == NULL)
+    {
+        return bounds;
+    }
+    const AMFRect* pRects = static_cast<const AMFRect*>(pBuffer->GetNative());
+    count = pBuffer->GetSize() / sizeof(AMFRect);
+    for (amf_size i = 0; i < count; i++)
+    {
+        if (i == 0)
+        {
+            bounds = pRects[0];
+            continue;
+        }
+        bounds.left = AMF_MIN(bounds.left, pRects[i].left);
+        bounds.top = AMF_MIN(bounds.top, pRects[i].top);
+        bounds.right = AMF_MAX(bounds.right, pRects[i].right);
+        bounds.bottom = AMF_MAX(bounds.bottom, pRects[i].bottom);
+    }
+    return bounds;
+}
+//-------------------------------------------------------------------------------------------------
+static bool Contains(const AMFRect& outer, const AMFRect& inner)
+{
+    return outer.left <= inner.left && outer.top <= inner.top && outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+//-------------------------------------------------------------------------------------------------
+static bool Check(bool condition, const char* what)
+{
+    printf("%-60s %s\n", what, condition ? "ok" : "FAILED");
+    return condition;
+}
+//-------------------------------------------------------------------------------------------------
+static bool CheckDisplayCapture(AMFContext* pContext, Display* pDisplay)
+{
+    AMFComponentPtr pCapture;
+    AMF_RESULT res = AMFCreateComponentDisplayCapture(pContext, NULL, &pCapture);
+    if (!Check(res == AMF_OK, "create AMFDisplayCapture"))
+    {
+        return false;
+    }
+    pCapture->SetProperty(AMF_DISPLAYCAPTURE_MONITOR_INDEX, amf_int64(0));
+    pCapture->SetProperty(AMF_DISPLAYCAPTURE_FRAMERATE, AMFConstructRate(60, 1));
+    pCapture->SetProperty(AMF_DISPLAYCAPTURE_ENABLE_DIRTY_RECTS, true);
+    res = pCapture->Init(AMF_SURFACE_UNKNOWN, 0, 0);
+    if (!Check(res == AMF_OK, "Init() on monitor 0"))
+    {
+        return false;
+    }
+
+    bool passed = true;
+    AMFRect desktopRect = {};
+    pCapture->GetProperty(AMF_DISPLAYCAPTURE_DESKTOP_RECT, &desktopRect);
+    printf("monitor 0: %dx%d at %d,%d\n", desktopRect.Width(), desktopRect.Height(), desktopRect.left, desktopRect.top);
+
+    // the first frame is complete and reports the whole monitor as dirty
+    AMFSurfacePtr pFirst;
+    res = QueryFrame(pCapture, FRAME_TIMEOUT, &pFirst);
+    if (!Check(res == AMF_OK, "first frame"))
+    {
+        pCapture->Terminate();
+        return false;
+    }
+    amf_size count = 0;
+    const AMFRect fullRect = AMFConstructRect(0, 0, desktopRect.Width(), desktopRect.Height());
+    passed = Check(pFirst->GetMemoryType() == AMF_MEMORY_HOST, "first frame is in host memory") && passed;
+    passed = Check(pFirst->GetFormat() == AMF_SURFACE_BGRA || pFirst->GetFormat() == AMF_SURFACE_RGBA, "first frame is BGRA or RGBA") && passed;
+    passed = Check(pFirst->GetPlaneAt(0)->GetWidth() == desktopRect.Width() &&
+        pFirst->GetPlaneAt(0)->GetHeight() == desktopRect.Height(), "first frame has the monitor size") && passed;
+    passed = Check(Contains(GetDirtyBounds(pFirst, count), fullRect), "first frame is dirty as a whole") && passed;
+
+    // nobody draws, so there is no damage and no frame
+    AMFSurfacePtr pIdle;
+    res = QueryFrame(pCapture, IDLE_TIME, &pIdle);
+    passed = Check(res == AMF_REPEAT, "no frame while the screen is idle") && passed;
+
+    // draw a known rectangle on the root window and expect it in the next frame
+    const Window root = DefaultRootWindow(pDisplay);
+    const Visual* pVisual = DefaultVisual(pDisplay, DefaultScreen(pDisplay));
+    const unsigned long pixel = (pVisual->red_mask & (DRAWN_RED * 0x01010101UL)) | (pVisual->green_mask & (DRAWN_GREEN * 0x01010101UL)) |
+        (pVisual->blue_mask & (DRAWN_BLUE * 0x01010101UL));
+    GC gc = XCreateGC(pDisplay, root, 0, NULL);
+    XSetSubwindowMode(pDisplay, gc, IncludeInferiors);
+    XSetForeground(pDisplay, gc, pixel);
+    XFillRectangle(pDisplay, root, gc, desktopRect.left + DRAWN_RECT.left, desktopRect.top + DRAWN_RECT.top,
+        DRAWN_RECT.Width(), DRAWN_RECT.Height());
+    XFreeGC(pDisplay, gc);
+    XSync(pDisplay, False);
+
+    AMFSurfacePtr pDrawn;
+    res = QueryFrame(pCapture, FRAME_TIMEOUT, &pDrawn);
+    if (Check(res == AMF_OK, "frame after drawing"))
+    {
+        const AMFRect bounds = GetDirtyBounds(pDrawn, count);
+        passed = Check(count > 0 && Contains(bounds, DRAWN_RECT), "dirty rects cover the drawn rectangle") && passed;
+        passed = Check(Contains(DRAWN_RECT, bounds), "dirty rects stay within the drawn rectangle") && passed;
+
+        AMFPlane* pPlane = pDrawn->GetPlaneAt(0);
+        const amf_uint8* pCenter = static_cast<const amf_uint8*>(pPlane->GetNative()) +
+            (DRAWN_RECT.top + DRAWN_RECT.Height() / 2) * pPlane->GetHPitch() + (DRAWN_RECT.left + DRAWN_RECT.Width() / 2) * 4;
+        const bool bBGRA = pDrawn->GetFormat() == AMF_SURFACE_BGRA;
+        const amf_uint32 red = bBGRA ? pCenter[2] : pCenter[0];
+        const amf_uint32 blue = bBGRA ? pCenter[0] : pCenter[2];
+        passed = Check(red == DRAWN_RED && pCenter[1] == DRAWN_GREEN && blue == DRAWN_BLUE, "drawn color is captured") && passed;
+    }
+    else
+    {
+        passed = false;
+    }
+
+    // surfaces still held by the caller keep their segments alive across Terminate()
+    passed = Check(pCapture->Terminate() == AMF_OK, "Terminate() with frames outstanding") && passed;
+    pFirst = NULL;
+    pDrawn = NULL;
+    return passed;
+}
+//-------------------------------------------------------------------------------------------------
+static bool SameImage(AMFSurface* pA, AMFSurface* pB)
+{
+    AMFPlane* pPlaneA = pA->GetPlaneAt(0);
+    AMFPlane* pPlaneB = pB->GetPlaneAt(0);
+    if (pPlaneA->GetWidth() != pPlaneB->GetWidth() || pPlaneA->GetHeight() != pPlaneB->GetHeight())
+    {
+        return false;
+    }
+    for (amf_int32 y = 0; y < pPlaneA->GetHeight(); y++)
+    {
+        const amf_uint8* pRowA = static_cast<const amf_uint8*>(pPlaneA->GetNative()) + y * pPlaneA->GetHPitch();
+        const amf_uint8* pRowB = static_cast<const amf_uint8*>(pPlaneB->GetNative()) + y * pPlaneB->GetHPitch();
+        if (memcmp(pRowA, pRowB, pPlaneA->GetWidth() * 4) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+static AMF_RESULT AcquireCursorChange(AMFCursorCapture* pCursorCapture, AMFSurface** ppSurface)
+{
+    const amf_pts deadline = amf_high_precision_clock() + FRAME_TIMEOUT;
+    AMF_RESULT res = AMF_REPEAT;
+    while ((res = pCursorCapture->AcquireCursor(ppSurface)) == AMF_REPEAT && amf_high_precision_clock() < deadline)
+    {
+        amf_sleep(1);
+    }
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+static bool CheckCursorCapture(AMFContext* pContext, Display* pDisplay)
+{
+    AMFCursorCapturePtr pCursorCapture(new AMFCursorCaptureLinux(pContext));
+    bool passed = true;
+
+    AMFSurfacePtr pDefault;
+    AMF_RESULT res = pCursorCapture->AcquireCursor(&pDefault);
+    if (!Check(res == AMF_OK && pDefault != NULL, "first cursor"))
+    {
+        return false;
+    }
+    AMFSurfacePtr pRepeat;
+    passed = Check(pCursorCapture->AcquireCursor(&pRepeat) == AMF_REPEAT, "unchanged cursor repeats") && passed;
+
+    // switch the root window cursor away and back; the second switch is served from the cache
+    const Window root = DefaultRootWindow(pDisplay);
+    Cursor crosshair = XCreateFontCursor(pDisplay, XC_crosshair);
+    XDefineCursor(pDisplay, root, crosshair);
+    XSync(pDisplay, False);
+    AMFSurfacePtr pCrosshair;
+    res = AcquireCursorChange(pCursorCapture, &pCrosshair);
+    passed = Check(res == AMF_OK && pCrosshair != NULL && !SameImage(pCrosshair, pDefault), "changed cursor is captured") && passed;
+
+    XUndefineCursor(pDisplay, root);
+    XSync(pDisplay, False);
+    AMFSurfacePtr pCached;
+    res = AcquireCursorChange(pCursorCapture, &pCached);
+    passed = Check(res == AMF_OK && pCached != NULL && SameImage(pCached, pDefault), "cursor switched back matches the first one") && passed;
+    passed = Check(pCached != pDefault, "each acquire returns its own surface") && passed;
+
+    XFreeCursor(pDisplay, crosshair);
+    XSync(pDisplay, False);
+    pCursorCapture->Reset();
+    return passed;
+}
+//-------------------------------------------------------------------------------------------------
+int main(int /* argc */, char* /* argv */[])
+{
+    XInitThreads();
+    Display* pDisplay = XOpenDisplay(NULL);
+    if (pDisplay == NULL)
+    {
+        printf("Cannot open the X display, run under Xvfb: xvfb-run -s \"-screen 0 1280x720x24\" DisplayCaptureCheck\n");
+        return 2;
+    }
+
+    AMF_RESULT res = g_AMFFactory.Init();
+    if (res != AMF_OK)
+    {
+        printf("AMF failed to initialize\n");
+        XCloseDisplay(pDisplay);
+        return 2;
+    }
+
+    bool passed = false;
+    {
+        AMFContextPtr pContext;
+        res = g_AMFFactory.GetFactory()->CreateContext(&pContext);
+        if (res == AMF_OK)
+        {
+            passed = CheckDisplayCapture(pContext, pDisplay);
+            passed = CheckCursorCapture(pContext, pDisplay) && passed;
+            pContext->Terminate();
+        }
+        else
+        {
+            printf("CreateContext() failed\n");
+        }
+    }
+    g_AMFFactory.Terminate();
+    XCloseDisplay(pDisplay);
+
+    printf(passed ? "all checks passed\n" : "some checks FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// this sample measures SetProperty throughput of amf::AMFPropertyStorageImpl with 0, 1 and 4
+// observers attached; every SetProperty notifies all observers through AMFObservableImpl
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "public/common/PropertyStorageImpl.h"
+
+typedef amf::AMFInterfaceImpl<amf::AMFPropertyStorageImpl<amf::AMFPropertyStorage> > PropertyStorage;
+
+static const amf_int32 OBSERVER_COUNTS[] = { 0, 1, 4 };
+static const amf_int32 DEFAULT_ITERATIONS = 10000000;
+
+//-------------------------------------------------------------------------------------------------
+class CountingObserver : public amf::AMFPropertyStorageObserver
+{
+public:
+    CountingObserver() : m_iCalls(0) {}
+    virtual void AMF_STD_CALL OnPropertyChanged(const wchar_t* /* name */) { m_iCalls++; }
+    amf_int64 m_iCalls;
+};
+//-------------------------------------------------------------------------------------------------
+static void RunTest(amf_int32 observers, amf_int32 iterations)
+{
+    amf::AMFPropertyStoragePtr pStorage(new PropertyStorage());
+    // a few properties so the lookup is not trivially the first entry
+    pStorage->SetProperty(L"Duration", amf_int64(0));
+    pStorage->SetProperty(L"FrameType", amf_int64(0));
+    pStorage->SetProperty(L"Pts", amf_int64(0));
+    pStorage->SetProperty(L"StreamIndex", amf_int64(0));
+
+    std::vector<CountingObserver> list(observers);
+    for(amf_int32 i = 0; i < observers; i++)
+    {
+        pStorage->AddObserver(&list[i]);
+    }
+
+    const amf_pts start = amf_high_precision_clock();
+    for(amf_int32 i = 0; i < iterations; i++)
+    {
+        pStorage->SetProperty(L"Pts", amf_int64(i));
+    }
+    const amf_pts elapsed = amf_high_precision_clock() - start;
+
+    amf_int64 calls = 0;
+    for(amf_int32 i = 0; i < observers; i++)
+    {
+        pStorage->RemoveObserver(&list[i]);
+        calls += list[i].m_iCalls;
+    }
+    if(calls != (amf_int64)observers * iterations)
+    {
+        printf("%d observers: expected %lld notifications, got %lld\n", observers, (long long)observers * iterations, (long long)calls);
+    }
+    const double seconds = (double)elapsed / AMF_SECOND;
+    printf("%d observers: %8.2f M SetProperty/s  %6.1f ns/call\n", observers, iterations / seconds / 1000000.,
+        seconds * 1000000000. / iterations);
+}
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    amf_int32 iterations = DEFAULT_ITERATIONS;
+    if(argc > 1)
+    {
+        iterations = atoi(argv[1]);
+    }
+    if(iterations <= 0)
+    {
+        printf("Usage: %s [iterations]\n", argv[0]);
+        return -1;
+    }
+    for(size_t i = 0; i < amf_countof(OBSERVER_COUNTS); i++)
+    {
+        RunTest(OBSERVER_COUNTS[i], iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// this sample checks that every SIMD plane copy kernel supported by the CPU is bit-exact with the
+// scalar reference over odd widths, odd pitches and unaligned source and destination pointers;
+// the whole destination buffer is compared so writes past the row end are caught as well
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "public/src/components/ComponentsFFMPEG/PlaneCopyKernels.h"
+
+using namespace amf;
+
+typedef void (*RunKernelFunc)(const AMFPlaneCopyKernels& kernels, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8* pSrc1,
+    const amf_uint8* pSrc2, amf_size count, amf_int32 shift, bool bBigEndian);
+
+struct KernelCase
+{
+    const char*     name;
+    RunKernelFunc   Run;
+    amf_size        elementSize;    // pointer granularity of sources and destination
+    amf_size        srcBytes;       // bytes per unit of count in the largest source plane
+    amf_size        dstBytes;       // bytes per unit of count in the destination
+    bool            bShift;
+    bool            bEndian;
+};
+
+static const amf_int32 HEIGHT = 3;
+static const amf_int32 MAX_OFFSET = 4;              // in elements
+static const amf_size  PITCH_PADDING[] = { 0, 1, 3, 17 };  // in elements
+static const amf_int32 SHIFTS[] = { 0, 2, 4, 6 };
+static const amf_size  EXTRA_WIDTHS[] = { 127, 129, 255, 257, 1023, 1921 };
+static const amf_size  MAX_SMALL_WIDTH = 80;
+static const amf_uint8 GUARD = 0xCD;
+
+//-------------------------------------------------------------------------------------------------
+static void RunShiftLeft16(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8*, const amf_uint8*, amf_size count, amf_int32 shift, bool)
+{
+    k.ShiftLeft16((amf_uint16*)pDst, (const amf_uint16*)pSrc0, count, shift);
+}
+static void RunInterleaveUV8(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8* pSrc1, const amf_uint8*, amf_size count, amf_int32, bool)
+{
+    k.InterleaveUV8(pDst, pSrc0, pSrc1, count);
+}
+static void RunInterleaveUV16(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8* pSrc1, const amf_uint8*, amf_size count, amf_int32 shift, bool)
+{
+    k.InterleaveUV16((amf_uint16*)pDst, (const amf_uint16*)pSrc0, (const amf_uint16*)pSrc1, count, shift);
+}
+static void RunPackY210(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8* pSrc1, const amf_uint8* pSrc2, amf_size count, amf_int32 shift, bool)
+{
+    k.PackY210((amf_uint16*)pDst, (const amf_uint16*)pSrc0, (const amf_uint16*)pSrc1, (const amf_uint16*)pSrc2, count, shift);
+}
+static void RunPackY416(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8* pSrc1, const amf_uint8* pSrc2, amf_size count, amf_int32 shift, bool)
+{
+    k.PackY416((amf_uint16*)pDst, (const amf_uint16*)pSrc0, (const amf_uint16*)pSrc1, (const amf_uint16*)pSrc2, count, shift);
+}
+static void RunRGB48ToRGBA8(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8*, const amf_uint8*, amf_size count, amf_int32, bool bBigEndian)
+{
+    k.RGB48ToRGBA8(pDst, pSrc0, count, bBigEndian);
+}
+static void RunRGBA64ToRGBA8(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8*, const amf_uint8*, amf_size count, amf_int32, bool)
+{
+    k.RGBA64ToRGBA8(pDst, pSrc0, count);
+}
+static void RunRGB48ToRGBA16(const AMFPlaneCopyKernels& k, amf_uint8* pDst, const amf_uint8* pSrc0, const amf_uint8*, const amf_uint8*, amf_size count, amf_int32, bool bBigEndian)
+{
+    k.RGB48ToRGBA16((amf_uint16*)pDst, pSrc0, count, bBigEndian);
+}
+//-------------------------------------------------------------------------------------------------
+static const KernelCase s_Cases[] =
+{
+    { "ShiftLeft16",    RunShiftLeft16,     2, 2, 2, true,  false },
+    { "InterleaveUV8",  RunInterleaveUV8,   1, 1, 2, false, false },
+    { "InterleaveUV16", RunInterleaveUV16,  2, 2, 4, true,  false },
+    { "PackY210",       RunPackY210,        2, 4, 8, true,  false },
+    { "PackY416",       RunPackY416,        2, 2, 8, true,  false },
+    { "RGB48ToRGBA8",   RunRGB48ToRGBA8,    1, 6, 4, false, true  },
+    { "RGBA64ToRGBA8",  RunRGBA64ToRGBA8,   1, 8, 4, false, false },
+    { "RGB48ToRGBA16",  RunRGB48ToRGBA16,   2, 6, 8, false, true  },
+};
+//-------------------------------------------------------------------------------------------------
+// runs the kernel over a plane of HEIGHT rows for both kernel sets and compares the destinations
+static bool CheckPlane(const KernelCase& kc, const AMFPlaneCopyKernels& kernels, const std::vector<amf_uint8>& src,
+    amf_size width, amf_size srcOffset, amf_size dstOffset, amf_size padding, amf_int32 shift, bool bBigEndian)
+{
+    const AMFPlaneCopyKernels& scalar = GetPlaneCopyKernels(AMF_PLANE_COPY_ISA_SCALAR);
+
+    const amf_size srcPitch = width * kc.srcBytes + padding * kc.elementSize;
+    const amf_size dstPitch = width * kc.dstBytes + padding * kc.elementSize;
+    const amf_size srcPlaneSize = MAX_OFFSET * kc.elementSize + srcPitch * HEIGHT;
+    const amf_size dstSize = MAX_OFFSET * kc.elementSize + dstPitch * HEIGHT + 64;
+
+    std::vector<amf_uint8> dstRef(dstSize, GUARD);
+    std::vector<amf_uint8> dstTest(dstSize, GUARD);
+
+    // every plane gets its own misalignment so the kernels cannot rely on the planes sharing one
+    const amf_uint8* pSrc[3];
+    for (amf_size plane = 0; plane < 3; plane++)
+    {
+        const amf_size offset = ((srcOffset + plane) % MAX_OFFSET) * kc.elementSize;
+        pSrc[plane] = &src[0] + plane * srcPlaneSize + offset;
+    }
+
+    for (amf_int32 y = 0; y < HEIGHT; y++)
+    {
+        const amf_size srcRow = y * srcPitch;
+        const amf_size dstRow = dstOffset * kc.elementSize + y * dstPitch;
+        kc.Run(scalar, &dstRef[dstRow], pSrc[0] + srcRow, pSrc[1] + srcRow, pSrc[2] + srcRow, width, shift, bBigEndian);
+        kc.Run(kernels, &dstTest[dstRow], pSrc[0] + srcRow, pSrc[1] + srcRow, pSrc[2] + srcRow, width, shift, bBigEndian);
+    }
+
+    if (memcmp(&dstRef[0], &dstTest[0], dstSize) != 0)
+    {
+        amf_size pos = 0;
+        while (dstRef[pos] == dstTest[pos])
+        {
+            pos++;
+        }
+        printf("FAILED %s width=%d srcOffset=%d dstOffset=%d padding=%d shift=%d bigEndian=%d: byte %d is 0x%02X, expected 0x%02X\n",
+            kc.name, (int)width, (int)srcOffset, (int)dstOffset, (int)padding, (int)shift, bBigEndian ? 1 : 0,
+            (int)pos, (int)dstTest[pos], (int)dstRef[pos]);
+        return false;
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+static amf_int64 CheckKernel(const KernelCase& kc, const AMFPlaneCopyKernels& kernels, const std::vector<amf_uint8>& src, amf_int64& failures)
+{
+    std::vector<amf_size> widths;
+    for (amf_size w = 1; w <= MAX_SMALL_WIDTH; w++)
+    {
+        widths.push_back(w);
+    }
+    widths.insert(widths.end(), EXTRA_WIDTHS, EXTRA_WIDTHS + amf_countof(EXTRA_WIDTHS));
+
+    const amf_int32 shiftCount = kc.bShift ? (amf_int32)amf_countof(SHIFTS) : 1;
+    const amf_int32 endianCount = kc.bEndian ? 2 : 1;
+
+    amf_int64 checks = 0;
+    for (size_t w = 0; w < widths.size(); w++)
+    {
+        for (amf_size srcOffset = 0; srcOffset < (amf_size)MAX_OFFSET; srcOffset++)
+        {
+            for (amf_size dstOffset = 0; dstOffset < (amf_size)MAX_OFFSET; dstOffset++)
+            {
+                for (size_t p = 0; p < amf_countof(PITCH_PADDING); p++)
+                {
+                    for (amf_int32 s = 0; s < shiftCount; s++)
+                    {
+                        for (amf_int32 e = 0; e < endianCount; e++)
+                        {
+                            checks++;
+                            if (!CheckPlane(kc, kernels, src, widths[w], srcOffset, dstOffset, PITCH_PADDING[p], kc.bShift ? SHIFTS[s] : 0, e != 0))
+                            {
+                                failures++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return checks;
+}
+//-------------------------------------------------------------------------------------------------
+int main(int /* argc */, char* /* argv */[])
+{
+    static const AMF_PLANE_COPY_ISA isas[] = { AMF_PLANE_COPY_ISA_SSE2, AMF_PLANE_COPY_ISA_AVX2, AMF_PLANE_COPY_ISA_AVX512 };
+    static const char* isaNames[] = { "Scalar", "SSE2", "AVX2", "AVX512" };
+
+    // large enough for three planes of the widest case, filled with full range values
+    const amf_size maxWidth = EXTRA_WIDTHS[amf_countof(EXTRA_WIDTHS) - 1];
+    const amf_size maxPlane = MAX_OFFSET * 2 + (maxWidth * 8 + PITCH_PADDING[amf_countof(PITCH_PADDING) - 1] * 2) * HEIGHT;
+    std::vector<amf_uint8> src(maxPlane * 3);
+    srand(12345);
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        src[i] = (amf_uint8)(rand() >> 3);
+    }
+
+    amf_int64 failures = 0;
+    bool bTested = false;
+    for (size_t i = 0; i < amf_countof(isas); i++)
+    {
+        const AMFPlaneCopyKernels& kernels = GetPlaneCopyKernels(isas[i]);
+        if (kernels.eISA != isas[i])
+        {
+            printf("%-8s not supported by this CPU, skipped\n", isaNames[isas[i]]);
+            continue;
+        }
+        bTested = true;
+        for (size_t c = 0; c < amf_countof(s_Cases); c++)
+        {
+            const amf_int64 failuresBefore = failures;
+            const amf_int64 checks = CheckKernel(s_Cases[c], kernels, src, failures);
+            printf("%-8s %-16s %8lld planes %s\n", isaNames[isas[i]], s_Cases[c].name, (long long)checks,
+                failures == failuresBefore ? "OK" : "FAILED");
+        }
+    }
+    if (!bTested)
+    {
+        printf("no SIMD kernels available, nothing to compare\n");
+    }
+    printf("%s\n", failures == 0 ? "PASSED" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
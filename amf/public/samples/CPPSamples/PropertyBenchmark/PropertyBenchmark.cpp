@@ -0,0 +1,121 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// this sample replays the per-packet property traffic between the FFmpeg demuxer and decoder:
+// the demuxer sets its FFMPEG:* packet properties on every output buffer and the decoder reads
+// them back, so every packet pays for 12 SetProperty and 12 GetProperty calls by name
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "public/common/PropertyStorageImpl.h"
+
+typedef amf::AMFInterfaceImpl<amf::AMFPropertyStorageImpl<amf::AMFPropertyStorage> > PropertyStorage;
+
+static const amf_int32 DEFAULT_PACKETS = 1000000;
+
+// the names FileDemuxerFFMPEGImpl sets on every packet buffer
+static const wchar_t* PACKET_PROPERTIES[] =
+{
+    L"FFMPEG:pts",
+    L"FFMPEG:dts",
+    L"FFMPEG:stream_index",
+    L"FFMPEG:flags",
+    L"FFMPEG:duration",
+    L"FFMPEG:pos",
+    L"FFMPEG:convergence_duration",
+    L"FFMPEG:FirstPtsOffset",
+    L"FFMPEG:start_time",
+    L"FFMPEG:time_base_den",
+    L"FFMPEG:time_base_num",
+    L"BufferType",
+};
+
+//-------------------------------------------------------------------------------------------------
+static amf_int64 ReplayPacket(amf::AMFPropertyStorage* pStorage, amf_int32 packet)
+{
+    for(size_t i = 0; i < amf_countof(PACKET_PROPERTIES); i++)
+    {
+        pStorage->SetProperty(PACKET_PROPERTIES[i], amf_int64(packet + i));
+    }
+    amf_int64 sum = 0;
+    for(size_t i = 0; i < amf_countof(PACKET_PROPERTIES); i++)
+    {
+        amf_int64 value = 0;
+        pStorage->GetProperty(PACKET_PROPERTIES[i], &value);
+        sum += value;
+    }
+    return sum;
+}
+//-------------------------------------------------------------------------------------------------
+static void Report(const char* name, amf_pts elapsed, amf_int32 packets)
+{
+    const double seconds = (double)elapsed / AMF_SECOND;
+    const double calls = (double)packets * amf_countof(PACKET_PROPERTIES) * 2;
+    printf("%-28s %8.1f ns/packet  %6.1f ns/call\n", name, seconds * 1000000000. / packets, seconds * 1000000000. / calls);
+}
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    amf_int32 packets = DEFAULT_PACKETS;
+    if(argc > 1)
+    {
+        packets = atoi(argv[1]);
+    }
+    if(packets <= 0)
+    {
+        printf("Usage: %s [packets]\n", argv[0]);
+        return -1;
+    }
+    amf_int64 check = 0;
+
+    // a new buffer per packet: every SetProperty inserts
+    amf_pts start = amf_high_precision_clock();
+    for(amf_int32 i = 0; i < packets; i++)
+    {
+        amf::AMFPropertyStoragePtr pStorage(new PropertyStorage());
+        check += ReplayPacket(pStorage, i);
+    }
+    Report("new buffer per packet", amf_high_precision_clock() - start, packets);
+
+    // a pooled buffer: the names are already present, SetProperty only looks them up
+    amf::AMFPropertyStoragePtr pPooled(new PropertyStorage());
+    start = amf_high_precision_clock();
+    for(amf_int32 i = 0; i < packets; i++)
+    {
+        check += ReplayPacket(pPooled, i);
+    }
+    Report("pooled buffer", amf_high_precision_clock() - start, packets);
+
+    // keeps the compiler from dropping the reads
+    return check == 0 ? 1 : 0;
+}
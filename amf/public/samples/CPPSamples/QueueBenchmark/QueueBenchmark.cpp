@@ -0,0 +1,141 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// this sample measures throughput and handoff latency of amf::AMFQueue against amf::AMFRingQueue
+// with 1, 2, 4 and 8 producer threads feeding one consumer
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include "public/common/Thread.h"
+
+typedef amf::AMFQueueBase<amf_pts> TimestampQueue;
+
+static const amf_int32 QUEUE_SIZE = 256;
+static const amf_int32 DEFAULT_ITEMS = 1000000;
+
+//-------------------------------------------------------------------------------------------------
+class ProducerThread : public amf::AMFThread
+{
+public:
+    ProducerThread(TimestampQueue* pQueue, amf_int32 items) : m_pQueue(pQueue), m_iItems(items) {}
+
+    virtual void Run()
+    {
+        for(amf_int32 i = 0; i < m_iItems; i++)
+        {
+            // the item is its own enqueue time, the consumer turns it into handoff latency
+            m_pQueue->Add(0, amf_high_precision_clock());
+        }
+    }
+private:
+    TimestampQueue* m_pQueue;
+    amf_int32       m_iItems;
+};
+//-------------------------------------------------------------------------------------------------
+static void RunTest(const char* name, TimestampQueue* pQueue, amf_int32 producers, amf_int32 itemsPerProducer)
+{
+    const amf_int32 total = producers * itemsPerProducer;
+    std::vector<amf_pts> latency;
+    latency.reserve(total);
+
+    std::vector<ProducerThread*> threads;
+    for(amf_int32 i = 0; i < producers; i++)
+    {
+        threads.push_back(new ProducerThread(pQueue, itemsPerProducer));
+    }
+
+    const amf_pts start = amf_high_precision_clock();
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->Start();
+    }
+    for(amf_int32 i = 0; i < total; i++)
+    {
+        amf_ulong id = 0;
+        amf_pts enqueued = 0;
+        pQueue->Get(id, enqueued, AMF_INFINITE);
+        latency.push_back(amf_high_precision_clock() - enqueued);
+    }
+    const amf_pts elapsed = amf_high_precision_clock() - start;
+
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->WaitForStop();
+        delete threads[i];
+    }
+
+    std::vector<amf_pts>::iterator p99 = latency.begin() + (latency.size() * 99) / 100;
+    std::nth_element(latency.begin(), p99, latency.end());
+
+    printf("%-24s %9d %12.2f %14.1f\n", name, producers,
+        double(total) / (double(elapsed) / AMF_SECOND) / 1000000.0, double(*p99) / AMF_MICROSECOND);
+}
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    amf_int32 itemsPerProducer = DEFAULT_ITEMS;
+    if(argc > 1)
+    {
+        itemsPerProducer = atoi(argv[1]);
+    }
+    if(itemsPerProducer <= 0)
+    {
+        printf("Usage: QueueBenchmark [items per producer]\n");
+        return -1;
+    }
+
+    printf("%d items per producer, queue size %d\n", itemsPerProducer, QUEUE_SIZE);
+    printf("%-24s %9s %12s %14s\n", "queue", "producers", "Mitems/s", "p99 latency us");
+
+    const amf_int32 producerCounts[] = { 1, 2, 4, 8 };
+    for(size_t i = 0; i < amf_countof(producerCounts); i++)
+    {
+        const amf_int32 producers = producerCounts[i];
+        {
+            amf::AMFQueue<amf_pts> queue(QUEUE_SIZE);
+            RunTest("AMFQueue", &queue, producers, itemsPerProducer);
+        }
+        {
+            amf::AMFRingQueue<amf_pts> queue(QUEUE_SIZE, true);
+            RunTest("AMFRingQueue MPMC", &queue, producers, itemsPerProducer);
+        }
+        if(producers == 1)
+        {
+            amf::AMFRingQueue<amf_pts> queue(QUEUE_SIZE, false);
+            RunTest("AMFRingQueue SPSC", &queue, producers, itemsPerProducer);
+        }
+    }
+    return 0;
+}
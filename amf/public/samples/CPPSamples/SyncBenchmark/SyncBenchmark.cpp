@@ -0,0 +1,240 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// this sample measures the thread synchronization primitives: AMFLock contention on one
+// AMFCriticalSection, AMFEvent ping-pong between two threads, AMFQueue handoff between a producer
+// and a consumer, and how closely a timed AMFEvent wait matches the requested timeout
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include "public/common/Thread.h"
+
+static const amf_int32 DEFAULT_ITERATIONS = 1000000;
+static const amf_ulong WAIT_TIMEOUT_MS = 10;
+static const amf_int32 WAIT_TIMEOUT_REPEATS = 20;
+
+//-------------------------------------------------------------------------------------------------
+class LockThread : public amf::AMFThread
+{
+public:
+    LockThread(amf::AMFCriticalSection* pSect, amf_int64* pCounter, amf_int32 iterations) :
+        m_pSect(pSect), m_pCounter(pCounter), m_iIterations(iterations) {}
+
+    virtual void Run()
+    {
+        for(amf_int32 i = 0; i < m_iIterations; i++)
+        {
+            amf::AMFLock lock(m_pSect);
+            (*m_pCounter)++;
+        }
+    }
+private:
+    amf::AMFCriticalSection*    m_pSect;
+    amf_int64*                  m_pCounter;
+    amf_int32                   m_iIterations;
+};
+//-------------------------------------------------------------------------------------------------
+static bool RunLockTest(amf_int32 threadCount, amf_int32 iterations)
+{
+    amf::AMFCriticalSection sect;
+    amf_int64 counter = 0;
+
+    std::vector<LockThread*> threads;
+    for(amf_int32 i = 0; i < threadCount; i++)
+    {
+        threads.push_back(new LockThread(&sect, &counter, iterations));
+    }
+    const amf_pts start = amf_high_precision_clock();
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->Start();
+    }
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->WaitForStop();
+        delete threads[i];
+    }
+    const amf_pts elapsed = amf_high_precision_clock() - start;
+
+    const amf_int64 total = amf_int64(threadCount) * iterations;
+    printf("%-24s %8d %14.1f\n", "AMFLock", threadCount, double(elapsed) * 100.0 / double(total));
+    if(counter != total)
+    {
+        printf("AMFLock: counter is %lld, expected %lld\n", (long long)counter, (long long)total);
+        return false;
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+class PongThread : public amf::AMFThread
+{
+public:
+    PongThread(amf::AMFEvent* pPing, amf::AMFEvent* pPong, amf_int32 iterations) :
+        m_pPing(pPing), m_pPong(pPong), m_iIterations(iterations) {}
+
+    virtual void Run()
+    {
+        for(amf_int32 i = 0; i < m_iIterations; i++)
+        {
+            m_pPing->Lock();
+            m_pPong->SetEvent();
+        }
+    }
+private:
+    amf::AMFEvent*  m_pPing;
+    amf::AMFEvent*  m_pPong;
+    amf_int32       m_iIterations;
+};
+//-------------------------------------------------------------------------------------------------
+static void RunEventTest(amf_int32 iterations)
+{
+    // auto-reset events, each round trip wakes the other thread twice
+    amf::AMFEvent ping;
+    amf::AMFEvent pong;
+    PongThread thread(&ping, &pong, iterations);
+    thread.Start();
+
+    const amf_pts start = amf_high_precision_clock();
+    for(amf_int32 i = 0; i < iterations; i++)
+    {
+        ping.SetEvent();
+        pong.Lock();
+    }
+    const amf_pts elapsed = amf_high_precision_clock() - start;
+    thread.WaitForStop();
+
+    printf("%-24s %8d %14.1f\n", "AMFEvent ping-pong", 2, double(elapsed) * 100.0 / double(iterations));
+}
+//-------------------------------------------------------------------------------------------------
+class ProducerThread : public amf::AMFThread
+{
+public:
+    ProducerThread(amf::AMFQueue<amf_int32>* pQueue, amf_int32 iterations) : m_pQueue(pQueue), m_iIterations(iterations) {}
+
+    virtual void Run()
+    {
+        for(amf_int32 i = 0; i < m_iIterations; i++)
+        {
+            m_pQueue->Add(0, i);
+        }
+    }
+private:
+    amf::AMFQueue<amf_int32>*   m_pQueue;
+    amf_int32                   m_iIterations;
+};
+//-------------------------------------------------------------------------------------------------
+static bool RunQueueTest(amf_int32 queueSize, amf_int32 iterations)
+{
+    amf::AMFQueue<amf_int32> queue(queueSize);
+    ProducerThread thread(&queue, iterations);
+
+    bool ordered = true;
+    const amf_pts start = amf_high_precision_clock();
+    thread.Start();
+    for(amf_int32 i = 0; i < iterations; i++)
+    {
+        amf_ulong id = 0;
+        amf_int32 item = 0;
+        queue.Get(id, item, AMF_INFINITE);
+        ordered = ordered && item == i;
+    }
+    const amf_pts elapsed = amf_high_precision_clock() - start;
+    thread.WaitForStop();
+
+    char name[64];
+    snprintf(name, sizeof(name), "AMFQueue size %d", queueSize);
+    printf("%-24s %8d %14.1f\n", name, 2, double(elapsed) * 100.0 / double(iterations));
+    if(!ordered)
+    {
+        printf("%s: items arrived out of order\n", name);
+    }
+    return ordered;
+}
+//-------------------------------------------------------------------------------------------------
+static bool RunTimeoutTest()
+{
+    // nobody signals the event, every wait has to run into the timeout
+    amf::AMFEvent event;
+    std::vector<amf_pts> waited;
+    bool timedOut = true;
+    for(amf_int32 i = 0; i < WAIT_TIMEOUT_REPEATS; i++)
+    {
+        const amf_pts start = amf_high_precision_clock();
+        timedOut = !event.Lock(WAIT_TIMEOUT_MS) && timedOut;
+        waited.push_back(amf_high_precision_clock() - start);
+    }
+    std::sort(waited.begin(), waited.end());
+
+    printf("AMFEvent Lock(%lu ms): min %.2f ms, median %.2f ms, max %.2f ms\n", WAIT_TIMEOUT_MS,
+        double(waited.front()) / AMF_MILLISECOND, double(waited[waited.size() / 2]) / AMF_MILLISECOND,
+        double(waited.back()) / AMF_MILLISECOND);
+    if(!timedOut || waited.front() < amf_pts(WAIT_TIMEOUT_MS) * AMF_MILLISECOND)
+    {
+        printf("AMFEvent Lock(%lu ms) returned early\n", WAIT_TIMEOUT_MS);
+        return false;
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    amf_int32 iterations = DEFAULT_ITERATIONS;
+    if(argc > 1)
+    {
+        iterations = atoi(argv[1]);
+    }
+    if(iterations <= 0)
+    {
+        printf("Usage: SyncBenchmark [iterations]\n");
+        return -1;
+    }
+
+    printf("%d iterations per thread\n", iterations);
+    printf("%-24s %8s %14s\n", "test", "threads", "ns/operation");
+
+    bool passed = true;
+    const amf_int32 threadCounts[] = { 1, 2, 4, 8 };
+    for(size_t i = 0; i < amf_countof(threadCounts); i++)
+    {
+        passed = RunLockTest(threadCounts[i], iterations) && passed;
+    }
+    RunEventTest(iterations);
+    const amf_int32 queueSizes[] = { 1, 256 };
+    for(size_t i = 0; i < amf_countof(queueSizes); i++)
+    {
+        passed = RunQueueTest(queueSizes[i], iterations) && passed;
+    }
+    passed = RunTimeoutTest() && passed;
+    return passed ? 0 : 1;
+}
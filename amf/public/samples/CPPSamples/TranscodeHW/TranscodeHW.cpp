@@ -260,6 +260,8 @@ AMF_RESULT RegisterParams(ParametersStorage* pParams)
 {
     pParams->SetParamDescription(PARAM_NAME_OUTPUT, ParamCommon, L"Output file name", NULL);
     pParams->SetParamDescription(PARAM_NAME_INPUT, ParamCommon,  L"Input file name", NULL);
+    pParams->SetParamDescription(PARAM_NAME_INPUT_MMAP, ParamCommon, L"Memory-map raw input files (bool, default = true)", ParamConverterBoolean);
+    pParams->SetParamDescription(PARAM_NAME_INPUT_READ_AHEAD, ParamCommon, L"Raw input frames prefetched ahead of the reader (in frames, default = 4)", ParamConverterInt64);
 
     pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_SCALE_WIDTH, ParamCommon, L"Frame width (integer, default = 0)", ParamConverterInt64);
     pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_SCALE_HEIGHT, ParamCommon, L"Frame height (integer, default = 0)", ParamConverterInt64);
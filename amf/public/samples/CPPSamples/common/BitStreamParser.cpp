@@ -31,6 +31,7 @@
 //
 
 #include <assert.h>
+#include <string.h>
 #include <string>
 #include <cctype>
 #include <algorithm>
@@ -41,6 +42,11 @@
 #include "BitStreamParserH265.h"
 #include "BitStreamParserIVF.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BIT_STREAM_PARSER_SSE2 1
+#endif
+
 BitStreamParser::~BitStreamParser()
 {
 }
@@ -118,3 +124,70 @@ BitStreamParserPtr BitStreamParser::Create(amf::AMFDataStream* pStream, BitStrea
     }
     return pParser;
 }
+//-------------------------------------------------------------------------------------------------
+const amf_uint8* Parser::FindStartCode(const amf_uint8* begin, const amf_uint8* end)
+{
+    const amf_uint8* p = begin;
+#if defined(BIT_STREAM_PARSER_SSE2)
+    // tests 16 positions per step: p[i] == 0 && p[i + 1] == 0 && p[i + 2] == 1
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    while (end - p >= 18)
+    {
+        const __m128i b0 = _mm_loadu_si128((const __m128i*)p);
+        const __m128i b1 = _mm_loadu_si128((const __m128i*)(p + 1));
+        const __m128i b2 = _mm_loadu_si128((const __m128i*)(p + 2));
+        const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)), _mm_cmpeq_epi8(b2, one));
+        int mask = _mm_movemask_epi8(match);
+        if (mask != 0)
+        {
+            while ((mask & 1) == 0)
+            {
+                mask >>= 1;
+                p++;
+            }
+            return p;
+        }
+        p += 16;
+    }
+#endif
+    // 01 bytes are rare in coded data so let memchr skip ahead to them
+    if (end - p < 3)
+    {
+        return end;
+    }
+    const amf_uint8* last = p + 2;
+    while (last < end)
+    {
+        last = static_cast<const amf_uint8*>(memchr(last, 1, end - last));
+        if (last == NULL)
+        {
+            break;
+        }
+        if (last[-1] == 0 && last[-2] == 0)
+        {
+            return last - 2;
+        }
+        last++;
+    }
+    return end;
+}
+//-------------------------------------------------------------------------------------------------
+size_t Parser::EBSPtoRBSP(const amf_uint8* src, size_t srcSize, amf_uint8* dst, size_t dstSize)
+{
+    size_t written = 0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < srcSize && written < dstSize; i++)
+    {
+        const amf_uint8 ch = src[i];
+        if (zeros >= 2 && ch == 0x03)
+        {
+            // emulation prevention byte after 00 00
+            zeros = 0;
+            continue;
+        }
+        dst[written++] = ch;
+        zeros = (ch == 0) ? zeros + 1 : 0;
+    }
+    return written;
+}
@@ -165,5 +165,11 @@ namespace Parser
             return r;
         }
     }
+
+    // returns the first byte of the next 00 00 01 start code in [begin, end), or end
+    const amf_uint8* FindStartCode(const amf_uint8* begin, const amf_uint8* end);
+
+    // strips emulation prevention bytes until dstSize bytes of RBSP are written; returns the RBSP size
+    size_t EBSPtoRBSP(const amf_uint8* src, size_t srcSize, amf_uint8* dst, size_t dstSize);
 }
 
@@ -484,13 +484,16 @@ protected:
     static const amf_uint8 NalRefIdcMask = 0x60;   // b01100000
     static const amf_uint8 NalUnitLengthSize = 4U;
 
-    static const size_t m_ReadSize = 1024*4;
+    static const size_t m_ReadSize = 1024*1024;
 
     static const amf_uint16 maxSpsSize = 0xFFFF;
     static const amf_uint16 minSpsSize = 5;
     static const amf_uint16 maxPpsSize = 0xFFFF;
 
     NalUnitHeader ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size);
+    bool          ReadMore();
+    void          CompactReadWindow();
+    size_t        ToRBSP(size_t naluOffset, size_t naluSize, size_t maxSize);
     void          FindSPSandPPS();
     static inline NalUnitHeader GetNaluUnitType(amf_uint8 *nalUnit)
     {
@@ -504,11 +507,13 @@ protected:
 
         return nalu_header;
     }
-    size_t EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos);
     AMFRect GetCropRect() const;
 
 
+    // read window: unconsumed data is [m_ReadPos, m_ReadEnd); consumed data is dropped in bulk by CompactReadWindow()
     AMFByteArray   m_ReadData;
+    size_t         m_ReadPos;
+    size_t         m_ReadEnd;
     AMFByteArray   m_Extradata;
     
     AMFByteArray   m_EBSPtoRBSPData;
@@ -531,6 +536,8 @@ BitStreamParser* CreateHEVCParser(amf::AMFDataStream* stream, amf::AMFContext* p
 }
 //-------------------------------------------------------------------------------------------------
 HevcParser::HevcParser(amf::AMFDataStream* stream, amf::AMFContext* pContext) :
+    m_ReadPos(0),
+    m_ReadEnd(0),
     m_bUseStartCodes(false),
     m_currentFrameTimestamp(0),
     m_pStream(stream),
@@ -689,7 +696,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     {
         return AMF_OK;
     }
-    if((m_bEof && m_ReadData.GetSize() == 0) || m_maxFramesNumber && m_PacketCount >= m_maxFramesNumber)
+    if((m_bEof && m_ReadPos == m_ReadEnd) || m_maxFramesNumber && m_PacketCount >= m_maxFramesNumber)
     {
         return AMF_EOF;
     }
@@ -698,14 +705,14 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     size_t readSize = 0;
     std::vector<size_t> naluStarts;
     std::vector<size_t> naluSizes;
-    size_t dataOffset = 0;
+    size_t dataOffset = m_ReadPos;
     bool bSliceFound = false;
 	amf_uint32 prev_slice_nal_unit_type;
 	
     do 
     {
 		size_t naluSize = 0;
-        size_t naluOffset = 0;
+        size_t naluOffset = m_ReadPos;
         size_t naluAnnexBOffset = dataOffset;
         NalUnitHeader   naluHeader = ReadNextNaluUnit(&dataOffset, &naluOffset, &naluSize);
 
@@ -811,7 +818,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     amf_uint8 *data = (amf_uint8*)pictureBuffer->GetNative();
     if(m_bUseStartCodes)
     {
-        memcpy(data, m_ReadData.GetData(), packetSize);
+        memcpy(data, m_ReadData.GetData() + m_ReadPos, packetSize);
     }
     else
     {
@@ -834,13 +841,8 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     pictureBuffer->SetDuration(frameDuration);
     m_currentFrameTimestamp += frameDuration;
 
-//    if (newPictureDetected)
-    {
-    // shift remaining data in m_ReadData
-        size_t remainingData = m_ReadData.GetSize() - readSize;
-        memmove(m_ReadData.GetData(), m_ReadData.GetData()+readSize, remainingData);
-        m_ReadData.SetSize(remainingData);
-    }
+    m_ReadPos = readSize;
+    CompactReadWindow();
     *ppData = pictureBuffer.Detach();
     m_PacketCount++;
     return AMF_OK;
@@ -849,73 +851,44 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
 HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size)
 {
     *size = 0;
-    size_t startOffset = *offset;
+    const size_t startOffset = *offset;
+    size_t searchOffset = startOffset;
 
     bool newNalFound = false;
-    size_t zerosCount = 0;
-
     while(!newNalFound)
     {
-        // read next portion if needed
-        size_t ready = m_ReadData.GetSize() - *offset;
-		//printf("ReadNextNaluUnit: remaining data size for read: %d\n", ready);
-		if (ready == 0)
-		{
-			if (m_bEof == false)
-			{
-				m_ReadData.SetSize(m_ReadData.GetSize() + m_ReadSize);
-                ready = 0;
-                m_pStream->Read(m_ReadData.GetData() + *offset, m_ReadSize, &ready);
-			}
-			
-
-			if (ready != m_ReadSize && ready != 0)
-			{
-				m_ReadData.SetSize(m_ReadData.GetSize() - (m_ReadSize - ready));
-			}
-				
-			
-			
-
-            if(ready == 0 )
+        const amf_uint8* data = m_ReadData.GetData();
+        const amf_uint8* startCode = Parser::FindStartCode(data + searchOffset, data + m_ReadEnd);
+        if(startCode == data + m_ReadEnd)
+        {
+            // a start code may be split between reads - rescan its first two bytes
+            searchOffset = AMF_MAX(searchOffset, m_ReadEnd >= 2 ? m_ReadEnd - 2 : 0);
+            if(!ReadMore())
             {
-				if (m_bEof == false)
-				m_ReadData.SetSize(m_ReadData.GetSize() - m_ReadSize);
-
                 m_bEof = true;
-                newNalFound = startOffset != *offset; 
-                *offset = m_ReadData.GetSize();
+                newNalFound = startOffset != m_ReadEnd;
+                *offset = m_ReadEnd;
                 break; // EOF
             }
+            continue;
         }
-        amf_uint8* data= m_ReadData.GetData() + *offset;
-        for(size_t i = 0; i < ready; i++)
+        // zeros in front of 00 00 01 (4-byte start code, trailing_zero_8bits) belong to the start code
+        size_t codeOffset = startCode - data;
+        size_t zerosOffset = codeOffset;
+        while(zerosOffset > startOffset && data[zerosOffset - 1] == 0)
         {
-            amf_uint8 ch = *data++;
-            if (0 == ch)
-            {
-                zerosCount++;
-            }
-            else 
-            {
-                if (1 == ch && zerosCount >=2) // We found a start code in Annex B stream
-                {
-                    if(*offset + (i - zerosCount) > startOffset)
-                    {
-                        ready = i - zerosCount;
-                        newNalFound = true; // new NAL
-                        break; 
-                    }
-                    else
-                    {
-                        *nalu = *offset + zerosCount + 1;
-                    }
-                }
-                zerosCount = 0;
-            }
+            zerosOffset--;
+        }
+        if(zerosOffset > startOffset)
+        {
+            *offset = zerosOffset;
+            newNalFound = true; // new NAL
+        }
+        else
+        {
+            *nalu = codeOffset + 3;
+            searchOffset = *nalu;
         }
-        // if zeros found but not a new NAL - continue with zerosCount on the next iteration
-        *offset += ready;
     }
     if(!newNalFound)
     {
@@ -928,6 +901,39 @@ HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t
     return GetNaluUnitType(m_ReadData.GetData() + *nalu);
 }
 //-------------------------------------------------------------------------------------------------
+bool HevcParser::ReadMore()
+{
+    if(m_ReadData.GetSize() < m_ReadEnd + m_ReadSize)
+    {
+        m_ReadData.SetSize(m_ReadEnd + m_ReadSize);
+    }
+    amf_size ready = 0;
+    m_pStream->Read(m_ReadData.GetData() + m_ReadEnd, m_ReadData.GetSize() - m_ReadEnd, &ready);
+    m_ReadEnd += ready;
+    return ready != 0;
+}
+//-------------------------------------------------------------------------------------------------
+void HevcParser::CompactReadWindow()
+{
+    // move the unconsumed tail to the front only once it is smaller than the consumed part,
+    // so every byte is moved at most once on average instead of once per frame
+    const size_t remaining = m_ReadEnd - m_ReadPos;
+    if(m_ReadPos == 0 || remaining > m_ReadPos)
+    {
+        return;
+    }
+    memmove(m_ReadData.GetData(), m_ReadData.GetData() + m_ReadPos, remaining);
+    m_ReadPos = 0;
+    m_ReadEnd = remaining;
+}
+//-------------------------------------------------------------------------------------------------
+size_t HevcParser::ToRBSP(size_t naluOffset, size_t naluSize, size_t maxSize)
+{
+    const size_t rbspSize = AMF_MIN(naluSize, maxSize);
+    m_EBSPtoRBSPData.SetSize(rbspSize);
+    return Parser::EBSPtoRBSP(m_ReadData.GetData() + naluOffset, naluSize, m_EBSPtoRBSPData.GetData(), rbspSize);
+}
+//-------------------------------------------------------------------------------------------------
 void    HevcParser::FindSPSandPPS()
 {
     ExtraDataBuilder extraDataBuilder;
@@ -938,7 +944,7 @@ void    HevcParser::FindSPSandPPS()
     {
         
         size_t naluSize = 0;
-        size_t naluOffset = 0;
+        size_t naluOffset = dataOffset;
         size_t naluAnnexBOffset = dataOffset;
         NalUnitHeader   naluHeader = ReadNextNaluUnit(&dataOffset, &naluOffset, &naluSize);
 
@@ -949,9 +955,7 @@ void    HevcParser::FindSPSandPPS()
 
         if (naluHeader.nal_unit_type == NAL_UNIT_SPS)
         {
-            m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            size_t newNaluSize = ToRBSP(naluOffset, naluSize, naluSize);
 
             SpsData sps;
             sps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
@@ -960,9 +964,7 @@ void    HevcParser::FindSPSandPPS()
         }
         else if (naluHeader.nal_unit_type == NAL_UNIT_PPS)
         {
-            m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            size_t newNaluSize = ToRBSP(naluOffset, naluSize, naluSize);
 
             PpsData pps;
             pps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
@@ -993,7 +995,9 @@ void    HevcParser::FindSPSandPPS()
     } while (true);
 
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
-    m_ReadData.SetSize(0);
+    m_ReadPos = 0;
+    m_ReadEnd = 0;
+    m_bEof = false;
     // It will fail if SPS or PPS are absent
     extraDataBuilder.GetExtradata(m_Extradata);
 }
@@ -1698,60 +1702,6 @@ bool HevcParser::ExtraDataBuilder::GetExtradata(AMFByteArray   &extradata)
     data += m_PPSs.GetSize();
     return true;
 }
-//-------------------------------------------------------------------------------------------------
-#define ZEROBYTES_SHORTSTARTCODE 2 //indicates the number of zero bytes in the short start-code prefix
-//-------------------------------------------------------------------------------------------------
-size_t HevcParser::EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos)
-{
-    int count = 0;
-    if(end_bytepos < begin_bytepos)
-    {
-        return end_bytepos;
-    }
-    amf_uint8 *streamBuffer_i=streamBuffer+begin_bytepos;
-    amf_uint8 *streamBuffer_end=streamBuffer+end_bytepos;
-    int iReduceCount=0;
-    for(; streamBuffer_i!=streamBuffer_end; )
-    { 
-        //starting from begin_bytepos to avoid header information
-        //in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
-        register amf_uint8 tmp=*streamBuffer_i;
-        if(count == ZEROBYTES_SHORTSTARTCODE)
-        {
-            if(tmp == 0x03)
-            {
-                //check the 4th amf_uint8 after 0x000003, except when cabac_zero_word is used, in which case the last three bytes of this NAL unit must be 0x000003
-                if((streamBuffer_i+1 != streamBuffer_end) && (streamBuffer_i[1] > 0x03))
-                {
-                    return -1;
-                }
-                //if cabac_zero_word is used, the final amf_uint8 of this NAL unit(0x03) is discarded, and the last two bytes of RBSP must be 0x0000
-                if(streamBuffer_i+1 == streamBuffer_end)
-                {
-                    break;
-                }
-                memmove(streamBuffer_i,streamBuffer_i+1,streamBuffer_end-streamBuffer_i-1);
-                streamBuffer_end--;
-                iReduceCount++;
-                count = 0;
-                tmp = *streamBuffer_i;
-            }
-            else if(tmp < 0x03) 
-            {
-            }
-        }
-        if(tmp == 0x00)
-        {
-            count++;
-        }
-        else
-        {
-            count = 0;
-        }
-        streamBuffer_i++;
-    }
-    return end_bytepos - begin_bytepos + iReduceCount;
-}
 
 //sizeId = 0
 int scaling_list_default_0 [1][6][16] =  {{{16,16,16,16,16,16,16,16,16,16,16,16,16,16,16,16},
@@ -1784,5 +1734,7 @@ AMF_RESULT              HevcParser::ReInit()
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
     m_PacketCount = 0;
     m_bEof = false;
+    m_ReadPos = 0;
+    m_ReadEnd = 0;
     return AMF_OK;
 }
@@ -36,7 +36,11 @@
 
 #pragma warning(disable:4355)
 
-typedef amf::AMFQueue<amf::AMFDataPtr>   DataQueue;
+typedef amf::AMFQueue<amf::AMFDataPtr>      DataQueue;
+typedef amf::AMFRingQueue<amf::AMFDataPtr>  DataRingQueue;
+typedef std::shared_ptr<amf::AMFQueueBase<amf::AMFDataPtr> > DataQueuePtr;
+
+#define PIPELINE_FREEZE_TIMEOUT 1000 // ms - bound for a component call in flight when the pipeline is frozen
 
 class PipelineConnector;
 class InputSlot;
@@ -49,9 +53,11 @@ public:
     PipelineConnector      *m_pConnector;
     amf_int32               m_iThisSlot;
     amf::AMFPreciseWaiter   m_waiter;
+    amf::AMFEvent           m_WakeEvent;
+    amf::AMFEvent           m_ParkedEvent;  // set by the slot thread once it stopped calling the element
     bool                    m_bEof;
     bool                    m_bFrozen;
-    
+
 
     Slot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot);
     virtual ~Slot(){}
@@ -60,11 +66,16 @@ public:
     virtual bool StopRequested();
     virtual bool IsEof(){return m_bEof;}
     virtual void OnEof();
-    virtual void Restart(){m_bEof = false;}
+    virtual void Restart(){m_bEof = false; Wake();}
 
-    virtual AMF_RESULT Freeze() { m_bFrozen = true; return AMF_OK;}
-    virtual AMF_RESULT UnFreeze(){ m_bFrozen = false; return AMF_OK;}
+    virtual AMF_RESULT Freeze() { m_ParkedEvent.ResetEvent(); m_bFrozen = true; Wake(); return AMF_OK;}
+    virtual AMF_RESULT UnFreeze(){ m_bFrozen = false; Wake(); return AMF_OK;}
     virtual AMF_RESULT Flush() = 0;
+    bool WaitForFrozen(amf_pts deadline);
+
+    void WaitForWork();
+    void Wake();
+    void Park();
 
 };
 //-------------------------------------------------------------------------------------------------
@@ -87,10 +98,10 @@ typedef std::shared_ptr<InputSlot> InputSlotPtr;
 class OutputSlot : public Slot
 {
 public:
-    DataQueue               m_dataQueue;
+    DataQueuePtr            m_pDataQueue;
     InputSlot               *m_pDownstreamInputSlot;
 
-    OutputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot, amf_int32 queueSize);
+    OutputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot, amf_int32 queueSize, PipelineQueueType eQueueType);
     virtual ~OutputSlot(){}
 
     virtual void Run();
@@ -104,6 +115,7 @@ typedef std::shared_ptr<OutputSlot> OutputSlotPtr;
 class PipelineConnector
 {
     friend class Pipeline;
+    friend class Slot;
     friend class InputSlot;
     friend class OutputSlot;
 protected:
@@ -134,9 +146,14 @@ public:
     AMF_RESULT Freeze();
     AMF_RESULT UnFreeze();
     AMF_RESULT Flush();
+    AMF_RESULT WaitForFrozen(amf_pts deadline);
 
     void SetStatSlot(amf_int32 slot) {m_iStatSlot = slot;}
 
+    // event-driven scheduling notifications
+    void OnInputConsumed();
+    void OnOutputProduced();
+
 protected:
     Pipeline*               m_pPipeline;
     PipelineElementPtr      m_pElement;
@@ -152,9 +169,12 @@ protected:
 // class Pipeline
 //-------------------------------------------------------------------------------------------------
 Pipeline::Pipeline() : 
-    m_state(PipelineStateNotReady),
     m_startTime(0),
-    m_stopTime(0)
+    m_stopTime(0),
+    m_state(PipelineStateNotReady),
+    m_eScheduling(PS_Polling),
+    m_ulIdleTimeout(5),
+    m_eQueueType(PQ_Locked)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -163,7 +183,8 @@ Pipeline::~Pipeline()
     Stop();
 }
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 queueSize, ConnectionThreading eThreading)
+AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 queueSize, ConnectionThreading eThreading,
+                             const amf::AMFThreadAttributes* pThreadAttributes)
 {
     amf::AMFLock lock(&m_cs);
     PipelineConnectorPtr upstreamConnector;
@@ -171,10 +192,11 @@ AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 queueSize, C
     {
         upstreamConnector = *m_connectors.rbegin();
     }
-    return Connect(pElement, 0, upstreamConnector == NULL ? NULL : upstreamConnector->m_pElement, 0, queueSize, eThreading);
+    return Connect(pElement, 0, upstreamConnector == NULL ? NULL : upstreamConnector->m_pElement, 0, queueSize, eThreading, pThreadAttributes);
 }
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 slot, PipelineElementPtr upstreamElement, amf_int32 upstreamSlot, amf_int32 queueSize, ConnectionThreading eThreading)
+AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 slot, PipelineElementPtr upstreamElement, amf_int32 upstreamSlot, amf_int32 queueSize,
+                             ConnectionThreading eThreading, const amf::AMFThreadAttributes* pThreadAttributes)
 {
     amf::AMFLock lock(&m_cs);
 
@@ -198,10 +220,15 @@ AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 slot, Pipeli
     }
     if(upstreamConnector != NULL)
     {
-        OutputSlotPtr pOutoutSlot = OutputSlotPtr(new OutputSlot(eThreading, upstreamConnector.get() , upstreamSlot, queueSize));
+        OutputSlotPtr pOutoutSlot = OutputSlotPtr(new OutputSlot(eThreading, upstreamConnector.get() , upstreamSlot, queueSize, m_eQueueType));
         InputSlotPtr pInputSlot = InputSlotPtr(new InputSlot(eThreading, connector.get(), slot));
         pOutoutSlot->m_pDownstreamInputSlot = pInputSlot.get();
         pInputSlot->m_pUpstreamOutputSlot = pOutoutSlot.get();
+        if(pThreadAttributes != NULL)
+        {
+            pOutoutSlot->SetAttributes(*pThreadAttributes);
+            pInputSlot->SetAttributes(*pThreadAttributes);
+        }
         upstreamConnector->AddOutputSlot(pOutoutSlot);
         connector->AddInputSlot(pInputSlot);
     }
@@ -211,6 +238,26 @@ AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 slot, Pipeli
     m_state = PipelineStateReady;
     return AMF_OK;
 }
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Pipeline::SetScheduling(PipelineScheduling eScheduling, amf_ulong ulIdleTimeout)
+{
+    amf::AMFLock lock(&m_cs);
+    if(m_state == PipelineStateRunning || m_state == PipelineStateFrozen)
+    {
+        return AMF_WRONG_STATE;
+    }
+    m_eScheduling = eScheduling;
+    m_ulIdleTimeout = ulIdleTimeout;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Pipeline::SetQueueType(PipelineQueueType eQueueType)
+{
+    amf::AMFLock lock(&m_cs);
+    m_eQueueType = eQueueType;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 PipelineElementPtr Pipeline::GetLastElement()
 {
     PipelineElementPtr res;
@@ -388,13 +435,32 @@ AMF_RESULT Pipeline::Restart()
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT Pipeline::Freeze()
 {
-    amf::AMFLock lock(&m_cs);
-    for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end(); it++)
+    ConnectorList connectors;
     {
-        (*it)->Freeze();
+        amf::AMFLock lock(&m_cs);
+        for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end(); it++)
+        {
+            (*it)->Freeze();
+        }
+        m_state = PipelineStateFrozen;
+        connectors = m_connectors;
     }
-    m_state = PipelineStateFrozen;
-    return AMF_OK;
+    // slot threads may still be inside a component call - wait outside the lock as they can report EOF;
+    // all slots share one deadline so the wait is bounded by the timeout, not by timeout * slots
+    const amf_pts deadline = amf_high_precision_clock() + PIPELINE_FREEZE_TIMEOUT * AMF_MILLISECOND;
+    AMF_RESULT res = AMF_OK;
+    for(ConnectorList::iterator it = connectors.begin(); it != connectors.end(); it++)
+    {
+        if((*it)->WaitForFrozen(deadline) != AMF_OK)
+        {
+            res = AMF_FAIL;
+        }
+    }
+    if(res != AMF_OK)
+    {
+        LOG_ERROR(L"Freeze() - slot threads did not stop within " << PIPELINE_FREEZE_TIMEOUT << L" ms");
+    }
+    return res;
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT Pipeline::UnFreeze()
@@ -424,6 +490,8 @@ Slot::Slot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int
     m_eThreading(eThreading),
     m_pConnector(connector),
     m_iThisSlot(thisSlot),
+    m_WakeEvent(false, false),
+    m_ParkedEvent(false, true),
     m_bEof(false),
     m_bFrozen(false)
 {
@@ -432,9 +500,48 @@ Slot::Slot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int
 void Slot::Stop()
 {
     RequestStop();
+    Wake();
     WaitForStop();
 }
 //-------------------------------------------------------------------------------------------------
+void Slot::WaitForWork()
+{
+    if(m_pConnector->m_pPipeline->GetScheduling() == PS_EventDriven)
+    {
+        // components that complete work asynchronously (HW) do not notify - fall back to a bounded sleep
+        m_WakeEvent.LockTimeout(m_pConnector->m_pPipeline->GetIdleTimeout());
+    }
+    else
+    {
+        m_waiter.Wait(1);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void Slot::Wake()
+{
+    if(m_pConnector->m_pPipeline->GetScheduling() == PS_EventDriven)
+    {
+        m_WakeEvent.SetEvent();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// called from the slot thread when it sees the frozen flag
+void Slot::Park()
+{
+    m_ParkedEvent.SetEvent();
+    WaitForWork();
+}
+//-------------------------------------------------------------------------------------------------
+bool Slot::WaitForFrozen(amf_pts deadline)
+{
+    if(!IsRunning())
+    {
+        return true; // runs on the caller's thread, stops with it
+    }
+    const amf_pts left = deadline - amf_high_precision_clock();
+    return m_ParkedEvent.LockTimeout(left > 0 ? amf_ulong(left / AMF_MILLISECOND) : 0);
+}
+//-------------------------------------------------------------------------------------------------
 void Slot::OnEof()
 {
     m_bEof = true;
@@ -462,7 +569,7 @@ void InputSlot::Run()
     {
         if(m_bFrozen)
         {
-            m_waiter.Wait(1);
+            Park();
             continue;
         }
         if(!IsEof()) // after EOF thread waits for stop
@@ -476,12 +583,12 @@ void InputSlot::Run()
             }
             else
             {
-                m_waiter.Wait(1);
+                WaitForWork();
             }
         }
         else
         {
-            m_waiter.Wait(1);
+            WaitForWork();
         }
 
     }
@@ -502,7 +609,7 @@ AMF_RESULT InputSlot::Drain()
         // LOG_INFO(L"m_pElement->Drain() returned AMF_INPUT_FULL");
         if(this->m_eThreading != CT_Direct)
         {
-            m_waiter.Wait(1);
+            WaitForWork();
         }
         else
         {
@@ -566,7 +673,7 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong ulTimeout, bool
 
                 // if input is full, also need to wait a bit 
                 // for input to be processed...
-                m_waiter.Wait(1); // wait till Poll thread clears input
+                WaitForWork(); // wait till Poll thread clears input
             }
             else if(res == AMF_REPEAT)
             {
@@ -580,6 +687,7 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong ulTimeout, bool
                     {
                         m_pConnector->m_iSubmitFramesProcessed++;
                     }
+                    m_pConnector->OnInputConsumed();
                 }
                 else if(res != AMF_EOF)
                 {
@@ -607,11 +715,20 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong ulTimeout, bool
 //-------------------------------------------------------------------------------------------------
 // class OutputSlot
 //-------------------------------------------------------------------------------------------------
-OutputSlot::OutputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot, amf_int32 queueSize) :
+OutputSlot::OutputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot, amf_int32 queueSize, PipelineQueueType eQueueType) :
     Slot(eThreading, connector, thisSlot),
     m_pDownstreamInputSlot(NULL)
 {
-    m_dataQueue.SetQueueSize(queueSize);
+    if(eQueueType == PQ_LockFree)
+    {
+        // Flush()/Restart() clear the queue from the control thread - keep the multi-threaded ring
+        m_pDataQueue = DataQueuePtr(new DataRingQueue(queueSize));
+    }
+    else
+    {
+        m_pDataQueue = DataQueuePtr(new DataQueue());
+        m_pDataQueue->SetQueueSize(queueSize);
+    }
 }
 //-------------------------------------------------------------------------------------------------
 void OutputSlot::Run()
@@ -621,7 +738,7 @@ void OutputSlot::Run()
     {
         if(m_bFrozen)
         {
-            m_waiter.Wait(1);
+            Park();
             continue;
         }
 
@@ -630,12 +747,12 @@ void OutputSlot::Run()
             res = Poll();
             if(res != AMF_OK) // 
             {
-                m_waiter.Wait(1);
+                WaitForWork();
             }
         }
         else
         {
-            m_waiter.Wait(1);
+            WaitForWork();
         }
     }
 }
@@ -656,12 +773,16 @@ AMF_RESULT OutputSlot::QueryOutput(amf::AMFData** ppData, amf_ulong ulTimeout)
         {
             OnEof();
         }
+        if(*ppData != NULL)
+        {
+            m_pConnector->OnOutputProduced();
+        }
         return res;
     }
     // m_eThreading == CT_ThreadQueue
     amf::AMFDataPtr data;
     amf_ulong id=0;
-    if(m_dataQueue.Get(id, data, ulTimeout))
+    if(m_pDataQueue->Get(id, data, ulTimeout))
     {
         if(m_bFrozen)
         {
@@ -705,6 +826,10 @@ AMF_RESULT OutputSlot::Poll()
         {
             m_pConnector->m_iPollFramesProcessed++; // EOF is not included
         }
+        if(data != NULL)
+        {
+            m_pConnector->OnOutputProduced();
+        }
         if(data != NULL || res == AMF_EOF) // EOF is sent as NULL data to the next element
         {
             // have data - send it
@@ -717,8 +842,9 @@ AMF_RESULT OutputSlot::Poll()
                         break;
                     }
                     amf_ulong id=0;
-                    if(m_dataQueue.Add(id, data, 0, 50))
+                    if(m_pDataQueue->Add(id, data, 0, 50))
                     {
+                        m_pDownstreamInputSlot->Wake();
                         break;
                     }
                 }
@@ -753,13 +879,13 @@ AMF_RESULT OutputSlot::Poll()
 //-------------------------------------------------------------------------------------------------
 void OutputSlot::Restart()
 {
-    m_dataQueue.Clear();
+    m_pDataQueue->Clear();
     Slot::Restart();
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT OutputSlot::Flush()
 {
-    m_dataQueue.Clear();
+    m_pDataQueue->Clear();
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -898,6 +1024,29 @@ void PipelineConnector::AddOutputSlot(OutputSlotPtr pSlot)
     m_OutputSlots.push_back(pSlot);
 }
 //-------------------------------------------------------------------------------------------------
+// element accepted input: it may have output now
+void PipelineConnector::OnInputConsumed()
+{
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        OutputSlotPtr pSlot = m_OutputSlots[i];
+        pSlot->Wake();
+        if(pSlot->m_eThreading == CT_ThreadPoll)
+        {
+            pSlot->m_pDownstreamInputSlot->Wake(); // downstream thread polls this element directly
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// element released output: it may accept input now
+void PipelineConnector::OnOutputProduced()
+{
+    for(amf_size i = 0; i < m_InputSlots.size(); i++)
+    {
+        m_InputSlots[i]->Wake();
+    }
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT PipelineConnector::Freeze()
 {
     for(amf_size i = 0; i < m_OutputSlots.size(); i++)
@@ -924,6 +1073,26 @@ AMF_RESULT PipelineConnector::UnFreeze()
     return m_pElement->UnFreeze();
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT PipelineConnector::WaitForFrozen(amf_pts deadline)
+{
+    AMF_RESULT res = AMF_OK;
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        if(!m_OutputSlots[i]->WaitForFrozen(deadline))
+        {
+            res = AMF_FAIL;
+        }
+    }
+    for(amf_size i = 0; i < m_InputSlots.size(); i++)
+    {
+        if(!m_InputSlots[i]->WaitForFrozen(deadline))
+        {
+            res = AMF_FAIL;
+        }
+    }
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT PipelineConnector::Flush()
 {
     for(amf_size i = 0; i < m_OutputSlots.size(); i++)
@@ -48,6 +48,16 @@ enum ConnectionThreading
     CT_ThreadPoll,
     CT_Direct,
 };
+enum PipelineScheduling
+{
+    PS_Polling,         // slot threads re-check their components every 1 ms
+    PS_EventDriven,     // slot threads sleep until a neighbour slot signals new data or free capacity
+};
+enum PipelineQueueType
+{
+    PQ_Locked,          // amf::AMFQueue
+    PQ_LockFree,        // amf::AMFRingQueue
+};
 
 class PipelineConnector;
 class Pipeline
@@ -58,11 +68,21 @@ public:
     Pipeline();
     virtual ~Pipeline();
 
-    AMF_RESULT Connect(PipelineElementPtr pElement, amf_int32 queueSize, ConnectionThreading eThreading = CT_ThreadQueue);
-    AMF_RESULT Connect(PipelineElementPtr pElement, amf_int32 slot, PipelineElementPtr upstreamElement, amf_int32 upstreamSlot, amf_int32 queueSize, ConnectionThreading eThreading = CT_ThreadQueue);
+    // pThreadAttributes pins the slot threads of the connection (upstream output and downstream input), NULL - OS default
+    AMF_RESULT Connect(PipelineElementPtr pElement, amf_int32 queueSize, ConnectionThreading eThreading = CT_ThreadQueue,
+                       const amf::AMFThreadAttributes* pThreadAttributes = NULL);
+    AMF_RESULT Connect(PipelineElementPtr pElement, amf_int32 slot, PipelineElementPtr upstreamElement, amf_int32 upstreamSlot, amf_int32 queueSize,
+                       ConnectionThreading eThreading = CT_ThreadQueue, const amf::AMFThreadAttributes* pThreadAttributes = NULL);
     AMF_RESULT SetStatSlot(PipelineElementPtr pElement, amf_int32 slot);
     PipelineElementPtr GetLastElement();
 
+    // must be called before Start(); ulIdleTimeout (ms) bounds the sleep for components that produce output asynchronously
+    AMF_RESULT SetScheduling(PipelineScheduling eScheduling, amf_ulong ulIdleTimeout = 5);
+    PipelineScheduling GetScheduling() const { return m_eScheduling; }
+    amf_ulong GetIdleTimeout() const { return m_ulIdleTimeout; }
+    // applies to CT_ThreadQueue connections made after the call
+    AMF_RESULT SetQueueType(PipelineQueueType eQueueType);
+
     virtual AMF_RESULT      Start();
     virtual AMF_RESULT      Stop();
     virtual AMF_RESULT      Restart();
@@ -87,5 +107,8 @@ protected:
     typedef std::vector<PipelineConnectorPtr> ConnectorList;
     ConnectorList                       m_connectors;
     PipelineState                       m_state;
+    PipelineScheduling                  m_eScheduling;
+    amf_ulong                           m_ulIdleTimeout;
+    PipelineQueueType                   m_eQueueType;
     mutable amf::AMFCriticalSection     m_cs;
 };
\ No newline at end of file
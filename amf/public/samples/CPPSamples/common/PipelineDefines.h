@@ -42,6 +42,8 @@
 #define PARAM_NAME_INPUT_HEIGHT            L"HEIGHT"
 #define PARAM_NAME_INPUT_FORMAT            L"FORMAT"
 #define PARAM_NAME_INPUT_FRAMES            L"FRAMES"
+#define PARAM_NAME_INPUT_MMAP              L"INPUT_MMAP"
+#define PARAM_NAME_INPUT_READ_AHEAD        L"INPUT_READ_AHEAD"
                
 #define PARAM_NAME_INPUT_ROI_X             L"ROI_X"
 #define PARAM_NAME_INPUT_ROI_Y             L"ROI_Y"
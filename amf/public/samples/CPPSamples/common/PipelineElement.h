@@ -36,7 +36,9 @@
 #include "public/include/components/Component.h"
 #include "public/common/DataStream.h"
 #include "public/common/Thread.h"
+#include "public/common/ByteArray.h"
 #include "CmdLogger.h"
+#include <atomic>
 #include <vector>
 
 class Pipeline;
@@ -74,56 +76,211 @@ protected:
 //-------------------------------------------------------------------------------------------------
 typedef std::shared_ptr<PipelineElement> PipelineElementPtr;
 //-------------------------------------------------------------------------------------------------
-class StreamWriter : public PipelineElement
+// AsyncWriter - SubmitInput() queues the data and a background thread writes it to the stream;
+// the bounded queue throttles the pipeline only when the storage can not keep up
+//-------------------------------------------------------------------------------------------------
+#define ASYNC_WRITER_WAIT_TIMEOUT   50 // ms - bound for a blocked call so Freeze() and Stop() get through
+
+class AsyncWriter : public PipelineElement
 {
 public:
-    StreamWriter(amf::AMFDataStream *pDataStream)
-        :m_pDataStream(pDataStream), m_framesWritten(0),
-        m_maxSize(0), m_totalSize(0)
+    virtual amf_int32 GetInputSlotCount() const { return 1; }
+    virtual amf_int32 GetOutputSlotCount() const { return 0; }
+
+    virtual AMF_RESULT SubmitInput(amf::AMFData* pData)
     {
+        {
+            amf::AMFLock lock(&m_cs);
+            if(m_bFrozen)
+            {
+                return AMF_INPUT_FULL;
+            }
+            if(!m_WriterThread.IsRunning())
+            {
+                m_WriterThread.Start();
+            }
+        }
+        if(pData == NULL)
+        {
+            return WaitForWrites() ? AMF_EOF : AMF_INPUT_FULL;
+        }
+        if(m_eWriteError != AMF_OK)
+        {
+            return m_eWriteError;
+        }
+
+        AddPending();
+        if(m_Queue.Add(0, amf::AMFDataPtr(pData), 0, 0))
+        {
+            return AMF_OK;
+        }
+        const amf_pts startStall = amf_high_precision_clock();
+        const bool added = m_Queue.Add(0, amf::AMFDataPtr(pData), 0, ASYNC_WRITER_WAIT_TIMEOUT);
+        {
+            amf::AMFLock lock(&m_StatSync);
+            m_ptsStallTime += amf_high_precision_clock() - startStall;
+        }
+        if(!added)
+        {
+            ReleasePending();
+            return AMF_INPUT_FULL;
+        }
+        return AMF_OK;
+    }
+    virtual AMF_RESULT QueryOutput(amf::AMFData** ppData)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    virtual AMF_RESULT Drain(amf_int32 inputSlot)
+    {
+        return WaitForWrites() ? AMF_OK : AMF_INPUT_FULL;
     }
 
-    virtual ~StreamWriter()
+protected:
+    AsyncWriter(amf::AMFDataStream* pDataStream, amf_int32 queueDepth) :
+        m_pDataStream(pDataStream),
+        m_WriterThread(this),
+        m_IdleEvent(true, true),    // signaled while nothing is pending
+        m_iPending(0),
+        m_eWriteError(AMF_OK),
+        m_iFramesWritten(0),
+        m_iBytesWritten(0),
+        m_ptsWriteTime(0),
+        m_ptsStallTime(0)
+    {
+        m_Queue.SetQueueSize(queueDepth);
+    }
+    virtual ~AsyncWriter()
     {
-//        LOG_DEBUG(L"Stream Writer: written frames:" << m_framesWritten << L"\n");
     }
 
-    virtual amf_int32 GetInputSlotCount() const { return 1; }
-    virtual amf_int32 GetOutputSlotCount() const { return 0; }
+    // called by the writer thread; derived destructors must call StopWriter() first
+    virtual AMF_RESULT WriteData(amf::AMFData* pData, amf_size& written) = 0;
 
-    virtual AMF_RESULT SubmitInput(amf::AMFData* pData)
+    // writes everything still queued and stops the thread
+    void StopWriter()
     {
-        amf::AMFLock lock(&m_cs);
-        if(m_bFrozen)
+        m_WriterThread.RequestStop();
+        m_WriterThread.WaitForStop();
+    }
+    bool WaitForWrites()
+    {
+        if(m_iPending == 0)
         {
-            return AMF_INPUT_FULL;
+            return true;
         }
-
-        AMF_RESULT res = AMF_OK;
-        if(pData)
+        m_IdleEvent.LockTimeout(ASYNC_WRITER_WAIT_TIMEOUT);
+        return m_iPending == 0;
+    }
+    std::wstring GetWriteStats()
+    {
+        amf::AMFLock lock(&m_StatSync);
+        std::wstringstream messageStream;
+        if(m_iFramesWritten > 0)
         {
-            amf::AMFBufferPtr pBuffer(pData);
+            const double mbytes = m_iBytesWritten / (1024. * 1024.);
+            const double writeSec = (double)m_ptsWriteTime / AMF_SECOND;
+            messageStream << L" Written " << mbytes << L" MB in " << m_iFramesWritten << L" frames";
+            if(writeSec > 0)
+            {
+                messageStream << L" at " << mbytes / writeSec << L" MB/s";
+            }
+            messageStream << L", pipeline stalled " << (double)m_ptsStallTime / 10000. << L" ms";
+        }
+        return messageStream.str();
+    }
 
-            amf_size towrite = pBuffer->GetSize();
+    amf::AMFDataStreamPtr   m_pDataStream;
+
+private:
+    class WriterThread : public amf::AMFThread
+    {
+    public:
+        WriterThread(AsyncWriter* pHost) : m_pHost(pHost) {}
+        virtual void Run() { m_pHost->RunWriter(); }
+    private:
+        AsyncWriter* m_pHost;
+    };
+    friend class WriterThread;
+
+    void RunWriter()
+    {
+        for(;;)
+        {
+            amf_ulong id = 0;
+            amf::AMFDataPtr pData;
+            if(!m_Queue.Get(id, pData, ASYNC_WRITER_WAIT_TIMEOUT))
+            {
+                if(m_WriterThread.StopRequested())
+                {
+                    break;
+                }
+                continue;
+            }
+            const amf_pts start = amf_high_precision_clock();
             amf_size written = 0;
-            m_pDataStream->Write(pBuffer->GetNative(), towrite, &written);
-            m_framesWritten++;
-            if(m_maxSize < towrite)
+            AMF_RESULT res = WriteData(pData, written);
+            pData = NULL;
             {
-                m_maxSize = towrite;
+                amf::AMFLock lock(&m_StatSync);
+                m_ptsWriteTime += amf_high_precision_clock() - start;
+                m_iBytesWritten += written;
+                m_iFramesWritten++;
             }
-            m_totalSize += towrite;
+            if(res != AMF_OK)
+            {
+                LOG_ERROR(L"Writer failed to write data: " << g_AMFFactory.GetTrace()->GetResultText(res));
+                m_eWriteError = res;
+            }
+            ReleasePending();
         }
-        else
+    }
+    // the idle event follows m_iPending; m_IdleSync keeps a 0->1 reset from racing a 1->0 set
+    void AddPending()
+    {
+        amf::AMFLock lock(&m_IdleSync);
+        if(m_iPending++ == 0)
         {
-            res = AMF_EOF;
+            m_IdleEvent.ResetEvent();
         }
-        return res;
     }
-    virtual AMF_RESULT QueryOutput(amf::AMFData** ppData)
+    void ReleasePending()
     {
-        return AMF_NOT_SUPPORTED;
+        amf::AMFLock lock(&m_IdleSync);
+        if(--m_iPending == 0)
+        {
+            m_IdleEvent.SetEvent();
+        }
     }
+
+    WriterThread                        m_WriterThread;
+    amf::AMFQueue<amf::AMFDataPtr>      m_Queue;
+    amf::AMFCriticalSection             m_IdleSync;
+    amf::AMFEvent                       m_IdleEvent;
+    std::atomic<amf_int32>              m_iPending;     // queued or being written
+    std::atomic<AMF_RESULT>             m_eWriteError;
+
+    amf::AMFCriticalSection             m_StatSync;
+    amf_int64                           m_iFramesWritten;
+    amf_int64                           m_iBytesWritten;
+    amf_pts                             m_ptsWriteTime;
+    amf_pts                             m_ptsStallTime;
+};
+//-------------------------------------------------------------------------------------------------
+class StreamWriter : public AsyncWriter
+{
+public:
+    StreamWriter(amf::AMFDataStream *pDataStream, amf_int32 queueDepth = 16)
+        :AsyncWriter(pDataStream, queueDepth),
+        m_framesWritten(0), m_maxSize(0), m_totalSize(0)
+    {
+    }
+
+    virtual ~StreamWriter()
+    {
+        StopWriter();
+    }
+
     virtual std::wstring       GetDisplayResult()
     {
         amf::AMFLock lock(&m_cs);
@@ -133,12 +290,29 @@ public:
         {
             std::wstringstream messageStream;
             messageStream << L" Average (Max) Frame size: " << m_totalSize / m_framesWritten << L" bytes (" << m_maxSize << " bytes)";
+            messageStream << GetWriteStats();
             ret = messageStream.str();
         }
         return ret;
     }
+protected:
+    virtual AMF_RESULT WriteData(amf::AMFData* pData, amf_size& written)
+    {
+        amf::AMFBufferPtr pBuffer(pData);
+
+        amf_size towrite = pBuffer->GetSize();
+        AMF_RESULT res = m_pDataStream->Write(pBuffer->GetNative(), towrite, &written);
+
+        amf::AMFLock lock(&m_cs);
+        m_framesWritten++;
+        if(m_maxSize < towrite)
+        {
+            m_maxSize = towrite;
+        }
+        m_totalSize += towrite;
+        return res;
+    }
 private:
-    amf::AMFDataStreamPtr   m_pDataStream;
     amf_int                 m_framesWritten;
     amf_size                m_maxSize;
     amf_int64               m_totalSize;
@@ -146,58 +320,78 @@ private:
 //-------------------------------------------------------------------------------------------------
 typedef std::shared_ptr<StreamWriter> StreamWriterPtr;
 //-------------------------------------------------------------------------------------------------
-class SurfaceWriter : public PipelineElement
+class SurfaceWriter : public AsyncWriter
 {
 public:
-    SurfaceWriter(amf::AMFDataStream* pDataStream)
-        :m_pDataStream(pDataStream), m_framesWritten(0)
+    SurfaceWriter(amf::AMFDataStream* pDataStream, amf_int32 queueDepth = 4)
+        :AsyncWriter(pDataStream, queueDepth)
     {
     }
 
     virtual ~SurfaceWriter()
     {
-//        LOG_DEBUG(L"Stream Writer: written frames:" << m_framesWritten << L"\n");
+        StopWriter();
     }
 
-    virtual amf_int32 GetOutputSlotCount() const { return 0; }
-
-    virtual AMF_RESULT SubmitInput(amf::AMFData* pData)
+    virtual std::wstring       GetDisplayResult()
     {
-        amf::AMFLock lock(&m_cs);
-        if(m_bFrozen)
+        return GetWriteStats();
+    }
+protected:
+    // writes only the visible (cropped) rows of each plane, without pitch padding
+    virtual AMF_RESULT WriteData(amf::AMFData* pData, amf_size& written)
+    {
+        amf::AMFSurfacePtr pSurface(pData);
+        AMF_RESULT res = pSurface->Convert(amf::AMF_MEMORY_HOST);
+        if(res != AMF_OK)
         {
-            return AMF_INPUT_FULL;
+            return res;
         }
 
-        AMF_RESULT res = AMF_OK;
-        if(pData)
+        const amf_size planes = pSurface->GetPlanesCount();
+        bool contiguous = true;
+        amf_size frameSize = 0;
+        for(amf_size i = 0; i < planes; i++)
         {
-            amf::AMFSurfacePtr pSurface(pData);
-            pSurface->Convert(amf::AMF_MEMORY_HOST);
+            amf::AMFPlane* pPlane = pSurface->GetPlaneAt(i);
+            const amf_size rowSize = (amf_size)pPlane->GetWidth() * pPlane->GetPixelSizeInBytes();
+            contiguous = contiguous && rowSize == (amf_size)pPlane->GetHPitch();
+            frameSize += rowSize * pPlane->GetHeight();
+        }
 
-            for(amf_size i = 0; i < pSurface->GetPlanesCount(); i++)
+        if(contiguous)
+        {
+            // rows follow each other without padding: write the planes in place
+            for(amf_size i = 0; i < planes && res == AMF_OK; i++)
             {
-                amf::AMFPlanePtr pPlane = pSurface->GetPlaneAt(i);
-                amf_size towrite = ((amf_size)pPlane->GetOffsetY() + (amf_size)pPlane->GetHeight()) * (amf_size)pPlane->GetHPitch();
-                amf_size written = 0;
-               m_pDataStream->Write(pPlane->GetNative(), towrite, &written);
+                amf::AMFPlane* pPlane = pSurface->GetPlaneAt(i);
+                const amf_uint8* pSrc = static_cast<const amf_uint8*>(pPlane->GetNative()) + (amf_size)pPlane->GetOffsetY() * pPlane->GetHPitch();
+                amf_size planeWritten = 0;
+                res = m_pDataStream->Write(pSrc, (amf_size)pPlane->GetHPitch() * pPlane->GetHeight(), &planeWritten);
+                written += planeWritten;
             }
-            m_framesWritten++;
+            return res;
         }
-        else
+
+        // gather the rows of all planes so the frame goes out in a single write
+        m_Staging.SetSizeUninitialized(frameSize);
+        amf_uint8* pDst = m_Staging.GetData();
+        for(amf_size i = 0; i < planes; i++)
         {
-            res = AMF_EOF;
+            amf::AMFPlane* pPlane = pSurface->GetPlaneAt(i);
+            const amf_int32 pitch = pPlane->GetHPitch();
+            const amf_size rowSize = (amf_size)pPlane->GetWidth() * pPlane->GetPixelSizeInBytes();
+            const amf_uint8* pSrc = static_cast<const amf_uint8*>(pPlane->GetNative()) +
+                (amf_size)pPlane->GetOffsetY() * pitch + (amf_size)pPlane->GetOffsetX() * pPlane->GetPixelSizeInBytes();
+            for(amf_int32 y = 0; y < pPlane->GetHeight(); y++, pSrc += pitch, pDst += rowSize)
+            {
+                memcpy(pDst, pSrc, rowSize);
+            }
         }
-        return res;
+        return m_pDataStream->Write(m_Staging.GetData(), frameSize, &written);
     }
-    virtual AMF_RESULT QueryOutput(amf::AMFData** ppData)
-    {
-        return AMF_NOT_SUPPORTED;
-    }
-
 private:
-    amf::AMFDataStreamPtr    m_pDataStream;
-    amf_int                 m_framesWritten;
+    AMFByteArray            m_Staging;
 };
 //-------------------------------------------------------------------------------------------------
 typedef std::shared_ptr<SurfaceWriter> SurfaceWriterPtr;
@@ -208,10 +208,15 @@ AMF_RESULT PlaybackPipelineBase::Seek(amf_pts pts)
         amf::AMFMediaSourcePtr pSource(m_pDemuxerVideo);
         if(pSource != NULL)
         {
-            Freeze();
+            // flushing and seeking is only safe once no slot thread is inside a component
+            AMF_RESULT res = Freeze();
+            if(res != AMF_OK)
+            {
+                UnFreeze();
+                LOG_ERROR(L"Seek() - pipeline did not freeze, seek to " << pts << L" skipped");
+                return res;
+            }
             Flush();
-            //MM temporarely - till provide better information that pipeline frozen
-            amf_sleep(200);
             pSource->Seek(pts, amf::AMF_SEEK_PREV_KEYFRAME, -1);
 
             if(m_pDemuxerAudio != NULL)
@@ -33,8 +33,19 @@
 #include "RawStreamReader.h"
 #include "PipelineDefines.h"
 #include "CmdLogger.h"
+#include "public/common/AMFSTL.h"
 #include <fstream>
 #include <wctype.h>
+#include <algorithm>
+#include <atomic>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 // replacing with std::iswdigit(wchar_t ch)
@@ -160,7 +171,260 @@ static void YUV420PicCopy(const amf_uint8 *src, amf_int32 srcStride, amf_int32 s
     PlaneCopy(src + srcYSize + srcUSize, srcStride / 2, srcHeight / 2, dst + dstYSize + dstUSize, dstStride / 2, dstHeight / 2); 
 }
 
+//-------------------------------------------------------------------------------------------------
+// RawFramePool - memory-mapped input file and recycled host frame buffers; surfaces wrapping
+// either one hold a reference on the pool and hand it back in OnSurfaceDataRelease()
+//-------------------------------------------------------------------------------------------------
+class RawFramePool : public amf::AMFSurfaceObserver
+{
+public:
+    RawFramePool() :
+        m_iRefCount(1),
+        m_pMapped(NULL),
+        m_iMappedSize(0),
+#if defined(_WIN32)
+        m_hFile(INVALID_HANDLE_VALUE),
+        m_hMapping(NULL),
+#endif
+        m_iBufferSize(0),
+        m_iHPitch(0),
+        m_iVPitch(0)
+    {
+    }
+
+    void Acquire()
+    {
+        m_iRefCount++;
+    }
+    void Release()
+    {
+        if(--m_iRefCount == 0)
+        {
+            delete this;
+        }
+    }
+
+    bool Map(const std::wstring& path)
+    {
+#if defined(_WIN32)
+        m_hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if(m_hFile == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER size = {};
+        if(!GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0 || (amf_uint64)size.QuadPart > (amf_uint64)SIZE_MAX)
+        {
+            return false;
+        }
+        // copy-on-write view: a downstream component writing into a wrapped frame never touches the file
+        m_hMapping = CreateFileMappingW(m_hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if(m_hMapping == NULL)
+        {
+            return false;
+        }
+        m_pMapped = static_cast<amf_uint8*>(MapViewOfFile(m_hMapping, FILE_MAP_COPY, 0, 0, 0));
+        if(m_pMapped == NULL)
+        {
+            return false;
+        }
+        m_iMappedSize = size.QuadPart;
+#else
+        const amf_string name = amf::amf_from_unicode_to_utf8(amf_wstring(path.c_str()));
+        const int fd = open(name.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            return false;
+        }
+        struct stat st = {};
+        if(fstat(fd, &st) != 0 || st.st_size == 0 || (amf_uint64)st.st_size > (amf_uint64)SIZE_MAX)
+        {
+            close(fd);
+            return false;
+        }
+        // private writable mapping: a downstream component writing into a wrapped frame never touches the file
+        void* pMapped = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(pMapped == MAP_FAILED)
+        {
+            return false;
+        }
+        m_pMapped = static_cast<amf_uint8*>(pMapped);
+        m_iMappedSize = st.st_size;
+        madvise(m_pMapped, (size_t)m_iMappedSize, MADV_SEQUENTIAL);
+#endif
+        return true;
+    }
+    bool IsMapped() const                   { return m_pMapped != NULL; }
+    amf_uint8* GetMappedData() const        { return m_pMapped; }
 
+    // starts the I/O for the range and faults its pages in, so the reader does not block on them
+    void Prefetch(amf_int64 offset, amf_int64 size)
+    {
+        if(m_pMapped == NULL || offset >= m_iMappedSize)
+        {
+            return;
+        }
+        size = AMF_MIN(size, m_iMappedSize - offset);
+#if !defined(_WIN32)
+        const amf_int64 pageMask = (amf_int64)sysconf(_SC_PAGESIZE) - 1;
+        const amf_int64 begin = offset & ~pageMask;
+        madvise(m_pMapped + begin, (size_t)(offset + size - begin), MADV_WILLNEED);
+#endif
+        volatile amf_uint8 sink = 0;
+        for(amf_int64 pos = offset; pos < offset + size; pos += 4096)
+        {
+            sink ^= m_pMapped[pos];
+        }
+        (void)sink;
+    }
+
+    void SetBufferLayout(amf_size bufferSize, amf_int32 hPitch, amf_int32 vPitch)
+    {
+        m_iBufferSize = bufferSize;
+        m_iHPitch = hPitch;
+        m_iVPitch = vPitch;
+    }
+    amf_int32 GetHPitch() const             { return m_iHPitch; }
+    amf_int32 GetVPitch() const             { return m_iVPitch; }
+
+    amf_uint8* AcquireBuffer()
+    {
+        amf::AMFLock lock(&m_sync);
+        if(!m_FreeBuffers.empty())
+        {
+            amf_uint8* pBuffer = m_FreeBuffers.back();
+            m_FreeBuffers.pop_back();
+            return pBuffer;
+        }
+        amf_uint8* pBuffer = static_cast<amf_uint8*>(amf_virtual_alloc(m_iBufferSize));
+        if(pBuffer != NULL)
+        {
+            m_AllBuffers.push_back(pBuffer);
+        }
+        return pBuffer;
+    }
+    void ReturnBuffer(amf_uint8* pBuffer)
+    {
+        amf::AMFLock lock(&m_sync);
+        m_FreeBuffers.push_back(pBuffer);
+    }
+
+    // AMFSurfaceObserver interface
+    virtual void AMF_STD_CALL OnSurfaceDataRelease(amf::AMFSurface* pSurface)
+    {
+        amf_uint8* pData = static_cast<amf_uint8*>(pSurface->GetPlaneAt(0)->GetNative());
+        {
+            amf::AMFLock lock(&m_sync);
+            if(std::find(m_AllBuffers.begin(), m_AllBuffers.end(), pData) != m_AllBuffers.end())
+            {
+                m_FreeBuffers.push_back(pData);
+            }
+        }
+        Release();
+    }
+
+private:
+    virtual ~RawFramePool()
+    {
+        for(std::vector<amf_uint8*>::iterator it = m_AllBuffers.begin(); it != m_AllBuffers.end(); ++it)
+        {
+            amf_virtual_free(*it);
+        }
+#if defined(_WIN32)
+        if(m_pMapped != NULL)
+        {
+            UnmapViewOfFile(m_pMapped);
+        }
+        if(m_hMapping != NULL)
+        {
+            CloseHandle(m_hMapping);
+        }
+        if(m_hFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_hFile);
+        }
+#else
+        if(m_pMapped != NULL)
+        {
+            munmap(m_pMapped, (size_t)m_iMappedSize);
+        }
+#endif
+    }
+
+    std::atomic<amf_long>       m_iRefCount;
+    amf_uint8*                  m_pMapped;
+    amf_int64                   m_iMappedSize;
+#if defined(_WIN32)
+    HANDLE                      m_hFile;
+    HANDLE                      m_hMapping;
+#endif
+    amf::AMFCriticalSection     m_sync;
+    std::vector<amf_uint8*>     m_AllBuffers;
+    std::vector<amf_uint8*>     m_FreeBuffers;
+    amf_size                    m_iBufferSize;
+    amf_int32                   m_iHPitch;
+    amf_int32                   m_iVPitch;
+};
+//-------------------------------------------------------------------------------------------------
+// RawReadAheadThread - keeps the next N frames of the mapping resident ahead of the reader
+//-------------------------------------------------------------------------------------------------
+class RawReadAheadThread : public amf::AMFThread
+{
+public:
+    RawReadAheadThread(RawFramePool* pPool, amf_int32 frameSize, amf_int64 framesCount, amf_int32 depth) :
+        m_pPool(pPool),
+        m_iFrameSize(frameSize),
+        m_iFramesCount(framesCount),
+        m_iDepth(depth),
+        m_iNextFrame(0),
+        m_WakeEvent(false, false)
+    {
+        m_pPool->Acquire();
+    }
+    virtual ~RawReadAheadThread()
+    {
+        m_pPool->Release();
+    }
+    void OnFrameRead(amf_int64 frame)
+    {
+        m_iNextFrame = frame;
+        m_WakeEvent.SetEvent();
+    }
+    void Stop()
+    {
+        RequestStop();
+        m_WakeEvent.SetEvent();
+        WaitForStop();
+    }
+    virtual void Run()
+    {
+        amf_int64 prefetched = 0;
+        while(!StopRequested())
+        {
+            const amf_int64 next = m_iNextFrame;
+            if(next < prefetched - m_iDepth)
+            {
+                prefetched = next; // RestartReader() rewound the file
+            }
+            const amf_int64 last = AMF_MIN(next + m_iDepth, m_iFramesCount);
+            for(amf_int64 frame = AMF_MAX(prefetched, next); frame < last && !StopRequested(); frame++)
+            {
+                m_pPool->Prefetch(frame * m_iFrameSize, m_iFrameSize);
+                prefetched = frame + 1;
+            }
+            m_WakeEvent.LockTimeout(100);
+        }
+    }
+private:
+    RawFramePool*           m_pPool;
+    amf_int32               m_iFrameSize;
+    amf_int64               m_iFramesCount;
+    amf_int32               m_iDepth;
+    std::atomic<amf_int64>  m_iNextFrame;
+    amf::AMFEvent           m_WakeEvent;
+};
+//-------------------------------------------------------------------------------------------------
 RawStreamReader::RawStreamReader()
     :m_pDataStream(),
     m_format(amf::AMF_SURFACE_UNKNOWN),
@@ -168,9 +432,13 @@ RawStreamReader::RawStreamReader()
     m_width(0), 
     m_height(0), 
     m_stride(0), 
+    m_frameSize(0),
     m_framesCount(0),
     m_framesCountRead(0),
-    m_frame()
+    m_frame(),
+    m_pPool(NULL),
+    m_pReadAhead(NULL),
+    m_bZeroCopy(false)
 {
 }
 
@@ -181,6 +449,8 @@ RawStreamReader::~RawStreamReader()
 
 AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pContext)
 {
+    Terminate();
+
     AMF_RESULT res = AMF_OK;
     m_pContext = pContext;
     std::wstring path;
@@ -315,7 +585,7 @@ AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pC
         LOG_ERROR("Wrong format:" << m_format);
         return AMF_FAIL;
     }
-    m_frame.SetSize(frameSize);
+    m_frameSize = frameSize;
 
     if (!m_stride || !frameSize)
     {
@@ -329,12 +599,60 @@ AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pC
     {
         m_framesCount = AMF_MIN(frames, m_framesCount);
     }
+
+    // pooled host buffers get the layout AllocSurface() would give, so they are interchangeable with its surfaces
+    amf::AMFSurfacePtr pLayoutSurface;
+    res = m_pContext->AllocSurface(amf::AMF_MEMORY_HOST, m_format, m_width, m_height, &pLayoutSurface);
+    CHECK_AMF_ERROR_RETURN(res, L"AMFContext::AllocSurface(amf::AMF_MEMORY_HOST) failed");
+    const amf_int32 hPitch = pLayoutSurface->GetPlaneAt(0)->GetHPitch();
+    const amf_int32 vPitch = pLayoutSurface->GetPlaneAt(0)->GetVPitch();
+    amf_size bufferSize = (amf_size)hPitch * vPitch;
+    if(m_format == amf::AMF_SURFACE_YUV420P || m_format == amf::AMF_SURFACE_NV12 || m_format == amf::AMF_SURFACE_P010 ||
+        m_format == amf::AMF_SURFACE_P012 || m_format == amf::AMF_SURFACE_P016)
+    {
+        bufferSize += bufferSize / 2; // chroma planes of 4:2:0 formats follow the luma plane
+    }
+
+    m_pPool = new RawFramePool();
+    m_pPool->SetBufferLayout(bufferSize, hPitch, vPitch);
+
+    bool useMapping = true;
+    pParams->GetParam(PARAM_NAME_INPUT_MMAP, useMapping);
+    if(useMapping && m_pPool->Map(path))
+    {
+        // the file is wrapped as is when its frames already have the host surface layout
+        m_bZeroCopy = m_stride == hPitch && m_height == vPitch;
+
+        amf_int64 readAhead = 4;
+        pParams->GetParam(PARAM_NAME_INPUT_READ_AHEAD, readAhead);
+        if(readAhead > 0)
+        {
+            m_pReadAhead = new RawReadAheadThread(m_pPool, m_frameSize, m_framesCount, (amf_int32)readAhead);
+            m_pReadAhead->Start();
+        }
+    }
+    else
+    {
+        m_frame.SetSize(frameSize);
+    }
     return AMF_OK;
 }
 
 AMF_RESULT RawStreamReader::Terminate()
 {
     AMF_RESULT res = AMF_OK;
+    if(m_pReadAhead != NULL)
+    {
+        m_pReadAhead->Stop();
+        delete m_pReadAhead;
+        m_pReadAhead = NULL;
+    }
+    if(m_pPool != NULL)
+    {
+        m_pPool->Release(); // surfaces still in flight keep the mapping and their buffers alive
+        m_pPool = NULL;
+    }
+    m_bZeroCopy = false;
     m_pDataStream = NULL;
     m_pContext = NULL;
     return res;
@@ -350,17 +668,29 @@ AMF_RESULT RawStreamReader::QueryOutput(amf::AMFData** ppData)
     AMF_RESULT res = AMF_OK;
     amf::AMFSurfacePtr pSurface;
 
-    res = m_pContext->AllocSurface(amf::AMF_MEMORY_HOST, m_format, m_width , m_height, &pSurface);
-    CHECK_AMF_ERROR_RETURN(res, L"AMFContext::AllocSurface(amf::AMF_MEMORY_HOST) failed");
-    pSurface->SetCrop(m_roi_x, m_roi_y, m_roi_width, m_roi_height);
-
-    amf::AMFPlanePtr plane = pSurface->GetPlaneAt(0);
-    res = ReadNextFrame(plane->GetHPitch(), m_height, plane->GetVPitch(), static_cast<unsigned char*>(plane->GetNative()));
-    if(res == AMF_EOF)
+    if(m_bZeroCopy)
+    {
+        res = WrapNextMappedFrame(&pSurface);
+        if(res == AMF_EOF)
+        {
+            return res;
+        }
+        CHECK_AMF_ERROR_RETURN(res, L"WrapNextMappedFrame() failed");
+    }
+    else
     {
-        return res;
+        res = AcquirePooledSurface(&pSurface);
+        CHECK_AMF_ERROR_RETURN(res, L"AcquirePooledSurface() failed");
+
+        amf::AMFPlanePtr plane = pSurface->GetPlaneAt(0);
+        res = ReadNextFrame(plane->GetHPitch(), m_height, plane->GetVPitch(), static_cast<unsigned char*>(plane->GetNative()));
+        if(res == AMF_EOF)
+        {
+            return res;
+        }
+        CHECK_AMF_ERROR_RETURN(res, L"ReadNextFrame() failed");
     }
-    CHECK_AMF_ERROR_RETURN(res, L"ReadNextFrame() failed");
+    pSurface->SetCrop(m_roi_x, m_roi_y, m_roi_width, m_roi_height);
 
     // RawStreamReader doesn't have a frame rate, so let's
     // assume the frame rate is 30 fps, and then set pts and duration
@@ -399,6 +729,12 @@ AMF_RESULT RawStreamReader::ReadNextFrame(int dstStride, int dstHeight, int vali
         return AMF_EOF;
     }
 
+    const amf_uint8* pSrc = NULL;
+    if(m_pPool->IsMapped())
+    {
+        pSrc = m_pPool->GetMappedData() + m_framesCountRead * m_frameSize;
+    }
+    else
     {
         amf_size read = 0;
         m_pDataStream->Read(m_frame.GetData(), m_frame.GetSize(), &read);
@@ -406,8 +742,9 @@ AMF_RESULT RawStreamReader::ReadNextFrame(int dstStride, int dstHeight, int vali
         {
             return AMF_EOF;
         }
-        m_framesCountRead++;
+        pSrc = m_frame.GetData();
     }
+    OnFrameRead();
 
     switch(m_format)
     {
@@ -417,16 +754,16 @@ AMF_RESULT RawStreamReader::ReadNextFrame(int dstStride, int dstHeight, int vali
     case amf::AMF_SURFACE_RGBA:
     case amf::AMF_SURFACE_RGBA_F16:
     case amf::AMF_SURFACE_R10G10B10A2:
-        PlaneCopy(m_frame.GetData(), m_stride, m_height, pDstBits, dstStride, valignment);
+        PlaneCopy(pSrc, m_stride, m_height, pDstBits, dstStride, valignment);
         break;
     case amf::AMF_SURFACE_YUV420P:
-        YUV420PicCopy(m_frame.GetData(), m_stride, m_height, pDstBits, dstStride, valignment);
+        YUV420PicCopy(pSrc, m_stride, m_height, pDstBits, dstStride, valignment);
         break;
     case amf::AMF_SURFACE_NV12:
     case amf::AMF_SURFACE_P010:
     case amf::AMF_SURFACE_P012:
     case amf::AMF_SURFACE_P016:
-        NV12PicCopy(m_frame.GetData(), m_stride, m_height, pDstBits, dstStride, valignment);
+        NV12PicCopy(pSrc, m_stride, m_height, pDstBits, dstStride, valignment);
         break;
     default:
         LOG_ERROR("Format reading is not supported");
@@ -435,6 +772,46 @@ AMF_RESULT RawStreamReader::ReadNextFrame(int dstStride, int dstHeight, int vali
     return AMF_OK;
 }
 
+AMF_RESULT RawStreamReader::WrapNextMappedFrame(amf::AMFSurface** ppSurface)
+{
+    if(m_framesCountRead == m_framesCount)
+    {
+        return AMF_EOF;
+    }
+    amf_uint8* pFrame = m_pPool->GetMappedData() + m_framesCountRead * m_frameSize;
+    AMF_RESULT res = m_pContext->CreateSurfaceFromHostNative(m_format, m_width, m_height, m_stride, m_height, pFrame, ppSurface, m_pPool);
+    CHECK_AMF_ERROR_RETURN(res, L"AMFContext::CreateSurfaceFromHostNative() failed");
+    m_pPool->Acquire(); // released in OnSurfaceDataRelease()
+    OnFrameRead();
+    return AMF_OK;
+}
+
+AMF_RESULT RawStreamReader::AcquirePooledSurface(amf::AMFSurface** ppSurface)
+{
+    amf_uint8* pBuffer = m_pPool->AcquireBuffer();
+    if(pBuffer != NULL)
+    {
+        AMF_RESULT res = m_pContext->CreateSurfaceFromHostNative(m_format, m_width, m_height, m_pPool->GetHPitch(), m_pPool->GetVPitch(),
+            pBuffer, ppSurface, m_pPool);
+        if(res == AMF_OK)
+        {
+            m_pPool->Acquire(); // released in OnSurfaceDataRelease()
+            return AMF_OK;
+        }
+        m_pPool->ReturnBuffer(pBuffer);
+    }
+    return m_pContext->AllocSurface(amf::AMF_MEMORY_HOST, m_format, m_width, m_height, ppSurface);
+}
+
+void RawStreamReader::OnFrameRead()
+{
+    m_framesCountRead++;
+    if(m_pReadAhead != NULL)
+    {
+        m_pReadAhead->OnFrameRead(m_framesCountRead);
+    }
+}
+
 AMF_RESULT RawStreamReader::ReadNextSearchCenterMap(int dstStride, int dstHeight, int valignment, unsigned char* pDstBits)
 {
 	amf_size read = 0;
@@ -551,6 +928,10 @@ void RawStreamReader::RestartReader()
 {
     m_pDataStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
     m_framesCountRead = 0;
+    if(m_pReadAhead != NULL)
+    {
+        m_pReadAhead->OnFrameRead(m_framesCountRead);
+    }
 }
 //----------------------------------------------------------------------------------------------
 amf::AMF_SURFACE_FORMAT AMF_STD_CALL GetFormatFromString(const wchar_t* str)
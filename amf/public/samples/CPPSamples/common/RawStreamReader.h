@@ -38,6 +38,8 @@
 #include "public/samples/CPPSamples/common/ParametersStorage.h"
 #include "public/common/ByteArray.h"
 
+class RawFramePool;
+class RawReadAheadThread;
 
 class RawStreamReader :public PipelineElement
 {
@@ -66,6 +68,9 @@ private:
 
     virtual AMF_RESULT Terminate();
     AMF_RESULT ReadNextFrame(int dstStride, int dstHeight, int valignment, unsigned char* pDstBits);
+    AMF_RESULT WrapNextMappedFrame(amf::AMFSurface** ppSurface);
+    AMF_RESULT AcquirePooledSurface(amf::AMFSurface** ppSurface);
+    void       OnFrameRead();
 	AMF_RESULT ReadNextSearchCenterMap(int dstStride, int dstHeight, int valignment, unsigned char* pDstBits);
 
     amf::AMFContextPtr      m_pContext;
@@ -77,6 +82,7 @@ private:
     amf_int32               m_width;
     amf_int32               m_height;
     amf_int32               m_stride;
+    amf_int32               m_frameSize;
 
     amf_int32               m_roi_x; 
     amf_int32               m_roi_y;
@@ -88,6 +94,10 @@ private:
 
     AMFByteArray            m_frame;
 
+    RawFramePool*           m_pPool;        // ref-counted: stays alive while surfaces wrapping its memory are in flight
+    RawReadAheadThread*     m_pReadAhead;
+    bool                    m_bZeroCopy;    // surfaces wrap the file mapping directly
+
 	amf::AMFDataStreamPtr   m_pSearchCenterMapStream;   
 	amf::AMF_SURFACE_FORMAT m_searchCenterMapformat;    
 	amf_int32               m_searchCenterMapSize;     
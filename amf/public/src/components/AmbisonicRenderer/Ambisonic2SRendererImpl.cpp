@@ -89,13 +89,55 @@ void Ambi2Stereo::loadTabulatedHRTFs(){
     m_convolution = new convolution(IRTABLEN,responseLength);
     m_convolution->init();
 
+    if (convolutionMethod == AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT){
+        loadResponseSpectra();
+    }
+}
+
+void Ambi2Stereo::loadResponseSpectra(){
+
+    m_fftConvolution = new fftConvolution(4, 2, bufSize, responseLength);
+    if (!m_fftConvolution->init()){
+        // not a power of two block - stay on timeDomainCPU
+        AMFTraceWarning(AMF_FACILITY, L"Partitioned FFT convolution not available for block %d, using time domain", (int)bufSize);
+        delete m_fftConvolution;
+        m_fftConvolution = NULL;
+        return;
+    }
+    const int spectrumLength = m_fftConvolution->getSpectrumLength();
+
+    for (int n = 0; n < IRTABLEN; n++){
+        for (int ear = 0; ear < 2; ear++){
+            SpeakerSpectrumRe[ear][n] = new float[spectrumLength];
+            SpeakerSpectrumIm[ear][n] = new float[spectrumLength];
+            m_fftConvolution->transformResponse(ear == 0 ? vSpkrNresponse_L[n] : vSpkrNresponse_R[n], responseLength,
+                SpeakerSpectrumRe[ear][n], SpeakerSpectrumIm[ear][n]);
+        }
+    }
+    for (int k = 0; k < 8; k++){
+        ResponseSpectrumRe[k] = new float[spectrumLength];
+        ResponseSpectrumIm[k] = new float[spectrumLength];
+    }
+    spectraValid = false;
 }
 
-Ambi2Stereo::Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM decodemethod, amf_int64 inSampleRate_) :
+Ambi2Stereo::Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM decodemethod, AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM convolutionmethod, amf_int64 inSampleRate_) :
 inSampleRate(inSampleRate_)
 {
     m_convolution = NULL;
     method = decodemethod;
+    convolutionMethod = convolutionmethod;
+
+    m_fftConvolution = NULL;
+    for (int n = 0; n < MAX_SPEAKERS; n++){
+        SpeakerSpectrumRe[0][n] = SpeakerSpectrumIm[0][n] = NULL;
+        SpeakerSpectrumRe[1][n] = SpeakerSpectrumIm[1][n] = NULL;
+    }
+    for (int k = 0; k < 8; k++){
+        ResponseSpectrumRe[k] = ResponseSpectrumIm[k] = NULL;
+    }
+    spectraTheta = spectraPhi = 0.0;
+    spectraValid = false;
 
     bufSize = 64;
     prevHeadTheta = prevHeadPhi = 0.0;
@@ -160,6 +202,21 @@ Ambi2Stereo::~Ambi2Stereo()
     {
         delete m_convolution;
     }
+
+    for (int n = 0; n < MAX_SPEAKERS; n++){
+        delete[] SpeakerSpectrumRe[0][n];
+        delete[] SpeakerSpectrumIm[0][n];
+        delete[] SpeakerSpectrumRe[1][n];
+        delete[] SpeakerSpectrumIm[1][n];
+    }
+    for (int k = 0; k < 8; k++){
+        delete[] ResponseSpectrumRe[k];
+        delete[] ResponseSpectrumIm[k];
+    }
+    if (m_fftConvolution)
+    {
+        delete m_fftConvolution;
+    }
 }
 
 //virtual mic 
@@ -219,9 +276,7 @@ void Ambi2Stereo::getResponses(float thetaHead, float phiHead,
 
         for (int n = 0; n < 20; n++){
 
-            X0 = (float)((1 - p)*cos((thetaHead - theta[n])*PI / 180.0) * cos((phiHead - phi[n])*PI / 180.0));
-            Y0 = (float)((1 - p)*sin((thetaHead - theta[n])*PI / 180.0) * cos((phiHead - phi[n])*PI / 180.0));
-            Z0 = (float)((1 - p)*sin((phiHead - phi[n])*PI / 180.0));
+            getSpeakerGains(thetaHead, phiHead, n, &X0, &Y0, &Z0);
 
             switch (channel){
             case 0:
@@ -255,6 +310,48 @@ void Ambi2Stereo::getResponses(float thetaHead, float phiHead,
     }
 }
 
+void Ambi2Stereo::getSpeakerGains(float thetaHead, float phiHead, int n, float *X0, float *Y0, float *Z0)
+{
+    float p = 0.5; // Cardiod
+
+    *X0 = (float)((1 - p)*cos((thetaHead - theta[n])*PI / 180.0) * cos((phiHead - phi[n])*PI / 180.0));
+    *Y0 = (float)((1 - p)*sin((thetaHead - theta[n])*PI / 180.0) * cos((phiHead - phi[n])*PI / 180.0));
+    *Z0 = (float)((1 - p)*sin((phiHead - phi[n])*PI / 180.0));
+}
+
+// same responses as getResponses() for both ears, mixed from the precomputed speaker spectra
+void Ambi2Stereo::updateResponseSpectra(float thetaHead, float phiHead)
+{
+    // the mix only depends on the head orientation
+    if (spectraValid && thetaHead == spectraTheta && phiHead == spectraPhi){
+        return;
+    }
+    float p = 0.5; // Cardiod
+    const float scale = (float)( (3.0 / 2.0) / 20.0 );
+    const float W0 = (float)( p*sqrt(2.0) );
+    const int spectrumLength = m_fftConvolution->getSpectrumLength();
+
+    for (int k = 0; k < 8; k++){
+        memset(ResponseSpectrumRe[k], 0, sizeof(float)*spectrumLength);
+        memset(ResponseSpectrumIm[k], 0, sizeof(float)*spectrumLength);
+    }
+    for (int n = 0; n < IRTABLEN; n++){
+        float gains[4];
+        gains[0] = W0;
+        getSpeakerGains(thetaHead, phiHead, n, &gains[1], &gains[2], &gains[3]);
+
+        for (int ear = 0; ear < 2; ear++){
+            for (int c = 0; c < 4; c++){
+                m_fftConvolution->accumulateSpectrum(ResponseSpectrumRe[ear * 4 + c], ResponseSpectrumIm[ear * 4 + c],
+                    SpeakerSpectrumRe[ear][n], SpeakerSpectrumIm[ear][n], gains[c] * scale);
+            }
+        }
+    }
+    spectraTheta = thetaHead;
+    spectraPhi = phiHead;
+    spectraValid = true;
+}
+
 void Ambi2Stereo::process(float newtheta, float newphi, int nSamples, float *W, float *X, float *Y, float *Z, float *left, float *right)
 {
     float theta = prevHeadTheta;
@@ -306,6 +403,21 @@ void Ambi2Stereo::process(float newtheta, float newphi, int nSamples, float *W,
             right[i] = W[i] * RightResponseW[0] + X[i] * RightResponseX[0] + Y[i] * RightResponseY[0] + Z[i] * RightResponseZ[0];
         }
     }
+    else if (m_fftConvolution != NULL){
+        // W, X, Y, Z are transformed once and shared by both ears, the mix down happens in the frequency domain
+        for (long i = 0; i < nSamples; i += bufSize){
+            updateResponseSpectra(theta, phi);
+            theta += deltaTheta;
+            phi += deltaPhi;
+
+            float *Out[2] = { left + i, right + i };
+            m_fftConvolution->process(Data, ResponseSpectrumRe, ResponseSpectrumIm, Out);
+
+            for (int ii = 0; ii < 4; ii++){
+                Data[ii] += bufSize;
+            }
+        }
+    }
     else {
 
         for (long i = 0; i < nSamples; i += bufSize){
@@ -434,6 +546,12 @@ const AMFEnumDescriptionEntry AMF_AMBISONIC2SRENDERER_MODE_ENUM_DESCRIPTION[] =
 
 };
 
+const AMFEnumDescriptionEntry AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM_DESCRIPTION[] = {
+{ AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN, L"Time domain" },
+{ AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT, L"Partitioned FFT" },
+{ AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN, 0 }  // This is end of description mark
+};
+
 
 //
 //
@@ -463,6 +581,7 @@ AMFAmbisonic2SRendererImpl::AMFAmbisonic2SRendererImpl(AMFContext* pContext)
   ,  m_ptsNext(0)
   ,  m_ambi2S(NULL)
   , m_eMode(AMF_AMBISONIC2SRENDERER_MODE_HRTF_MIT1)
+  , m_eConvolution(AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN)
   , m_ptsLastTime(-1LL)
 {
     AMFPrimitivePropertyInfoMapBegin
@@ -476,6 +595,7 @@ AMFAmbisonic2SRendererImpl::AMFAmbisonic2SRendererImpl(AMFContext* pContext)
         AMFPropertyInfoEnum(AMF_AMBISONIC2SRENDERER_IN_AUDIO_SAMPLE_FORMAT,     L"input Sample Format", AMFAF_FLTP, AMF_SAMPLE_INPUT_FORMAT_ENUM_DESCRIPTION, false),
 
         AMFPropertyInfoEnum(AMF_AMBISONIC2SRENDERER_MODE,                       L"Mode", AMF_AMBISONIC2SRENDERER_MODE_HRTF_MIT1, AMF_AMBISONIC2SRENDERER_MODE_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoEnum(AMF_AMBISONIC2SRENDERER_CONVOLUTION,                L"Convolution", AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN, AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM_DESCRIPTION, false),
 
         AMFPropertyInfoInt64(AMF_AMBISONIC2SRENDERER_W,                         L"w channel", 0, 0, 3, true),
         AMFPropertyInfoInt64(AMF_AMBISONIC2SRENDERER_X,                         L"x channel", 1, 0, 3, true),
@@ -536,6 +656,9 @@ AMF_RESULT AMF_STD_CALL  AMFAmbisonic2SRendererImpl::Init(AMF_SURFACE_FORMAT /*f
     amf_int64 mode;
     GetProperty(AMF_AMBISONIC2SRENDERER_MODE, &mode);
     m_eMode = (AMF_AMBISONIC2SRENDERER_MODE_ENUM)mode;
+    amf_int64 convolutionMethod;
+    GetProperty(AMF_AMBISONIC2SRENDERER_CONVOLUTION, &convolutionMethod);
+    m_eConvolution = (AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM)convolutionMethod;
     GetProperty(AMF_AMBISONIC2SRENDERER_X, &m_xIndex);
     GetProperty(AMF_AMBISONIC2SRENDERER_Y, &m_yIndex);
     GetProperty(AMF_AMBISONIC2SRENDERER_Z, &m_zIndex);
@@ -560,7 +683,7 @@ AMF_RESULT AMF_STD_CALL  AMFAmbisonic2SRendererImpl::Init(AMF_SURFACE_FORMAT /*f
     if (pslash){
         *pslash = '\0';
     }
-    m_ambi2S = new Ambi2Stereo(m_eMode, inSampleRate);
+    m_ambi2S = new Ambi2Stereo(m_eMode, m_eConvolution, inSampleRate);
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -710,7 +833,7 @@ AMF_RESULT AMF_STD_CALL  AMFAmbisonic2SRendererImpl::QueryOutput(AMFData** ppDat
     //allocated enough space to hold float type of input data
     amf_size new_size       = (amf_size) (iSamplesIn * m_inChannels * sizeof(float));
     new_size = ((((amf_size)new_size) + (64 - 1)) & ~(64 - 1));
-    m_InternmediateData.SetSize(new_size);
+    m_InternmediateData.SetSizeUninitialized(new_size); // fully written by the conversion below
 
     float *pInputAsFLTP = (float *) m_InternmediateData.GetData(); 
 
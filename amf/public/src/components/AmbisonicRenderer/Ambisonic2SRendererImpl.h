@@ -28,6 +28,7 @@
 #include "public/common/ByteArray.h"
 
 #include "convolution.h"
+#include "fftConvolution.h"
 
 #include <stdio.h>
 #include <memory.h>
@@ -56,12 +57,14 @@ namespace amf
         amf_int64    inSampleRate;
         unsigned int responseLength;
         AMF_AMBISONIC2SRENDERER_MODE_ENUM method;
+        AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM convolutionMethod;
         float *theta, *phi;
         float prevHeadTheta, prevHeadPhi;
 
         void getResponses(float theta, float phi,
             int channel,
             float *Wresponse, float *Xresponse, float *Yresponse, float *Zresponse);
+        void getSpeakerGains(float thetaHead, float phiHead, int n, float *X0, float *Y0, float *Z0);
 
         unsigned int bufSize;
         float *OutData[8];
@@ -70,8 +73,21 @@ namespace amf
 
         convolution *m_convolution;
 
+        // partitioned FFT path: virtual speaker HRTF spectra per ear are computed once,
+        // the eight W/X/Y/Z responses are mixed from them in the frequency domain
+        void loadResponseSpectra();
+        void updateResponseSpectra(float thetaHead, float phiHead);
+
+        fftConvolution *m_fftConvolution;
+        float *SpeakerSpectrumRe[2][MAX_SPEAKERS];
+        float *SpeakerSpectrumIm[2][MAX_SPEAKERS];
+        float *ResponseSpectrumRe[8];
+        float *ResponseSpectrumIm[8];
+        float spectraTheta, spectraPhi;
+        bool spectraValid;
+
     public:
-        Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM  method, amf_int64 inSampleRate);
+        Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM  method, AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM convolutionMethod, amf_int64 inSampleRate);
         ~Ambi2Stereo();
 
         void process(float theta, float phi, int nSamples, float *W, float *X, float *Y, float *Z, float *left, float *right);
@@ -137,6 +153,7 @@ namespace amf
         amf_int64                           m_inChannels;
 
         AMF_AMBISONIC2SRENDERER_MODE_ENUM   m_eMode;
+        AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM m_eConvolution;
 
         amf_int64                           m_wIndex;
         amf_int64                           m_xIndex;
@@ -0,0 +1,335 @@
+//
+// Copyright (c) 2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// CPU implementation
+#include "public/include/core/Platform.h"
+#include <memory.h>
+#include <math.h>
+#include "fftConvolution.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FFT_CONVOLUTION_SSE2 1
+#endif
+
+#define PI 3.1415926535897932384626433
+
+namespace
+{
+    // acc += a * b over n split complex values, n is a multiple of 4
+    void complexMultiplyAccumulate(float *accRe, float *accIm, const float *aRe, const float *aIm,
+        const float *bRe, const float *bIm, int n)
+    {
+        int i = 0;
+#if defined(FFT_CONVOLUTION_SSE2)
+        for (; i < n; i += 4){
+            __m128 ar = _mm_loadu_ps(aRe + i);
+            __m128 ai = _mm_loadu_ps(aIm + i);
+            __m128 br = _mm_loadu_ps(bRe + i);
+            __m128 bi = _mm_loadu_ps(bIm + i);
+            __m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+            __m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+            _mm_storeu_ps(accRe + i, _mm_add_ps(_mm_loadu_ps(accRe + i), re));
+            _mm_storeu_ps(accIm + i, _mm_add_ps(_mm_loadu_ps(accIm + i), im));
+        }
+#endif
+        for (; i < n; i++){
+            accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+            accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+        }
+    }
+}
+
+fftConvolution::fftConvolution(int nInputs, int nOutputs, int blockSize, int responseLength){
+    m_nInputs = nInputs;
+    m_nOutputs = nOutputs;
+    m_ResponseLength = responseLength;
+    m_BlockSize = blockSize;
+    m_nPartitions = (responseLength + blockSize - 1) / blockSize;
+    m_BinStride = (blockSize + 1 + 3) & ~3;
+
+    m_BitReverse = NULL;
+    m_TwiddleRe = NULL;
+    m_TwiddleIm = NULL;
+    m_RealTwiddleRe = NULL;
+    m_RealTwiddleIm = NULL;
+    m_InputHistory = NULL;
+    m_DelayLineRe = NULL;
+    m_DelayLineIm = NULL;
+    m_DelayLinePos = 0;
+    m_AccRe = NULL;
+    m_AccIm = NULL;
+    m_Time = NULL;
+}
+
+bool fftConvolution::init(){
+    // the complex FFT works on blockSize points and needs a power of two
+    if (m_BlockSize < 4 || (m_BlockSize & (m_BlockSize - 1)) != 0 || m_nPartitions <= 0){
+        return false;
+    }
+    const int n = m_BlockSize;
+
+    m_BitReverse = new int[n];
+    int bits = 0;
+    while ((1 << bits) < n){
+        bits++;
+    }
+    for (int i = 0; i < n; i++){
+        int r = 0;
+        for (int b = 0; b < bits; b++){
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_BitReverse[i] = r;
+    }
+
+    m_TwiddleRe = new float[n];
+    m_TwiddleIm = new float[n];
+    for (int half = 1; half < n; half <<= 1){
+        for (int j = 0; j < half; j++){
+            m_TwiddleRe[half - 1 + j] = (float)cos(-PI * j / half);
+            m_TwiddleIm[half - 1 + j] = (float)sin(-PI * j / half);
+        }
+    }
+
+    m_RealTwiddleRe = new float[n + 1];
+    m_RealTwiddleIm = new float[n + 1];
+    for (int k = 0; k <= n; k++){
+        m_RealTwiddleRe[k] = (float)cos(-PI * k / n);
+        m_RealTwiddleIm[k] = (float)sin(-PI * k / n);
+    }
+
+    const int spectrumLength = getSpectrumLength();
+    m_InputHistory = new float*[m_nInputs];
+    m_DelayLineRe = new float*[m_nInputs];
+    m_DelayLineIm = new float*[m_nInputs];
+    for (int i = 0; i < m_nInputs; i++){
+        m_InputHistory[i] = new float[2 * n];
+        m_DelayLineRe[i] = new float[spectrumLength];
+        m_DelayLineIm[i] = new float[spectrumLength];
+    }
+    m_AccRe = new float[m_BinStride];
+    m_AccIm = new float[m_BinStride];
+    m_Time = new float[2 * n];
+
+    reset();
+    return true;
+}
+
+fftConvolution::~fftConvolution(){
+    delete[] m_BitReverse;
+    delete[] m_TwiddleRe;
+    delete[] m_TwiddleIm;
+    delete[] m_RealTwiddleRe;
+    delete[] m_RealTwiddleIm;
+    if (m_InputHistory != NULL){
+        for (int i = 0; i < m_nInputs; i++){
+            delete[] m_InputHistory[i];
+            delete[] m_DelayLineRe[i];
+            delete[] m_DelayLineIm[i];
+        }
+        delete[] m_InputHistory;
+        delete[] m_DelayLineRe;
+        delete[] m_DelayLineIm;
+    }
+    delete[] m_AccRe;
+    delete[] m_AccIm;
+    delete[] m_Time;
+}
+
+void fftConvolution::reset(){
+    const int spectrumLength = getSpectrumLength();
+    for (int i = 0; i < m_nInputs; i++){
+        memset(m_InputHistory[i], 0, 2 * m_BlockSize * sizeof(float));
+        memset(m_DelayLineRe[i], 0, spectrumLength * sizeof(float));
+        memset(m_DelayLineIm[i], 0, spectrumLength * sizeof(float));
+    }
+    m_DelayLinePos = 0;
+}
+
+// in-place forward FFT of m_BlockSize split complex points
+void fftConvolution::fft(float *re, float *im){
+    const int n = m_BlockSize;
+    for (int i = 0; i < n; i++){
+        int r = m_BitReverse[i];
+        if (r > i){
+            float t = re[i]; re[i] = re[r]; re[r] = t;
+            t = im[i]; im[i] = im[r]; im[r] = t;
+        }
+    }
+    for (int half = 1; half < n; half <<= 1){
+        const float *wRe = m_TwiddleRe + half - 1;
+        const float *wIm = m_TwiddleIm + half - 1;
+        for (int start = 0; start < n; start += 2 * half){
+            float *uRe = re + start;
+            float *uIm = im + start;
+            float *vRe = uRe + half;
+            float *vIm = uIm + half;
+            int j = 0;
+#if defined(FFT_CONVOLUTION_SSE2)
+            for (; j + 4 <= half; j += 4){
+                __m128 wr = _mm_loadu_ps(wRe + j);
+                __m128 wi = _mm_loadu_ps(wIm + j);
+                __m128 xr = _mm_loadu_ps(vRe + j);
+                __m128 xi = _mm_loadu_ps(vIm + j);
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                __m128 ur = _mm_loadu_ps(uRe + j);
+                __m128 ui = _mm_loadu_ps(uIm + j);
+                _mm_storeu_ps(uRe + j, _mm_add_ps(ur, tr));
+                _mm_storeu_ps(uIm + j, _mm_add_ps(ui, ti));
+                _mm_storeu_ps(vRe + j, _mm_sub_ps(ur, tr));
+                _mm_storeu_ps(vIm + j, _mm_sub_ps(ui, ti));
+            }
+#endif
+            for (; j < half; j++){
+                float tr = vRe[j] * wRe[j] - vIm[j] * wIm[j];
+                float ti = vRe[j] * wIm[j] + vIm[j] * wRe[j];
+                vRe[j] = uRe[j] - tr;
+                vIm[j] = uIm[j] - ti;
+                uRe[j] += tr;
+                uIm[j] += ti;
+            }
+        }
+    }
+}
+
+// 2 * m_BlockSize real samples -> m_BlockSize + 1 bins, computed as a half size complex FFT
+void fftConvolution::forwardReal(const float *x, float *re, float *im){
+    const int n = m_BlockSize;
+    for (int m = 0; m < n; m++){
+        re[m] = x[2 * m];
+        im[m] = x[2 * m + 1];
+    }
+    fft(re, im);
+
+    // X[k] = E[k] + W^k * O[k], with E and O recovered from Z[k] and conj(Z[n - k])
+    re[n] = re[0];
+    im[n] = im[0];
+    for (int k = 0; k <= n / 2; k++){
+        const float zr = re[k], zi = im[k];
+        const float cr = re[n - k], ci = -im[n - k];
+        const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+        const float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+        const float wr = m_RealTwiddleRe[k], wi = m_RealTwiddleIm[k];
+        const float tr = or_ * wr - oi * wi, ti = or_ * wi + oi * wr;
+        re[k] = er + tr;
+        im[k] = ei + ti;
+        // the mirrored bin uses conj(E) and -conj(W^k) * conj(O)
+        re[n - k] = er - tr;
+        im[n - k] = -(ei - ti);
+    }
+    for (int k = n + 1; k < m_BinStride; k++){
+        re[k] = 0.0f;
+        im[k] = 0.0f;
+    }
+}
+
+// inverse of forwardReal including the 1 / (2 * m_BlockSize) scale; re and im are destroyed
+void fftConvolution::inverseReal(float *re, float *im, float *x){
+    const int n = m_BlockSize;
+    for (int k = 0; k <= n / 2; k++){
+        const float xr = re[k], xi = im[k];
+        const float cr = re[n - k], ci = -im[n - k];
+        const float er = 0.5f * (xr + cr), ei = 0.5f * (xi + ci);
+        // O[k] = (X[k] - conj(X[n - k])) / (2 * W^k), 1 / W^k = conj(W^k)
+        const float dr = 0.5f * (xr - cr), di = 0.5f * (xi - ci);
+        const float wr = m_RealTwiddleRe[k], wi = -m_RealTwiddleIm[k];
+        const float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+        // Z[k] = E[k] + i * O[k], conjugated for the inverse transform
+        const float zr = er - oi, zi = ei + or_;
+        // the same for n - k: E' = conj(E), O' = conj(O)
+        const float zr2 = er + oi, zi2 = -ei + or_;
+        re[k] = zr;
+        im[k] = -zi;
+        re[n - k] = zr2;
+        im[n - k] = -zi2;
+    }
+    fft(re, im);
+    const float scale = 1.0f / n;
+    for (int m = 0; m < n; m++){
+        x[2 * m] = re[m] * scale;
+        x[2 * m + 1] = -im[m] * scale;
+    }
+}
+
+void fftConvolution::transformResponse(const float *resp, int length, float *re, float *im){
+    const int n = m_BlockSize;
+    if (length > m_ResponseLength){
+        length = m_ResponseLength;
+    }
+    for (int p = 0; p < m_nPartitions; p++){
+        memset(m_Time, 0, 2 * n * sizeof(float));
+        const int first = p * n;
+        const int count = length - first < n ? length - first : n;
+        if (count > 0){
+            memcpy(m_Time, resp + first, count * sizeof(float));
+        }
+        forwardReal(m_Time, re + p * m_BinStride, im + p * m_BinStride);
+    }
+}
+
+void fftConvolution::accumulateSpectrum(float *dstRe, float *dstIm, const float *srcRe, const float *srcIm, float gain){
+    const int length = getSpectrumLength();
+    int i = 0;
+#if defined(FFT_CONVOLUTION_SSE2)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i < length; i += 4){
+        _mm_storeu_ps(dstRe + i, _mm_add_ps(_mm_loadu_ps(dstRe + i), _mm_mul_ps(g, _mm_loadu_ps(srcRe + i))));
+        _mm_storeu_ps(dstIm + i, _mm_add_ps(_mm_loadu_ps(dstIm + i), _mm_mul_ps(g, _mm_loadu_ps(srcIm + i))));
+    }
+#endif
+    for (; i < length; i++){
+        dstRe[i] += gain * srcRe[i];
+        dstIm[i] += gain * srcIm[i];
+    }
+}
+
+void fftConvolution::process(float **in, float **respRe, float **respIm, float **out){
+    const int n = m_BlockSize;
+
+    // overlap-save: transform the last two blocks of every input into the frequency domain delay line
+    for (int i = 0; i < m_nInputs; i++){
+        float *hist = m_InputHistory[i];
+        memcpy(hist, hist + n, n * sizeof(float));
+        memcpy(hist + n, in[i], n * sizeof(float));
+        forwardReal(hist, m_DelayLineRe[i] + m_DelayLinePos * m_BinStride, m_DelayLineIm[i] + m_DelayLinePos * m_BinStride);
+    }
+
+    for (int o = 0; o < m_nOutputs; o++){
+        memset(m_AccRe, 0, m_BinStride * sizeof(float));
+        memset(m_AccIm, 0, m_BinStride * sizeof(float));
+        for (int i = 0; i < m_nInputs; i++){
+            const float *hRe = respRe[o * m_nInputs + i];
+            const float *hIm = respIm[o * m_nInputs + i];
+            int slot = m_DelayLinePos;
+            for (int p = 0; p < m_nPartitions; p++){
+                complexMultiplyAccumulate(m_AccRe, m_AccIm,
+                    m_DelayLineRe[i] + slot * m_BinStride, m_DelayLineIm[i] + slot * m_BinStride,
+                    hRe + p * m_BinStride, hIm + p * m_BinStride, m_BinStride);
+                slot = slot == 0 ? m_nPartitions - 1 : slot - 1;
+            }
+        }
+        inverseReal(m_AccRe, m_AccIm, m_Time);
+        // the first half is circular wrap-around, the second half is the linear convolution
+        memcpy(out[o], m_Time + n, n * sizeof(float));
+    }
+    m_DelayLinePos = (m_DelayLinePos + 1) % m_nPartitions;
+}
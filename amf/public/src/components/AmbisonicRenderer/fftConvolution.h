@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once 
+
+// Uniformly partitioned overlap-save convolution.
+// A response is cut into blockSize partitions whose spectra are computed once by transformResponse();
+// each process() call then costs one forward FFT per input, one inverse FFT per output and a complex
+// multiply-accumulate per partition, instead of blockSize * responseLength multiplies.
+class fftConvolution
+{
+public:
+    fftConvolution(int nInputs, int nOutputs, int blockSize, int responseLength);
+    ~fftConvolution();
+    bool init();
+    void reset();
+
+    int getBlockSize() const { return m_BlockSize; }
+    // floats in each of the re / im arrays of a partitioned spectrum
+    int getSpectrumLength() const { return m_nPartitions * m_BinStride; }
+
+    void transformResponse(const float *resp, int length, float *re, float *im);
+    // dst += gain * src, for spectra produced by transformResponse()
+    void accumulateSpectrum(float *dstRe, float *dstIm, const float *srcRe, const float *srcIm, float gain);
+
+    // filters one block of blockSize samples per input:
+    // out[o] = sum of in[i] convolved with the response at respRe/respIm[o * nInputs + i]
+    void process(float **in, float **respRe, float **respIm, float **out);
+
+private:
+    void fft(float *re, float *im);
+    void forwardReal(const float *x, float *re, float *im);
+    void inverseReal(float *re, float *im, float *x);
+
+    int m_nInputs;
+    int m_nOutputs;
+    int m_ResponseLength;
+    int m_BlockSize;        // partition size and hop, FFT size is twice this
+    int m_nPartitions;
+    int m_BinStride;        // blockSize + 1 bins, padded for SIMD
+
+    int *m_BitReverse;      // complex FFT of blockSize points
+    float *m_TwiddleRe;     // per stage, stage with half size h starts at h - 1
+    float *m_TwiddleIm;
+    float *m_RealTwiddleRe; // e^-i*pi*k/blockSize for the real split
+    float *m_RealTwiddleIm;
+
+    float **m_InputHistory; // previous and current block per input
+    float **m_DelayLineRe;  // input spectra of the last nPartitions blocks per input
+    float **m_DelayLineIm;
+    int m_DelayLinePos;
+
+    float *m_AccRe;
+    float *m_AccIm;
+    float *m_Time;
+
+    fftConvolution(const fftConvolution&);
+    fftConvolution& operator=(const fftConvolution&);
+};
@@ -33,6 +33,7 @@
 
 #include "AudioConverterFFMPEGImpl.h"
 #include "UtilsFFMPEG.h"
+#include "AudioSampleKernels.h"
 
 #include "public/include/core/Context.h"
 #include "public/include/core/Trace.h"
@@ -76,8 +77,7 @@ const AMFEnumDescriptionEntry AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION[] =
 AMFAudioConverterFFMPEGImpl::AMFAudioConverterFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_pResampler(NULL),
-    m_pTempBuffer(NULL),
-    m_uiTempBufferSize(0),
+    m_bDirectConvert(false),
     m_inSampleFormat(AMFAF_UNKNOWN),
     m_outSampleFormat(AMFAF_UNKNOWN),
     m_inSampleRate(0),
@@ -146,7 +146,12 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*
     GetProperty(AUDIO_CONVERTER_OUT_AUDIO_CHANNELS, &m_outChannels);
     m_outSampleFormat = (AMF_AUDIO_FORMAT)outSampleFormat;
 
-    if ((m_outSampleFormat != m_inSampleFormat) || (m_outSampleRate != m_inSampleRate) || (m_outChannels != m_inChannels))
+    if ((m_outSampleRate == m_inSampleRate) && (m_outChannels == m_inChannels) && (m_outSampleFormat != m_inSampleFormat) &&
+        IsDirectConvertFormat(m_inSampleFormat) && IsDirectConvertFormat(m_outSampleFormat))
+    {
+        m_bDirectConvert = true;
+    }
+    else if ((m_outSampleFormat != m_inSampleFormat) || (m_outSampleRate != m_inSampleRate) || (m_outChannels != m_inChannels))
     {
 
         m_pResampler = avresample_alloc_context();
@@ -200,16 +205,10 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::Terminate()
         m_pResampler = NULL;
     }
 
-    if (m_pTempBuffer != NULL)
-    {
-        free(m_pTempBuffer);
-        m_pTempBuffer = NULL;
-    }
-
     m_audioFrameSubmitCount = 0;
     m_audioFrameQueryCount = 0;
 
-    m_uiTempBufferSize = 0;
+    m_bDirectConvert = false;
     m_bEof = false;
 
     return AMF_OK;
@@ -270,11 +269,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::SubmitInput(AMFData* pData
 
         m_audioFrameSubmitCount++;
 
-        // just pass through
-        if (m_pResampler == NULL) 
-        {
-            return AMF_OK;
-        }
     }
                 
     return AMF_OK;
@@ -301,7 +295,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
         return AMF_REPEAT;
     }
 
-    // just pass through
+    // just pass through or convert without the resampler
     if (m_pResampler == NULL) 
     {
         if (m_pInputData == NULL)
@@ -311,8 +305,28 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
             return AMF_EOF;
         }
 
-        *ppData = m_pInputData;
-        (*ppData)->Acquire();
+        if (m_bDirectConvert)
+        {
+            const amf_int32 iSamples = m_pInputData->GetSampleCount();
+            AMFAudioBufferPtr pOutputAudioBuffer;
+            AMF_RESULT err = m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_outSampleFormat,
+                                             iSamples, (amf_int32) m_outSampleRate, (amf_int32) m_outChannels, &pOutputAudioBuffer);
+            AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocAudioBuffer failed");
+
+            ConvertDirect(static_cast<const amf_uint8*>(m_pInputData->GetNative()), static_cast<amf_uint8*>(pOutputAudioBuffer->GetNative()), iSamples);
+
+            CopyInputProperties(pOutputAudioBuffer);
+            pOutputAudioBuffer->SetPts(m_pInputData->GetPts());
+            pOutputAudioBuffer->SetDuration(m_pInputData->GetDuration());
+            m_ptsNext = pOutputAudioBuffer->GetPts() + pOutputAudioBuffer->GetDuration();
+
+            *ppData = pOutputAudioBuffer.Detach();
+        }
+        else
+        {
+            *ppData = m_pInputData;
+            (*ppData)->Acquire();
+        }
         m_pInputData.Release();
         m_audioFrameQueryCount++;
 
@@ -332,79 +346,38 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
         pMemIn   = static_cast<uint8_t*>(m_pInputData->GetNative());
     }
 
-    amf_int64 iSamplesOut    = 0;
-    if (NULL != m_pResampler)
-    {
-        iSamplesOut = avresample_get_out_samples(m_pResampler, (int)iSamplesIn);
-    }
-    else
-    {
-        iSamplesOut = iSamplesIn;
-    }
-
-    //if there are no more samples, we have drained
-    if (iSamplesOut == 0 && m_bEof == true)
-    {
-        m_bEof = false;
-        m_bDrained = true;
-        return AMF_OK;
-    }
-
-    amf_int64 new_size       = (amf_int64) iSamplesOut * m_outChannels * iSampleSizeOut;
-    if (m_uiTempBufferSize < (amf_uint) new_size)
-    {
-        m_uiTempBufferSize = ((((amf_size)new_size) + (64 - 1)) & ~(64 - 1));
-        m_pTempBuffer = (short *) realloc(m_pTempBuffer, m_uiTempBufferSize);
-    }
-    AMF_RETURN_IF_FALSE(m_pTempBuffer != NULL, AMF_OUT_OF_MEMORY, L"QueryOutput() - No memory m_uiTempBufferSize = %" LPRId64 L"", (amf_int64)m_uiTempBufferSize);
-
-    uint8_t *ibuf[12] = { pMemIn };
-    uint8_t *obuf[12] = { (uint8_t*) m_pTempBuffer };
-
-    int istride[12] = { iSampleSizeIn };
-    int ostride[12] = { iSampleSizeOut };
-
-
+    uint8_t *ibuf[AVRESAMPLE_MAX_CHANNELS] = { pMemIn };
     if (IsAudioPlanar(m_inSampleFormat) && pMemIn != NULL)
     {
-        for (amf_int32 ch = 0; ch < m_inChannels; ch++)
+        for (amf_int32 ch = 0; ch < m_inChannels && ch < AVRESAMPLE_MAX_CHANNELS; ch++)
         {
             ibuf[ch] = (amf_uint8*) pMemIn + ch * (iSampleSizeIn * iSamplesIn);
-            istride[ch] = iSampleSizeIn;
         }
     }
-    if (IsAudioPlanar(m_outSampleFormat))
-    {
-        for (amf_int32 ch = 0; ch < m_outChannels; ch++)
-        {
-            obuf[ch] = (amf_uint8*) m_pTempBuffer + ch * (iSampleSizeOut * iSamplesOut);
-            ostride[ch] = iSampleSizeOut;
-        }
+
+    // with no output the resampler keeps everything in its FIFO, so the exact
+    // number of ready samples is known before the output buffer is allocated
+    // and avresample_read() can write straight into it.
+    // NULL input flushes the samples held back by the resampler.
+    const int queued = avresample_convert(m_pResampler, NULL, 0, 0,
+                                    pMemIn != NULL ? ibuf : NULL, (int) (iSampleSizeIn * iSamplesIn), (int) iSamplesIn);
+    AMF_RETURN_IF_FALSE(queued >= 0, AMF_FAIL, L"QueryOutput() - avresample_convert failed");
+
+    if(pMemIn != NULL)
+    { 
+        m_bDrained = false;
     }
-    if (m_pResampler != NULL)
+    else
     {
-        int  writtenSamples = avresample_convert(m_pResampler,
-                                        obuf, (int) (iSampleSizeOut * iSamplesOut), (int) iSamplesOut,
-                                        pMemIn != NULL ? ibuf : NULL, (int) (iSampleSizeIn * iSamplesIn), (int) iSamplesIn);
-
-        if(pMemIn != NULL)
-        { 
-            if (writtenSamples == 0)
-            {
-                return AMF_FAIL;
-            }
-            m_bDrained = false;
-        }
-        else
-        {
-            m_bEof = false;
-            m_bDrained = true;
-        }
-        iSamplesOut = writtenSamples;
+        m_bEof = false;
+        m_bDrained = true;
     }
-    if(iSamplesOut == 0)
+
+    const int iSamplesOut = avresample_available(m_pResampler);
+    if(iSamplesOut <= 0)
     { 
-        if(m_bEof)
+        m_pInputData.Release();
+        if(m_bDrained)
         {
             return AMF_EOF;
         }
@@ -414,26 +387,25 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
     // allocate output buffer
     AMFAudioBufferPtr pOutputAudioBuffer;
     AMF_RESULT  err = m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_outSampleFormat, 
-                                     (amf_int32) iSamplesOut, (amf_int32) m_outSampleRate, (amf_int32) m_outChannels, &pOutputAudioBuffer);
+                                     iSamplesOut, (amf_int32) m_outSampleRate, (amf_int32) m_outChannels, &pOutputAudioBuffer);
     AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocAudioBuffer failed");
 
-
     amf_uint8* pMemOut = static_cast<amf_uint8*>(pOutputAudioBuffer->GetNative());
+    uint8_t *obuf[AVRESAMPLE_MAX_CHANNELS] = { pMemOut };
     if (IsAudioPlanar(m_outSampleFormat))
     {
-        for (amf_int32 ch = 0; ch < m_outChannels; ch++)
+        for (amf_int32 ch = 0; ch < m_outChannels && ch < AVRESAMPLE_MAX_CHANNELS; ch++)
         {
-            memcpy(pMemOut + ch * (iSamplesOut * iSampleSizeOut), obuf[ch], (size_t)(iSamplesOut * iSampleSizeOut));
+            obuf[ch] = pMemOut + ch * (iSampleSizeOut * iSamplesOut);
         }
     }
-    else
-    { 
-        memcpy(pMemOut, m_pTempBuffer, (size_t)(iSamplesOut * m_outChannels * iSampleSizeOut));
-    }
+    const int readSamples = avresample_read(m_pResampler, obuf, iSamplesOut);
+    AMF_RETURN_IF_FALSE(readSamples == iSamplesOut, AMF_FAIL, L"QueryOutput() - avresample_read returned %d of %d samples", readSamples, iSamplesOut);
+
     if(m_pInputData != NULL)
     { 
+        CopyInputProperties(pOutputAudioBuffer);
         pOutputAudioBuffer->SetPts(m_pInputData->GetPts());
-        m_pInputData->CopyTo(pOutputAudioBuffer, false);
     }
     else
     {
@@ -451,6 +423,81 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+bool AMFAudioConverterFFMPEGImpl::IsDirectConvertFormat(AMF_AUDIO_FORMAT format)
+{
+    return format == AMFAF_S16 || format == AMFAF_S16P || format == AMFAF_FLT || format == AMFAF_FLTP;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioConverterFFMPEGImpl::ConvertDirect(const amf_uint8* pSrc, amf_uint8* pDst, amf_int32 samples)
+{
+    const AMFAudioSampleKernels& kernels = GetAudioSampleKernels();
+    const bool      bInFloat    = m_inSampleFormat == AMFAF_FLT || m_inSampleFormat == AMFAF_FLTP;
+    const bool      bOutFloat   = m_outSampleFormat == AMFAF_FLT || m_outSampleFormat == AMFAF_FLTP;
+    const bool      bInPlanar   = IsAudioPlanar(m_inSampleFormat);
+    const bool      bOutPlanar  = IsAudioPlanar(m_outSampleFormat);
+    const amf_int32 inSize      = GetAudioSampleSize(m_inSampleFormat);
+    const amf_int32 outSize     = GetAudioSampleSize(m_outSampleFormat);
+    const amf_int32 channels    = (amf_int32)m_inChannels;
+
+    // converts count contiguous samples, a plain copy when only the layout changes
+    struct Local
+    {
+        static void Convert(const AMFAudioSampleKernels& k, bool bInFloat, bool bOutFloat, void* pOut, const void* pIn, amf_size count, amf_int32 size)
+        {
+            if (bInFloat == bOutFloat)
+            {
+                memcpy(pOut, pIn, count * size);
+            }
+            else if (bOutFloat)
+            {
+                k.S16ToFLT(static_cast<float*>(pOut), static_cast<const amf_int16*>(pIn), count);
+            }
+            else
+            {
+                k.FLTToS16(static_cast<amf_int16*>(pOut), static_cast<const float*>(pIn), count);
+            }
+        }
+    };
+
+    if (bInPlanar == bOutPlanar)
+    {
+        Local::Convert(kernels, bInFloat, bOutFloat, pDst, pSrc, (amf_size)samples * channels, inSize);
+        return;
+    }
+
+    // layout changes: work through the channels in blocks small enough to stay in L1
+    static const amf_int32 BLOCK = 512;
+    amf_uint32 temp[BLOCK];
+    for (amf_int32 start = 0; start < samples; start += BLOCK)
+    {
+        const amf_int32 count = AMF_MIN(BLOCK, samples - start);
+        for (amf_int32 ch = 0; ch < channels; ch++)
+        {
+            if (bOutPlanar)
+            {
+                amf_uint8* pOut = pDst + ((amf_size)ch * samples + start) * outSize;
+                DeinterleaveChannel(temp, pSrc + (amf_size)start * channels * inSize, channels, ch, count, inSize);
+                Local::Convert(kernels, bInFloat, bOutFloat, pOut, temp, count, inSize);
+            }
+            else
+            {
+                const amf_uint8* pIn = pSrc + ((amf_size)ch * samples + start) * inSize;
+                Local::Convert(kernels, bInFloat, bOutFloat, temp, pIn, count, inSize);
+                InterleaveChannel(pDst + (amf_size)start * channels * outSize, temp, channels, ch, count, outSize);
+            }
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioConverterFFMPEGImpl::CopyInputProperties(AMFAudioBuffer* pOutput)
+{
+    // most buffers carry no properties - skip the copy and the Clear() that CopyTo() does
+    if (m_pInputData->GetPropertyCount() > 0)
+    {
+        m_pInputData->AddTo(pOutput, true, false);
+    }
+}
+//-------------------------------------------------------------------------------------------------
 void AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::OnPropertyChanged(const wchar_t* pName)
 {
     AMFLock lock(&m_sync);
@@ -94,6 +94,10 @@ namespace amf
         virtual void        AMF_STD_CALL  OnPropertyChanged(const wchar_t* pName);
 
     private:
+        static bool              IsDirectConvertFormat(AMF_AUDIO_FORMAT format);
+        void                     ConvertDirect(const amf_uint8* pSrc, amf_uint8* pDst, amf_int32 samples);
+        void                     CopyInputProperties(AMFAudioBuffer* pOutput);
+
       mutable AMFCriticalSection  m_sync;
 
         AMFContextPtr            m_pContext;
@@ -103,8 +107,8 @@ namespace amf
 
         AMFAudioBufferPtr        m_pInputData;
 
-        short*                   m_pTempBuffer;
-        amf_size                 m_uiTempBufferSize;
+        // same rate and channel count, only the sample type or layout differs
+        bool                     m_bDirectConvert;
 
         // cache property values and update them on 
         // OnPropertyChanged so we don't have to get
@@ -78,7 +78,9 @@ AMFAudioDecoderFFMPEGImpl::AMFAudioDecoderFFMPEGImpl(AMFContext* pContext)
     m_bForceEof(false),
     m_pCodecContext(NULL),
     m_SeekPts(0),
-    m_iLastDataOffset(0),
+    m_bDrainSent(false),
+    m_iPacketIndex(0),
+    m_iLastPacketIndex(-1),
     m_ptsLastDataOffset(0),
     m_audioFrameSubmitCount(0),
     m_audioFrameQueryCount(0)
@@ -263,9 +265,11 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::Terminate()
 {
     AMFLock lock(&m_sync);
 
-    // clear the internally stored buffer
-    m_pInputData = nullptr;
-    m_pLastInputData = nullptr;
+    // drop the packets still in flight
+    m_InputBuffers.clear();
+    m_iPacketIndex = 0;
+    m_iLastPacketIndex = -1;
+    m_bDrainSent = false;
 
     // clean-up codec related items
     if (m_pCodecContext != NULL)
@@ -278,7 +282,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::Terminate()
         m_SeekPts = 0;
     }
     m_ptsLastDataOffset = 0;
-    m_iLastDataOffset = 0;
 
     m_audioFrameSubmitCount = 0;
     m_audioFrameQueryCount = 0;
@@ -300,9 +303,17 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::Flush()
 {
     AMFLock lock(&m_sync);
 
-    // clear the internally stored buffer
-    m_pInputData = nullptr;
-    m_pLastInputData = nullptr;
+    // discard the packets and frames the decoder holds, this also
+    // makes it accept input again after it was drained
+    if (m_pCodecContext != NULL)
+    {
+        avcodec_flush_buffers(m_pCodecContext);
+    }
+    m_InputBuffers.clear();
+    m_iLastPacketIndex = -1;
+    m_ptsLastDataOffset = 0;
+    m_bForceEof = false;
+    m_bDrainSent = false;
 
     return AMF_OK;
 }
@@ -315,34 +326,56 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::SubmitInput(AMFData* pData)
 
     AMFLock lock(&m_sync);
 
-    // if the buffer is already full, we can't set more data
-    if (m_pInputData && pData)
+    // a NULL input means end of stream, see Drain()
+    if (pData == NULL)
     {
-        return AMF_INPUT_FULL;
+        return AMF_EOF;
     }
+    AMFBufferPtr pInBuffer(pData);
+    AMF_RETURN_IF_FALSE(pInBuffer != NULL, AMF_INVALID_ARG, L"SubmitInput() - Input should be Buffer");
 
-    // if the internal buffer is empty and the in buffer is also empty,
-    // we reached the end of the available input...
-    if (!m_pInputData && !pData)
+    // no input is accepted after Drain() until Flush() or ReInit()
+    if (m_bForceEof)
     {
         return AMF_EOF;
     }
-
-    // if the internal buffer is empty and we got new data coming in
-    // update internal buffer with new information
-    if (!m_pInputData && pData)
+    // if decoding's been disabled, the packet is accepted and dropped
+    if (!m_bDecodingEnabled)
     {
-        m_ptsLastDataOffset = 0;
-        m_pInputData = AMFBufferPtr(pData);
-        AMF_RETURN_IF_FALSE(m_pInputData != 0, AMF_INVALID_ARG, L"SubmitInput() - Input should be Buffer");
+        return AMF_OK;
+    }
 
-        m_pLastInputData = AMFBufferPtr(pData);
+    AMF_RESULT err = pInBuffer->Convert(AMF_MEMORY_HOST);
+    AMF_RETURN_IF_FAILED(err, L"SubmitInput() - Convert(AMF_MEMORY_HOST) failed");
+    AMF_RETURN_IF_FALSE(pInBuffer->GetSize() != 0, AMF_INVALID_ARG, L"SubmitInput() - Invalid Param");
 
-        AMF_RESULT err = m_pInputData->Convert(AMF_MEMORY_HOST);
-        AMF_RETURN_IF_FAILED(err, L"SubmitInput() - Convert(AMF_MEMORY_HOST) failed");
-        m_audioFrameSubmitCount++;
+    AVPacket avpkt;
+    av_init_packet(&avpkt);
+    avpkt.data = static_cast<uint8_t*>(pInBuffer->GetNative());
+    avpkt.size = int(pInBuffer->GetSize());
+    ReadAVPacketInfo(pInBuffer, &avpkt);
+
+    m_pCodecContext->reordered_opaque = m_iPacketIndex;
+    int ret = avcodec_send_packet(m_pCodecContext, &avpkt);
+    if (ret == AVERROR(EAGAIN))
+    {
+        // frames are ready - they have to be queried before more input is accepted
+        return AMF_INPUT_FULL;
+    }
+    if (ret < 0)
+    {
+        // a damaged packet only costs its own samples
+        AMFTraceWarning(AMF_FACILITY, L"SubmitInput() - avcodec_send_packet() failed: %d", ret);
+        return AMF_OK;
     }
-                
+
+    m_InputBuffers[m_iPacketIndex++] = pInBuffer;
+    if (m_InputBuffers.size() > AUDIO_DECODER_MAX_PACKETS_IN_FLIGHT)
+    {
+        m_InputBuffers.erase(m_InputBuffers.begin());
+    }
+    m_audioFrameSubmitCount++;
+
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -364,132 +397,112 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
         return m_bForceEof ? AMF_EOF : AMF_OK;
     }
 
-    // if we requested to drain, see if we have any more packets
-    if (m_bForceEof && !m_pInputData)
-    {
-        return AMF_EOF;
-    }
-
-    // if the input buffer is empty, we need more data
-    if (!m_pInputData)
+    // once draining was requested, the decoder is told there is no more input
+    if (m_bForceEof && !m_bDrainSent)
     {
-        return AMF_REPEAT;
+        avcodec_send_packet(m_pCodecContext, NULL);
+        m_bDrainSent = true;
     }
 
+    AVFrame decoded_frame;
+    memset(&decoded_frame, 0, sizeof(AVFrame));
+    av_frame_unref(&decoded_frame);
+    AVFrameUnrefGuard frameGuard(&decoded_frame);
 
+    AMFBufferPtr pInBuffer;
+    amf_pts      AudioBufferPts = 0;
+    amf_pts      duration = 0;
+    for (;;)
+    {
+        int ret = avcodec_receive_frame(m_pCodecContext, &decoded_frame);
+        if (ret == AVERROR(EAGAIN))
+        {
+            // every frame that is ready has been returned, more input is needed
+            return AMF_REPEAT;
+        }
+        if (ret == AVERROR_EOF)
+        {
+            return AMF_EOF;
+        }
+        AMF_RETURN_IF_FALSE(ret >= 0, AMF_FAIL, L"QueryOutput() - avcodec_receive_frame() failed: %d", ret);
 
-    amf_pts       AudioBufferPts = m_pInputData->GetPts();
-    amf_size      uiMemSizeIn    = m_pInputData->GetSize() - m_iLastDataOffset;
-    AMF_RETURN_IF_FALSE(uiMemSizeIn != 0, AMF_INVALID_ARG, L"QueryOutput() - Invalid Param");
-
+        pInBuffer = FindInputBuffer(decoded_frame.reordered_opaque);
+        if (decoded_frame.reordered_opaque != m_iLastPacketIndex)
+        {
+            m_iLastPacketIndex = decoded_frame.reordered_opaque;
+            m_ptsLastDataOffset = 0;
+        }
+        if (pInBuffer != NULL)
+        {
+            AVPacket packetInfo;
+            av_init_packet(&packetInfo);
+            AudioBufferPts = ReadAVPacketInfo(pInBuffer, &packetInfo) ? GetPtsFromFFMPEG(pInBuffer, &decoded_frame) : pInBuffer->GetPts();
+        }
+        AudioBufferPts += m_ptsLastDataOffset;
+        duration = amf_pts(AMF_SECOND) * decoded_frame.nb_samples / m_pCodecContext->sample_rate;
+        m_ptsLastDataOffset += duration;
 
+        if (AudioBufferPts >= m_SeekPts && decoded_frame.nb_samples > 0)
+        {
+            break;
+        }
+        av_frame_unref(&decoded_frame);
+    }
 
-    // decode
-    AVPacket avpkt;
-    memset(&avpkt, 0, sizeof(AVPacket));
-    avpkt.size = int(uiMemSizeIn);
-    avpkt.data = static_cast<uint8_t*>(m_pInputData->GetNative()) + m_iLastDataOffset;
+    amf_int64  sampleFormat = AMFAF_UNKNOWN;
+    GetProperty(AUDIO_DECODER_IN_AUDIO_SAMPLE_FORMAT, &sampleFormat);
 
-    AVFrame decoded_frame;
-    memset(&decoded_frame, 0, sizeof(AVFrame));
-    av_frame_unref(&decoded_frame);
+    AMFAudioBufferPtr  pOutputAudioBuffer;
+    AMF_RESULT err = m_pContext->AllocAudioBuffer(
+        AMF_MEMORY_HOST,
+        (AMF_AUDIO_FORMAT) sampleFormat,
+        decoded_frame.nb_samples,
+        m_pCodecContext->sample_rate,
+        m_pCodecContext->channels,
+        &pOutputAudioBuffer);
 
-    int  iGotFrame = 0;
-    bool bAVPacketRead = ReadAVPacketInfo(m_pInputData, &avpkt);
-    int  ret           = avcodec_decode_audio4(m_pCodecContext, &decoded_frame, &iGotFrame, &avpkt);
+    AMF_RETURN_IF_FAILED(err, L"Process() - AllocAudioBuffer failed");
 
-    if (iGotFrame && bAVPacketRead)
-    {
-        AudioBufferPts = GetPtsFromFFMPEG(m_pInputData, &decoded_frame);
-    }
+    amf_uint8* pMemOut = static_cast<amf_uint8*>(pOutputAudioBuffer->GetNative());
 
-    AMF_RESULT  err = AMF_OK;
-    if (ret > 0 && ret < avpkt.size)
+    // copy data to output buffer
+    if (IsAudioPlanar((AMF_AUDIO_FORMAT) sampleFormat))
     {
-        m_iLastDataOffset += ret;
-        err = AMF_REPEAT;
+        const int        iPlaneSize     = GetAudioSampleSize((AMF_AUDIO_FORMAT) sampleFormat) * decoded_frame.nb_samples;
+        const amf_int64  outputChannels = m_pCodecContext->channels;
+        for (amf_int32 ch = 0; ch < outputChannels; ch++)
+        {
+            memcpy(pMemOut, decoded_frame.data[ch], iPlaneSize);
+            pMemOut += iPlaneSize;
+        }
     }
     else
     {
-        m_pInputData = NULL;
-        m_iLastDataOffset = 0;
+        memcpy(pMemOut, decoded_frame.data[0], pOutputAudioBuffer->GetSize());
     }
 
-    if (AudioBufferPts < m_SeekPts)
-    {
-        return m_bForceEof ? AMF_EOF : err;
-    }
+    pOutputAudioBuffer->SetPts(AudioBufferPts);
+    pOutputAudioBuffer->SetDuration(duration);
 
-    if (m_iLastDataOffset == 0)
+    if (pInBuffer != NULL)
     {
-        m_pInputData = NULL;
+        pInBuffer->CopyTo(pOutputAudioBuffer, false);
     }
 
-    if (ret < 0)
-    {
-        return m_bForceEof ? AMF_EOF : err;
-    }
+    *ppData = pOutputAudioBuffer;
+    (*ppData)->Acquire();
 
+    m_audioFrameQueryCount++;
 
-    if (iGotFrame && decoded_frame.nb_samples > 0)
+    bool debug = false;
+    GetProperty(AUDIO_DECODER_ENABLE_DEBUGGING, &debug);
+    if (debug)
     {
-        amf_int64  sampleFormat = AMFAF_UNKNOWN;
-        GetProperty(AUDIO_DECODER_IN_AUDIO_SAMPLE_FORMAT, &sampleFormat);
-
-        AMFAudioBufferPtr  pOutputAudioBuffer;
-        AMF_RESULT err1 = m_pContext->AllocAudioBuffer(
-            AMF_MEMORY_HOST,
-            (AMF_AUDIO_FORMAT) sampleFormat,
-            decoded_frame.nb_samples,
-            m_pCodecContext->sample_rate,
-            m_pCodecContext->channels,
-            &pOutputAudioBuffer);
-
-        AMF_RETURN_IF_FAILED(err1, L"Process() - AllocAudioBuffer failed");
-
-        amf_uint8* pMemOut = static_cast<amf_uint8*>(pOutputAudioBuffer->GetNative());
-
-        // copy data to output buffer
-        if (IsAudioPlanar((AMF_AUDIO_FORMAT) sampleFormat))
-        {
-            const int        iPlaneSize     = GetAudioSampleSize((AMF_AUDIO_FORMAT) sampleFormat) * decoded_frame.nb_samples;
-            const amf_int64  outputChannels = m_pCodecContext->channels;
-            for (amf_int32 ch = 0; ch < outputChannels; ch++)
-            {
-                memcpy(pMemOut, decoded_frame.data[ch], iPlaneSize);
-                pMemOut += iPlaneSize;
-            }
-        }
-        else
-        {
-            memcpy(pMemOut, decoded_frame.data[0], pOutputAudioBuffer->GetSize());
-        }
-
-        pOutputAudioBuffer->SetPts(AudioBufferPts + m_ptsLastDataOffset);
-        amf_pts tmpPts = (amf_pts(AMF_SECOND) * decoded_frame.nb_samples);
-        amf_pts duration = (tmpPts / m_pCodecContext->sample_rate);
-        pOutputAudioBuffer->SetDuration(duration);
-        m_ptsLastDataOffset += duration;
-
-        if (m_pLastInputData)
-        {
-            m_pLastInputData->CopyTo(pOutputAudioBuffer, false);
-        }
-
-        *ppData = pOutputAudioBuffer;
-        (*ppData)->Acquire();
-
-        m_audioFrameQueryCount++;
-
-        bool debug = false;
-        GetProperty(AUDIO_DECODER_ENABLE_DEBUGGING, &debug);
-        if (debug)
-        {
-            AMFTraceDebug(AMF_FACILITY, L"AMFAudioDecoderFFMPEG::Process() - output block pts=%.2f", (double)pOutputAudioBuffer->GetPts() / AMF_SECOND);
-        }
+        AMFTraceDebug(AMF_FACILITY, L"AMFAudioDecoderFFMPEG::Process() - output block pts=%.2f", (double)pOutputAudioBuffer->GetPts() / AMF_SECOND);
     }
 
-    return m_bForceEof ? AMF_EOF : err;
+    // while draining the caller keeps querying until the decoder reports AMF_EOF
+    return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
 void AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::OnPropertyChanged(const wchar_t* pName)
@@ -512,6 +525,11 @@ void AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::OnPropertyChanged(const wchar_t* p
             {
                 avcodec_flush_buffers(m_pCodecContext);
             }
+            m_InputBuffers.clear();
+            m_iLastPacketIndex = -1;
+            m_ptsLastDataOffset = 0;
+            m_bForceEof = false;
+            m_bDrainSent = false;
             m_SeekPts = seekPts;
         }
     }
@@ -551,6 +569,17 @@ bool AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::ReadAVPacketInfo(AMFBufferPtr pBuf
     return true;
 }
 //-------------------------------------------------------------------------------------------------
+AMFBufferPtr AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::FindInputBuffer(amf_int64 packetIndex)
+{
+    // audio frames come back in submission order, so older packets are done with
+    while (!m_InputBuffers.empty() && m_InputBuffers.begin()->first < packetIndex)
+    {
+        m_InputBuffers.erase(m_InputBuffers.begin());
+    }
+    InputBufferMap::iterator it = m_InputBuffers.find(packetIndex);
+    return it != m_InputBuffers.end() ? it->second : AMFBufferPtr();
+}
+//-------------------------------------------------------------------------------------------------
 amf_pts AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::GetPtsFromFFMPEG(AMFBufferPtr pBuffer, AVFrame *pFrame)
 {
     amf_pts retPts = 0;
@@ -52,6 +52,7 @@ extern "C"
 #endif
 }
 
+#define AUDIO_DECODER_MAX_PACKETS_IN_FLIGHT             128
 
 namespace amf
 {
@@ -96,6 +97,7 @@ namespace amf
     protected:
         bool                AMF_STD_CALL  ReadAVPacketInfo(AMFBufferPtr pBuffer, AVPacket *pPacket);
         amf_pts             AMF_STD_CALL  GetPtsFromFFMPEG(AMFBufferPtr pBuffer, AVFrame *pFrame);
+        AMFBufferPtr        AMF_STD_CALL  FindInputBuffer(amf_int64 packetIndex);
 
     private:
       mutable AMFCriticalSection  m_sync;
@@ -107,11 +109,14 @@ namespace amf
         // member variables from AMFAudioDecoderFFMPEG
         AVCodecContext*         m_pCodecContext;
         amf_pts                 m_SeekPts;
-
-
-        AMFBufferPtr            m_pInputData;
-        AMFBufferPtr            m_pLastInputData;
-        amf_size                m_iLastDataOffset;
+        bool                    m_bDrainSent;
+
+        // packets sent to the decoder, keyed by the reordered_opaque their frames come back with;
+        // one packet can decode to several frames, their pts continue from the packet pts
+        typedef amf_map<amf_int64, AMFBufferPtr> InputBufferMap;
+        InputBufferMap          m_InputBuffers;
+        amf_int64               m_iPacketIndex;
+        amf_int64               m_iLastPacketIndex;
         amf_pts                 m_ptsLastDataOffset;
 
         amf_int64               m_audioFrameSubmitCount;
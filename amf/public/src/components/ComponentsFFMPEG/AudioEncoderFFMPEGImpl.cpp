@@ -75,19 +75,19 @@ const AMFEnumDescriptionEntry AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION[] =
 AMFAudioEncoderFFMPEGImpl::AMFAudioEncoderFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_bEncodingEnabled(true),
-    m_bEof(false),
-    m_bDrained(true),
     m_pCodecContext(NULL),
+    m_iSamplesSent(0),
+    m_iFirstFramePts(-1LL),
     m_pCompressedBuffer(NULL),
     m_iSamplesPacked(0),
-    m_iFrameOffset(0),
-    m_iFirstFramePts(-1LL),
 	m_iSamplesInPackaet(0),
-    m_audioFrameSubmitCount(0),
-    m_audioFrameQueryCount(0),
+    m_bEof(false),
+    m_bDrained(true),
     m_inSampleFormat(AMFAF_UNKNOWN),
     m_iChannelCount(0),
     m_iSampleRate(0),
+    m_audioFrameSubmitCount(0),
+    m_audioFrameQueryCount(0),
     m_PrevPts(-1LL)
 
 {
@@ -248,7 +248,10 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*fo
         AMF_RETURN_IF_FAILED(SetProperty(AUDIO_ENCODER_OUT_AUDIO_EXTRA_DATA, spBuffer));
     }
 
-    m_iFrameOffset = 0;
+    // keep a few codec frames worth of input so steady state submits never reallocate
+    const amf_int32 reserveSamples = m_pCodecContext->frame_size > 0 ? m_pCodecContext->frame_size * 4 : 0;
+    AMF_RETURN_IF_FAILED(m_Fifo.Init(m_inSampleFormat, m_iChannelCount, reserveSamples));
+    m_iSamplesSent = 0;
 
     return AMF_OK;
 }
@@ -279,8 +282,8 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Terminate()
         m_pCompressedBuffer=NULL;
     }
 
-    m_pFrame.Release();
-    m_iFrameOffset = 0;
+    m_Fifo.Terminate();
+    m_iSamplesSent = 0;
     m_iFirstFramePts = -1;
 	
     m_iSamplesPacked=0;
@@ -308,8 +311,8 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Flush()
 {
     AMFLock lock(&m_sync);
 
-    m_pFrame.Release();
-    m_iFrameOffset = 0;
+    m_Fifo.Reset();
+    m_iSamplesSent = 0;
     m_iFirstFramePts = -1;
     m_iSamplesPacked = -1;
     m_bDrained = true;
@@ -345,7 +348,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
         m_iFirstFramePts = pData->GetPts();
     }
 
-    if(m_pFrame != NULL && m_pFrame->GetSampleCount() - m_iFrameOffset >= m_pCodecContext->frame_size)
+    if(m_Fifo.GetSampleCount() > 0 && m_Fifo.GetSampleCount() >= m_pCodecContext->frame_size)
     {
         return AMF_INPUT_FULL;
     }
@@ -356,15 +359,8 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
     AMF_RESULT err=pAudioBuffer->Convert(AMF_MEMORY_HOST);
     AMF_RETURN_IF_FAILED(err,L"SubmitInput() - Convert(AMF_MEMORY_HOST) failed");
 
-    if(m_pCodecContext->frame_size == 0 || m_pFrame == NULL)
-    {
-        m_pFrame = pAudioBuffer;
-    }
-    else
-    { 
-        m_pFrame = CombineBuffers(m_pFrame, m_iFrameOffset, pAudioBuffer);
-    }
-    m_iFrameOffset = 0;
+    err = m_Fifo.Write(pAudioBuffer);
+    AMF_RETURN_IF_FAILED(err, L"SubmitInput() - failed to queue samples");
     m_audioFrameSubmitCount++;
     
     m_pInputData = AMFDataPtr(pData);
@@ -372,42 +368,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
-AMFAudioBufferPtr AMFAudioEncoderFFMPEGImpl::CombineBuffers(AMFAudioBuffer *dst, amf_int32 dstOffset, AMFAudioBuffer *src)
-{
-    AMFAudioBufferPtr out;
-    amf_int32 samples = src->GetSampleCount();
-    samples += (dst->GetSampleCount() - dstOffset);
-
-    m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_inSampleFormat, samples, m_iSampleRate, m_iChannelCount, &out);
-
-    int iSampleSize = GetAudioSampleSize((AMF_AUDIO_FORMAT) m_inSampleFormat);
-
-    int planar = IsAudioPlanar(m_inSampleFormat) ? 1 : m_iChannelCount;
-    int planes = !IsAudioPlanar(m_inSampleFormat) ? 1 : m_iChannelCount;
-
-    amf_size outPlaneSize = out->GetSampleCount() * iSampleSize * planar;
-    amf_int32 dstCopy = 0;
-    amf_int32 dstOffsetBytes =          dstOffset * iSampleSize * planar;
-    amf_size dstPlaneSize = dst->GetSampleCount() * iSampleSize * planar;
-    dstCopy = (dst->GetSampleCount() - dstOffset) * iSampleSize * planar;
-
-    for(int ch = 0; ch < planes; ch++)
-    { 
-        memcpy( (amf_uint8*)out->GetNative()    + ch * outPlaneSize, 
-                (amf_uint8*)dst->GetNative()    + ch * dstPlaneSize  + dstOffsetBytes, 
-            dstCopy);
-    }
-    
-    amf_size srcPlaneSize = src->GetSampleCount() * iSampleSize * planar;
-    for(int ch = 0; ch < planes; ch++)
-    { 
-        memcpy( (amf_uint8*)out->GetNative()    + ch * outPlaneSize + dstCopy, 
-                (amf_uint8*)src->GetNative()    + ch * srcPlaneSize, 
-                srcPlaneSize);
-    }
-    return out;
-
-}
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData)
 {
@@ -424,15 +384,11 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
     {
         return m_bEof ? AMF_EOF : AMF_OK;
     }
-    if(m_pFrame == NULL && m_bDrained)
+    if(m_Fifo.GetSampleCount() == 0 && m_bDrained)
     {
         return m_bEof ? AMF_EOF : AMF_OK;
     }
-    int samples = 0;
-    if(m_pFrame != NULL)
-    { 
-        samples = m_pFrame->GetSampleCount() - m_iFrameOffset;
-    }
+    int samples = m_Fifo.GetSampleCount();
     if(m_pCodecContext->frame_size > 0)
     { 
         if(samples < m_pCodecContext->frame_size)
@@ -447,14 +403,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
             samples = m_pCodecContext->frame_size;
         }
     }
-    int iSampleSize = GetAudioSampleSize((AMF_AUDIO_FORMAT) m_inSampleFormat);
-   
-    int iFrameSizeBytes = (int)samples * iSampleSize * m_iChannelCount;
-    if(iFrameSizeBytes == 0)
-    {
-        iFrameSizeBytes = m_pCodecContext->frame_size * iSampleSize * m_iChannelCount;
-    }
-
 
     // encode
     AVPacket  avPacket;
@@ -465,7 +413,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
     int ret = 0;
     int pckt = 0;
 
-    if (m_pFrame != NULL)
+    if (samples > 0)
     {
         // fill the frame information
         AVFrame  avFrame;
@@ -477,30 +425,19 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
         avFrame.channels = m_iChannelCount;
         avFrame.sample_rate = m_iSampleRate;
         avFrame.key_frame = 1;
-        avFrame.pts = av_rescale_q(m_pFrame->GetPts(), AMF_TIME_BASE_Q, m_pCodecContext->time_base);
-
-        int planar = IsAudioPlanar(m_inSampleFormat) ? 1 : m_iChannelCount;
-        int planes = !IsAudioPlanar(m_inSampleFormat) ? 1 : m_iChannelCount;
+        avFrame.pts = av_rescale_q(m_iFirstFramePts, AMF_TIME_BASE_Q, m_pCodecContext->time_base) + m_iSamplesSent;
 
-        // setup the data pointers in the AVFrame
-
-        amf_int32 dstOffsetBytes = m_iFrameOffset * iSampleSize * planar;
-        amf_size dstPlaneSize = m_pFrame->GetSampleCount() * iSampleSize * planar;
-
-        for(int ch = 0; ch < planes; ch++)
+        // setup the data pointers in the AVFrame - the FIFO keeps each plane contiguous
+        for(int ch = 0; ch < m_Fifo.GetPlaneCount(); ch++)
         { 
-            avFrame.data[ch] = (uint8_t *)m_pFrame->GetNative() + ch * dstPlaneSize + dstOffsetBytes;
+            avFrame.data[ch] = m_Fifo.GetReadPtr(ch);
         }
         avFrame.extended_data = avFrame.data;
 
         ret = avcodec_encode_audio2(m_pCodecContext, &avPacket, &avFrame, &pckt);
-        m_iFrameOffset += samples;
+        m_Fifo.Consume(samples);
+        m_iSamplesSent += samples;
         m_bDrained = false;
-        if(m_iFrameOffset >= m_pFrame->GetSampleCount())
-        {
-            m_pFrame.Release();
-            m_iFrameOffset = 0;
-        }
     }
     else
     {
@@ -556,7 +493,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
 
     // if we have more output to be consumed than a frame, we should consume it
     // before submitting more input...
-    if (m_pFrame && (m_pFrame->GetSampleCount() - m_iFrameOffset >= m_pCodecContext->frame_size))
+    if (m_Fifo.GetSampleCount() > 0 && m_Fifo.GetSampleCount() >= m_pCodecContext->frame_size)
     {
         return AMF_REPEAT;
     }
@@ -36,6 +36,7 @@
 #include "public/include/components/FFMPEGAudioEncoder.h"
 #include "public/common/PropertyStorageExImpl.h"
 #include "public/include/core/Context.h"
+#include "AudioFifo.h"
 
 extern "C"
 {
@@ -95,8 +96,6 @@ namespace amf
 
 
     private:
-        AMFAudioBufferPtr   CombineBuffers(AMFAudioBuffer *dst, amf_int32 dstOffset, AMFAudioBuffer *src);
-
       mutable AMFCriticalSection  m_sync;
 
         AMFContextPtr           m_pContext;
@@ -105,8 +104,8 @@ namespace amf
         AVCodecContext*         m_pCodecContext;
 
         AMFDataPtr              m_pInputData;
-        AMFAudioBufferPtr       m_pFrame;
-        amf_int32               m_iFrameOffset;
+        AMFAudioFifo            m_Fifo;             // input samples waiting for a full codec frame
+        amf_pts                 m_iSamplesSent;     // samples passed to the codec since the first frame
         amf_pts                 m_iFirstFramePts;
 
         amf_uint8*              m_pCompressedBuffer;
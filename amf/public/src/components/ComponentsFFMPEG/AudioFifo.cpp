@@ -0,0 +1,234 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "AudioFifo.h"
+#include "UtilsFFMPEG.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/TraceAdapter.h"
+
+#define AMF_FACILITY L"AMFAudioFifo"
+
+using namespace amf;
+
+//-------------------------------------------------------------------------------------------------
+AMFAudioFifo::AMFAudioFifo()
+  : m_pData(NULL),
+    m_iCapacity(0),
+    m_iReadPos(0),
+    m_iWritePos(0),
+    m_eFormat(AMFAF_UNKNOWN),
+    m_iChannels(0),
+    m_iPlanes(0),
+    m_iSampleStride(0)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMFAudioFifo::~AMFAudioFifo()
+{
+    Terminate();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioFifo::Init(AMF_AUDIO_FORMAT format, amf_int32 channels, amf_int32 reserveSamples)
+{
+    Terminate();
+
+    const amf_int32 sampleSize = GetAudioSampleSize(format);
+    AMF_RETURN_IF_FALSE(sampleSize > 0, AMF_INVALID_FORMAT, L"Init() - unsupported format %d", (int)format);
+    AMF_RETURN_IF_FALSE(channels > 0, AMF_INVALID_ARG, L"Init() - invalid channel count %d", (int)channels);
+
+    m_eFormat = format;
+    m_iChannels = channels;
+    if (IsAudioPlanar(format))
+    {
+        m_iPlanes = channels;
+        m_iSampleStride = sampleSize;
+    }
+    else
+    {
+        m_iPlanes = 1;
+        m_iSampleStride = sampleSize * channels;
+    }
+    return reserveSamples > 0 ? Reserve(reserveSamples) : AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioFifo::Terminate()
+{
+    if (m_pData != NULL)
+    {
+        amf_free(m_pData);
+        m_pData = NULL;
+    }
+    m_iCapacity = 0;
+    m_iReadPos = 0;
+    m_iWritePos = 0;
+    m_eFormat = AMFAF_UNKNOWN;
+    m_iChannels = 0;
+    m_iPlanes = 0;
+    m_iSampleStride = 0;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioFifo::Reset()
+{
+    m_iReadPos = 0;
+    m_iWritePos = 0;
+}
+//-------------------------------------------------------------------------------------------------
+amf_uint8* AMFAudioFifo::GetPlane(amf_int32 plane) const
+{
+    return m_pData + (amf_size)plane * m_iCapacity * m_iSampleStride;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioFifo::Reserve(amf_int32 samples)
+{
+    if (m_iWritePos + samples <= m_iCapacity)
+    {
+        return AMF_OK;
+    }
+    const amf_int32 queued = GetSampleCount();
+
+    // moving the queued samples to the front is cheap once at least as much has been consumed
+    if (queued + samples <= m_iCapacity && m_iReadPos >= queued)
+    {
+        if (queued > 0)
+        {
+            for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+            {
+                amf_uint8* pPlane = GetPlane(plane);
+                memcpy(pPlane, pPlane + (amf_size)m_iReadPos * m_iSampleStride, (amf_size)queued * m_iSampleStride);
+            }
+        }
+        m_iReadPos = 0;
+        m_iWritePos = queued;
+        return AMF_OK;
+    }
+
+    amf_int32 capacity = m_iCapacity * 2;
+    if (capacity < queued + samples)
+    {
+        capacity = queued + samples;
+    }
+    amf_uint8* pData = static_cast<amf_uint8*>(amf_alloc((amf_size)capacity * m_iSampleStride * m_iPlanes));
+    AMF_RETURN_IF_FALSE(pData != NULL, AMF_OUT_OF_MEMORY, L"Reserve() - failed to allocate %d samples", (int)capacity);
+
+    if (m_pData != NULL)
+    {
+        for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+        {
+            memcpy(pData + (amf_size)plane * capacity * m_iSampleStride,
+                GetPlane(plane) + (amf_size)m_iReadPos * m_iSampleStride, (amf_size)queued * m_iSampleStride);
+        }
+        amf_free(m_pData);
+    }
+    m_pData = pData;
+    m_iCapacity = capacity;
+    m_iReadPos = 0;
+    m_iWritePos = queued;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioFifo::Write(AMFAudioBuffer* pBuffer)
+{
+    AMF_RETURN_IF_FALSE(pBuffer != NULL, AMF_INVALID_ARG, L"Write() - pBuffer == NULL");
+    AMF_RETURN_IF_FALSE(m_iPlanes > 0, AMF_NOT_INITIALIZED, L"Write() - FIFO not initialized");
+    AMF_RETURN_IF_FALSE(pBuffer->GetSampleFormat() == m_eFormat && pBuffer->GetChannelCount() == m_iChannels,
+        AMF_INVALID_FORMAT, L"Write() - buffer format %d x %d does not match FIFO %d x %d",
+        (int)pBuffer->GetSampleFormat(), (int)pBuffer->GetChannelCount(), (int)m_eFormat, (int)m_iChannels);
+
+    const amf_int32 samples = pBuffer->GetSampleCount();
+    if (samples <= 0)
+    {
+        return AMF_OK;
+    }
+    AMF_RETURN_IF_FAILED(Reserve(samples));
+
+    const amf_size planeSize = (amf_size)samples * m_iSampleStride;
+    const amf_uint8* pSrc = static_cast<const amf_uint8*>(pBuffer->GetNative());
+    for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+    {
+        memcpy(GetPlane(plane) + (amf_size)m_iWritePos * m_iSampleStride, pSrc + plane * planeSize, planeSize);
+    }
+    m_iWritePos += samples;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioFifo::Write(const amf_uint8* const* ppPlanes, amf_int32 samples)
+{
+    AMF_RETURN_IF_FALSE(m_iPlanes > 0, AMF_NOT_INITIALIZED, L"Write() - FIFO not initialized");
+    if (samples <= 0)
+    {
+        return AMF_OK;
+    }
+    AMF_RETURN_IF_FALSE(ppPlanes != NULL, AMF_INVALID_ARG, L"Write() - ppPlanes == NULL");
+    AMF_RETURN_IF_FAILED(Reserve(samples));
+
+    for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+    {
+        memcpy(GetPlane(plane) + (amf_size)m_iWritePos * m_iSampleStride, ppPlanes[plane], (amf_size)samples * m_iSampleStride);
+    }
+    m_iWritePos += samples;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+amf_int32 AMFAudioFifo::Read(amf_uint8* const* ppPlanes, amf_int32 samples)
+{
+    if (samples > GetSampleCount())
+    {
+        samples = GetSampleCount();
+    }
+    if (samples <= 0)
+    {
+        return 0;
+    }
+    for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+    {
+        memcpy(ppPlanes[plane], GetReadPtr(plane), (amf_size)samples * m_iSampleStride);
+    }
+    Consume(samples);
+    return samples;
+}
+//-------------------------------------------------------------------------------------------------
+amf_uint8* AMFAudioFifo::GetReadPtr(amf_int32 plane) const
+{
+    return GetPlane(plane) + (amf_size)m_iReadPos * m_iSampleStride;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioFifo::Consume(amf_int32 samples)
+{
+    m_iReadPos += samples < GetSampleCount() ? samples : GetSampleCount();
+    if (m_iReadPos == m_iWritePos)
+    {
+        m_iReadPos = 0;
+        m_iWritePos = 0;
+    }
+}
+//-------------------------------------------------------------------------------------------------
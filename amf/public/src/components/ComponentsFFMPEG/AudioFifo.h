@@ -0,0 +1,88 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/AudioBuffer.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Sample FIFO for planar or interleaved host audio.
+    // Samples are kept contiguous per plane so a reader can point an AVFrame straight at the front
+    // of the queue. Storage is reused between writes: the tail is compacted when enough has been
+    // consumed and grows geometrically otherwise, so appending costs O(new samples).
+    //-------------------------------------------------------------------------------------------------
+    class AMFAudioFifo
+    {
+    public:
+        AMFAudioFifo();
+        ~AMFAudioFifo();
+
+        AMF_RESULT          Init(AMF_AUDIO_FORMAT format, amf_int32 channels, amf_int32 reserveSamples);
+        void                Terminate();
+        void                Reset();    // drops queued samples, keeps the storage
+
+        AMF_AUDIO_FORMAT    GetFormat() const           { return m_eFormat; }
+        amf_int32           GetChannelCount() const     { return m_iChannels; }
+        amf_int32           GetPlaneCount() const       { return m_iPlanes; }
+        amf_int32           GetSampleCount() const      { return m_iWritePos - m_iReadPos; }
+
+        // buffer must be in host memory and match the FIFO format and channel count
+        AMF_RESULT          Write(AMFAudioBuffer* pBuffer);
+        // one pointer per plane, samples counted per channel
+        AMF_RESULT          Write(const amf_uint8* const* ppPlanes, amf_int32 samples);
+        // copies out up to samples and returns the number copied
+        amf_int32           Read(amf_uint8* const* ppPlanes, amf_int32 samples);
+
+        // direct access to the oldest queued sample of a plane; valid until the next Write()
+        amf_uint8*          GetReadPtr(amf_int32 plane) const;
+        void                Consume(amf_int32 samples);
+
+    private:
+        AMF_RESULT          Reserve(amf_int32 samples);
+        amf_uint8*          GetPlane(amf_int32 plane) const;
+
+        amf_uint8*          m_pData;
+        amf_int32           m_iCapacity;        // in samples per plane
+        amf_int32           m_iReadPos;
+        amf_int32           m_iWritePos;
+
+        AMF_AUDIO_FORMAT    m_eFormat;
+        amf_int32           m_iChannels;
+        amf_int32           m_iPlanes;
+        amf_int32           m_iSampleStride;    // bytes per sample in a plane
+
+        AMFAudioFifo(const AMFAudioFifo&);
+        AMFAudioFifo& operator=(const AMFAudioFifo&);
+    };
+}
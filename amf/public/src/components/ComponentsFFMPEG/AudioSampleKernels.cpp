@@ -0,0 +1,237 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "AudioSampleKernels.h"
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define AMF_AUDIO_SAMPLE_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #define AMF_TARGET_SSE2
+        #define AMF_TARGET_AVX2
+    #else
+        #define AMF_TARGET_SSE2     __attribute__((target("sse2")))
+        #define AMF_TARGET_AVX2     __attribute__((target("avx2")))
+    #endif
+#else
+    #define AMF_AUDIO_SAMPLE_X86 0
+#endif
+
+using namespace amf;
+
+//-------------------------------------------------------------------------------------------------
+// scalar reference kernels
+//-------------------------------------------------------------------------------------------------
+static void S16ToFLT_Scalar(float* pDst, const amf_int16* pSrc, amf_size count)
+{
+    for (amf_size i = 0; i < count; i++)
+    {
+        pDst[i] = pSrc[i] * (1.0f / 32768.0f);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void FLTToS16_Scalar(amf_int16* pDst, const float* pSrc, amf_size count)
+{
+    for (amf_size i = 0; i < count; i++)
+    {
+        float value = pSrc[i] * 32768.0f;
+        value = value < -32768.0f ? -32768.0f : (value > 32767.0f ? 32767.0f : value);
+        pDst[i] = amf_int16(lrintf(value));
+    }
+}
+
+#if AMF_AUDIO_SAMPLE_X86
+//-------------------------------------------------------------------------------------------------
+// SSE2
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void S16ToFLT_SSE2(float* pDst, const amf_int16* pSrc, amf_size count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    amf_size i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+        // sign extend by unpacking into the high half and shifting back
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(pDst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(pDst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    S16ToFLT_Scalar(pDst + i, pSrc + i, count - i);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void FLTToS16_SSE2(amf_int16* pDst, const float* pSrc, amf_size count)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    amf_size i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128 f0 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i + 0), scale), minValue), maxValue);
+        const __m128 f1 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i + 4), scale), minValue), maxValue);
+        // cvtps rounds to nearest even like lrintf in the default rounding mode
+        _mm_storeu_si128((__m128i*)(pDst + i), _mm_packs_epi32(_mm_cvtps_epi32(f0), _mm_cvtps_epi32(f1)));
+    }
+    FLTToS16_Scalar(pDst + i, pSrc + i, count - i);
+}
+//-------------------------------------------------------------------------------------------------
+// AVX2
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void S16ToFLT_AVX2(float* pDst, const amf_int16* pSrc, amf_size count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    amf_size i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pSrc + i + 0)));
+        const __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pSrc + i + 8)));
+        _mm256_storeu_ps(pDst + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(pDst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    S16ToFLT_SSE2(pDst + i, pSrc + i, count - i);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void FLTToS16_AVX2(amf_int16* pDst, const float* pSrc, amf_size count)
+{
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    const __m256 minValue = _mm256_set1_ps(-32768.0f);
+    const __m256 maxValue = _mm256_set1_ps(32767.0f);
+    amf_size i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256 f0 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(pSrc + i + 0), scale), minValue), maxValue);
+        const __m256 f1 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(pSrc + i + 8), scale), minValue), maxValue);
+        // packs works per 128-bit lane, the permute restores sample order
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+        _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    FLTToS16_SSE2(pDst + i, pSrc + i, count - i);
+}
+#endif // AMF_AUDIO_SAMPLE_X86
+
+//-------------------------------------------------------------------------------------------------
+// dispatch tables
+//-------------------------------------------------------------------------------------------------
+static const AMFAudioSampleKernels s_KernelsScalar =
+{
+    AMF_PLANE_COPY_ISA_SCALAR,
+    S16ToFLT_Scalar, FLTToS16_Scalar
+};
+#if AMF_AUDIO_SAMPLE_X86
+static const AMFAudioSampleKernels s_KernelsSSE2 =
+{
+    AMF_PLANE_COPY_ISA_SSE2,
+    S16ToFLT_SSE2, FLTToS16_SSE2
+};
+static const AMFAudioSampleKernels s_KernelsAVX2 =
+{
+    AMF_PLANE_COPY_ISA_AVX2,
+    S16ToFLT_AVX2, FLTToS16_AVX2
+};
+#endif
+
+//-------------------------------------------------------------------------------------------------
+const AMFAudioSampleKernels& AMF_STD_CALL amf::GetAudioSampleKernels(AMF_PLANE_COPY_ISA eISA)
+{
+#if AMF_AUDIO_SAMPLE_X86
+    // the plane copy kernels already know what the CPU and the OS support
+    const AMF_PLANE_COPY_ISA eBestISA = GetPlaneCopyKernels().eISA;
+    if (eISA > eBestISA)
+    {
+        eISA = eBestISA;
+    }
+    switch (eISA)
+    {
+    case AMF_PLANE_COPY_ISA_AVX512:
+    case AMF_PLANE_COPY_ISA_AVX2:
+        return s_KernelsAVX2;
+    case AMF_PLANE_COPY_ISA_SSE2:
+        return s_KernelsSSE2;
+    default:
+        break;
+    }
+#else
+    (void)eISA;
+#endif
+    return s_KernelsScalar;
+}
+//-------------------------------------------------------------------------------------------------
+const AMFAudioSampleKernels& AMF_STD_CALL amf::GetAudioSampleKernels()
+{
+    return GetAudioSampleKernels(AMF_PLANE_COPY_ISA_AVX512);
+}
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+static void DeinterleaveChannelT(T* pDst, const T* pSrc, amf_int32 channels, amf_size count)
+{
+    for (amf_size i = 0; i < count; i++)
+    {
+        pDst[i] = pSrc[i * channels];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+static void InterleaveChannelT(T* pDst, const T* pSrc, amf_int32 channels, amf_size count)
+{
+    for (amf_size i = 0; i < count; i++)
+    {
+        pDst[i * channels] = pSrc[i];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL amf::DeinterleaveChannel(void* pDst, const void* pSrc, amf_int32 channels, amf_int32 channel, amf_size count, amf_int32 elementSize)
+{
+    if (elementSize == 2)
+    {
+        DeinterleaveChannelT(static_cast<amf_uint16*>(pDst), static_cast<const amf_uint16*>(pSrc) + channel, channels, count);
+    }
+    else
+    {
+        DeinterleaveChannelT(static_cast<amf_uint32*>(pDst), static_cast<const amf_uint32*>(pSrc) + channel, channels, count);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL amf::InterleaveChannel(void* pDst, const void* pSrc, amf_int32 channels, amf_int32 channel, amf_size count, amf_int32 elementSize)
+{
+    if (elementSize == 2)
+    {
+        InterleaveChannelT(static_cast<amf_uint16*>(pDst) + channel, static_cast<const amf_uint16*>(pSrc), channels, count);
+    }
+    else
+    {
+        InterleaveChannelT(static_cast<amf_uint32*>(pDst) + channel, static_cast<const amf_uint32*>(pSrc), channels, count);
+    }
+}
+//-------------------------------------------------------------------------------------------------
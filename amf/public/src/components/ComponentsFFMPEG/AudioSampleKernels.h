@@ -0,0 +1,61 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "PlaneCopyKernels.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Sample conversion kernels for the audio converter paths that need no resampling.
+    // Conversions match libavresample: S16 -> FLT scales by 1/32768, FLT -> S16 scales by 32768,
+    // clips and rounds to nearest even. Pointers may be unaligned.
+    //-------------------------------------------------------------------------------------------------
+    struct AMFAudioSampleKernels
+    {
+        AMF_PLANE_COPY_ISA eISA;
+
+        void (*S16ToFLT)(float* pDst, const amf_int16* pSrc, amf_size count);
+        void (*FLTToS16)(amf_int16* pDst, const float* pSrc, amf_size count);
+    };
+
+    // returns kernels for the best instruction set supported by the CPU and the OS
+    const AMFAudioSampleKernels& AMF_STD_CALL GetAudioSampleKernels();
+    // returns kernels for the requested instruction set or the best supported one below it
+    const AMFAudioSampleKernels& AMF_STD_CALL GetAudioSampleKernels(AMF_PLANE_COPY_ISA eISA);
+
+    // gathers one channel of interleaved samples, elementSize is 2 or 4 bytes
+    void AMF_STD_CALL DeinterleaveChannel(void* pDst, const void* pSrc, amf_int32 channels, amf_int32 channel, amf_size count, amf_int32 elementSize);
+    // scatters one channel into interleaved samples, elementSize is 2 or 4 bytes
+    void AMF_STD_CALL InterleaveChannel(void* pDst, const void* pSrc, amf_int32 channels, amf_int32 channel, amf_size count, amf_int32 elementSize);
+}
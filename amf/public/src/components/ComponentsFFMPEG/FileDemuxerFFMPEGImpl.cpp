@@ -112,6 +112,14 @@ const AMFEnumDescriptionEntry AMF_STREAM_TYPE_ENUM_DESCRIPTION[] =
     { AMF_STREAM_UNKNOWN   , 0 }  // This is end of description mark
 };
 
+const AMFEnumDescriptionEntry AMF_DEMUXER_STREAM_SELECTION_ENUM_DESCRIPTION[] =
+{
+    {AMF_DEMUXER_STREAM_SELECTION_MAIN,    L"Main"},
+    {AMF_DEMUXER_STREAM_SELECTION_ALL,     L"All"},
+    {AMF_DEMUXER_STREAM_SELECTION_LIST,    L"List"},
+    { AMF_DEMUXER_STREAM_SELECTION_MAIN    , 0 }  // This is end of description mark
+};
+
 struct FormatMap
 {
     AVPixelFormat ffmpegFormat;
@@ -149,11 +157,25 @@ static const sFormatMap[] =
 };
 
 
-void  ClearPacket(AVPacket* pPacket)
+#define MAX_POOLED_PACKETS 64
+
+//-------------------------------------------------------------------------------------------------
+// keeps the packet payload alive while the AMFBuffer wrapping it is in use
+class PacketBufferObserver : public AMFBufferObserver
 {
-    av_packet_unref(pPacket);
-    delete pPacket;
-}
+public:
+    PacketBufferObserver(AVBufferRef* pRef) : m_pRef(pRef) {}
+
+    virtual void AMF_STD_CALL OnBufferDataRelease(AMFBuffer* /*pBuffer*/)
+    {
+        av_buffer_unref(&m_pRef);
+        delete this;
+    }
+private:
+    virtual ~PacketBufferObserver() {}
+
+    AVBufferRef*    m_pRef;
+};
 
 
 
@@ -170,6 +192,17 @@ AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::AMFOutputDemuxerImpl(AMFFileDemu
       m_bEnabled(false),
       m_iPacketCount(0)
 {
+    const AVStream* ist = pHost->m_pInputContext->streams[index];
+    const AVDictionaryEntry* pLanguage = av_dict_get(ist->metadata, "language", NULL, 0);
+    const amf_wstring language = pLanguage != NULL ? amf_from_utf8_to_unicode(amf_string(pLanguage->value)) : amf_wstring();
+
+    AMFPrimitivePropertyInfoMapBegin
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_STREAM_INDEX, L"FFmpeg stream index", index, 0, INT_MAX, false),
+        AMFPropertyInfoWString(FFMPEG_DEMUXER_STREAM_LANGUAGE, L"Language", L"", false),
+    AMFPrimitivePropertyInfoMapEnd
+
+    SetProperty(FFMPEG_DEMUXER_STREAM_INDEX, index);
+    SetProperty(FFMPEG_DEMUXER_STREAM_LANGUAGE, language.c_str());
 }
 //-------------------------------------------------------------------------------------------------
 AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::~AMFOutputDemuxerImpl()
@@ -223,7 +256,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::QueryOu
     err = m_pHost->BufferFromPacket(packet, &buf);
     if (err != AMF_OK)
     {
-        ClearPacket(packet);
+        m_pHost->ReleasePacket(packet);
         return err;
     }
 
@@ -231,7 +264,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::QueryOu
     *ppData = buf;
     (*ppData)->Acquire();
 
-    ClearPacket(packet);
+    m_pHost->ReleasePacket(packet);
 
     m_iPacketCount++;
     return AMF_OK;
@@ -246,7 +279,7 @@ AMF_RESULT  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::CachePacket(AVPacket
 
     if(!m_bEnabled)
     { 
-        ClearPacket(pPacket);
+        m_pHost->ReleasePacket(pPacket);
         return AMF_FAIL;
     }
        // add the packet to the cache...
@@ -258,7 +291,7 @@ void  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::ClearPacketCache()
 {
     for (amf_list<AVPacket*>::iterator it = m_packetsCache.begin(); it != m_packetsCache.end(); ++it)
     {
-        ClearPacket(*it);
+        m_pHost->ReleasePacket(*it);
     }
     m_packetsCache.clear();
 }
@@ -447,6 +480,44 @@ AMFFileDemuxerFFMPEGImpl::AMFAudioOutputDemuxerImpl::AMFAudioOutputDemuxerImpl(A
 
 
 
+//
+//
+// AMFDataOutputDemuxerImpl
+//
+//
+
+//-------------------------------------------------------------------------------------------------
+AMFFileDemuxerFFMPEGImpl::AMFDataOutputDemuxerImpl::AMFDataOutputDemuxerImpl(AMFFileDemuxerFFMPEGImpl* pHost, amf_int32 index)
+    : AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl(pHost, index)
+{
+    const AVStream* ist = pHost->m_pInputContext->streams[index];
+
+    // text subtitles keep their style header here
+    AMFBufferPtr spBuffer;
+    if (ist->codecpar->extradata_size > 0)
+    {
+        AMF_RESULT err = m_pHost->m_pContext->AllocBuffer(AMF_MEMORY_HOST, ist->codecpar->extradata_size, &spBuffer);
+        if ((err == AMF_OK) && spBuffer->GetNative())
+        {
+            memcpy(spBuffer->GetNative(), ist->codecpar->extradata, ist->codecpar->extradata_size);
+        }
+    }
+
+    AMFPrimitivePropertyInfoMapBegin
+        AMFPropertyInfoEnum(AMF_STREAM_TYPE, L"Stream Type", AMF_STREAM_DATA, AMF_STREAM_TYPE_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoBool(AMF_STREAM_ENABLED, L"Enabled", false, true),
+        AMFPropertyInfoInt64(AMF_STREAM_CODEC_ID, L"Codec ID", ist->codecpar->codec_id, AV_CODEC_ID_NONE, INT_MAX, false),
+        AMFPropertyInfoInt64(AMF_STREAM_BIT_RATE, L"Bit Rate", ist->codecpar->bit_rate, 0, INT_MAX, false),
+        AMFPropertyInfoInterface(AMF_STREAM_EXTRA_DATA, L"Extra Data", NULL, false),
+    AMFPrimitivePropertyInfoMapEnd
+
+    SetProperty(AMF_STREAM_CODEC_ID, ist->codecpar->codec_id);
+    SetProperty(AMF_STREAM_BIT_RATE, ist->codecpar->bit_rate);
+    AMFPropertyStorage::SetProperty(AMF_STREAM_EXTRA_DATA, spBuffer);
+}
+
+
+
 //
 //
 // AMFFileDemuxerFFMPEGImpl
@@ -457,18 +528,22 @@ AMFFileDemuxerFFMPEGImpl::AMFAudioOutputDemuxerImpl::AMFAudioOutputDemuxerImpl(A
 AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_pInputContext(NULL),
-    m_ptsDuration(0),
-    m_ptsPosition(0),
-    m_ptsSeekPos(-1),
-    m_ptsInitialMinPosition(0),
+    m_bCloseDataStream(false),
+    m_pIOContext(NULL),
+//    m_bSyncAV(false),
     m_iPacketCount(0),
+    m_bTerminated(true),
     m_bForceEof(false),
     m_bStreamingMode(true),
+    m_bZeroCopy(false),
+    m_iStreamCacheSize(1024),
+    m_ptsDuration(0),
+    m_ptsPosition(0),
+    m_ptsInitialMinPosition(0),
+    m_ptsSeekPos(-1),
     m_iVideoStreamIndexFFmpeg(-1),
     m_iAudioStreamIndexFFmpeg(-1),
-    m_bTerminated(true),
     m_bStreaming(false)
-//    m_bSyncAV(false)
 {
     g_AMFFactory.Init();
 
@@ -482,7 +557,21 @@ AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
 //        AMFPropertyInfoBool(FFMPEG_DEMUXER_SYNC_AV, L"Sync Audio and Video by PTS", false, false),
         AMFPropertyInfoBool(FFMPEG_DEMUXER_CHECK_MVC, L"Check MVC", true, false),
         AMFPropertyInfoBool(FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE, L"Stream mode", true, false),
-        AMFPropertyInfoBool(FFMPEG_DEMUXER_LISTEN, L"Listen", false, false)
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_LISTEN, L"Listen", false, false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_ZERO_COPY, L"Zero copy output", false, true),
+        AMFPropertyInfoInterface(FFMPEG_DEMUXER_DATA_STREAM, L"Input data stream", NULL, false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_IO_BUFFER_SIZE, L"I/O buffer size in bytes", 0, 0, INT_MAX, false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_DIRECT_IO, L"Bypass the page cache", false, false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_FAST_OPEN, L"Fast open", false, false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_PROBE_SIZE, L"Probe size in bytes", 0, 0, LLONG_MAX, false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_ANALYZE_DURATION, L"Analyze duration", 0, 0, LLONG_MAX, false),
+        AMFPropertyInfoPath(FFMPEG_DEMUXER_STREAM_INFO_CACHE, L"Stream info cache folder", L"", false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_KEYFRAME_INDEX, L"Keyframe index", false, false),
+        AMFPropertyInfoPath(FFMPEG_DEMUXER_KEYFRAME_INDEX_PATH, L"Keyframe index file", L"", false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_SEEK_DECODE_FRAMES, L"Packets to decode after seek", -1, -1, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoEnum(FFMPEG_DEMUXER_STREAM_SELECTION, L"Stream selection", AMF_DEMUXER_STREAM_SELECTION_MAIN, AMF_DEMUXER_STREAM_SELECTION_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoWString(FFMPEG_DEMUXER_STREAM_LIST, L"Stream list", L"", false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_STREAM_CACHE_SIZE, L"Packets cached per output", 1024, 0, INT_MAX, true)
         
     AMFPrimitivePropertyInfoMapEnd
 
@@ -493,6 +582,11 @@ AMFFileDemuxerFFMPEGImpl::~AMFFileDemuxerFFMPEGImpl()
 {
     Terminate();
     Close();
+    for (amf_vector<AVPacket*>::iterator it = m_PacketPool.begin(); it != m_PacketPool.end(); ++it)
+    {
+        delete *it;
+    }
+    m_PacketPool.clear();
     g_AMFFactory.Terminate();
 }
 //-------------------------------------------------------------------------------------------------
@@ -594,7 +688,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::QueryOutput(AMFData** ppData)
     AMF_RESULT err = BufferFromPacket(pPacket, &buf);
     if (err != AMF_OK)
     {
-        ClearPacket(pPacket);
+        ReleasePacket(pPacket);
         return err;
     }
 
@@ -602,7 +696,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::QueryOutput(AMFData** ppData)
     *ppData = buf;
     (*ppData)->Acquire();
 
-    ClearPacket(pPacket);
+    ReleasePacket(pPacket);
 
     return AMF_OK;
 }
@@ -664,8 +758,29 @@ AMF_RESULT AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::Seek(amf_pts ptsPos, AMF_SEEK_
         AVStream*  ist    = m_pInputContext->streams[stream_index];
         int64_t    offset = av_rescale_q(ptsPos, AMF_TIME_BASE_Q, ist->time_base);
 
-        // AVSEEK_FLAG_BACKWARD means that we need packet before ptsPos
-        int ret = av_seek_frame(m_pInputContext, stream_index, offset, flags);
+        // with the index the keyframe is known: seek to exactly its timestamp, or its byte offset
+        int ret = -1;
+        amf_int64 decodeFrames = -1;
+        AMFKeyframeIndex::Entry keyframe;
+        amf_int32 distance = 0;
+        if (m_KeyframeIndex.Find(stream_index, offset, eType == AMF_SEEK_NEXT_KEYFRAME, keyframe, distance))
+        {
+            ret = avformat_seek_file(m_pInputContext, stream_index, keyframe.pts, keyframe.pts, keyframe.pts, 0);
+            if (ret < 0 && keyframe.pos >= 0 && (m_pInputContext->iformat->flags & AVFMT_NO_BYTE_SEEK) == 0)
+            {
+                ret = avformat_seek_file(m_pInputContext, stream_index, keyframe.pos, keyframe.pos, keyframe.pos, AVSEEK_FLAG_BYTE);
+            }
+            if (ret >= 0)
+            {
+                decodeFrames = distance;
+            }
+        }
+        if (ret < 0)
+        {
+            // AVSEEK_FLAG_BACKWARD means that we need packet before ptsPos
+            ret = av_seek_frame(m_pInputContext, stream_index, offset, flags);
+        }
+        SetPrivateProperty(FFMPEG_DEMUXER_SEEK_DECODE_FRAMES, decodeFrames);
         if (ret<0)
         {
             // sometimes failed av_seek_frame cause further av_read functions return errors too.
@@ -818,6 +933,20 @@ void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::OnPropertyChanged(const wchar_t* pN
         GetProperty(FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE, &m_bStreamingMode);
         return;
     }
+
+    if (name == FFMPEG_DEMUXER_ZERO_COPY)
+    {
+        GetProperty(FFMPEG_DEMUXER_ZERO_COPY, &m_bZeroCopy);
+        return;
+    }
+
+    if (name == FFMPEG_DEMUXER_STREAM_CACHE_SIZE)
+    {
+        amf_int64 cacheSize = 0;
+        GetProperty(FFMPEG_DEMUXER_STREAM_CACHE_SIZE, &cacheSize);
+        m_iStreamCacheSize = (amf_size)cacheSize;
+        return;
+    }
 }
 
 
@@ -839,11 +968,20 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
     GetPropertyWString(FFMPEG_DEMUXER_URL, &Url);
     GetPropertyWString(FFMPEG_DEMUXER_PATH, &Path);
 
+    AMFInterfacePtr pStreamInterface;
+    GetProperty(FFMPEG_DEMUXER_DATA_STREAM, &pStreamInterface);
+
     amf_string convertedfilename;
     bool bListen = false;
     AVInputFormat* file_iformat = NULL;
     bool bStreaming = false;
-    if(Url.length() >0)
+    if(pStreamInterface != NULL)
+    {
+        // a stream can't be compared with the opened one, reopen every time
+        convertedfilename = amf_from_unicode_to_utf8(Path);
+        Url = Path;
+    }
+    else if(Url.length() >0)
     { 
         if (m_Url == Url)
         {
@@ -888,6 +1026,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
     m_ptsPosition = 0;
     m_bTerminated = false;
 
+    AMF_RESULT res = AMF_OK;
     AVDictionary *options = NULL;
 
     if(bListen)
@@ -896,10 +1035,71 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
         av_dict_set(&options, "timeout", "30", 0);
     }
 
+    bool bFastOpen = false;
+    GetProperty(FFMPEG_DEMUXER_FAST_OPEN, &bFastOpen);
+    amf_int64 probeSize = 0;
+    GetProperty(FFMPEG_DEMUXER_PROBE_SIZE, &probeSize);
+    amf_int64 analyzeDuration = 0;
+    GetProperty(FFMPEG_DEMUXER_ANALYZE_DURATION, &analyzeDuration);
+    if (bFastOpen)
+    {
+        probeSize = probeSize != 0 ? probeSize : 1024 * 1024;
+        analyzeDuration = analyzeDuration != 0 ? analyzeDuration : AMF_SECOND / 2;
+    }
+    if (probeSize > 0)
+    {
+        av_dict_set_int(&options, "probesize", probeSize, 0);
+    }
+    if (analyzeDuration > 0)
+    {
+        av_dict_set_int(&options, "analyzeduration", av_rescale_q(analyzeDuration, AMF_TIME_BASE_Q, FFMPEG_TIME_BASE_Q), 0);
+    }
+
+    amf_int64 ioBufferSize = 0;
+    GetProperty(FFMPEG_DEMUXER_IO_BUFFER_SIZE, &ioBufferSize);
+    bool bDirectIO = false;
+    GetProperty(FFMPEG_DEMUXER_DIRECT_IO, &bDirectIO);
+
+    if(pStreamInterface != NULL)
+    {
+        m_pDataStream = AMFDataStreamPtr(pStreamInterface);
+        AMF_RETURN_IF_FALSE(m_pDataStream != NULL, AMF_INVALID_ARG, L"Open() - DataStream must be AMFDataStream");
+    }
+    else if(!bStreaming && (ioBufferSize > 0 || bDirectIO))
+    {
+        res = OpenFileDataStream(Path.c_str(), false, bDirectIO, &m_pDataStream);
+        AMF_RETURN_IF_FAILED(res, L"Open() - failed to open %s", Path.c_str());
+        m_bCloseDataStream = true;
+    }
+    if(m_pDataStream != NULL)
+    {
+        m_pIOContext = CreateAVIOContext(m_pDataStream, false, ioBufferSize);
+        AMF_RETURN_IF_FALSE(m_pIOContext != NULL, AMF_OUT_OF_MEMORY, L"Open() - CreateAVIOContext() failed");
+
+        // avformat_open_input() keeps a preallocated context and its I/O
+        m_pInputContext = avformat_alloc_context();
+        AMF_RETURN_IF_FALSE(m_pInputContext != NULL, AMF_OUT_OF_MEMORY, L"Open() - avformat_alloc_context() failed");
+        m_pInputContext->pb = m_pIOContext;
+        m_pInputContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+
+    // reopening a known local file can skip avformat_find_stream_info()
+    m_StreamInfoCache.Reset();
+    if (!bStreaming && pStreamInterface == NULL)
+    {
+        amf_wstring cacheDir;
+        GetPropertyWString(FFMPEG_DEMUXER_STREAM_INFO_CACHE, &cacheDir);
+        m_StreamInfoCache.Init(cacheDir.c_str(), Path.c_str());
+    }
+
     // try open the file, if it fails, return error code
     AVInputFormat* fmt               = NULL;
     amf_bool bImageFormat = false;
-    AMF_RESULT res = OpenFile(convertedfilename, fmt, options, bImageFormat);
+    res = OpenFile(convertedfilename, fmt, options, bImageFormat);
+    if (res != AMF_OK || bImageFormat == false)
+    {
+        av_dict_free(&options);
+    }
     AMF_RETURN_IF_FALSE(res==AMF_OK && m_pInputContext!=NULL, AMF_INVALID_ARG, L"Open() failed to open file %s", Url.c_str());
  
     if(file_iformat!= NULL)
@@ -910,27 +1110,64 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
     if (bImageFormat)
     {
         res = OpenAsImageSequence(convertedfilename, fmt, options);
+        av_dict_free(&options);
     }
 
+    // every selected stream gets an output; all of them are served by one read loop
+    amf_int64 selection = AMF_DEMUXER_STREAM_SELECTION_MAIN;
+    GetProperty(FFMPEG_DEMUXER_STREAM_SELECTION, &selection);
+    amf_vector<amf_int32> selectedList;
+    if (selection == AMF_DEMUXER_STREAM_SELECTION_LIST)
+    {
+        amf_wstring streamList;
+        GetPropertyWString(FFMPEG_DEMUXER_STREAM_LIST, &streamList);
+        const wchar_t* pList = streamList.c_str();
+        while (*pList != 0)
+        {
+            wchar_t* pEnd = NULL;
+            const long index = wcstol(pList, &pEnd, 10);
+            if (pEnd == pList)
+            {
+                pList++; // separator
+                continue;
+            }
+            selectedList.push_back((amf_int32)index);
+            pList = pEnd;
+        }
+    }
+    amf_int64 cacheSize = 0;
+    GetProperty(FFMPEG_DEMUXER_STREAM_CACHE_SIZE, &cacheSize);
+    m_iStreamCacheSize = (amf_size)cacheSize;
+
     int videoIndex = -1;
     amf_vector<AMFOutputDemuxerImplPtr>  outputStreams;
     for (amf_int32 i = 0; i < static_cast<amf_int32>(m_pInputContext->nb_streams); i++)
     {
         const AVStream* ist = m_pInputContext->streams[i];
         AMFOutputDemuxerImplPtr newOutput;
-        if (ist->codec->codec_type == AVMEDIA_TYPE_VIDEO && m_iVideoStreamIndexFFmpeg == i)
+        if (!IsStreamSelected(i, selection, selectedList))
+        {
+            continue;
+        }
+        if (ist->codec->codec_type == AVMEDIA_TYPE_VIDEO)
         {
             if (ist->codec->pix_fmt == AV_PIX_FMT_BGR24)
                 continue;
 
             newOutput = new AMFVideoOutputDemuxerImpl(this, i);
-            videoIndex = i;
+            if (m_iVideoStreamIndexFFmpeg == i)
+            {
+                videoIndex = (int)outputStreams.size();
+            }
         }
-        
-        if (ist->codec->codec_type == AVMEDIA_TYPE_AUDIO && m_iAudioStreamIndexFFmpeg == i)
+        else if (ist->codec->codec_type == AVMEDIA_TYPE_AUDIO)
         {
             newOutput = new AMFAudioOutputDemuxerImpl(this, i);
         }
+        else if (ist->codec->codec_type == AVMEDIA_TYPE_SUBTITLE)
+        {
+            newOutput = new AMFDataOutputDemuxerImpl(this, i);
+        }
         if(newOutput != NULL)
         { 
             for(amf_vector<AMFOutputDemuxerImplPtr>::iterator it = m_OutputStreams.begin(); it != m_OutputStreams.end(); it++)
@@ -948,7 +1185,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
 
     
     
-    if (m_iVideoStreamIndexFFmpeg >= 0 && m_pInputContext->streams[m_iVideoStreamIndexFFmpeg]->codec->codec_id == AV_CODEC_ID_H264)
+    if (videoIndex >= 0 && m_pInputContext->streams[m_iVideoStreamIndexFFmpeg]->codec->codec_id == AV_CODEC_ID_H264)
     {
         bool checkMVC = true;
         GetProperty(FFMPEG_DEMUXER_CHECK_MVC, &checkMVC);
@@ -956,7 +1193,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
         bool bEnabled = false;
         m_OutputStreams[videoIndex]->GetProperty(AMF_STREAM_ENABLED, &bEnabled);
         m_OutputStreams[videoIndex]->SetProperty(AMF_STREAM_ENABLED, true);
-        if (checkMVC && CheckH264MVC())
+        if (checkMVC && !bFastOpen && CheckH264MVC())
         {
             m_OutputStreams[videoIndex]->SetProperty(AMF_STREAM_CODEC_ID, GetAMFVideoFormat(AVCodecID(AV_CODEC_H264MVC)));
         }
@@ -984,6 +1221,16 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
 
 //    GetProperty(FFMPEG_DEMUXER_SYNC_AV, &m_bSyncAV);
     SetProperty(FFMPEG_DEMUXER_DURATION, m_ptsDuration);
+    SetPrivateProperty(FFMPEG_DEMUXER_SEEK_DECODE_FRAMES, amf_int64(-1));
+
+    bool bKeyframeIndex = false;
+    GetProperty(FFMPEG_DEMUXER_KEYFRAME_INDEX, &bKeyframeIndex);
+    if (bKeyframeIndex && !bStreaming && pStreamInterface == NULL && !bImageFormat)
+    {
+        amf_wstring indexPath;
+        GetPropertyWString(FFMPEG_DEMUXER_KEYFRAME_INDEX_PATH, &indexPath);
+        m_KeyframeIndex.Start(Path.c_str(), indexPath.c_str(), m_pInputContext);
+    }
 
     // trace info about file and number of streams
     AMFTrace(AMF_TRACE_INFO, AMF_FACILITY, L"Open(%s) succeeded; streams=%d", Url.c_str(), m_pInputContext->nb_streams);
@@ -995,11 +1242,23 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Close()
 {
     AMFLock lock(&m_sync);
 
+    m_KeyframeIndex.Stop();
     if (m_pInputContext != NULL)
     {
         avformat_close_input(&m_pInputContext);
         m_pInputContext = NULL;
     }
+    // with AVFMT_FLAG_CUSTOM_IO the I/O context is not freed by avformat_close_input()
+    DestroyAVIOContext(&m_pIOContext);
+    if (m_pDataStream != NULL)
+    {
+        if (m_bCloseDataStream)
+        {
+            m_pDataStream->Close();
+        }
+        m_pDataStream.Release();
+        m_bCloseDataStream = false;
+    }
 
     ClearCachedPackets();
 
@@ -1016,6 +1275,34 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Close()
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AVPacket* AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AllocPacket()
+{
+    AMFLock lock(&m_sync);
+
+    if (!m_PacketPool.empty())
+    {
+        AVPacket* pPacket = m_PacketPool.back();
+        m_PacketPool.pop_back();
+        return pPacket;
+    }
+    return new AVPacket;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReleasePacket(AVPacket* pPacket)
+{
+    av_packet_unref(pPacket);
+
+    AMFLock lock(&m_sync);
+    if (m_PacketPool.size() < MAX_POOLED_PACKETS)
+    {
+        m_PacketPool.push_back(pPacket);
+    }
+    else
+    {
+        delete pPacket;
+    }
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
 {
     *packet = NULL;
@@ -1087,7 +1374,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
     }
 
 
-    *packet = new AVPacket;
+    *packet = AllocPacket();
     memcpy(*packet, &pkt, sizeof(pkt));
 
     return AMF_OK;
@@ -1107,6 +1394,11 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 stre
         {
             return AMF_EOF;
         }
+        // back-pressure: the next packet could belong to an output whose reader is behind
+        if (streamIndex != -1 && saveSkipped && IsOtherCacheFull(streamIndex))
+        {
+            return AMF_REPEAT;
+        }
 
         // read the next packet and assign it 
         // to the appropriate cache/queue
@@ -1123,20 +1415,16 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 stre
 
         // we got a valid packet, assign it to 
         // the appropriate cache/queue
-        // NOTE: for now we skip all streams 
-        //       except 1 video and 1 audio 
+        // NOTE: streams without an output are skipped
         const amf_int32  packetStreamIndex = pTempPacket->stream_index;
-        if ( ((m_iVideoStreamIndexFFmpeg != -1) && (packetStreamIndex == m_iVideoStreamIndexFFmpeg)) 
-            ||
-             ((m_iAudioStreamIndexFFmpeg != -1) && (packetStreamIndex == m_iAudioStreamIndexFFmpeg)) 
-            )
+        if (FromFFmpegToOutputIndex(packetStreamIndex) >= 0)
         {
             // nothing to do - code to handle correct packets 
             // right after this "if"
         }
         else
         {
-            ClearPacket(pTempPacket);
+            ReleasePacket(pTempPacket);
 //          pTempPacket = nullptr;
 
             // if we're requesting packets from streams we don't 
@@ -1166,7 +1454,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 stre
             }
             if(!bFound)
             {
-                ClearPacket(pTempPacket);
+                ReleasePacket(pTempPacket);
             }
             if (m_bStreaming)
             {
@@ -1206,11 +1494,59 @@ void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ClearCachedPackets()
     }
 }
 //-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::IsOtherCacheFull(amf_int32 streamIndex) const
+{
+    for (amf_vector<AMFOutputDemuxerImplPtr>::const_iterator it = m_OutputStreams.begin(); it != m_OutputStreams.end(); ++it)
+    {
+        if ((*it)->m_iIndexFFmpeg != streamIndex && (*it)->IsCacheFull(m_iStreamCacheSize))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::IsStreamSelected(amf_int32 streamIndex, amf_int64 selection, const amf_vector<amf_int32>& list) const
+{
+    const AVStream* ist = m_pInputContext->streams[streamIndex];
+    switch (selection)
+    {
+    case AMF_DEMUXER_STREAM_SELECTION_ALL:
+        if (ist->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            return (ist->disposition & AV_DISPOSITION_ATTACHED_PIC) == 0;
+        }
+        return ist->codecpar->codec_type == AVMEDIA_TYPE_AUDIO || ist->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE;
+    case AMF_DEMUXER_STREAM_SELECTION_LIST:
+        return std::find(list.begin(), list.end(), streamIndex) != list.end();
+    default:
+        return streamIndex == m_iVideoStreamIndexFFmpeg || streamIndex == m_iAudioStreamIndexFFmpeg;
+    }
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::BufferFromPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer)
 {
     AMF_RETURN_IF_FALSE(pPacket != NULL, AMF_INVALID_ARG, L"BufferFromPacket() - packet not passed in");
     AMF_RETURN_IF_FALSE(ppBuffer != NULL, AMF_INVALID_ARG, L"BufferFromPacket() - buffer pointer not passed in");
 
+    // ref-counted packets already carry zeroed padding - wrap the payload and hold a reference
+    // to the packet buffer until the AMFBuffer is released
+    if (m_bZeroCopy && pPacket->buf != NULL)
+    {
+        AVBufferRef* pRef = av_buffer_ref(pPacket->buf);
+        AMF_RETURN_IF_FALSE(pRef != NULL, AMF_OUT_OF_MEMORY, L"BufferFromPacket() - av_buffer_ref failed");
+
+        PacketBufferObserver* pObserver = new PacketBufferObserver(pRef);
+        AMF_RESULT err = m_pContext->CreateBufferFromHostNative(pPacket->data, pPacket->size, ppBuffer, pObserver);
+        if (err != AMF_OK)
+        {
+            pObserver->OnBufferDataRelease(NULL);
+        }
+        AMF_RETURN_IF_FAILED(err, L"BufferFromPacket() - CreateBufferFromHostNative failed");
+
+        return UpdateBufferProperties(*ppBuffer, pPacket);
+    }
+
 
     // Reproduce FFMPEG packet allocate logic (file libavcodec/avpacket.c function av_packet_duplicate)
     // ...
@@ -1317,6 +1653,14 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuf
         UpdateBufferAudioDuration(pBuffer, pPacket, ist);
 //        AMFTraceWarning(AMF_FACILITY, L"Audio count=%lld size=%d PTS=%5.2f", m_OutputStreams[outputIndex]->GetPacketCount(), (int)pBuffer->GetSize(),  pBuffer->GetPts() / 10000.);
     }
+    else
+    {
+        pBuffer->SetProperty(FFMPEG_DEMUXER_BUFFER_TYPE, AMFVariant(AMF_STREAM_DATA));
+        if (pPacket->duration > 0)
+        {
+            pBuffer->SetDuration(av_rescale_q(pPacket->duration, ist->time_base, AMF_TIME_BASE_Q));
+        }
+    }
     if (outputIndex >= 0)
     {
         pBuffer->SetProperty(FFMPEG_DEMUXER_BUFFER_STREAM_INDEX, outputIndex);
@@ -1502,13 +1846,13 @@ bool AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::CheckH264MVC()
             }
             else
             {
-                ClearPacket(packet);
+                ReleasePacket(packet);
                 continue;
             }
         }
         else
         {
-            ClearPacket(packet);
+            ReleasePacket(packet);
             continue;
         }
 
@@ -1607,6 +1951,7 @@ AMF_RESULT AMFFileDemuxerFFMPEGImpl::OpenAsImageSequence(
     AVDictionary* pOptions)
 {
     avformat_close_input(&m_pInputContext);
+    m_StreamInfoCache.Reset();
     size_t posEnd = filename.rfind(".");
     size_t posStart = filename.find_last_of("\\/");
     amf_string ext = filename.c_str() + posEnd;
@@ -1636,16 +1981,24 @@ AMF_RESULT AMFFileDemuxerFFMPEGImpl::OpenFile(
     amf_bool& bIsImage)
 {
     bIsImage = false;
-    int ret = avformat_open_input(&m_pInputContext, filename.c_str(), pFmt, &pOptions);
+    // avformat_open_input() consumes the dictionary, the caller may reuse pOptions
+    AVDictionary* pOpenOptions = NULL;
+    av_dict_copy(&pOpenOptions, pOptions, 0);
+    int ret = avformat_open_input(&m_pInputContext, filename.c_str(), pFmt, &pOpenOptions);
+    av_dict_free(&pOpenOptions);
 	if (ret < 0)
 	{
         return AMF_NOT_FOUND;
 	}
     // disable raw video support. toos should use raw reader
-    ret = avformat_find_stream_info(m_pInputContext, NULL);
-    if (ret < 0)
+    if (!m_StreamInfoCache.Load(m_pInputContext))
     {
-        return AMF_NOT_SUPPORTED;
+        ret = avformat_find_stream_info(m_pInputContext, NULL);
+        if (ret < 0)
+        {
+            return AMF_NOT_SUPPORTED;
+        }
+        m_StreamInfoCache.Store(m_pInputContext);
     }
 
     if (m_pInputContext->metadata != nullptr)
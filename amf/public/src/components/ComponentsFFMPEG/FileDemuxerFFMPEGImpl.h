@@ -37,8 +37,11 @@
 #include "public/include/components/MediaSource.h"
 #include "public/common/PropertyStorageExImpl.h"
 #include "public/include/core/Context.h"
+#include "public/common/DataStream.h"
 
 #include "H264Mp4ToAnnexB.h"
+#include "StreamInfoCache.h"
+#include "KeyframeIndex.h"
 
 extern "C"
 {
@@ -106,6 +109,7 @@ namespace amf
             AMF_RESULT  CachePacket(AVPacket* pPacket);
             void        ClearPacketCache();
             bool        IsCached();
+            bool        IsCacheFull(amf_size limit) const { return m_bEnabled && limit != 0 && m_packetsCache.size() >= limit; }
             amf_int64   GetPacketCount() { return m_iPacketCount; }
         };
         typedef AMFInterfacePtr_T<AMFOutputDemuxerImpl>    AMFOutputDemuxerImplPtr;
@@ -129,6 +133,17 @@ namespace amf
             virtual ~AMFAudioOutputDemuxerImpl()    {};
         };
 
+    //-------------------------------------------------------------------------------------------------
+
+        // subtitles - packets are passed through as AMF_STREAM_DATA buffers
+        class AMFDataOutputDemuxerImpl :
+            public AMFOutputDemuxerImpl
+        {
+        public:
+            AMFDataOutputDemuxerImpl(AMFFileDemuxerFFMPEGImpl* pHost, amf_int32 index);
+            virtual ~AMFDataOutputDemuxerImpl()     {};
+        };
+
 
     public:
         // interface access
@@ -189,10 +204,14 @@ namespace amf
         AMF_RESULT AMF_STD_CALL  Close();
 
         // helper functions
+        AVPacket*  AMF_STD_CALL  AllocPacket();
+        void       AMF_STD_CALL  ReleasePacket(AVPacket* pPacket);
         AMF_RESULT AMF_STD_CALL  ReadPacket(AVPacket **packet);
         AMF_RESULT AMF_STD_CALL  FindNextPacket(amf_int32 streamIndex, AVPacket **packet, bool saveSkipped);
         bool       AMF_STD_CALL  OutOfRange();
         void       AMF_STD_CALL  ClearCachedPackets();
+        bool       AMF_STD_CALL  IsOtherCacheFull(amf_int32 streamIndex) const;
+        bool       AMF_STD_CALL  IsStreamSelected(amf_int32 streamIndex, amf_int64 selection, const amf_vector<amf_int32>& list) const;
 
         AMF_RESULT AMF_STD_CALL  BufferFromPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer);
         AMF_RESULT AMF_STD_CALL  UpdateBufferProperties(AMFBuffer* pBuffer, const AVPacket* pPacket);
@@ -215,6 +234,7 @@ namespace amf
       mutable AMFCriticalSection  m_sync;
 
         AMFContextPtr                        m_pContext;
+        amf_vector<AVPacket*>                m_PacketPool;   // released AVPacket structs for reuse
         amf_vector<AMFOutputDemuxerImplPtr>  m_OutputStreams;
 
         amf_int32               FromFFmpegToOutputIndex(amf_int32 indexFFmpeg);
@@ -223,6 +243,11 @@ namespace amf
         // member variables from AMFDemuxerFFMPEG
         AVFormatContext*        m_pInputContext;
         amf_wstring             m_Url;
+        AMFDataStreamPtr        m_pDataStream;          // custom I/O backend, NULL when FFmpeg opens the file itself
+        bool                    m_bCloseDataStream;     // the stream was opened from Path by the demuxer
+        AVIOContext*            m_pIOContext;
+        AMFStreamInfoCache      m_StreamInfoCache;      // enabled for local files only
+        AMFKeyframeIndex        m_KeyframeIndex;        // enabled for local files only
 //        bool                    m_bSyncAV;
 
         amf_int64               m_iPacketCount;
@@ -230,6 +255,8 @@ namespace amf
         bool                    m_bTerminated;
         bool                    m_bForceEof;
         bool                    m_bStreamingMode;
+        bool                    m_bZeroCopy;
+        amf_size                m_iStreamCacheSize;     // packets per enabled output, 0 - unlimited
 
         amf_pts                 m_ptsDuration;
         amf_pts                 m_ptsPosition;
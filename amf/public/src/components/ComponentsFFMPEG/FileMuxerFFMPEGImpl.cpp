@@ -68,6 +68,10 @@ extern "C"
 #define AMF_FACILITY            L"AMFFileMuxerFFMPEGImpl"
 #define MY_AV_NOPTS_VALUE       ((int64_t)0x8000000000000000LL)
 
+#define WRITE_QUEUE_DEPTH_DEFAULT       256
+#define WRITE_QUEUE_MEMORY_DEFAULT      (64 * 1024 * 1024)
+#define WRITER_WAIT_TIMEOUT             50  // ms
+
 using namespace amf;
 
 
@@ -310,13 +314,25 @@ AMFFileMuxerFFMPEGImpl::AMFFileMuxerFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_pOutputContext(NULL),
     m_bHeaderIsWritten(false),
+    m_bCloseDataStream(false),
     m_bTerminated(true),
     m_bForceEof(false),
     m_iViewFrameCount(0),
     m_ptsStatTime(0),
     m_bPtsOffsetIsCalculated(false),
     m_ptsOffset(0),
-    m_isUsageTrim(false)
+    m_isUsageTrim(false),
+    m_bWriteBehind(false),
+    m_iWriteQueueDepth(WRITE_QUEUE_DEPTH_DEFAULT),
+    m_iWriteQueueMemory(WRITE_QUEUE_MEMORY_DEFAULT),
+    m_WriterThread(this),
+    m_iWriteQueueBytes(0),
+    m_eWriteError(AMF_OK),
+    m_bWriterStop(false),
+    m_WriteQueueDataEvent(false, false),
+    m_WriteQueueSpaceEvent(false, false),
+    m_iStatWriteStalls(0),
+    m_ptsStatWriteStallTime(0)
 {
     g_AMFFactory.Init();
 
@@ -327,8 +343,17 @@ AMFFileMuxerFFMPEGImpl::AMFFileMuxerFFMPEGImpl(AMFContext* pContext)
         AMFPropertyInfoBool(FFMPEG_MUXER_ENABLE_AUDIO, L"Enable audio stream", false, true),
         AMFPropertyInfoBool(FFMPEG_MUXER_LISTEN, L"Listen", false, false),
         AMFPropertyInfoBool(FFMPEG_MUXER_USAGE_IS_TRIM, L"is the usage of the muxer to trim a video by remux", false, true),
-        AMFPropertyInfoInterface(FFMPEG_MUXER_CURRENT_TIME_INTERFACE, L"Interface object for getting current time", NULL, false)
-        
+        AMFPropertyInfoInterface(FFMPEG_MUXER_CURRENT_TIME_INTERFACE, L"Interface object for getting current time", NULL, false),
+        AMFPropertyInfoBool(FFMPEG_MUXER_WRITE_BEHIND, L"Write packets on a dedicated I/O thread", false, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_WRITE_QUEUE_DEPTH, L"Write-behind queue depth in packets", WRITE_QUEUE_DEPTH_DEFAULT, 1, INT_MAX, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_WRITE_QUEUE_MEMORY, L"Write-behind queue size in bytes", WRITE_QUEUE_MEMORY_DEFAULT, 1, LLONG_MAX, false),
+        AMFPropertyInfoInterface(FFMPEG_MUXER_DATA_STREAM, L"Output data stream", NULL, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_IO_BUFFER_SIZE, L"I/O buffer size in bytes", 0, 0, INT_MAX, false),
+        AMFPropertyInfoBool(FFMPEG_MUXER_DIRECT_IO, L"Bypass the page cache", false, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_QUEUE_DEPTH, L"Packets in the write-behind queue", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_QUEUE_BYTES, L"Bytes in the write-behind queue", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_WRITE_STALLS, L"Submits blocked by a full write-behind queue", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_WRITE_STALL_TIME, L"Time submits were blocked by a full write-behind queue", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ)
 
     AMFPrimitivePropertyInfoMapEnd
 
@@ -352,6 +377,9 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*forma
     m_pCurrentTime = (AMFCurrentTimePtr)pTmp.GetPtr();
 
     GetProperty(FFMPEG_MUXER_USAGE_IS_TRIM, &m_isUsageTrim);
+    GetProperty(FFMPEG_MUXER_WRITE_BEHIND, &m_bWriteBehind);
+    GetProperty(FFMPEG_MUXER_WRITE_QUEUE_DEPTH, &m_iWriteQueueDepth);
+    GetProperty(FFMPEG_MUXER_WRITE_QUEUE_MEMORY, &m_iWriteQueueMemory);
 
     Close();
     AMF_RESULT res = Open();
@@ -409,6 +437,44 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::GetInput(amf_int32 index, AMFIn
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const
+{
+    AMF_RETURN_IF_INVALID_POINTER(name);
+    AMF_RETURN_IF_INVALID_POINTER(pValue);
+
+    // statistics are tracked by the write-behind queue and read live
+    amf_int64 stat = 0;
+    bool bStat = true;
+    {
+        AMFLock lock(&m_WriteQueueSync);
+        if (wcscmp(name, FFMPEG_MUXER_STAT_QUEUE_DEPTH) == 0)
+        {
+            stat = (amf_int64)m_WriteQueue.size();
+        }
+        else if (wcscmp(name, FFMPEG_MUXER_STAT_QUEUE_BYTES) == 0)
+        {
+            stat = m_iWriteQueueBytes;
+        }
+        else if (wcscmp(name, FFMPEG_MUXER_STAT_WRITE_STALLS) == 0)
+        {
+            stat = m_iStatWriteStalls;
+        }
+        else if (wcscmp(name, FFMPEG_MUXER_STAT_WRITE_STALL_TIME) == 0)
+        {
+            stat = m_ptsStatWriteStallTime;
+        }
+        else
+        {
+            bStat = false;
+        }
+    }
+    if (bStat)
+    {
+        return AMFVariantAssignInt64(pValue, stat);
+    }
+    return AMFPropertyStorageExImpl<AMFComponentEx>::GetProperty(name, pValue);
+}
+//-------------------------------------------------------------------------------------------------
 void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::OnPropertyChanged(const wchar_t* pName)
 {
     AMFLock lock(&m_sync);
@@ -710,12 +776,41 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Open()
         iret = av_dict_set(&options, "rtmp_live", "live", 0);
     }
     // open file
-//    int iret = avio_open(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE);
-    iret = avio_open2(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE, NULL, &options);
+    AMFInterfacePtr pStreamInterface;
+    GetProperty(FFMPEG_MUXER_DATA_STREAM, &pStreamInterface);
+    amf_int64 ioBufferSize = 0;
+    GetProperty(FFMPEG_MUXER_IO_BUFFER_SIZE, &ioBufferSize);
+    bool bDirectIO = false;
+    GetProperty(FFMPEG_MUXER_DIRECT_IO, &bDirectIO);
+
+    if(pStreamInterface != NULL)
+    {
+        m_pDataStream = AMFDataStreamPtr(pStreamInterface);
+        AMF_RETURN_IF_FALSE(m_pDataStream != NULL, AMF_INVALID_ARG, L"Open() - DataStream must be AMFDataStream");
+    }
+    else if(url.length() == 0 && (ioBufferSize > 0 || bDirectIO))
+    {
+        AMF_RESULT res = OpenFileDataStream(path.c_str(), true, bDirectIO, &m_pDataStream);
+        AMF_RETURN_IF_FAILED(res, L"Open() - failed to open %s", path.c_str());
+        m_bCloseDataStream = true;
+    }
 
-    if(iret != 0)
+    if(m_pDataStream != NULL)
     {
-        return AMF_FILE_NOT_OPEN;
+        av_dict_free(&options);
+        m_pOutputContext->pb = CreateAVIOContext(m_pDataStream, true, ioBufferSize);
+        AMF_RETURN_IF_FALSE(m_pOutputContext->pb != NULL, AMF_OUT_OF_MEMORY, L"Open() - CreateAVIOContext() failed");
+        m_pOutputContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+    else
+    {
+//        int iret = avio_open(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE);
+        iret = avio_open2(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE, NULL, &options);
+
+        if(iret != 0)
+        {
+            return AMF_FILE_NOT_OPEN;
+        }
     }
 
     AMF_RESULT err = WriteHeader();
@@ -728,21 +823,45 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Open()
     }
     m_iViewFrameCount = 0;
     m_ptsStatTime = 0;
+
+    if (m_bWriteBehind)
+    {
+        StartWriter();
+    }
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Close()
 {
+    // write everything still queued before the trailer
+    StopWriter();
+
     if(m_pOutputContext && m_pOutputContext->pb)
     {
         if(m_bHeaderIsWritten)
         {
             av_write_trailer(m_pOutputContext);
         }
-        avio_close(m_pOutputContext->pb);
+        if(m_pDataStream != NULL)
+        {
+            DestroyAVIOContext(&m_pOutputContext->pb);
+        }
+        else
+        {
+            avio_close(m_pOutputContext->pb);
+        }
         m_pOutputContext->pb = 0;
         m_pOutputContext->oformat = 0;
     }
+    if(m_pDataStream != NULL)
+    {
+        if(m_bCloseDataStream)
+        {
+            m_pDataStream->Close();
+        }
+        m_pDataStream.Release();
+        m_bCloseDataStream = false;
+    }
     FreeContext();
     return AMF_OK;
 }
@@ -770,11 +889,6 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WriteData(AMFData* pData, amf_i
     if (pData)
     {
         m_bForceEof = false;
-        AVStream *ost = m_pOutputContext->streams[iIndex];
-
-        // fill packet
-        AVPacket  pkt = {};
-        av_init_packet(&pkt);
 
         AMFBufferPtr pInBuffer(pData);
         AMF_RETURN_IF_FALSE(pInBuffer != 0,AMF_INVALID_ARG, L"WriteData() - Input should be Buffer");
@@ -782,127 +896,262 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WriteData(AMFData* pData, amf_i
         AMF_RESULT err = pInBuffer->Convert(AMF_MEMORY_HOST);
         AMF_RETURN_IF_FAILED(err, L"WriteData() - Convert(AMF_MEMORY_HOST) failed");
 
-        amf_size uiMemSizeIn = pInBuffer->GetSize();
-        AMF_RETURN_IF_FALSE(uiMemSizeIn!=0, AMF_INVALID_ARG, L"WriteData() - Invalid param");
+        AMF_RETURN_IF_FALSE(pInBuffer->GetSize() != 0, AMF_INVALID_ARG, L"WriteData() - Invalid param");
 
-        pkt.data = static_cast<uint8_t*>(pInBuffer->GetNative());
-        pkt.size = (int)uiMemSizeIn;
-        pkt.stream_index = iIndex;
+        if (m_WriterThread.IsRunning())
+        {
+            err = QueuePacket(pInBuffer, iIndex);
+        }
+        else
+        {
+            err = WritePacket(pInBuffer, iIndex);
+        }
+        AMF_RETURN_IF_FAILED(err, L"WriteData() - failed to write packet");
+    }
+    // check if all streams reached EOF
+    if (!pData || m_bForceEof)
+    {
+        m_bEofList[iIndex] = true;
+    }
+    for(amf_size i=0; i < m_bEofList.size(); i++)
+    {
+        if (!m_bEofList[i])
+        {
+            return AMF_OK;
+        }
+    }
+    Close(); // EOF detected - close the file
+    return AMF_EOF;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WritePacket(AMFBuffer* pBuffer, amf_int32 iIndex)
+{
+    AVStream *ost = m_pOutputContext->streams[iIndex];
+
+    // fill packet
+    AVPacket  pkt = {};
+    av_init_packet(&pkt);
 
-        if (m_isUsageTrim)
+    AMFData* pData = pBuffer;
+
+    pkt.data = static_cast<uint8_t*>(pBuffer->GetNative());
+    pkt.size = (int)pBuffer->GetSize();
+    pkt.stream_index = iIndex;
+
+    if (m_isUsageTrim)
+    {
+        amf_int64 flags = 0;
+        if (AMF_OK == pData->GetProperty(L"FFMPEG:flags", &flags))
         {
-            amf_int64 flags = 0;
-            if (AMF_OK == pData->GetProperty(L"FFMPEG:flags", &flags))
-            {
-                pkt.flags = flags;
-            }
-                
+            pkt.flags = flags;
         }
+            
+    }
 
-        // Try to determine the output video frame type
-        amf_int64 outputDataType = -1;
-        if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE, &outputDataType))
+    // Try to determine the output video frame type
+    amf_int64 outputDataType = -1;
+    if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE, &outputDataType))
+    {
+        // set key flag for key frames
+        if (outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_IDR || outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_I)
         {
-            // set key flag for key frames
-            if (outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_IDR || outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_I)
-            {
-                pkt.flags |= AV_PKT_FLAG_KEY;
-            }
+            pkt.flags |= AV_PKT_FLAG_KEY;
         }
-        else if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE, &outputDataType))
+    }
+    else if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE, &outputDataType))
+    {
+        if (outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_I || outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_IDR)
         {
-            if (outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_I || outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_IDR)
-            {
-                pkt.flags |= AV_PKT_FLAG_KEY;
-            }
+            pkt.flags |= AV_PKT_FLAG_KEY;
         }
+    }
 
-        // resample pts
-        amf_pts pts = pData->GetPts();
-        amf_pts duration = pData->GetDuration();
+    // resample pts
+    amf_pts pts = pData->GetPts();
+    amf_pts duration = pData->GetDuration();
 
-        pkt.duration = av_rescale_q(duration, AMF_TIME_BASE_Q, ost->time_base);
+    pkt.duration = av_rescale_q(duration, AMF_TIME_BASE_Q, ost->time_base);
 
-        amf_pts dts = pts;
-        if (ost->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+    amf_pts dts = pts;
+    if (ost->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+    {
+        if (pData->GetProperty(AMF_VIDEO_ENCODER_PRESENTATION_TIME_STAMP, &pts) == AMF_OK)
         {
-            if (pData->GetProperty(AMF_VIDEO_ENCODER_PRESENTATION_TIME_STAMP, &pts) == AMF_OK)
+            if (!m_bPtsOffsetIsCalculated && ((pkt.flags & AV_PKT_FLAG_KEY) != 0))
             {
-                if (!m_bPtsOffsetIsCalculated && ((pkt.flags & AV_PKT_FLAG_KEY) != 0))
+                // calculate offset for preventing PTS < DTS
+                if (pts == dts)
                 {
-                    // calculate offset for preventing PTS < DTS
-                    if (pts == dts)
-                    {
-                        m_ptsOffset = duration;
-                    }
-                    else if (pts > dts)
-                    {
-                        // PTS and DTS set by encoder are the same for the first frame
-                        // adjust PTS by the same offset applied to DTS by upstream application
-                        m_ptsOffset = duration - pts + dts;
-                    }
-
-                    m_bPtsOffsetIsCalculated = true;
+                    m_ptsOffset = duration;
                 }
-
-                pts += m_ptsOffset;
-
-                // PTS can be smaller than DTS when there are large gaps in input PTS
-                // in which case set PTS = DTS
-                if (pts < dts)
+                else if (pts > dts)
                 {
-                    pts = dts;
+                    // PTS and DTS set by encoder are the same for the first frame
+                    // adjust PTS by the same offset applied to DTS by upstream application
+                    m_ptsOffset = duration - pts + dts;
                 }
+
+                m_bPtsOffsetIsCalculated = true;
             }
-        }
 
-        pkt.pts=av_rescale_q(pts, AMF_TIME_BASE_Q, ost->time_base);
-        if (ost->cur_dts == pkt.pts && ost->codec->codec_type == AVMEDIA_TYPE_AUDIO) // MM sometimes time_base doesn't have enough precision for the a buffer with small number of compressed samples producing the same dts. AVI muxder fails with this
-        {
-            pkt.pts++;
-        }
+            pts += m_ptsOffset;
 
-        if (dts != pts)
-        {
-            pkt.dts = av_rescale_q(dts, AMF_TIME_BASE_Q, ost->time_base);
-        }
-        else
-        {
-            pkt.dts = pkt.pts;
+            // PTS can be smaller than DTS when there are large gaps in input PTS
+            // in which case set PTS = DTS
+            if (pts < dts)
+            {
+                pts = dts;
+            }
         }
+    }
+
+    pkt.pts=av_rescale_q(pts, AMF_TIME_BASE_Q, ost->time_base);
+    if (ost->cur_dts == pkt.pts && ost->codec->codec_type == AVMEDIA_TYPE_AUDIO) // MM sometimes time_base doesn't have enough precision for the a buffer with small number of compressed samples producing the same dts. AVI muxder fails with this
+    {
+        pkt.pts++;
+    }
+
+    if (dts != pts)
+    {
+        pkt.dts = av_rescale_q(dts, AMF_TIME_BASE_Q, ost->time_base);
+    }
+    else
+    {
+        pkt.dts = pkt.pts;
+    }
 
 //        amf_int64 ptsFFmpeg = pkt.pts;
-        if (av_interleaved_write_frame(m_pOutputContext,&pkt)<0)
+    if (av_interleaved_write_frame(m_pOutputContext,&pkt)<0)
+    {
+        return AMF_FAIL;
+    }
+
+    if(ost->codec->codec_type == AVMEDIA_TYPE_VIDEO && m_pCurrentTime != nullptr)
+    {
+        m_ptsStatTime += m_pCurrentTime->Get() - pData->GetPts();
+
+        m_iViewFrameCount++;
+        if((m_iViewFrameCount % 100) == 0)
         {
-            return AMF_FAIL;
+//                AMFTraceWarning(AMF_FACILITY, L" Averate Latency=%5.2f", m_ptsStatTime / 100. / 10000.);
+            m_ptsStatTime = 0;
         }
-
-        if(ost->codec->codec_type == AVMEDIA_TYPE_VIDEO && m_pCurrentTime != nullptr)
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::QueuePacket(AMFBuffer* pBuffer, amf_int32 iIndex)
+{
+    const amf_int64 size = (amf_int64)pBuffer->GetSize();
+    amf_pts startStall = 0;
+    for (;;)
+    {
         {
-            m_ptsStatTime += m_pCurrentTime->Get() - pData->GetPts();
+            AMFLock lock(&m_WriteQueueSync);
+            AMF_RETURN_IF_FAILED(m_eWriteError, L"QueuePacket() - I/O thread failed to write");
 
-            m_iViewFrameCount++;
-            if((m_iViewFrameCount % 100) == 0)
+            // an empty queue takes any packet so one above the memory limit doesn't block forever
+            if (m_WriteQueue.empty() ||
+                ((amf_int64)m_WriteQueue.size() < m_iWriteQueueDepth && m_iWriteQueueBytes + size <= m_iWriteQueueMemory))
             {
-//                AMFTraceWarning(AMF_FACILITY, L" Averate Latency=%5.2f", m_ptsStatTime / 100. / 10000.);
-                m_ptsStatTime = 0;
+                WriteRequest request = { pBuffer, iIndex };
+                m_WriteQueue.push_back(request);
+                m_iWriteQueueBytes += size;
+                if (startStall != 0)
+                {
+                    m_ptsStatWriteStallTime += amf_high_precision_clock() - startStall;
+                }
+                break;
+            }
+            if (startStall == 0)
+            {
+                startStall = amf_high_precision_clock();
+                m_iStatWriteStalls++;
             }
         }
+        m_WriteQueueSpaceEvent.Lock(WRITER_WAIT_TIMEOUT);
     }
-    // check if all streams reached EOF
-    if (!pData || m_bForceEof)
+    m_WriteQueueDataEvent.SetEvent();
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::StartWriter()
+{
     {
-        m_bEofList[iIndex] = true;
+        AMFLock lock(&m_WriteQueueSync);
+        m_WriteQueue.clear();
+        m_iWriteQueueBytes = 0;
+        m_eWriteError = AMF_OK;
+        m_bWriterStop = false;
+        m_iStatWriteStalls = 0;
+        m_ptsStatWriteStallTime = 0;
     }
-    for(amf_size i=0; i < m_bEofList.size(); i++)
+    m_WriterThread.Start();
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::StopWriter()
+{
+    if (!m_WriterThread.IsRunning())
     {
-        if (!m_bEofList[i])
+        return;
+    }
+    {
+        AMFLock lock(&m_WriteQueueSync);
+        m_bWriterStop = true;
+    }
+    m_WriteQueueDataEvent.SetEvent();
+    m_WriterThread.WaitForStop();
+
+    AMFLock lock(&m_WriteQueueSync);
+    m_WriteQueue.clear();
+    m_iWriteQueueBytes = 0;
+}
+//-------------------------------------------------------------------------------------------------
+// runs on the I/O thread; m_sync is not taken here so submitters only wait for queue space
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WriterLoop()
+{
+    for (;;)
+    {
+        WriteRequest request = {};
+        bool bWriteFailed = false;
         {
-            return AMF_OK;
+            AMFLock lock(&m_WriteQueueSync);
+            if (m_WriteQueue.empty())
+            {
+                if (m_bWriterStop)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                request = m_WriteQueue.front();
+                bWriteFailed = m_eWriteError != AMF_OK;
+            }
+        }
+        if (request.pBuffer == NULL)
+        {
+            m_WriteQueueDataEvent.Lock(WRITER_WAIT_TIMEOUT);
+            continue;
+        }
+
+        // after a failure the rest of the queue is dropped so submitters don't block
+        AMF_RESULT res = bWriteFailed ? AMF_OK : WritePacket(request.pBuffer, request.iIndex);
+        if (res != AMF_OK)
+        {
+            AMFTraceError(AMF_FACILITY, L"WriterLoop() - failed to write packet, stream# %d", request.iIndex);
+        }
+        {
+            AMFLock lock(&m_WriteQueueSync);
+            m_WriteQueue.pop_front();
+            m_iWriteQueueBytes -= (amf_int64)request.pBuffer->GetSize();
+            if (res != AMF_OK && m_eWriteError == AMF_OK)
+            {
+                m_eWriteError = res;
+            }
         }
+        m_WriteQueueSpaceEvent.SetEvent();
     }
-    Close(); // EOF detected - close the file
-    return AMF_EOF;
 }
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
@@ -51,6 +51,8 @@ extern "C"
 #include "public/include/components/Component.h"
 #include "public/include/components/FFMPEGFileMuxer.h"
 #include "public/common/PropertyStorageExImpl.h"
+#include "public/common/Thread.h"
+#include "public/common/DataStream.h"
 #include "public/include/core/Context.h"
 #include "public/include/core/CurrentTime.h"
 
@@ -160,6 +162,10 @@ namespace amf
         virtual AMF_RESULT  AMF_STD_CALL  GetInput(amf_int32 index, AMFInput** ppInput);
         virtual AMF_RESULT  AMF_STD_CALL  GetOutput(amf_int32 /*index*/, AMFOutput** /*ppOutput*/)          {  return AMF_NOT_SUPPORTED;  };
 
+        // AMFPropertyStorage interface
+        using AMFPropertyStorageExImpl<AMFComponentEx>::GetProperty;
+        virtual AMF_RESULT  AMF_STD_CALL  GetProperty(const wchar_t* name, AMFVariantStruct* pValue) const;
+
         // AMFPropertyStorageObserver interface
         virtual void        AMF_STD_CALL  OnPropertyChanged(const wchar_t* pName);
 
@@ -172,6 +178,28 @@ namespace amf
 
         AMF_RESULT AMF_STD_CALL     WriteHeader();
         AMF_RESULT AMF_STD_CALL     WriteData(AMFData* pData, amf_int32 iIndex);
+        AMF_RESULT AMF_STD_CALL     WritePacket(AMFBuffer* pBuffer, amf_int32 iIndex);
+
+        // write-behind
+        AMF_RESULT AMF_STD_CALL     QueuePacket(AMFBuffer* pBuffer, amf_int32 iIndex);
+        void       AMF_STD_CALL     StartWriter();
+        void       AMF_STD_CALL     StopWriter();
+        void       AMF_STD_CALL     WriterLoop();
+
+        struct WriteRequest
+        {
+            AMFBufferPtr    pBuffer;
+            amf_int32       iIndex;
+        };
+
+        class WriterThread : public AMFThread
+        {
+        public:
+            WriterThread(AMFFileMuxerFFMPEGImpl* pHost) : m_pHost(pHost) {}
+            virtual void Run() { m_pHost->WriterLoop(); }
+        private:
+            AMFFileMuxerFFMPEGImpl* m_pHost;
+        };
     private:
       mutable AMFCriticalSection  m_sync;
 
@@ -181,6 +209,8 @@ namespace amf
         // member variables from AMFMuxerFMPEG
         AVFormatContext*        m_pOutputContext;
         bool                    m_bHeaderIsWritten;
+        AMFDataStreamPtr        m_pDataStream;          // custom I/O backend, NULL when FFmpeg opens the file itself
+        bool                    m_bCloseDataStream;     // the stream was opened from Path by the muxer
 //
         amf_vector<bool>        m_bEofList;
 
@@ -195,6 +225,20 @@ namespace amf
         bool                    m_bPtsOffsetIsCalculated;
         amf_pts                 m_ptsOffset;
         bool                    m_isUsageTrim;
+
+        bool                        m_bWriteBehind;
+        amf_int64                   m_iWriteQueueDepth;
+        amf_int64                   m_iWriteQueueMemory;
+        WriterThread                m_WriterThread;
+        mutable AMFCriticalSection  m_WriteQueueSync;
+        amf_deque<WriteRequest>     m_WriteQueue;      // the front request stays queued while it is written
+        amf_int64                   m_iWriteQueueBytes;
+        AMF_RESULT                  m_eWriteError;
+        bool                        m_bWriterStop;
+        AMFEvent                    m_WriteQueueDataEvent;
+        AMFEvent                    m_WriteQueueSpaceEvent;
+        amf_int64                   m_iStatWriteStalls;
+        amf_pts                     m_ptsStatWriteStallTime;
     };
 
  //   typedef AMFInterfacePtr_T<AMFFileMuxerFFMPEGImpl>    AMFFileMuxerFFMPEGPtr;
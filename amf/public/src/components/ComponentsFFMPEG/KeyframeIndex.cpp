@@ -0,0 +1,359 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "KeyframeIndex.h"
+#include "public/common/TraceAdapter.h"
+
+#include <algorithm>
+
+#define AMF_FACILITY L"AMFKeyframeIndex"
+
+using namespace amf;
+
+namespace
+{
+    const amf_uint32 KEYFRAME_INDEX_MAGIC    = 0x49464B41; // "AKFI"
+    const amf_uint32 KEYFRAME_INDEX_VERSION  = 2;
+    const amf_size   KEYFRAME_INDEX_MAX_SIZE = 256 * 1024 * 1024;
+
+    bool EntryPtsLess(const AMFKeyframeIndex::Entry& left, const AMFKeyframeIndex::Entry& right)
+    {
+        return left.pts < right.pts;
+    }
+    bool EntryPtsLessValue(const AMFKeyframeIndex::Entry& left, amf_int64 pts)
+    {
+        return left.pts < pts;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+AMFKeyframeIndex::AMFKeyframeIndex()
+  : m_bReady(false),
+    m_Thread(this)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMFKeyframeIndex::~AMFKeyframeIndex()
+{
+    Stop();
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndex::Start(const wchar_t* filePath, const wchar_t* sidecarPath, const AVFormatContext* pContext)
+{
+    Stop();
+    if (pContext == NULL || pContext->nb_streams == 0 || !GetCacheFileKey(filePath, m_Key))
+    {
+        return;
+    }
+    m_FilePath = filePath;
+    if (sidecarPath != NULL && sidecarPath[0] != 0)
+    {
+        m_SidecarPath = sidecarPath;
+    }
+    else
+    {
+        m_SidecarPath = m_FilePath + L".kfi";
+    }
+
+    m_Layout.resize(pContext->nb_streams);
+    for (amf_uint32 i = 0; i < pContext->nb_streams; i++)
+    {
+        const AVStream* pStream = pContext->streams[i];
+        m_Layout[i].timeBase = pStream->time_base;
+        m_Layout[i].bVideo = pStream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO &&
+            (pStream->disposition & AV_DISPOSITION_ATTACHED_PIC) == 0;
+    }
+
+    StreamIndexList streams = m_Layout;
+    if (Load(streams))
+    {
+        AMFLock lock(&m_Sync);
+        m_Streams.swap(streams);
+        m_bReady = true;
+        return;
+    }
+    m_Thread.Start();
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndex::Stop()
+{
+    m_Thread.RequestStop();
+    m_Thread.WaitForStop();
+    AMFLock lock(&m_Sync);
+    m_bReady = false;
+    m_Streams.clear();
+    m_Layout.clear();
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFKeyframeIndex::IsReady() const
+{
+    AMFLock lock(&m_Sync);
+    return m_bReady;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFKeyframeIndex::Find(amf_int32 stream, amf_int64 pts, bool bForward, Entry& entry, amf_int32& decodeFrames) const
+{
+    AMFLock lock(&m_Sync);
+    if (!m_bReady || stream < 0 || stream >= (amf_int32)m_Streams.size())
+    {
+        return false;
+    }
+    const StreamIndex& index = m_Streams[stream];
+    if (index.entries.empty())
+    {
+        return false;
+    }
+
+    // first keyframe at or after pts
+    amf_vector<Entry>::const_iterator it = std::lower_bound(index.entries.begin(), index.entries.end(), pts, EntryPtsLessValue);
+    if (bForward)
+    {
+        if (it == index.entries.end())
+        {
+            return false;
+        }
+        entry = *it;
+        decodeFrames = 0;
+        return true;
+    }
+    // before the first keyframe there is nothing earlier to decode from
+    if ((it == index.entries.end() || it->pts > pts) && it != index.entries.begin())
+    {
+        --it;
+    }
+    entry = *it;
+
+    // with reordering the frames presented before pts are not the leading packets in decode order,
+    // so count up to the last of them; past the next keyframe only its leading pictures can qualify
+    const amf_int32 count = (amf_int32)index.packetPts.size();
+    const amf_int32 gopEnd = entry.firstPacket + entry.gopLength;
+    const amf_int64 nextKeyPts = gopEnd < count ? index.packetPts[gopEnd] : AV_NOPTS_VALUE;
+    decodeFrames = 0;
+    for (amf_int32 i = entry.firstPacket; i < count; i++)
+    {
+        const amf_int64 packetPts = index.packetPts[i];
+        if (i > gopEnd && (packetPts == AV_NOPTS_VALUE || nextKeyPts == AV_NOPTS_VALUE || packetPts >= nextKeyPts))
+        {
+            break;
+        }
+        if (packetPts != AV_NOPTS_VALUE && packetPts < pts)
+        {
+            decodeFrames = i - entry.firstPacket + 1;
+        }
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndex::BuildLoop()
+{
+    const amf_pts start = amf_high_precision_clock();
+
+    StreamIndexList streams = m_Layout;
+    if (Scan(streams) != AMF_OK)
+    {
+        return;
+    }
+    amf_size count = 0;
+    for (amf_size i = 0; i < streams.size(); i++)
+    {
+        std::sort(streams[i].entries.begin(), streams[i].entries.end(), EntryPtsLess);
+        count += streams[i].entries.size();
+    }
+    AMFTraceInfo(AMF_FACILITY, L"BuildLoop() - %d keyframes indexed in %.1f ms", (int)count,
+        (double)(amf_high_precision_clock() - start) / 10000.);
+
+    Save(streams);
+
+    AMFLock lock(&m_Sync);
+    m_Streams.swap(streams);
+    m_bReady = true;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndex::Scan(StreamIndexList& streams)
+{
+    const amf_string url = amf_string("file:") + amf_from_unicode_to_utf8(m_FilePath);
+    AVFormatContext* pContext = NULL;
+    AMF_RETURN_IF_FALSE(avformat_open_input(&pContext, url.c_str(), NULL, NULL) >= 0, AMF_NOT_FOUND,
+        L"Scan() - failed to open %s", m_FilePath.c_str());
+
+    AMF_RESULT res = AMF_OK;
+    if (avformat_find_stream_info(pContext, NULL) < 0 || pContext->nb_streams != streams.size())
+    {
+        res = AMF_NOT_SUPPORTED;
+    }
+    for (amf_uint32 i = 0; i < pContext->nb_streams && res == AMF_OK; i++)
+    {
+        if (av_cmp_q(pContext->streams[i]->time_base, streams[i].timeBase) != 0)
+        {
+            res = AMF_NOT_SUPPORTED;
+        }
+        // skipped packets are still read but not parsed or returned
+        pContext->streams[i]->discard = streams[i].bVideo ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+    AVPacket* pPacket = res == AMF_OK ? av_packet_alloc() : NULL;
+    if (res == AMF_OK && pPacket == NULL)
+    {
+        res = AMF_OUT_OF_MEMORY;
+    }
+
+    while (res == AMF_OK && av_read_frame(pContext, pPacket) >= 0)
+    {
+        if (m_Thread.StopRequested())
+        {
+            res = AMF_EOF;
+        }
+        else if (pPacket->stream_index >= 0 && pPacket->stream_index < (int)streams.size() && streams[pPacket->stream_index].bVideo)
+        {
+            StreamIndex& index = streams[pPacket->stream_index];
+            const amf_int64 pts = pPacket->pts != AV_NOPTS_VALUE ? pPacket->pts : pPacket->dts;
+            if ((pPacket->flags & AV_PKT_FLAG_KEY) != 0 && pts != AV_NOPTS_VALUE)
+            {
+                Entry entry = { pts, pPacket->pos, 1, (amf_int32)index.packetPts.size() };
+                index.entries.push_back(entry);
+                index.packetPts.push_back(pts);
+            }
+            else if (!index.entries.empty())
+            {
+                index.entries.back().gopLength++;
+                index.packetPts.push_back(pts);
+            }
+        }
+        av_packet_unref(pPacket);
+    }
+    av_packet_free(&pPacket);
+    avformat_close_input(&pContext);
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFKeyframeIndex::Load(StreamIndexList& streams) const
+{
+    amf_vector<amf_uint8> data;
+    if (!ReadCacheFile(m_SidecarPath, KEYFRAME_INDEX_MAX_SIZE, data))
+    {
+        return false;
+    }
+    AMFCacheReader reader(&data[0], data.size());
+    if (reader.Get<amf_uint32>() != KEYFRAME_INDEX_MAGIC || reader.Get<amf_uint32>() != KEYFRAME_INDEX_VERSION)
+    {
+        return false;
+    }
+    amf_int32 keySize = 0;
+    const amf_uint8* pKey = reader.GetBytes(keySize);
+    if (!reader.IsValid() || amf_string(reinterpret_cast<const char*>(pKey), keySize) != m_Key)
+    {
+        return false;
+    }
+    if (reader.Get<amf_uint32>() != streams.size())
+    {
+        return false;
+    }
+    for (amf_size i = 0; i < streams.size(); i++)
+    {
+        StreamIndex& index = streams[i];
+        const AVRational timeBase = reader.GetRational();
+        const amf_uint32 count = reader.Get<amf_uint32>();
+        if (!reader.IsValid() || av_cmp_q(timeBase, index.timeBase) != 0 ||
+            count > reader.GetRemaining() / (sizeof(amf_int64) * 2 + sizeof(amf_int32) * 2))
+        {
+            return false;
+        }
+        index.entries.resize(count);
+        for (amf_uint32 k = 0; k < count; k++)
+        {
+            index.entries[k].pts = reader.Get<amf_int64>();
+            index.entries[k].pos = reader.Get<amf_int64>();
+            index.entries[k].gopLength = reader.Get<amf_int32>();
+            index.entries[k].firstPacket = reader.Get<amf_int32>();
+        }
+        const amf_uint32 packets = reader.Get<amf_uint32>();
+        if (!reader.IsValid() || packets > reader.GetRemaining() / sizeof(amf_int64))
+        {
+            return false;
+        }
+        index.packetPts.resize(packets);
+        for (amf_uint32 k = 0; k < packets; k++)
+        {
+            index.packetPts[k] = reader.Get<amf_int64>();
+        }
+        // Find() walks packetPts from every keyframe, a damaged entry must not point outside of it
+        for (amf_uint32 k = 0; k < count; k++)
+        {
+            const Entry& entry = index.entries[k];
+            if (entry.firstPacket < 0 || entry.gopLength < 1 || (amf_int64)entry.firstPacket + entry.gopLength > (amf_int64)packets)
+            {
+                return false;
+            }
+        }
+    }
+    if (!reader.IsValid())
+    {
+        AMFTraceWarning(AMF_FACILITY, L"Load() - ignoring damaged index %s", m_SidecarPath.c_str());
+        return false;
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndex::Save(const StreamIndexList& streams) const
+{
+    AMFCacheWriter writer;
+    writer.Put(KEYFRAME_INDEX_MAGIC);
+    writer.Put(KEYFRAME_INDEX_VERSION);
+    writer.PutBytes(m_Key.c_str(), (amf_int32)m_Key.length());
+    writer.Put((amf_uint32)streams.size());
+    for (amf_size i = 0; i < streams.size(); i++)
+    {
+        const StreamIndex& index = streams[i];
+        writer.PutRational(index.timeBase);
+        writer.Put((amf_uint32)index.entries.size());
+        for (amf_size k = 0; k < index.entries.size(); k++)
+        {
+            writer.Put((amf_int64)index.entries[k].pts);
+            writer.Put((amf_int64)index.entries[k].pos);
+            writer.Put((amf_int32)index.entries[k].gopLength);
+            writer.Put((amf_int32)index.entries[k].firstPacket);
+        }
+        writer.Put((amf_uint32)index.packetPts.size());
+        for (amf_size k = 0; k < index.packetPts.size(); k++)
+        {
+            writer.Put((amf_int64)index.packetPts[k]);
+        }
+    }
+    // the media folder may be read-only - the index still serves this session
+    AMF_RESULT res = WriteCacheFile(m_SidecarPath, writer.GetData());
+    if (res != AMF_OK)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"Save() - index not saved to %s", m_SidecarPath.c_str());
+    }
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
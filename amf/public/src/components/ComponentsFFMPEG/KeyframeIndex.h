@@ -0,0 +1,109 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "StreamInfoCache.h"
+#include "public/common/Thread.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Index of the video keyframes of a local file: pts, byte offset and GOP length per keyframe,
+    // plus the pts of every video packet in decode order so seek distances are exact.
+    // A sidecar file matching path, size and time of the media is loaded at once; otherwise a
+    // background thread scans the file with its own demuxer context and writes the sidecar, so
+    // opening is never delayed and seeks fall back to the demuxer until the index is ready.
+    //-------------------------------------------------------------------------------------------------
+    class AMFKeyframeIndex
+    {
+    public:
+        struct Entry
+        {
+            amf_int64   pts;            // in stream time base
+            amf_int64   pos;            // byte offset, -1 if the demuxer does not report it
+            amf_int32   gopLength;      // packets from this keyframe up to the next one
+            amf_int32   firstPacket;    // keyframe position in StreamIndex::packetPts
+        };
+
+        AMFKeyframeIndex();
+        ~AMFKeyframeIndex();
+
+        // sidecarPath empty = filePath + ".kfi"; pContext gives the stream layout to match
+        void        Start(const wchar_t* filePath, const wchar_t* sidecarPath, const AVFormatContext* pContext);
+        void        Stop();
+        bool        IsReady() const;
+
+        // nearest keyframe at or before pts, or at or after it if bForward; decodeFrames receives
+        // the number of packets, counted in decode order from the keyframe, that have to be decoded
+        // until every frame presented before pts is out
+        bool        Find(amf_int32 stream, amf_int64 pts, bool bForward, Entry& entry, amf_int32& decodeFrames) const;
+
+    private:
+        struct StreamIndex
+        {
+            AVRational          timeBase;
+            bool                bVideo;
+            amf_vector<Entry>   entries;
+            amf_vector<amf_int64> packetPts;  // from the first keyframe on, AV_NOPTS_VALUE if unknown
+        };
+        typedef amf_vector<StreamIndex> StreamIndexList;
+
+        class BuilderThread : public AMFThread
+        {
+        public:
+            BuilderThread(AMFKeyframeIndex* pHost) : m_pHost(pHost) {}
+            virtual void Run() { m_pHost->BuildLoop(); }
+        private:
+            AMFKeyframeIndex* m_pHost;
+        };
+
+        void        BuildLoop();
+        AMF_RESULT  Scan(StreamIndexList& streams);
+        bool        Load(StreamIndexList& streams) const;
+        AMF_RESULT  Save(const StreamIndexList& streams) const;
+
+        mutable AMFCriticalSection  m_Sync;
+        StreamIndexList     m_Streams;      // valid when m_bReady
+        bool                m_bReady;
+
+        // set by Start() before the builder runs
+        StreamIndexList     m_Layout;
+        amf_wstring         m_FilePath;
+        amf_wstring         m_SidecarPath;
+        amf_string          m_Key;
+        BuilderThread       m_Thread;
+
+        AMFKeyframeIndex(const AMFKeyframeIndex&);
+        AMFKeyframeIndex& operator=(const AMFKeyframeIndex&);
+    };
+}
@@ -0,0 +1,632 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "PlaneCopyKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define AMF_PLANE_COPY_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define AMF_TARGET_SSE2
+        #define AMF_TARGET_SSSE3
+        #define AMF_TARGET_AVX2
+        #define AMF_TARGET_AVX512
+    #else
+        #define AMF_TARGET_SSE2     __attribute__((target("sse2")))
+        #define AMF_TARGET_SSSE3    __attribute__((target("ssse3")))
+        #define AMF_TARGET_AVX2     __attribute__((target("avx2")))
+        #define AMF_TARGET_AVX512   __attribute__((target("avx512f,avx512bw")))
+    #endif
+#else
+    #define AMF_PLANE_COPY_X86 0
+#endif
+
+using namespace amf;
+
+//-------------------------------------------------------------------------------------------------
+// scalar reference kernels
+//-------------------------------------------------------------------------------------------------
+static void ShiftLeft16_Scalar(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[x] = amf_uint16(pSrc[x] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV8_Scalar(amf_uint8* pDst, const amf_uint8* pSrcU, const amf_uint8* pSrcV, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[2 * x + 0] = pSrcU[x];
+        pDst[2 * x + 1] = pSrcV[x];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV16_Scalar(amf_uint16* pDst, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[2 * x + 0] = amf_uint16(pSrcU[x] << shift);
+        pDst[2 * x + 1] = amf_uint16(pSrcV[x] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void PackY210_Scalar(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = amf_uint16(pSrcU[x] << shift);
+        pDst[4 * x + 1] = amf_uint16(pSrcY[2 * x] << shift);
+        pDst[4 * x + 2] = amf_uint16(pSrcV[x] << shift);
+        pDst[4 * x + 3] = amf_uint16(pSrcY[2 * x + 1] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void PackY416_Scalar(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = amf_uint16(pSrcU[x] << shift);
+        pDst[4 * x + 1] = amf_uint16(pSrcY[x] << shift);
+        pDst[4 * x + 2] = amf_uint16(pSrcV[x] << shift);
+        pDst[4 * x + 3] = 65535;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48ToRGBA8_Scalar(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count, bool bBigEndian)
+{
+    const amf_size msb = bBigEndian ? 0 : 1;
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = pSrc[6 * x + 0 + msb];
+        pDst[4 * x + 1] = pSrc[6 * x + 2 + msb];
+        pDst[4 * x + 2] = pSrc[6 * x + 4 + msb];
+        pDst[4 * x + 3] = 255;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGBA64ToRGBA8_Scalar(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = pSrc[8 * x + 1];
+        pDst[4 * x + 1] = pSrc[8 * x + 3];
+        pDst[4 * x + 2] = pSrc[8 * x + 5];
+        pDst[4 * x + 3] = pSrc[8 * x + 7];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48ToRGBA16_Scalar(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count, bool bBigEndian)
+{
+    const amf_size hi = bBigEndian ? 0 : 1;
+    const amf_size lo = bBigEndian ? 1 : 0;
+    for (amf_size x = 0; x < count; x++)
+    {
+        const amf_uint8* pPixel = pSrc + 6 * x;
+        pDst[4 * x + 0] = amf_uint16((pPixel[0 + hi] << 8) | pPixel[0 + lo]);
+        pDst[4 * x + 1] = amf_uint16((pPixel[2 + hi] << 8) | pPixel[2 + lo]);
+        pDst[4 * x + 2] = amf_uint16((pPixel[4 + hi] << 8) | pPixel[4 + lo]);
+        pDst[4 * x + 3] = 65535;
+    }
+}
+
+#if AMF_PLANE_COPY_X86
+//-------------------------------------------------------------------------------------------------
+// SSE2 kernels
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void ShiftLeft16_SSE2(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(pSrc + x));
+        _mm_storeu_si128((__m128i*)(pDst + x), _mm_sll_epi16(v, s));
+    }
+    ShiftLeft16_Scalar(pDst + x, pSrc + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void InterleaveUV8_SSE2(amf_uint8* pDst, const amf_uint8* pSrcU, const amf_uint8* pSrcV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m128i u = _mm_loadu_si128((const __m128i*)(pSrcU + x));
+        __m128i v = _mm_loadu_si128((const __m128i*)(pSrcV + x));
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x +  0), _mm_unpacklo_epi8(u, v));
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x + 16), _mm_unpackhi_epi8(u, v));
+    }
+    InterleaveUV8_Scalar(pDst + 2 * x, pSrcU + x, pSrcV + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void InterleaveUV16_SSE2(amf_uint16* pDst, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i u = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcU + x)), s);
+        __m128i v = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcV + x)), s);
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x + 0), _mm_unpacklo_epi16(u, v));
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x + 8), _mm_unpackhi_epi16(u, v));
+    }
+    InterleaveUV16_Scalar(pDst + 2 * x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void PackY210_SSE2(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i u  = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcU + x)), s);
+        __m128i v  = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcV + x)), s);
+        __m128i y0 = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcY + 2 * x + 0)), s);
+        __m128i y1 = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcY + 2 * x + 8)), s);
+        __m128i uvLo = _mm_unpacklo_epi16(u, v);
+        __m128i uvHi = _mm_unpackhi_epi16(u, v);
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm_storeu_si128((__m128i*)(pOut +  0), _mm_unpacklo_epi16(uvLo, y0));
+        _mm_storeu_si128((__m128i*)(pOut +  8), _mm_unpackhi_epi16(uvLo, y0));
+        _mm_storeu_si128((__m128i*)(pOut + 16), _mm_unpacklo_epi16(uvHi, y1));
+        _mm_storeu_si128((__m128i*)(pOut + 24), _mm_unpackhi_epi16(uvHi, y1));
+    }
+    PackY210_Scalar(pDst + 4 * x, pSrcY + 2 * x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSE2 static void PackY416_SSE2(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    const __m128i alpha = _mm_set1_epi16(-1);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i y = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcY + x)), s);
+        __m128i u = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcU + x)), s);
+        __m128i v = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pSrcV + x)), s);
+        __m128i uyLo = _mm_unpacklo_epi16(u, y);
+        __m128i uyHi = _mm_unpackhi_epi16(u, y);
+        __m128i vaLo = _mm_unpacklo_epi16(v, alpha);
+        __m128i vaHi = _mm_unpackhi_epi16(v, alpha);
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm_storeu_si128((__m128i*)(pOut +  0), _mm_unpacklo_epi32(uyLo, vaLo));
+        _mm_storeu_si128((__m128i*)(pOut +  8), _mm_unpackhi_epi32(uyLo, vaLo));
+        _mm_storeu_si128((__m128i*)(pOut + 16), _mm_unpacklo_epi32(uyHi, vaHi));
+        _mm_storeu_si128((__m128i*)(pOut + 24), _mm_unpackhi_epi32(uyHi, vaHi));
+    }
+    PackY416_Scalar(pDst + 4 * x, pSrcY + x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+// SSSE3 kernels - byte shuffles for the packed RGB formats
+//-------------------------------------------------------------------------------------------------
+// splits 8 RGB48 pixels (48 bytes) into four registers holding two pixels each at bytes 0 and 6
+#define AMF_LOAD_RGB48_X8(pSrc, w0, w1, w2, w3) \
+    { \
+        __m128i a = _mm_loadu_si128((const __m128i*)((pSrc) +  0)); \
+        __m128i b = _mm_loadu_si128((const __m128i*)((pSrc) + 16)); \
+        __m128i c = _mm_loadu_si128((const __m128i*)((pSrc) + 32)); \
+        w0 = a; \
+        w1 = _mm_alignr_epi8(b, a, 12); \
+        w2 = _mm_alignr_epi8(c, b, 8); \
+        w3 = _mm_srli_si128(c, 4); \
+    }
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSSE3 static void RGB48ToRGBA8_SSSE3(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count, bool bBigEndian)
+{
+    const amf_int8 msb = bBigEndian ? 0 : 1;
+    const __m128i shuffle = _mm_setr_epi8(msb + 0, msb + 2, msb + 4, -1, msb + 6, msb + 8, msb + 10, -1,
+                                          -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i alpha = _mm_set1_epi32(int(0xFF000000));
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i w0, w1, w2, w3;
+        AMF_LOAD_RGB48_X8(pSrc + 6 * x, w0, w1, w2, w3);
+        __m128i lo = _mm_unpacklo_epi64(_mm_shuffle_epi8(w0, shuffle), _mm_shuffle_epi8(w1, shuffle));
+        __m128i hi = _mm_unpacklo_epi64(_mm_shuffle_epi8(w2, shuffle), _mm_shuffle_epi8(w3, shuffle));
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x +  0), _mm_or_si128(lo, alpha));
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x + 16), _mm_or_si128(hi, alpha));
+    }
+    RGB48ToRGBA8_Scalar(pDst + 4 * x, pSrc + 6 * x, count - x, bBigEndian);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSSE3 static void RGBA64ToRGBA8_SSSE3(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const __m128i shuffle = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const amf_uint8* pIn = pSrc + 8 * x;
+        __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pIn +  0)), shuffle);
+        __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pIn + 16)), shuffle);
+        __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pIn + 32)), shuffle);
+        __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pIn + 48)), shuffle);
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x +  0), _mm_unpacklo_epi64(p0, p1));
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x + 16), _mm_unpacklo_epi64(p2, p3));
+    }
+    RGBA64ToRGBA8_Scalar(pDst + 4 * x, pSrc + 8 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_SSSE3 static void RGB48ToRGBA16_SSSE3(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count, bool bBigEndian)
+{
+    const amf_int8 hi = bBigEndian ? 0 : 1;
+    const amf_int8 lo = bBigEndian ? 1 : 0;
+    const __m128i shuffle = _mm_setr_epi8(lo + 0, hi + 0, lo + 2, hi + 2, lo + 4, hi + 4, -1, -1,
+                                          lo + 6, hi + 6, lo + 8, hi + 8, lo + 10, hi + 10, -1, -1);
+    const __m128i alpha = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i w0, w1, w2, w3;
+        AMF_LOAD_RGB48_X8(pSrc + 6 * x, w0, w1, w2, w3);
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm_storeu_si128((__m128i*)(pOut +  0), _mm_or_si128(_mm_shuffle_epi8(w0, shuffle), alpha));
+        _mm_storeu_si128((__m128i*)(pOut +  8), _mm_or_si128(_mm_shuffle_epi8(w1, shuffle), alpha));
+        _mm_storeu_si128((__m128i*)(pOut + 16), _mm_or_si128(_mm_shuffle_epi8(w2, shuffle), alpha));
+        _mm_storeu_si128((__m128i*)(pOut + 24), _mm_or_si128(_mm_shuffle_epi8(w3, shuffle), alpha));
+    }
+    RGB48ToRGBA16_Scalar(pDst + 4 * x, pSrc + 6 * x, count - x, bBigEndian);
+}
+#undef AMF_LOAD_RGB48_X8
+//-------------------------------------------------------------------------------------------------
+// AVX2 kernels
+// 256-bit unpacks work inside 128-bit lanes, results are put back in order with permute2x128
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void ShiftLeft16_AVX2(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(pSrc + x));
+        _mm256_storeu_si256((__m256i*)(pDst + x), _mm256_sll_epi16(v, s));
+    }
+    ShiftLeft16_SSE2(pDst + x, pSrc + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void InterleaveUV8_AVX2(amf_uint8* pDst, const amf_uint8* pSrcU, const amf_uint8* pSrcV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m256i u = _mm256_loadu_si256((const __m256i*)(pSrcU + x));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(pSrcV + x));
+        __m256i lo = _mm256_unpacklo_epi8(u, v);
+        __m256i hi = _mm256_unpackhi_epi8(u, v);
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x +  0), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    InterleaveUV8_SSE2(pDst + 2 * x, pSrcU + x, pSrcV + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void InterleaveUV16_AVX2(amf_uint16* pDst, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i u = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcU + x)), s);
+        __m256i v = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcV + x)), s);
+        __m256i lo = _mm256_unpacklo_epi16(u, v);
+        __m256i hi = _mm256_unpackhi_epi16(u, v);
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x +  0), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    InterleaveUV16_SSE2(pDst + 2 * x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void PackY210_AVX2(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i u  = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcU + x)), s);
+        __m256i v  = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcV + x)), s);
+        __m256i y0 = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcY + 2 * x +  0)), s);
+        __m256i y1 = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcY + 2 * x + 16)), s);
+        // lanes: uvLo = pairs 0-3 | 8-11, uvHi = pairs 4-7 | 12-15; match luma to the same pairs
+        __m256i uvLo = _mm256_unpacklo_epi16(u, v);
+        __m256i uvHi = _mm256_unpackhi_epi16(u, v);
+        __m256i yLo = _mm256_permute2x128_si256(y0, y1, 0x20);
+        __m256i yHi = _mm256_permute2x128_si256(y0, y1, 0x31);
+        __m256i o0 = _mm256_unpacklo_epi16(uvLo, yLo); // pairs 0-1 | 8-9
+        __m256i o1 = _mm256_unpackhi_epi16(uvLo, yLo); // pairs 2-3 | 10-11
+        __m256i o2 = _mm256_unpacklo_epi16(uvHi, yHi); // pairs 4-5 | 12-13
+        __m256i o3 = _mm256_unpackhi_epi16(uvHi, yHi); // pairs 6-7 | 14-15
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm256_storeu_si256((__m256i*)(pOut +  0), _mm256_permute2x128_si256(o0, o1, 0x20));
+        _mm256_storeu_si256((__m256i*)(pOut + 16), _mm256_permute2x128_si256(o2, o3, 0x20));
+        _mm256_storeu_si256((__m256i*)(pOut + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+        _mm256_storeu_si256((__m256i*)(pOut + 48), _mm256_permute2x128_si256(o2, o3, 0x31));
+    }
+    PackY210_SSE2(pDst + 4 * x, pSrcY + 2 * x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX2 static void PackY416_AVX2(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    const __m256i alpha = _mm256_set1_epi16(-1);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i y = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcY + x)), s);
+        __m256i u = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcU + x)), s);
+        __m256i v = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pSrcV + x)), s);
+        __m256i uyLo = _mm256_unpacklo_epi16(u, y);
+        __m256i uyHi = _mm256_unpackhi_epi16(u, y);
+        __m256i vaLo = _mm256_unpacklo_epi16(v, alpha);
+        __m256i vaHi = _mm256_unpackhi_epi16(v, alpha);
+        __m256i o0 = _mm256_unpacklo_epi32(uyLo, vaLo); // pixels 0-1 | 8-9
+        __m256i o1 = _mm256_unpackhi_epi32(uyLo, vaLo); // pixels 2-3 | 10-11
+        __m256i o2 = _mm256_unpacklo_epi32(uyHi, vaHi); // pixels 4-5 | 12-13
+        __m256i o3 = _mm256_unpackhi_epi32(uyHi, vaHi); // pixels 6-7 | 14-15
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm256_storeu_si256((__m256i*)(pOut +  0), _mm256_permute2x128_si256(o0, o1, 0x20));
+        _mm256_storeu_si256((__m256i*)(pOut + 16), _mm256_permute2x128_si256(o2, o3, 0x20));
+        _mm256_storeu_si256((__m256i*)(pOut + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+        _mm256_storeu_si256((__m256i*)(pOut + 48), _mm256_permute2x128_si256(o2, o3, 0x31));
+    }
+    PackY416_SSE2(pDst + 4 * x, pSrcY + x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+// AVX-512 kernels
+// cross-lane word/dword interleaves are done with two-source permutes
+//-------------------------------------------------------------------------------------------------
+// low half interleave of two 16-bit vectors: a0 b0 a1 b1 ... a15 b15, high half adds 16
+static const amf_uint16 s_Interleave16Lo[32] = {
+     0, 32,  1, 33,  2, 34,  3, 35,  4, 36,  5, 37,  6, 38,  7, 39,
+     8, 40,  9, 41, 10, 42, 11, 43, 12, 44, 13, 45, 14, 46, 15, 47 };
+static const amf_uint16 s_Interleave16Hi[32] = {
+    16, 48, 17, 49, 18, 50, 19, 51, 20, 52, 21, 53, 22, 54, 23, 55,
+    24, 56, 25, 57, 26, 58, 27, 59, 28, 60, 29, 61, 30, 62, 31, 63 };
+// the same for 32-bit elements
+static const amf_uint32 s_Interleave32Lo[16] = { 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 };
+static const amf_uint32 s_Interleave32Hi[16] = { 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 };
+// puts the in-lane unpack results of byte vectors back in order
+static const amf_uint64 s_Reorder64Lo[8] = { 0, 1,  8,  9, 2, 3, 10, 11 };
+static const amf_uint64 s_Reorder64Hi[8] = { 4, 5, 12, 13, 6, 7, 14, 15 };
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX512 static void ShiftLeft16_AVX512(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m512i v = _mm512_loadu_si512((const void*)(pSrc + x));
+        _mm512_storeu_si512((void*)(pDst + x), _mm512_sll_epi16(v, s));
+    }
+    ShiftLeft16_AVX2(pDst + x, pSrc + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX512 static void InterleaveUV8_AVX512(amf_uint8* pDst, const amf_uint8* pSrcU, const amf_uint8* pSrcV, amf_size count)
+{
+    const __m512i reorderLo = _mm512_loadu_si512((const void*)s_Reorder64Lo);
+    const __m512i reorderHi = _mm512_loadu_si512((const void*)s_Reorder64Hi);
+    amf_size x = 0;
+    for (; x + 64 <= count; x += 64)
+    {
+        __m512i u = _mm512_loadu_si512((const void*)(pSrcU + x));
+        __m512i v = _mm512_loadu_si512((const void*)(pSrcV + x));
+        __m512i lo = _mm512_unpacklo_epi8(u, v);
+        __m512i hi = _mm512_unpackhi_epi8(u, v);
+        _mm512_storeu_si512((void*)(pDst + 2 * x +  0), _mm512_permutex2var_epi64(lo, reorderLo, hi));
+        _mm512_storeu_si512((void*)(pDst + 2 * x + 64), _mm512_permutex2var_epi64(lo, reorderHi, hi));
+    }
+    InterleaveUV8_AVX2(pDst + 2 * x, pSrcU + x, pSrcV + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX512 static void InterleaveUV16_AVX512(amf_uint16* pDst, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    const __m512i idxLo = _mm512_loadu_si512((const void*)s_Interleave16Lo);
+    const __m512i idxHi = _mm512_loadu_si512((const void*)s_Interleave16Hi);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m512i u = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcU + x)), s);
+        __m512i v = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcV + x)), s);
+        _mm512_storeu_si512((void*)(pDst + 2 * x +  0), _mm512_permutex2var_epi16(u, idxLo, v));
+        _mm512_storeu_si512((void*)(pDst + 2 * x + 32), _mm512_permutex2var_epi16(u, idxHi, v));
+    }
+    InterleaveUV16_AVX2(pDst + 2 * x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX512 static void PackY210_AVX512(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    const __m512i idxLo = _mm512_loadu_si512((const void*)s_Interleave16Lo);
+    const __m512i idxHi = _mm512_loadu_si512((const void*)s_Interleave16Hi);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m512i u  = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcU + x)), s);
+        __m512i v  = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcV + x)), s);
+        __m512i y0 = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcY + 2 * x +  0)), s);
+        __m512i y1 = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcY + 2 * x + 32)), s);
+        __m512i uv0 = _mm512_permutex2var_epi16(u, idxLo, v); // pairs 0-15
+        __m512i uv1 = _mm512_permutex2var_epi16(u, idxHi, v); // pairs 16-31
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm512_storeu_si512((void*)(pOut +  0), _mm512_permutex2var_epi16(uv0, idxLo, y0));
+        _mm512_storeu_si512((void*)(pOut + 32), _mm512_permutex2var_epi16(uv0, idxHi, y0));
+        _mm512_storeu_si512((void*)(pOut + 64), _mm512_permutex2var_epi16(uv1, idxLo, y1));
+        _mm512_storeu_si512((void*)(pOut + 96), _mm512_permutex2var_epi16(uv1, idxHi, y1));
+    }
+    PackY210_AVX2(pDst + 4 * x, pSrcY + 2 * x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_TARGET_AVX512 static void PackY416_AVX512(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    const __m512i alpha = _mm512_set1_epi16(-1);
+    const __m512i idx16Lo = _mm512_loadu_si512((const void*)s_Interleave16Lo);
+    const __m512i idx16Hi = _mm512_loadu_si512((const void*)s_Interleave16Hi);
+    const __m512i idx32Lo = _mm512_loadu_si512((const void*)s_Interleave32Lo);
+    const __m512i idx32Hi = _mm512_loadu_si512((const void*)s_Interleave32Hi);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m512i y = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcY + x)), s);
+        __m512i u = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcU + x)), s);
+        __m512i v = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrcV + x)), s);
+        __m512i uy0 = _mm512_permutex2var_epi16(u, idx16Lo, y);     // pixels 0-15
+        __m512i uy1 = _mm512_permutex2var_epi16(u, idx16Hi, y);     // pixels 16-31
+        __m512i va0 = _mm512_permutex2var_epi16(v, idx16Lo, alpha);
+        __m512i va1 = _mm512_permutex2var_epi16(v, idx16Hi, alpha);
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm512_storeu_si512((void*)(pOut +  0), _mm512_permutex2var_epi32(uy0, idx32Lo, va0));
+        _mm512_storeu_si512((void*)(pOut + 32), _mm512_permutex2var_epi32(uy0, idx32Hi, va0));
+        _mm512_storeu_si512((void*)(pOut + 64), _mm512_permutex2var_epi32(uy1, idx32Lo, va1));
+        _mm512_storeu_si512((void*)(pOut + 96), _mm512_permutex2var_epi32(uy1, idx32Hi, va1));
+    }
+    PackY416_AVX2(pDst + 4 * x, pSrcY + x, pSrcU + x, pSrcV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+// CPU detection
+//-------------------------------------------------------------------------------------------------
+static AMF_PLANE_COPY_ISA DetectPlaneCopyISA(bool& bSSSE3)
+{
+    AMF_PLANE_COPY_ISA eISA = AMF_PLANE_COPY_ISA_SCALAR;
+#if defined(_MSC_VER)
+    int regs[4] = {};
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+    __cpuid(regs, 1);
+    const bool bSSE2   = (regs[3] & (1 << 26)) != 0;
+    const bool bOSXSAVE = (regs[2] & (1 << 27)) != 0;
+    const bool bAVX    = (regs[2] & (1 << 28)) != 0;
+    bSSSE3 = (regs[2] & (1 << 9)) != 0;
+
+    bool bAVX2 = false;
+    bool bAVX512 = false;
+    if (bOSXSAVE && bAVX && maxLeaf >= 7)
+    {
+        const unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(regs, 7, 0);
+        // YMM state for AVX2, plus opmask and ZMM state for AVX-512
+        bAVX2 = (xcr0 & 0x06) == 0x06 && (regs[1] & (1 << 5)) != 0;
+        bAVX512 = (xcr0 & 0xE6) == 0xE6 && (regs[1] & (1 << 16)) != 0 && (regs[1] & (1 << 30)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool bSSE2   = __builtin_cpu_supports("sse2") != 0;
+    const bool bAVX2   = __builtin_cpu_supports("avx2") != 0;
+    const bool bAVX512 = __builtin_cpu_supports("avx512f") != 0 && __builtin_cpu_supports("avx512bw") != 0;
+    bSSSE3 = __builtin_cpu_supports("ssse3") != 0;
+#endif
+    if (bSSE2)
+    {
+        eISA = AMF_PLANE_COPY_ISA_SSE2;
+        if (bAVX2 && bSSSE3)
+        {
+            eISA = AMF_PLANE_COPY_ISA_AVX2;
+            if (bAVX512)
+            {
+                eISA = AMF_PLANE_COPY_ISA_AVX512;
+            }
+        }
+    }
+    return eISA;
+}
+#endif // AMF_PLANE_COPY_X86
+
+//-------------------------------------------------------------------------------------------------
+// dispatch tables
+//-------------------------------------------------------------------------------------------------
+static const AMFPlaneCopyKernels s_KernelsScalar =
+{
+    AMF_PLANE_COPY_ISA_SCALAR,
+    ShiftLeft16_Scalar, InterleaveUV8_Scalar, InterleaveUV16_Scalar, PackY210_Scalar, PackY416_Scalar,
+    RGB48ToRGBA8_Scalar, RGBA64ToRGBA8_Scalar, RGB48ToRGBA16_Scalar
+};
+#if AMF_PLANE_COPY_X86
+static const AMFPlaneCopyKernels s_KernelsSSE2 =
+{
+    AMF_PLANE_COPY_ISA_SSE2,
+    ShiftLeft16_SSE2, InterleaveUV8_SSE2, InterleaveUV16_SSE2, PackY210_SSE2, PackY416_SSE2,
+    RGB48ToRGBA8_Scalar, RGBA64ToRGBA8_Scalar, RGB48ToRGBA16_Scalar
+};
+static const AMFPlaneCopyKernels s_KernelsSSSE3 =
+{
+    AMF_PLANE_COPY_ISA_SSE2,
+    ShiftLeft16_SSE2, InterleaveUV8_SSE2, InterleaveUV16_SSE2, PackY210_SSE2, PackY416_SSE2,
+    RGB48ToRGBA8_SSSE3, RGBA64ToRGBA8_SSSE3, RGB48ToRGBA16_SSSE3
+};
+static const AMFPlaneCopyKernels s_KernelsAVX2 =
+{
+    AMF_PLANE_COPY_ISA_AVX2,
+    ShiftLeft16_AVX2, InterleaveUV8_AVX2, InterleaveUV16_AVX2, PackY210_AVX2, PackY416_AVX2,
+    RGB48ToRGBA8_SSSE3, RGBA64ToRGBA8_SSSE3, RGB48ToRGBA16_SSSE3
+};
+static const AMFPlaneCopyKernels s_KernelsAVX512 =
+{
+    AMF_PLANE_COPY_ISA_AVX512,
+    ShiftLeft16_AVX512, InterleaveUV8_AVX512, InterleaveUV16_AVX512, PackY210_AVX512, PackY416_AVX512,
+    RGB48ToRGBA8_SSSE3, RGBA64ToRGBA8_SSSE3, RGB48ToRGBA16_SSSE3
+};
+
+static bool               s_bSSSE3 = false;
+static AMF_PLANE_COPY_ISA s_eBestISA = DetectPlaneCopyISA(s_bSSSE3);
+#endif
+//-------------------------------------------------------------------------------------------------
+const AMFPlaneCopyKernels& AMF_STD_CALL amf::GetPlaneCopyKernels(AMF_PLANE_COPY_ISA eISA)
+{
+#if AMF_PLANE_COPY_X86
+    if (eISA > s_eBestISA)
+    {
+        eISA = s_eBestISA;
+    }
+    switch (eISA)
+    {
+    case AMF_PLANE_COPY_ISA_AVX512:
+        return s_KernelsAVX512;
+    case AMF_PLANE_COPY_ISA_AVX2:
+        return s_KernelsAVX2;
+    case AMF_PLANE_COPY_ISA_SSE2:
+        return s_bSSSE3 ? s_KernelsSSSE3 : s_KernelsSSE2;
+    default:
+        break;
+    }
+#else
+    (void)eISA;
+#endif
+    return s_KernelsScalar;
+}
+//-------------------------------------------------------------------------------------------------
+const AMFPlaneCopyKernels& AMF_STD_CALL amf::GetPlaneCopyKernels()
+{
+    return GetPlaneCopyKernels(AMF_PLANE_COPY_ISA_AVX512);
+}
+//-------------------------------------------------------------------------------------------------
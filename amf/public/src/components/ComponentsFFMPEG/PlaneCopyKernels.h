@@ -0,0 +1,78 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Row conversion kernels used to copy CPU decoded frames into AMF surfaces.
+    // Every kernel converts a single row; callers step through the planes using their own pitches.
+    // All implementations are bit-exact with the scalar reference and accept unaligned pointers.
+    //-------------------------------------------------------------------------------------------------
+    enum AMF_PLANE_COPY_ISA
+    {
+        AMF_PLANE_COPY_ISA_SCALAR = 0,
+        AMF_PLANE_COPY_ISA_SSE2,
+        AMF_PLANE_COPY_ISA_AVX2,
+        AMF_PLANE_COPY_ISA_AVX512,
+    };
+
+    struct AMFPlaneCopyKernels
+    {
+        AMF_PLANE_COPY_ISA eISA;
+
+        // dst[i] = src[i] << shift (LSB aligned high bit depth to MSB aligned P01x)
+        void (*ShiftLeft16)(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift);
+        // dst = U0 V0 U1 V1 ... (NV12 chroma)
+        void (*InterleaveUV8)(amf_uint8* pDst, const amf_uint8* pSrcU, const amf_uint8* pSrcV, amf_size count);
+        // dst = U0<<shift V0<<shift ... (P01x chroma)
+        void (*InterleaveUV16)(amf_uint16* pDst, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift);
+        // 4:2:2 planar to packed U Y0 V Y1, count is the number of pixel pairs
+        void (*PackY210)(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift);
+        // 4:4:4 planar to packed U Y V A with opaque alpha
+        void (*PackY416)(amf_uint16* pDst, const amf_uint16* pSrcY, const amf_uint16* pSrcU, const amf_uint16* pSrcV, amf_size count, amf_int32 shift);
+        // 16-bit RGB to RGBA 8-bit, keeps the most significant byte and sets opaque alpha
+        void (*RGB48ToRGBA8)(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count, bool bBigEndian);
+        // 16-bit RGBA little endian to RGBA 8-bit
+        void (*RGBA64ToRGBA8)(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count);
+        // 16-bit RGB to RGBA 16-bit little endian with opaque alpha
+        void (*RGB48ToRGBA16)(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count, bool bBigEndian);
+    };
+
+    // returns kernels for the best instruction set supported by the CPU and the OS
+    const AMFPlaneCopyKernels& AMF_STD_CALL GetPlaneCopyKernels();
+    // returns kernels for the requested instruction set or the best supported one below it
+    const AMFPlaneCopyKernels& AMF_STD_CALL GetPlaneCopyKernels(AMF_PLANE_COPY_ISA eISA);
+}
@@ -0,0 +1,418 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "StreamInfoCache.h"
+#include "public/common/DataStream.h"
+#include "public/common/TraceAdapter.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define AMF_FACILITY L"AMFStreamInfoCache"
+
+using namespace amf;
+
+namespace
+{
+    const amf_uint32 STREAM_INFO_CACHE_MAGIC   = 0x43495341; // "ASIC"
+    const amf_uint32 STREAM_INFO_CACHE_VERSION = 1;
+    const amf_size   STREAM_INFO_CACHE_MAX_SIZE = 64 * 1024 * 1024;
+
+    //-------------------------------------------------------------------------------------------------
+    bool GetFileStat(const wchar_t* path, amf_int64& size, amf_int64& mtime)
+    {
+#if defined(_WIN32)
+        struct _stat64 st;
+        if (_wstat64(path, &st) != 0)
+        {
+            return false;
+        }
+#else
+        struct stat st;
+        if (stat(amf_from_unicode_to_utf8(amf_wstring(path)).c_str(), &st) != 0)
+        {
+            return false;
+        }
+#endif
+        size = (amf_int64)st.st_size;
+        mtime = (amf_int64)st.st_mtime;
+        return true;
+    }
+    //-------------------------------------------------------------------------------------------------
+    bool RenameFile(const wchar_t* from, const wchar_t* to)
+    {
+#if defined(_WIN32)
+        _wremove(to);
+        return _wrename(from, to) == 0;
+#else
+        return rename(amf_from_unicode_to_utf8(amf_wstring(from)).c_str(), amf_from_unicode_to_utf8(amf_wstring(to)).c_str()) == 0;
+#endif
+    }
+    //-------------------------------------------------------------------------------------------------
+    void RemoveFile(const wchar_t* path)
+    {
+#if defined(_WIN32)
+        _wremove(path);
+#else
+        remove(amf_from_unicode_to_utf8(amf_wstring(path)).c_str());
+#endif
+    }
+    //-------------------------------------------------------------------------------------------------
+    // FNV-1a, only used to turn the key into a file name; the full key is verified on load
+    amf_uint64 HashKey(const amf_string& key)
+    {
+        amf_uint64 hash = 14695981039346656037ULL;
+        for (amf_size i = 0; i < key.length(); i++)
+        {
+            hash ^= (amf_uint8)key[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+    //-------------------------------------------------------------------------------------------------
+    bool IsStreamComplete(const AVStream* pStream)
+    {
+        const AVCodecParameters* par = pStream->codecpar;
+        switch (par->codec_type)
+        {
+        case AVMEDIA_TYPE_VIDEO:
+            return par->codec_id != AV_CODEC_ID_NONE && par->width > 0 && par->height > 0 && par->format != AV_PIX_FMT_NONE;
+        case AVMEDIA_TYPE_AUDIO:
+            return par->codec_id != AV_CODEC_ID_NONE && par->sample_rate > 0 && par->channels > 0 && par->format != AV_SAMPLE_FMT_NONE;
+        default:
+            return true;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool amf::GetCacheFileKey(const wchar_t* filePath, amf_string& key)
+{
+    amf_int64 size = 0;
+    amf_int64 mtime = 0;
+    if (filePath == NULL || filePath[0] == 0 || !GetFileStat(filePath, size, mtime))
+    {
+        return false;
+    }
+    key = amf_from_unicode_to_utf8(amf_wstring(filePath)) + amf_string_format("|%lld|%lld", (long long)size, (long long)mtime);
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool amf::ReadCacheFile(const amf_wstring& path, amf_size maxSize, amf_vector<amf_uint8>& data)
+{
+    AMFDataStreamPtr pStream;
+    if (AMFDataStream::OpenDataStream(path.c_str(), AMFSO_READ, AMFFS_SHARE_READ, &pStream) != AMF_OK || pStream == NULL)
+    {
+        return false;
+    }
+    amf_int64 fileSize = 0;
+    pStream->GetSize(&fileSize);
+    if (fileSize <= 0 || (amf_uint64)fileSize > maxSize)
+    {
+        return false;
+    }
+    data.resize((amf_size)fileSize);
+    amf_size read = 0;
+    pStream->Read(&data[0], data.size(), &read);
+    pStream->Close();
+    return read == data.size();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT amf::WriteCacheFile(const amf_wstring& path, const amf_vector<amf_uint8>& data)
+{
+    AMF_RETURN_IF_FALSE(!data.empty(), AMF_INVALID_ARG, L"WriteCacheFile() - no data");
+
+    const amf_wstring tempPath = path + L".tmp";
+    AMFDataStreamPtr pStream;
+    AMF_RETURN_IF_FAILED(AMFDataStream::OpenDataStream(tempPath.c_str(), AMFSO_WRITE, AMFFS_EXCLUSIVE, &pStream),
+        L"WriteCacheFile() - cannot create %s", tempPath.c_str());
+
+    amf_size written = 0;
+    AMF_RESULT res = pStream->Write(&data[0], data.size(), &written);
+    pStream->Close();
+    pStream.Release();
+    if (res != AMF_OK || written != data.size())
+    {
+        RemoveFile(tempPath.c_str());
+        AMF_RETURN_IF_FALSE(false, AMF_FAIL, L"WriteCacheFile() - failed to write %s", tempPath.c_str());
+    }
+    if (!RenameFile(tempPath.c_str(), path.c_str()))
+    {
+        RemoveFile(tempPath.c_str());
+        AMF_RETURN_IF_FALSE(false, AMF_FAIL, L"WriteCacheFile() - failed to rename %s", tempPath.c_str());
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMFStreamInfoCache::AMFStreamInfoCache()
+{
+}
+//-------------------------------------------------------------------------------------------------
+void AMFStreamInfoCache::Init(const wchar_t* cacheDir, const wchar_t* filePath)
+{
+    Reset();
+    if (cacheDir == NULL || cacheDir[0] == 0 || filePath == NULL || filePath[0] == 0)
+    {
+        return;
+    }
+    if (!GetCacheFileKey(filePath, m_Key))
+    {
+        return;
+    }
+    m_EntryPath = cacheDir;
+    const wchar_t last = m_EntryPath[m_EntryPath.length() - 1];
+    if (last != L'/' && last != L'\\')
+    {
+        m_EntryPath += L'/';
+    }
+    m_EntryPath += amf_string_format(L"%016llx.asic", (unsigned long long)HashKey(m_Key));
+}
+//-------------------------------------------------------------------------------------------------
+void AMFStreamInfoCache::Reset()
+{
+    m_EntryPath.clear();
+    m_Key.clear();
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFStreamInfoCache::Load(AVFormatContext* pContext)
+{
+    if (!IsEnabled() || pContext == NULL)
+    {
+        return false;
+    }
+    amf_vector<amf_uint8> data;
+    if (!ReadCacheFile(m_EntryPath, STREAM_INFO_CACHE_MAX_SIZE, data))
+    {
+        return false;
+    }
+    AMFCacheReader reader(&data[0], data.size());
+    if (reader.Get<amf_uint32>() != STREAM_INFO_CACHE_MAGIC || reader.Get<amf_uint32>() != STREAM_INFO_CACHE_VERSION)
+    {
+        return false;
+    }
+    amf_int32 keySize = 0;
+    const amf_uint8* pKey = reader.GetBytes(keySize);
+    if (!reader.IsValid() || amf_string(reinterpret_cast<const char*>(pKey), keySize) != m_Key)
+    {
+        return false;
+    }
+    const amf_int64 duration = reader.Get<amf_int64>();
+    const amf_int64 startTime = reader.Get<amf_int64>();
+    const amf_int64 bitRate = reader.Get<amf_int64>();
+    const amf_uint32 streamCount = reader.Get<amf_uint32>();
+    if (!reader.IsValid() || streamCount != pContext->nb_streams)
+    {
+        return false;
+    }
+
+    // parse into temporary parameters first so a damaged entry leaves the context untouched
+    amf_vector<AVCodecParameters*> params(streamCount, (AVCodecParameters*)NULL);
+    amf_vector<AVRational> rates(streamCount * 2);
+    amf_vector<amf_int64> times(streamCount * 3);
+    bool bValid = true;
+    for (amf_uint32 i = 0; i < streamCount && bValid; i++)
+    {
+        const AVStream* pAVStream = pContext->streams[i];
+        AVCodecParameters* par = avcodec_parameters_alloc();
+        if (par == NULL)
+        {
+            bValid = false;
+            break;
+        }
+        params[i] = par;
+
+        par->codec_type = (AVMediaType)reader.Get<amf_int32>();
+        par->codec_id = (AVCodecID)reader.Get<amf_int32>();
+        const AVRational timeBase = reader.GetRational();
+        if (par->codec_type != pAVStream->codecpar->codec_type ||
+            (pAVStream->codecpar->codec_id != AV_CODEC_ID_NONE && par->codec_id != pAVStream->codecpar->codec_id) ||
+            av_cmp_q(timeBase, pAVStream->time_base) != 0)
+        {
+            bValid = false;
+            break;
+        }
+        par->codec_tag = reader.Get<amf_uint32>();
+        par->format = reader.Get<amf_int32>();
+        par->bit_rate = reader.Get<amf_int64>();
+        par->bits_per_coded_sample = reader.Get<amf_int32>();
+        par->bits_per_raw_sample = reader.Get<amf_int32>();
+        par->profile = reader.Get<amf_int32>();
+        par->level = reader.Get<amf_int32>();
+        par->width = reader.Get<amf_int32>();
+        par->height = reader.Get<amf_int32>();
+        par->sample_aspect_ratio = reader.GetRational();
+        par->field_order = (AVFieldOrder)reader.Get<amf_int32>();
+        par->color_range = (AVColorRange)reader.Get<amf_int32>();
+        par->color_primaries = (AVColorPrimaries)reader.Get<amf_int32>();
+        par->color_trc = (AVColorTransferCharacteristic)reader.Get<amf_int32>();
+        par->color_space = (AVColorSpace)reader.Get<amf_int32>();
+        par->chroma_location = (AVChromaLocation)reader.Get<amf_int32>();
+        par->video_delay = reader.Get<amf_int32>();
+        par->channel_layout = reader.Get<amf_uint64>();
+        par->channels = reader.Get<amf_int32>();
+        par->sample_rate = reader.Get<amf_int32>();
+        par->block_align = reader.Get<amf_int32>();
+        par->frame_size = reader.Get<amf_int32>();
+        par->initial_padding = reader.Get<amf_int32>();
+        par->trailing_padding = reader.Get<amf_int32>();
+        par->seek_preroll = reader.Get<amf_int32>();
+
+        rates[i * 2] = reader.GetRational();
+        rates[i * 2 + 1] = reader.GetRational();
+        times[i * 3] = reader.Get<amf_int64>();
+        times[i * 3 + 1] = reader.Get<amf_int64>();
+        times[i * 3 + 2] = reader.Get<amf_int64>();
+
+        amf_int32 extraSize = 0;
+        const amf_uint8* pExtra = reader.GetBytes(extraSize);
+        if (!reader.IsValid())
+        {
+            bValid = false;
+            break;
+        }
+        if (extraSize > 0)
+        {
+            par->extradata = static_cast<uint8_t*>(av_mallocz(extraSize + AV_INPUT_BUFFER_PADDING_SIZE));
+            if (par->extradata == NULL)
+            {
+                bValid = false;
+                break;
+            }
+            memcpy(par->extradata, pExtra, extraSize);
+            par->extradata_size = extraSize;
+        }
+    }
+    if (bValid)
+    {
+        for (amf_uint32 i = 0; i < streamCount; i++)
+        {
+            AVStream* pAVStream = pContext->streams[i];
+            avcodec_parameters_copy(pAVStream->codecpar, params[i]);
+            pAVStream->r_frame_rate = rates[i * 2];
+            pAVStream->avg_frame_rate = rates[i * 2 + 1];
+            pAVStream->duration = times[i * 3];
+            pAVStream->start_time = times[i * 3 + 1];
+            pAVStream->nb_frames = times[i * 3 + 2];
+            pAVStream->sample_aspect_ratio = params[i]->sample_aspect_ratio;
+            // the demuxer still reads the legacy per-stream codec context
+            avcodec_parameters_to_context(pAVStream->codec, pAVStream->codecpar);
+        }
+        pContext->duration = duration;
+        pContext->start_time = startTime;
+        pContext->bit_rate = bitRate;
+    }
+    for (amf_uint32 i = 0; i < streamCount; i++)
+    {
+        avcodec_parameters_free(&params[i]);
+    }
+    if (!bValid)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"Load() - ignoring damaged cache entry %s", m_EntryPath.c_str());
+    }
+    return bValid;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFStreamInfoCache::Store(const AVFormatContext* pContext)
+{
+    AMF_RETURN_IF_FALSE(pContext != NULL, AMF_INVALID_ARG, L"Store() - pContext == NULL");
+    if (!IsEnabled())
+    {
+        return AMF_OK;
+    }
+    // streams appearing only while reading cannot be restored right after avformat_open_input()
+    if ((pContext->ctx_flags & AVFMTCTX_NOHEADER) != 0)
+    {
+        return AMF_OK;
+    }
+    for (amf_uint32 i = 0; i < pContext->nb_streams; i++)
+    {
+        if (!IsStreamComplete(pContext->streams[i]))
+        {
+            return AMF_OK;
+        }
+    }
+
+    AMFCacheWriter writer;
+    writer.Put(STREAM_INFO_CACHE_MAGIC);
+    writer.Put(STREAM_INFO_CACHE_VERSION);
+    writer.PutBytes(m_Key.c_str(), (amf_int32)m_Key.length());
+    writer.Put((amf_int64)pContext->duration);
+    writer.Put((amf_int64)pContext->start_time);
+    writer.Put((amf_int64)pContext->bit_rate);
+    writer.Put((amf_uint32)pContext->nb_streams);
+    for (amf_uint32 i = 0; i < pContext->nb_streams; i++)
+    {
+        const AVStream* pAVStream = pContext->streams[i];
+        const AVCodecParameters* par = pAVStream->codecpar;
+
+        writer.Put((amf_int32)par->codec_type);
+        writer.Put((amf_int32)par->codec_id);
+        writer.PutRational(pAVStream->time_base);
+        writer.Put((amf_uint32)par->codec_tag);
+        writer.Put((amf_int32)par->format);
+        writer.Put((amf_int64)par->bit_rate);
+        writer.Put((amf_int32)par->bits_per_coded_sample);
+        writer.Put((amf_int32)par->bits_per_raw_sample);
+        writer.Put((amf_int32)par->profile);
+        writer.Put((amf_int32)par->level);
+        writer.Put((amf_int32)par->width);
+        writer.Put((amf_int32)par->height);
+        writer.PutRational(par->sample_aspect_ratio);
+        writer.Put((amf_int32)par->field_order);
+        writer.Put((amf_int32)par->color_range);
+        writer.Put((amf_int32)par->color_primaries);
+        writer.Put((amf_int32)par->color_trc);
+        writer.Put((amf_int32)par->color_space);
+        writer.Put((amf_int32)par->chroma_location);
+        writer.Put((amf_int32)par->video_delay);
+        writer.Put((amf_uint64)par->channel_layout);
+        writer.Put((amf_int32)par->channels);
+        writer.Put((amf_int32)par->sample_rate);
+        writer.Put((amf_int32)par->block_align);
+        writer.Put((amf_int32)par->frame_size);
+        writer.Put((amf_int32)par->initial_padding);
+        writer.Put((amf_int32)par->trailing_padding);
+        writer.Put((amf_int32)par->seek_preroll);
+
+        writer.PutRational(pAVStream->r_frame_rate);
+        writer.PutRational(pAVStream->avg_frame_rate);
+        writer.Put((amf_int64)pAVStream->duration);
+        writer.Put((amf_int64)pAVStream->start_time);
+        writer.Put((amf_int64)pAVStream->nb_frames);
+        writer.PutBytes(par->extradata, par->extradata != NULL ? par->extradata_size : 0);
+    }
+
+    return WriteCacheFile(m_EntryPath, writer.GetData());
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,167 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Result.h"
+#include "public/common/AMFSTL.h"
+
+extern "C"
+{
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4244)
+#endif
+
+    #include "libavformat/avformat.h"
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+}
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // helpers for the small binary cache files kept next to the media or in a cache folder
+    //-------------------------------------------------------------------------------------------------
+    class AMFCacheWriter
+    {
+    public:
+        template<typename T>
+        void Put(T value)
+        {
+            const amf_uint8* p = reinterpret_cast<const amf_uint8*>(&value);
+            m_Data.insert(m_Data.end(), p, p + sizeof(T));
+        }
+        void PutBytes(const void* pData, amf_int32 size)
+        {
+            Put(size);
+            if (size > 0)
+            {
+                const amf_uint8* p = static_cast<const amf_uint8*>(pData);
+                m_Data.insert(m_Data.end(), p, p + size);
+            }
+        }
+        void PutRational(AVRational value)
+        {
+            Put(value.num);
+            Put(value.den);
+        }
+        const amf_vector<amf_uint8>& GetData() const { return m_Data; }
+    private:
+        amf_vector<amf_uint8> m_Data;
+    };
+    //-------------------------------------------------------------------------------------------------
+    // reads past the end or oversized blobs invalidate the reader instead of failing each call
+    class AMFCacheReader
+    {
+    public:
+        AMFCacheReader(const amf_uint8* pData, amf_size size) : m_pData(pData), m_Size(size), m_Pos(0), m_bValid(true) {}
+
+        template<typename T>
+        T Get()
+        {
+            T value = T();
+            if (m_bValid && m_Pos + sizeof(T) <= m_Size)
+            {
+                memcpy(&value, m_pData + m_Pos, sizeof(T));
+                m_Pos += sizeof(T);
+            }
+            else
+            {
+                m_bValid = false;
+            }
+            return value;
+        }
+        const amf_uint8* GetBytes(amf_int32& size)
+        {
+            size = Get<amf_int32>();
+            if (!m_bValid || size < 0 || (amf_size)size > m_Size - m_Pos)
+            {
+                m_bValid = false;
+                size = 0;
+                return NULL;
+            }
+            const amf_uint8* p = m_pData + m_Pos;
+            m_Pos += size;
+            return p;
+        }
+        AVRational GetRational()
+        {
+            AVRational value;
+            value.num = Get<int>();
+            value.den = Get<int>();
+            return value;
+        }
+        amf_size GetRemaining() const { return m_bValid ? m_Size - m_Pos : 0; }
+        bool IsValid() const { return m_bValid; }
+    private:
+        const amf_uint8*    m_pData;
+        amf_size            m_Size;
+        amf_size            m_Pos;
+        bool                m_bValid;
+    };
+    //-------------------------------------------------------------------------------------------------
+    // "path|size|mtime" of a local file; false if it cannot be stat'ed
+    bool                    GetCacheFileKey(const wchar_t* filePath, amf_string& key);
+    // whole file, false if missing or larger than maxSize
+    bool                    ReadCacheFile(const amf_wstring& path, amf_size maxSize, amf_vector<amf_uint8>& data);
+    // written aside and renamed so a concurrent reader never sees a partial file
+    AMF_RESULT              WriteCacheFile(const amf_wstring& path, const amf_vector<amf_uint8>& data);
+
+    //-------------------------------------------------------------------------------------------------
+    // On-disk cache of the stream parameters avformat_find_stream_info() produces for a local file.
+    // Entries are keyed by path, size and modification time, so an edited or replaced file simply
+    // misses. A hit restores codec parameters and extradata into the freshly opened context and
+    // lets the demuxer skip probing; anything that does not match exactly falls back to probing.
+    //-------------------------------------------------------------------------------------------------
+    class AMFStreamInfoCache
+    {
+    public:
+        AMFStreamInfoCache();
+
+        // cacheDir empty disables the cache; fails quietly (disabled) if the file cannot be stat'ed
+        void                Init(const wchar_t* cacheDir, const wchar_t* filePath);
+        void                Reset();
+        bool                IsEnabled() const { return !m_EntryPath.empty(); }
+
+        // fills the streams of a context returned by avformat_open_input(); false on a miss
+        bool                Load(AVFormatContext* pContext);
+        // saves the streams after a successful avformat_find_stream_info()
+        AMF_RESULT          Store(const AVFormatContext* pContext);
+
+    private:
+        amf_wstring         m_EntryPath;
+        amf_string          m_Key;
+    };
+}
@@ -35,6 +35,7 @@
 
 #include "public/common/AMFSTL.h"
 #include "public/common/DataStream.h"
+#include "public/common/DataStreamFile.h"
 #include "public/include/core/Trace.h"
 #include "public/common/TraceAdapter.h"
 
@@ -130,6 +131,122 @@ static int file_close(URLContext *h)
     return err == AMF_OK ? 0 : -1;
 }
 
+//-------------------------------------------------------------------------------------------------
+// AVIOContext callbacks on top of AMFDataStream
+//-------------------------------------------------------------------------------------------------
+static int stream_read_packet(void* opaque, uint8_t* buf, int size)
+{
+    AMFDataStream *ptr = (AMFDataStream *)opaque;
+    amf_size ready = 0;
+    AMF_RESULT err = ptr->Read(buf, size, &ready);
+    if (ready == 0)
+    {
+        return (err == AMF_OK || err == AMF_EOF) ? AVERROR_EOF : AVERROR(EIO);
+    }
+    return (int)ready;
+}
+//-------------------------------------------------------------------------------------------------
+static int stream_write_packet(void* opaque, uint8_t* buf, int size)
+{
+    AMFDataStream *ptr = (AMFDataStream *)opaque;
+    amf_size written = 0;
+    if (ptr->Write(buf, size, &written) != AMF_OK){
+        return AVERROR(EIO);
+    }
+    return (int)written;
+}
+//-------------------------------------------------------------------------------------------------
+static int64_t stream_seek(void* opaque, int64_t pos, int whence)
+{
+    AMFDataStream *ptr = (AMFDataStream *)opaque;
+    amf_int64 ret = 0;
+    AMF_RESULT err = AMF_OK;
+    whence &= ~AVSEEK_FORCE;
+    if (whence == AVSEEK_SIZE) {
+        err = ptr->GetSize(&ret);
+    }
+    else{
+        err = ptr->Seek((AMF_SEEK_ORIGIN)whence, pos, &ret);
+    }
+    if (err != AMF_OK){
+        return AVERROR(EIO);
+    }
+    return ret;
+}
+//-------------------------------------------------------------------------------------------------
+AVIOContext* AMF_STD_CALL amf::CreateAVIOContext(AMFDataStream* pStream, bool bWrite, amf_int64 iBufferSize)
+{
+    if (pStream == NULL)
+    {
+        return NULL;
+    }
+    if (iBufferSize <= 0)
+    {
+        iBufferSize = FFMPEG_IO_BUFFER_SIZE_DEFAULT;
+    }
+    // whole blocks keep flushes aligned for direct I/O
+    iBufferSize = (iBufferSize + FFMPEG_IO_BUFFER_ALIGNMENT - 1) & ~(amf_int64)(FFMPEG_IO_BUFFER_ALIGNMENT - 1);
+    iBufferSize = AMF_MIN(iBufferSize, (amf_int64)(INT_MAX & ~(FFMPEG_IO_BUFFER_ALIGNMENT - 1)));
+
+    unsigned char* pBuffer = (unsigned char*)av_malloc((size_t)iBufferSize);
+    if (pBuffer == NULL)
+    {
+        return NULL;
+    }
+    const bool bSeekable = pStream->IsSeekable();
+    AVIOContext* pContext = avio_alloc_context(pBuffer, (int)iBufferSize, bWrite ? 1 : 0, pStream,
+        bWrite ? NULL : stream_read_packet, bWrite ? stream_write_packet : NULL, bSeekable ? stream_seek : NULL);
+    if (pContext == NULL)
+    {
+        av_free(pBuffer);
+        return NULL;
+    }
+    pContext->seekable = bSeekable ? AVIO_SEEKABLE_NORMAL : 0;
+    pStream->Acquire();
+    return pContext;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL amf::DestroyAVIOContext(AVIOContext** ppContext)
+{
+    if (ppContext == NULL || *ppContext == NULL)
+    {
+        return;
+    }
+    AVIOContext* pContext = *ppContext;
+    if (pContext->write_flag)
+    {
+        avio_flush(pContext);
+    }
+    AMFDataStream *ptr = (AMFDataStream *)pContext->opaque;
+    // FFmpeg may have replaced the buffer while probing so free whatever it holds now
+    av_freep(&pContext->buffer);
+    avio_context_free(ppContext);
+    if (ptr != NULL)
+    {
+        ptr->Release();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL amf::OpenFileDataStream(const wchar_t* pPath, bool bWrite, bool bDirectIO, AMFDataStream** ppStream)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pPath);
+    AMF_RETURN_IF_INVALID_POINTER(ppStream);
+
+    AMFDataStreamFileImpl* pFile = new AMFDataStreamFileImpl();
+    AMFDataStreamPtr pStream(pFile);
+
+    if (bDirectIO && pFile->SetDirectIO(true) != AMF_OK)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"OpenFileDataStream() - direct I/O is not supported on this platform");
+    }
+    pFile->SetAccessHint(AMFFAH_SEQUENTIAL);
+
+    AMF_RESULT err = pFile->Open(pPath, bWrite ? AMFSO_WRITE : AMFSO_READ, bWrite ? AMFFS_EXCLUSIVE : AMFFS_SHARE_READ);
+    AMF_RETURN_IF_FAILED(err, L"OpenFileDataStream() - failed to open %s", pPath);
+
+    *ppStream = pStream.Detach();
+    return AMF_OK;
+}
 //-------------------------------------------------------------------------------------------------
 // FFmpeg doesnt support multi-byte file names only so if a file name has Eng + Lang1 + lang2 where one of languages is not default it will fail
 // FFmpeg 3.3.1 disabled custom protocols
@@ -33,6 +33,7 @@
 #pragma once
 
 #include "public/include/components/Component.h"
+#include "public/common/DataStream.h"
 
 
 extern "C"
@@ -64,8 +65,27 @@ namespace amf
 
     AMF_STREAM_CODEC_ID_ENUM  AMF_STD_CALL   GetAMFVideoFormat(AVCodecID inFormat);
     AVCodecID    AMF_STD_CALL   GetFFMPEGVideoFormat(AMF_STREAM_CODEC_ID_ENUM inFormat);
+
+    // AVIOContext reading from or writing to an AMFDataStream; the context holds a reference to the stream
+    AVIOContext*      AMF_STD_CALL   CreateAVIOContext(AMFDataStream* pStream, bool bWrite, amf_int64 iBufferSize);
+    void              AMF_STD_CALL   DestroyAVIOContext(AVIOContext** ppContext);
+    // opens a file stream for streaming access, optionally bypassing the page cache
+    AMF_RESULT        AMF_STD_CALL   OpenFileDataStream(const wchar_t* pPath, bool bWrite, bool bDirectIO, AMFDataStream** ppStream);
+
+    // releases the references a decoder handed out with a frame when leaving the scope
+    class AVFrameUnrefGuard
+    {
+    public:
+        AVFrameUnrefGuard(AVFrame* pFrame) : m_pFrame(pFrame) {}
+        ~AVFrameUnrefGuard() { av_frame_unref(m_pFrame); }
+    private:
+        AVFrame* m_pFrame;
+    };
 }
 
+#define FFMPEG_IO_BUFFER_SIZE_DEFAULT   (4 * 1024 * 1024)
+#define FFMPEG_IO_BUFFER_ALIGNMENT      4096
+
 // there is no definition in FFMPEG for H264MVC so create an ID
 // based on the last element in their enumeration
 #define AMF_CODEC_H265MAIN10      1005
@@ -50,6 +50,43 @@ extern "C"
 
 using namespace amf;
 
+const AMFEnumDescriptionEntry AMF_VIDEO_DECODER_THREAD_TYPE_ENUM_DESCRIPTION[] =
+{
+    { AMF_VIDEO_DECODER_THREAD_TYPE_AUTO,  L"Auto" },
+    { AMF_VIDEO_DECODER_THREAD_TYPE_FRAME, L"Frame" },
+    { AMF_VIDEO_DECODER_THREAD_TYPE_SLICE, L"Slice" },
+    { AMF_VIDEO_DECODER_THREAD_TYPE_AUTO,  0 }  // This is end of description mark
+};
+
+namespace
+{
+    //-------------------------------------------------------------------------------------------------
+    // attached to AVFrame::opaque_ref of pictures decoded into our own buffers
+    struct AMFDirectFrameLayout
+    {
+        const void* pOwner;
+        amf_int32   hPitch;
+        amf_int32   vPitch;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    // keeps a decoded picture buffer referenced for as long as the surface wrapping it is alive
+    class AMFDirectFrameObserver : public AMFSurfaceObserver
+    {
+    public:
+        AMFDirectFrameObserver(AVBufferRef* pBuffer) : m_pBuffer(pBuffer) {}
+        virtual ~AMFDirectFrameObserver() {}
+
+        virtual void AMF_STD_CALL OnSurfaceDataRelease(AMFSurface* /*pSurface*/)
+        {
+            av_buffer_unref(&m_pBuffer);
+            delete this;
+        }
+    private:
+        AVBufferRef* m_pBuffer;
+    };
+}
+
 
 //-------------------------------------------------------------------------------------------------
 AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
@@ -58,13 +95,17 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
     m_bForceEof(false),
     m_pCodecContext(NULL),
     m_SeekPts(0),
-    m_iLastDataOffset(0),
-    m_ptsLastDataOffset(0),
+    m_bDrainSent(false),
+    m_iPacketIndex(0),
     m_videoFrameSubmitCount(0),
     m_videoFrameQueryCount(0),
     m_eFormat(AMF_SURFACE_UNKNOWN),
     m_FrameRate(AMFConstructRate(25,1)),
-    m_CopyPipeline(&m_InputQueue)
+    m_iParallelCopyThreshold(VIDEO_DECODER_PARALLEL_COPY_THRESHOLD_DEFAULT),
+    m_pCopyExecutor(NULL),
+    m_bDirectOutput(true),
+    m_pDirectPool(NULL),
+    m_iDirectPoolSize(0)
 {
     g_AMFFactory.Init();
 
@@ -77,6 +118,10 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
         AMFPropertyInfoInt64(VIDEO_DECODER_BITRATE, L"Bitrate", 0, 0, INT_MAX, true),
         AMFPropertyInfoRate(VIDEO_DECODER_FRAMERATE, L"Frame rate", 25, 1, false),
         AMFPropertyInfoInt64(VIDEO_DECODER_SEEK_POSITION, L"Seek Position", 0, 0, INT_MAX, true),
+        AMFPropertyInfoInt64(VIDEO_DECODER_PARALLEL_COPY_THRESHOLD, L"Parallel copy threshold", VIDEO_DECODER_PARALLEL_COPY_THRESHOLD_DEFAULT, 0, INT_MAX, true),
+        AMFPropertyInfoInt64(VIDEO_DECODER_THREAD_COUNT, L"Thread count (0 - auto)", 0, 0, 256, true),
+        AMFPropertyInfoEnum(VIDEO_DECODER_THREAD_TYPE, L"Thread type", AMF_VIDEO_DECODER_THREAD_TYPE_AUTO, AMF_VIDEO_DECODER_THREAD_TYPE_ENUM_DESCRIPTION, true),
+        AMFPropertyInfoBool(VIDEO_DECODER_DIRECT_OUTPUT, L"Direct output", true, true),
     AMFPrimitivePropertyInfoMapEnd
 
     InitFFMPEG();
@@ -85,6 +130,11 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
 AMFVideoDecoderFFMPEGImpl::~AMFVideoDecoderFFMPEGImpl()
 {
     Terminate();
+    if (m_pCopyExecutor != NULL)
+    {
+        AMFParallelExecutor::ReleaseShared();
+        m_pCopyExecutor = NULL;
+    }
     g_AMFFactory.Terminate();
 }
 //-------------------------------------------------------------------------------------------------
@@ -151,43 +201,61 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT form
     AMFSize framesize = { width, height };
     SetProperty(VIDEO_DECODER_RESOLUTION, framesize);
 
-    m_pCodecContext->thread_count = 8;
-//    m_pCodecContext->thread_count = std::thread::hardware_concurrency();
+    amf_int64 threadCount = 0;
+    GetProperty(VIDEO_DECODER_THREAD_COUNT, &threadCount);
+    amf_int64 threadType = AMF_VIDEO_DECODER_THREAD_TYPE_AUTO;
+    GetProperty(VIDEO_DECODER_THREAD_TYPE, &threadType);
+
+    // 0 lets FFmpeg size the pool from the logical CPU count
+    m_pCodecContext->thread_count = (int)threadCount;
 #ifdef _WIN32
     //query the number of CPU HW cores
-    DWORD len = 0;
-    GetLogicalProcessorInformation(NULL, &len);
-    amf_int32 count = len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
-    SYSTEM_LOGICAL_PROCESSOR_INFORMATION* pBuffer = new SYSTEM_LOGICAL_PROCESSOR_INFORMATION[count];
-    if (pBuffer)
+    if (threadCount == 0)
     {
-        GetLogicalProcessorInformation(pBuffer, &len);
-        count = len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
-        amf_int32 iCores = 0;
-        for (amf_int32 idx = 0; idx < count; idx++)
+        DWORD len = 0;
+        GetLogicalProcessorInformation(NULL, &len);
+        amf_int32 count = len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        SYSTEM_LOGICAL_PROCESSOR_INFORMATION* pBuffer = new SYSTEM_LOGICAL_PROCESSOR_INFORMATION[count];
+        if (pBuffer)
         {
-            if (pBuffer[idx].Relationship == RelationProcessorCore)
+            GetLogicalProcessorInformation(pBuffer, &len);
+            count = len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+            amf_int32 iCores = 0;
+            for (amf_int32 idx = 0; idx < count; idx++)
             {
-                iCores++;
+                if (pBuffer[idx].Relationship == RelationProcessorCore)
+                {
+                    iCores++;
+                }
             }
+            m_pCodecContext->thread_count = iCores;
+            delete pBuffer;
         }
-        m_pCodecContext->thread_count = iCores;
-        delete pBuffer;
     }
 #endif
 
     //todo, expand to more codes
     bool bImage = (codecID == AV_CODEC_ID_EXR) || (codecID == AV_CODEC_ID_PNG);
+    const bool bFrameThreads = (m_pCodecContext->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) != 0;
+    const bool bSliceThreads = (m_pCodecContext->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) != 0;
 
-    if (bImage && (m_pCodecContext->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS))
+    if (threadType == AMF_VIDEO_DECODER_THREAD_TYPE_FRAME && bFrameThreads)
+    {
+        m_pCodecContext->thread_type = FF_THREAD_FRAME;
+    }
+    else if (threadType == AMF_VIDEO_DECODER_THREAD_TYPE_SLICE && bSliceThreads)
+    {
+        m_pCodecContext->thread_type = FF_THREAD_SLICE;
+    }
+    else if (bImage && bSliceThreads)
     {
         m_pCodecContext->thread_type = FF_THREAD_SLICE;
     }
-    else if (m_pCodecContext->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+    else if (bFrameThreads)
     {
         m_pCodecContext->thread_type = FF_THREAD_FRAME;
     }
-    else if (m_pCodecContext->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS)
+    else if (bSliceThreads)
     {
         m_pCodecContext->thread_type = FF_THREAD_SLICE;
     }
@@ -218,6 +286,19 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT form
 
     m_pCodecContext->strict_std_compliance = FF_COMPLIANCE_STRICT; // MM to try compliance
 
+    // pictures are held by reference so the ones decoded into our own buffers
+    // can be handed downstream without a copy
+    m_pCodecContext->refcounted_frames = 1;
+    GetProperty(VIDEO_DECODER_DIRECT_OUTPUT, &m_bDirectOutput);
+    if (m_bDirectOutput && (codec->capabilities & AV_CODEC_CAP_DR1) != 0)
+    {
+        m_pCodecContext->opaque = this;
+        m_pCodecContext->get_buffer2 = GetBufferCallback;
+        // the pool is guarded by m_DirectSync, so frame threads may call back directly
+        // instead of being serialized through the thread that submits packets
+        m_pCodecContext->thread_safe_callbacks = 1;
+    }
+
     if (avcodec_open2(m_pCodecContext, codec, NULL) < 0)
     {
         Terminate();
@@ -239,8 +320,10 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Terminate()
 {
     AMFLock lock(&m_sync);
 
-    // clear the internally stored buffer
-    m_pInputData = nullptr;
+    // drop the packets still in flight
+    m_InputBuffers.clear();
+    m_iPacketIndex = 0;
+    m_bDrainSent = false;
 
     // clean-up codec related items
     if (m_pCodecContext != NULL)
@@ -252,9 +335,12 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Terminate()
         m_pCodecContext = NULL;
         m_SeekPts = 0;
     }
-    m_ptsLastDataOffset = 0;
-    m_iLastDataOffset = 0;
-
+    {
+        // buffers still referenced by output surfaces keep the pool alive until they are released
+        AMFLock directLock(&m_DirectSync);
+        av_buffer_pool_uninit(&m_pDirectPool);
+        m_iDirectPoolSize = 0;
+    }
     m_videoFrameSubmitCount = 0;
     m_videoFrameQueryCount = 0;
     m_bForceEof = false;
@@ -275,9 +361,15 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Flush()
 {
     AMFLock lock(&m_sync);
 
-    // clear the internally stored buffer
-    m_pInputData = nullptr;
+    // discard the packets and pictures the decoder holds, this also
+    // makes it accept input again after it was drained
+    if (m_pCodecContext != NULL)
+    {
+        avcodec_flush_buffers(m_pCodecContext);
+    }
+    m_InputBuffers.clear();
     m_bForceEof = false;
+    m_bDrainSent = false;
 
     return AMF_OK;
 }
@@ -290,31 +382,51 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::SubmitInput(AMFData* pData)
 
     AMFLock lock(&m_sync);
 
-    // if the buffer is already full, we can't set more data
-    if (m_pInputData && pData)
+    // a NULL input means end of stream, see Drain()
+    if (pData == NULL)
     {
-        return AMF_INPUT_FULL;
+        return AMF_EOF;
     }
+    AMFBufferPtr pInBuffer(pData);
+    AMF_RETURN_IF_FALSE(pInBuffer != NULL, AMF_INVALID_ARG, L"SubmitInput() - Input should be Buffer");
 
-    // if the internal buffer is empty and the in buffer is also empty,
-    // we reached the end of the available input...
-    if (!m_pInputData && !pData)
+    // no input is accepted after Drain() until Flush() or ReInit()
+    if (m_bForceEof)
     {
         return AMF_EOF;
     }
+    // if decoding's been disabled, the packet is accepted and dropped
+    if (!m_bDecodingEnabled)
+    {
+        return AMF_OK;
+    }
+
+    AMF_RESULT err = pInBuffer->Convert(AMF_MEMORY_HOST);
+    AMF_RETURN_IF_FAILED(err, L"SubmitInput() - Convert(AMF_MEMORY_HOST) failed");
 
-    // if the internal buffer is empty and we got new data coming in
-    // update internal buffer with new information
-    if (!m_pInputData && pData)
+    av_init_packet(&m_avpkt);
+    m_avpkt.data = static_cast<uint8_t*>(pInBuffer->GetNative());
+    m_avpkt.size = int(pInBuffer->GetSize());
+    ReadAVPacketInfo(pInBuffer, &m_avpkt);
+
+    // the decoder copies the packet, the input buffer is only kept for the properties
+    // of the pictures it produces - they come back reordered and find it through reordered_opaque
+    m_pCodecContext->reordered_opaque = m_iPacketIndex;
+    int ret = avcodec_send_packet(m_pCodecContext, &m_avpkt);
+    if (ret == AVERROR(EAGAIN))
     {
-        m_ptsLastDataOffset = 0;
-        m_pInputData = AMFBufferPtr(pData);
-        AMF_RETURN_IF_FALSE(m_pInputData != 0, AMF_INVALID_ARG, L"SubmitInput() - Input should be Buffer");
+        // pictures are ready - they have to be queried before more input is accepted
+        return AMF_INPUT_FULL;
+    }
+    AMF_RETURN_IF_FALSE(ret >= 0, AMF_FAIL, L"SubmitInput() - avcodec_send_packet() failed: %d", ret);
 
-        AMF_RESULT err = m_pInputData->Convert(AMF_MEMORY_HOST);
-        AMF_RETURN_IF_FAILED(err, L"SubmitInput() - Convert(AMF_MEMORY_HOST) failed");
-        m_videoFrameSubmitCount++;
+    m_InputBuffers[m_iPacketIndex++] = pInBuffer;
+    if (m_InputBuffers.size() > VIDEO_DECODER_MAX_PACKETS_IN_FLIGHT)
+    {
+        // packets that never produce a picture would otherwise pile up
+        m_InputBuffers.erase(m_InputBuffers.begin());
     }
+    m_videoFrameSubmitCount++;
 
     return AMF_OK;
 }
@@ -333,83 +445,63 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     {
         return m_bForceEof ? AMF_EOF : AMF_OK;
     }
-    // if we requested to drain, see if we have any more packets
-    if (m_bForceEof && !m_pInputData)
+    // once draining was requested, the decoder is told there is no more input
+    if (m_bForceEof && !m_bDrainSent)
     {
-        return AMF_EOF;
+        avcodec_send_packet(m_pCodecContext, NULL);
+        m_bDrainSent = true;
     }
 
-    // if the input buffer is empty, we need more data
-    if (!m_pInputData)
-    {
-        return AMF_REPEAT;
-    }
     AMF_RESULT err = AMF_OK;
-    int got_picture = 0;
-    AMFBufferPtr pInBuffer(m_pInputData);
-
-    uint8_t* pMemIn = NULL;
-    amf_size uiMemSizeIn = 0;
-    amf_pts pts = 0;
-    amf_pts duration = 0;
-
-    if (pInBuffer != NULL)
-    {
-        pMemIn = static_cast<uint8_t*>(pInBuffer->GetNative());
-        uiMemSizeIn = pInBuffer->GetSize();
-        pts = pInBuffer->GetPts();
-        duration = pInBuffer->GetDuration();
-    }
-    AVFrame picture;  //MM: the memory allocated from preset buffers - no need to free
+    AVFrame picture;
     memset(&picture, 0, sizeof(picture));
     av_frame_unref(&picture);
+    AVFrameUnrefGuard pictureGuard(&picture);
 
-    m_avpkt.size = int(uiMemSizeIn);
-    m_avpkt.data = (uint8_t *)pMemIn;
-
-    bool bAVPacketRead = ReadAVPacketInfo(pInBuffer, &m_avpkt);
-
-    int ret = avcodec_decode_video2(m_pCodecContext, &picture, &got_picture, &m_avpkt);
-    m_pInputData = nullptr;
-
-    if (got_picture)
-    {
-        m_videoFrameQueryCount++;
-    }
-
-    if (ret < 0)
-    {
-        return AMF_FAIL;
-    }
-    amf_pts picPts = pts;
-
-    if (got_picture && bAVPacketRead)
-    {
-        picPts = GetPtsFromFFMPEG(pInBuffer, &picture);
-    }
-
-    if (!got_picture)
+    AMFBufferPtr pInBuffer;
+    amf_pts picPts = 0;
+    amf_pts duration = 0;
+    for (;;)
     {
-        if (m_bForceEof)
+        int ret = avcodec_receive_frame(m_pCodecContext, &picture);
+        if (ret == AVERROR(EAGAIN))
+        {
+            // every picture that is ready has been returned, more input is needed
+            return AMF_REPEAT;
+        }
+        if (ret == AVERROR_EOF)
         {
             return AMF_EOF;
         }
-        return AMF_OK;
-    }
+        AMF_RETURN_IF_FALSE(ret >= 0, AMF_FAIL, L"QueryOutput() - avcodec_receive_frame() failed: %d", ret);
+        m_videoFrameQueryCount++;
 
-    if (picPts < m_SeekPts)
-    {
-        return AMF_OK;
-    }
+        pInBuffer = TakeInputBuffer(picture.reordered_opaque);
+        if (pInBuffer != NULL)
+        {
+            AVPacket packetInfo;
+            av_init_packet(&packetInfo);
+            picPts = ReadAVPacketInfo(pInBuffer, &packetInfo) ? GetPtsFromFFMPEG(pInBuffer, &picture) : pInBuffer->GetPts();
+            duration = pInBuffer->GetDuration();
+        }
 
-    if (m_eFormat == AMF_SURFACE_UNKNOWN)
-    {
-        return AMF_OK;
+        // pictures before the seek point are decoded only as references
+        if (picPts >= m_SeekPts && m_eFormat != AMF_SURFACE_UNKNOWN)
+        {
+            break;
+        }
+        av_frame_unref(&picture);
     }
 
     AMF_RETURN_IF_FALSE(picture.linesize[0] > 0, AMF_FAIL, L"FFmpeg failed to return line size")
     AMFSurfacePtr pSurfaceOut;
-    if (m_pOutputDataCallback != NULL)
+    const bool bDirect = m_pOutputDataCallback == NULL && IsDirectFrame(&picture);
+    if (bDirect)
+    {
+        err = WrapDirectFrame(&picture, &pSurfaceOut);
+        AMF_RETURN_IF_FAILED(err, L"CreateSurfaceFromHostNative failed");
+    }
+    else if (m_pOutputDataCallback != NULL)
     {
         err = m_pOutputDataCallback->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, 0, 0, &pSurfaceOut);
     }
@@ -446,162 +538,120 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     amf_int32 paddedLSB = (m_eFormat == AMF_SURFACE_P010) ? 6 :
                           (m_eFormat == AMF_SURFACE_P012) ? 4 :
                           (m_eFormat == AMF_SURFACE_P016) ? 0 : 0;
-    int iThreadCount = 2;
+    const bool bHighBitDepth = m_eFormat == AMF_SURFACE_P010 ||
+                               m_eFormat == AMF_SURFACE_P012 ||
+                               m_eFormat == AMF_SURFACE_P016;
+    const AMFPlaneCopyKernels& kernels = GetPlaneCopyKernels();
+    bool bParallelCopy = false;
     {
         AMFPlanePtr plane = pSurfaceOut->GetPlane(AMF_PLANE_Y);
 
-        if (plane->GetHeight() > 2160 && m_eFormat != AMF_SURFACE_P010 &&
-                                         m_eFormat != AMF_SURFACE_P012 &&
-                                         m_eFormat != AMF_SURFACE_P016)
+        bParallelCopy = m_iParallelCopyThreshold > 0 &&
+                        (amf_int64)plane->GetWidth() * plane->GetHeight() >= m_iParallelCopyThreshold;
+        if (bParallelCopy && m_pCopyExecutor == NULL)
         {
-            if (m_CopyPipeline.m_ThreadPool.size() == 0)
-            {
-                m_CopyPipeline.Start(iThreadCount, 0);
-            }
-            amf_long counter = iThreadCount;
-
-            CopyTask task = {};
+            m_pCopyExecutor = AMFParallelExecutor::AcquireShared();
+        }
+    }
+    if (bDirect)
+    {
+        // luma (or RGBA) was decoded in place, only planar chroma still needs interleaving
+        bIsPlanar = picture.format == AV_PIX_FMT_YUV420P || picture.format == AV_PIX_FMT_YUVJ420P;
+    }
+    else
+    {
+        AMFPlanePtr plane = pSurfaceOut->GetPlane(AMF_PLANE_Y);
 
-            task.pSrc = picture.data[0];
-            task.pSrc1 = nullptr;
-            task.pDst = (amf_uint8*)plane->GetNative();
-            task.SrcLineSize = picture.linesize[0];
-            task.DstLineSize = plane->GetHPitch();
-            task.pEvent = &m_CopyPipeline.m_endEvent;
-            task.pCounter = &counter;
+        amf_uint8 *pPlaneOut = static_cast<amf_uint8*>(plane->GetNative());
+        const amf_size uOutPitch = plane->GetHPitch();
+        const amf_int32 iHeight = plane->GetHeight();
 
-            for (int i = 0; i < iThreadCount; i++)
+        if (picture.format == AV_PIX_FMT_YUV422P10LE)  //ProRes 10bit 4:2:2 from BM camera
+        {
+            amf_size uWidth = plane->GetWidth() / 2;  //YUYV
+            CopyRows(bParallelCopy, iHeight, [&](amf_int32 lineStart, amf_int32 lineEnd)
+            {
+                for (amf_int32 y = lineStart; y < lineEnd; y++)
+                {
+                    kernels.PackY210((amf_uint16*)(pPlaneOut + y * uOutPitch),
+                                     (amf_uint16*)(picture.data[0] + y * picture.linesize[0]),
+                                     (amf_uint16*)(picture.data[1] + y * picture.linesize[1]),
+                                     (amf_uint16*)(picture.data[2] + y * picture.linesize[2]),
+                                     uWidth, 6); //UYVY
+                }
+            });
+            bIsPlanar = false;
+        }
+        else if (uOutPitch == (amf_size)picture.linesize[0])
+        {
+            CopyRows(bParallelCopy, iHeight, [&](amf_int32 lineStart, amf_int32 lineEnd)
             {
-                task.lineStart = i * (plane->GetHeight() / iThreadCount);
-                if (i < iThreadCount - 1)
+                amf_uint8 *pIn = picture.data[0] + lineStart * uOutPitch;
+                amf_uint8 *pOut = pPlaneOut + lineStart * uOutPitch;
+                if (bHighBitDepth)
                 {
-                    task.lineEnd = task.lineStart + plane->GetHeight() / iThreadCount;
+                    kernels.ShiftLeft16((amf_uint16*)pOut, (amf_uint16*)pIn, ((lineEnd - lineStart) * uOutPitch) >> 1, paddedLSB);
                 }
                 else
                 {
-                    task.lineEnd = plane->GetHeight();
+                    memcpy(pOut, pIn, (lineEnd - lineStart) * uOutPitch);
                 }
-                m_InputQueue.Add(i, task);
-            }
-            if (m_CopyPipeline.m_endEvent.Lock(1000) == false)
-            {
-                // timout
-                int a = 1;
-            }
+            });
         }
         else
         {
-            if (picture.format == AV_PIX_FMT_YUV422P10LE)  //ProRes 10bit 4:2:2 from BM camera
+            amf_size to_copy = AMF_MIN(uOutPitch, (amf_size)std::abs(picture.linesize[0]));
+
+            if ((picture.format == AV_PIX_FMT_RGBA64LE) || //RGB -->RGBA
+                (picture.format == AV_PIX_FMT_RGB48LE)  || //RGB -->RGBA
+                (picture.format == AV_PIX_FMT_RGB48BE))    //RGB -->RGBA
             {
-                amf_uint16 *pTmpMemY210 = static_cast<amf_uint16*>(plane->GetNative());
-                amf_uint16 *pTmpMemInY = (amf_uint16*)(picture.data[0]);
-                amf_uint16 *pTmpMemInV = (amf_uint16*)(picture.data[1]);
-                amf_uint16 *pTmpMemInU = (amf_uint16*)(picture.data[2]);
-                amf_size uWidth = plane->GetWidth() / 2;  //YUYV
-                amf_size linesToCopy = plane->GetHeight();
-                for (amf_size y = 0; y < linesToCopy; y++)
+                CopyRows(bParallelCopy, iHeight, [&](amf_int32 lineStart, amf_int32 lineEnd)
                 {
-                    for (amf_size x = 0; x < uWidth; x++)  //UYVY
-                    {
-                        pTmpMemY210[4 * x + 0] = (pTmpMemInV[x] << 6) & 0xFFC0;        //U
-                        pTmpMemY210[4 * x + 1] = (pTmpMemInY[2 * x] << 6) & 0xFFC0;    //Y
-                        pTmpMemY210[4 * x + 2] = (pTmpMemInU[x] << 6) & 0xFFC0;        //V
-                        pTmpMemY210[4 * x + 3] = (pTmpMemInY[2 * x + 1] << 6) & 0xFFC0;//Y
-                    }
-                    pTmpMemInY  += picture.linesize[0] / sizeof(amf_uint16);
-                    pTmpMemInU  += picture.linesize[1] / sizeof(amf_uint16);
-                    pTmpMemInV  += picture.linesize[2] / sizeof(amf_uint16);
-                    pTmpMemY210 += plane->GetHPitch() / sizeof(amf_uint16);
-                }
+                    CopyFrameRGB_FP16(pPlaneOut + lineStart * uOutPitch, picture.data[0] + lineStart * picture.linesize[0],
+                                      picture.format, picture.linesize[0], uOutPitch, plane->GetWidth(), lineEnd - lineStart);
+                });
+                pSurfaceOut->SetProperty(VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC, AMF_COLOR_TRANSFER_CHARACTERISTIC_LINEAR);
                 bIsPlanar = false;
             }
-            else if (plane->GetHPitch() == picture.linesize[0])
+            else if (picture.format == AV_PIX_FMT_YUV444P10LE) //YUV444
             {
-                if (m_eFormat == AMF_SURFACE_P010 ||
-                    m_eFormat == AMF_SURFACE_P012 ||
-                    m_eFormat == AMF_SURFACE_P016)
+                amf_size uWidth = plane->GetWidth();
+                CopyRows(bParallelCopy, iHeight, [&](amf_int32 lineStart, amf_int32 lineEnd)
                 {
-                    amf_uint16 *pTmp16Src = (amf_uint16 *)picture.data[0];
-                    amf_uint16 *pTmp16Dest = (amf_uint16 *)(plane->GetNative());
-
-                    for (amf_int32 wordIdx = 0; wordIdx < (plane->GetHPitch() * plane->GetHeight()) >> 1; wordIdx++)
+                    for (amf_int32 y = lineStart; y < lineEnd; y++)
                     {
-                        pTmp16Dest[wordIdx] = pTmp16Src[wordIdx] << paddedLSB;
+                        kernels.PackY416((amf_uint16*)(pPlaneOut + y * uOutPitch),
+                                         (amf_uint16*)(picture.data[0] + y * picture.linesize[0]),
+                                         (amf_uint16*)(picture.data[1] + y * picture.linesize[1]),
+                                         (amf_uint16*)(picture.data[2] + y * picture.linesize[2]),
+                                         uWidth, 6);
                     }
-                }
-                else
-                {
-                    memcpy(plane->GetNative(), picture.data[0], plane->GetHPitch() * plane->GetHeight());
-                }
+                });
+                bIsPlanar = false;
             }
             else
             {
-                amf_uint8 *pTmpMemOut = static_cast<amf_uint8*>(plane->GetNative());
-                amf_uint8 *pTmpMemIn = picture.data[0];
-                amf_size to_copy = AMF_MIN(plane->GetHPitch(), std::abs(picture.linesize[0]));
-                amf_size linesToCopy = plane->GetHeight();
-
-                if ((picture.format == AV_PIX_FMT_RGBA64LE) || //RGB -->RGBA
-                    (picture.format == AV_PIX_FMT_RGB48LE)  || //RGB -->RGBA
-                    (picture.format == AV_PIX_FMT_RGB48BE))    //RGB -->RGBA
-                {
-                    CopyFrameRGB_FP16(pTmpMemOut, pTmpMemIn, picture.format, picture.linesize[0], plane->GetHPitch(), plane->GetWidth(), linesToCopy);
-                    pSurfaceOut->SetProperty(VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC, AMF_COLOR_TRANSFER_CHARACTERISTIC_LINEAR);
-                    bIsPlanar = false;
-                }
-                else if (picture.format == AV_PIX_FMT_YUV444P10LE) //YUV444
-                {
-                    amf_uint16 *pTmpMemYUVA = static_cast<amf_uint16*>(plane->GetNative());
-                    amf_uint16 *pTmpMemInY = (amf_uint16*)(picture.data[0]);
-                    amf_uint16 *pTmpMemInU = (amf_uint16*)(picture.data[1]);
-                    amf_uint16 *pTmpMemInV = (amf_uint16*)(picture.data[2]);
-                    amf_size uWidth = plane->GetWidth();
-                    for (amf_size y = 0; y < linesToCopy; y++)
-                    {
-                        for (amf_size x = 0; x < uWidth; x++)
-                        {
-                            pTmpMemYUVA[4 * x + 0] = pTmpMemInU[x] << 6;
-                            pTmpMemYUVA[4 * x + 1] = pTmpMemInY[x] << 6;
-                            pTmpMemYUVA[4 * x + 2] = pTmpMemInV[x] << 6;
-                            pTmpMemYUVA[4 * x + 3] = 65535;
-                        }
-                        pTmpMemInY += picture.linesize[0] / sizeof(amf_uint16);
-                        pTmpMemInU += picture.linesize[1] / sizeof(amf_uint16);
-                        pTmpMemInV += picture.linesize[2] / sizeof(amf_uint16);
-                        pTmpMemYUVA += plane->GetHPitch() / sizeof(amf_uint16);
-                    }
-                    bIsPlanar = false;
-                }
-                else
+                CopyRows(bParallelCopy, iHeight, [&](amf_int32 lineStart, amf_int32 lineEnd)
                 {
-                    while (linesToCopy > 0)
+                    for (amf_int32 y = lineStart; y < lineEnd; y++)
                     {
-                        if (m_eFormat == AMF_SURFACE_P010 ||
-                            m_eFormat == AMF_SURFACE_P012 ||
-                            m_eFormat == AMF_SURFACE_P016)
+                        amf_uint8 *pIn = picture.data[0] + y * picture.linesize[0];
+                        amf_uint8 *pOut = pPlaneOut + y * uOutPitch;
+                        if (bHighBitDepth)
                         {
                             // FFMPEG outputs in LSB format but we want MSB
                             // 10-bit example:
                             //     (LSB)         :  000000DD DDDDDDDD
                             //     we want (MSB) :  DDDDDDDD DD000000
-                            amf_uint16 *pTmp16Src = (amf_uint16 *)pTmpMemIn;
-                            amf_uint16 *pTmp16Dest = (amf_uint16 *)pTmpMemOut;
-
-                            for (amf_size lineIdx = 0; lineIdx < to_copy >> 1; lineIdx++)
-                            {
-                                pTmp16Dest[lineIdx] = pTmp16Src[lineIdx] << paddedLSB;
-                            }
+                            kernels.ShiftLeft16((amf_uint16*)pOut, (amf_uint16*)pIn, to_copy >> 1, paddedLSB);
                         }
                         else
                         {
-                            memcpy(pTmpMemOut, pTmpMemIn, to_copy);
+                            memcpy(pOut, pIn, to_copy);
                         }
-
-                        pTmpMemOut += plane->GetHPitch();
-                        pTmpMemIn += picture.linesize[0];
-                        linesToCopy -= 1;
                     }
-                }
+                });
             }
         }
     }
@@ -610,100 +660,31 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     {
         AMFPlanePtr plane = pSurfaceOut->GetPlane(AMF_PLANE_UV);
 
-        if (plane->GetHeight() > 2160 / 2 && m_eFormat != AMF_SURFACE_P010 &&
-                                             m_eFormat != AMF_SURFACE_P012 &&
-                                             m_eFormat != AMF_SURFACE_P016)
-        {
-            if (m_CopyPipeline.m_ThreadPool.size() == 0)
-            {
-                m_CopyPipeline.Start(iThreadCount, 0);
-            }
-            amf_long counter = iThreadCount;
+        amf_uint8 *pPlaneOut = static_cast<amf_uint8*>(plane->GetNative());
+        const amf_size uOutPitch = plane->GetHPitch();
+        const amf_size uWidth = plane->GetWidth();
 
+        // need to pack uv plane properly for 16-bit colour
+        const bool bWideUV = plane->GetPixelSizeInBytes() == 4;
 
-            CopyTask task;
-
-            task.pSrc = picture.data[1];
-            task.pSrc1 = picture.data[2];
-            task.pDst = (amf_uint8*)plane->GetNative();
-            task.SrcLineSize = picture.linesize[1];
-            task.DstLineSize = plane->GetHPitch();
-            task.pEvent = &m_CopyPipeline.m_endEvent;
-            task.pCounter = &counter;
-
-            for (int i = 0; i < iThreadCount; i++)
-            {
-                task.lineStart = i * (plane->GetHeight() / iThreadCount);
-                if (i < iThreadCount - 1)
-                {
-                    task.lineEnd = task.lineStart + plane->GetHeight() / iThreadCount;
-                }
-                else
-                {
-                    task.lineEnd = plane->GetHeight();
-                }
-                m_InputQueue.Add(i, task);
-            }
-            if (m_CopyPipeline.m_endEvent.Lock(1000) == false)
-            {
-                // timout
-                int a = 1;
-            }
-        }
-        else
+        CopyRows(bParallelCopy, plane->GetHeight(), [&](amf_int32 lineStart, amf_int32 lineEnd)
         {
-            amf_uint8 *pTmpMemOut = static_cast<amf_uint8*>(plane->GetNative());
-            amf_int32 iOutStride = plane->GetHPitch();
-            amf_uint8 *pTmpMemIn[2] = { picture.data[1], picture.data[2] };
-
-            amf_size uHeight = plane->GetHeight();
-            amf_size uWidth = plane->GetWidth();
-
-            // need to pack uv plane properly for 16-bit colour
-
-            if (plane->GetPixelSizeInBytes() == 4)
+            for (amf_int32 y = lineStart; y < lineEnd; y++)
             {
-                for (amf_size y = 0; y < uHeight; y++)
+                amf_uint8 *pOut = pPlaneOut + y * uOutPitch;
+                amf_uint8 *pInU = picture.data[1] + y * picture.linesize[1];
+                amf_uint8 *pInV = picture.data[2] + y * picture.linesize[2];
+                if (bWideUV)
                 {
-                    amf_uint16 *pLineMemOut = (amf_uint16*)pTmpMemOut;
-                    amf_uint16 *pLineMemIn1 = (amf_uint16*)pTmpMemIn[0];
-                    amf_uint16 *pLineMemIn2 = (amf_uint16*)pTmpMemIn[1];
-                    for (amf_size x = 0; x < uWidth; x++)
-                    {
-                        // FFMPEG outputs in LSB format but we want MSB
-                        // 10-bit example:
-                        //     (LSB)         :  000000DD DDDDDDDD
-                        //     we want (MSB) :  DDDDDDDD DD000000
-
-                        *pLineMemOut++ = *pLineMemIn1++ << paddedLSB;
-                        *pLineMemOut++ = *pLineMemIn2++ << paddedLSB;
-                    }
-                    pTmpMemOut += iOutStride;
-                    pTmpMemIn[0] += picture.linesize[1];
-                    pTmpMemIn[1] += picture.linesize[2];
+                    kernels.InterleaveUV16((amf_uint16*)pOut, (amf_uint16*)pInU, (amf_uint16*)pInV, uWidth, paddedLSB);
                 }
-            }
-            else
-            {
-                for (amf_size y = 0; y < uHeight; y++)
+                else
                 {
-                    amf_uint8 *pLineMemOut = pTmpMemOut;
-                    amf_uint8 *pLineMemIn1 = pTmpMemIn[0];
-                    amf_uint8 *pLineMemIn2 = pTmpMemIn[1];
-                    for (amf_size x = 0; x < uWidth; x++)
-                    {
-                        *pLineMemOut++ = *pLineMemIn1++;
-                        *pLineMemOut++ = *pLineMemIn2++;
-                    }
-                    pTmpMemOut += iOutStride;
-                    pTmpMemIn[0] += picture.linesize[1];
-                    pTmpMemIn[1] += picture.linesize[2];
+                    kernels.InterleaveUV8(pOut, pInU, pInV, uWidth);
                 }
             }
-        }
+        });
     }
-    double frame_time = (double)pts / AMF_SECOND;
-
     pSurfaceOut->SetPts(picPts);
 
 
@@ -900,26 +881,15 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
 
     pSurfaceOut->SetFrameType(eFrameType);
 
-    pInBuffer->CopyTo(pSurfaceOut, false);
+    if (pInBuffer != NULL)
+    {
+        pInBuffer->CopyTo(pSurfaceOut, false);
+    }
 
     *ppData = pSurfaceOut;
     (*ppData)->Acquire();
 
-    if (got_picture)
-    {
-        // return AMF_REPEAT;
-    }
-    if (m_bForceEof)
-    {
-        if (got_picture)
-        {
-            return AMF_REPEAT;
-        }
-        else
-        {
-            return AMF_EOF;
-        }
-    }
+    // while draining the caller keeps querying until the decoder reports AMF_EOF
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -934,6 +904,12 @@ void AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::OnPropertyChanged(const wchar_t* p
         return;
     }
 
+    if (name == VIDEO_DECODER_PARALLEL_COPY_THRESHOLD)
+    {
+        GetProperty(VIDEO_DECODER_PARALLEL_COPY_THRESHOLD, &m_iParallelCopyThreshold);
+        return;
+    }
+
     if (name == VIDEO_DECODER_SEEK_POSITION)
     {
         amf_pts  seekPts = 0;
@@ -943,6 +919,9 @@ void AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::OnPropertyChanged(const wchar_t* p
             {
                 avcodec_flush_buffers(m_pCodecContext);
             }
+            m_InputBuffers.clear();
+            m_bForceEof = false;
+            m_bDrainSent = false;
             m_SeekPts = seekPts;
         }
     }
@@ -955,6 +934,146 @@ void AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::OnPropertyChanged(const wchar_t* p
 //
 //
 
+//-------------------------------------------------------------------------------------------------
+int AMF_CDECL_CALL AMFVideoDecoderFFMPEGImpl::GetBufferCallback(AVCodecContext* pCodecContext, AVFrame* pFrame, int flags)
+{
+    AMFVideoDecoderFFMPEGImpl* pThis = static_cast<AMFVideoDecoderFFMPEGImpl*>(pCodecContext->opaque);
+    if (pThis != NULL && pThis->GetDirectBuffer(pCodecContext, pFrame))
+    {
+        return 0;
+    }
+    return avcodec_default_get_buffer2(pCodecContext, pFrame, flags);
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::GetDirectBuffer(AVCodecContext* pCodecContext, AVFrame* pFrame)
+{
+    // only layouts the output surface can share with the decoder:
+    // NV12 as is, YUV420P with U and V decoded into scratch planes behind the surface
+    // and interleaved into its UV plane on output, RGBA as is
+    const bool bNV12   = m_eFormat == AMF_SURFACE_NV12 && pFrame->format == AV_PIX_FMT_NV12;
+    const bool bPlanar = m_eFormat == AMF_SURFACE_NV12 && (pFrame->format == AV_PIX_FMT_YUV420P || pFrame->format == AV_PIX_FMT_YUVJ420P);
+    const bool bRGBA   = m_eFormat == AMF_SURFACE_RGBA && pFrame->format == AV_PIX_FMT_RGBA;
+    if (!bNV12 && !bPlanar && !bRGBA)
+    {
+        return false;
+    }
+
+    int width = pFrame->width;
+    int height = pFrame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS] = {};
+    avcodec_align_dimensions2(pCodecContext, &width, &height, linesizeAlign);
+    for (int i = 0; i < (bPlanar ? 3 : bNV12 ? 2 : 1); i++)
+    {
+        if (linesizeAlign[i] <= 0 || VIDEO_DECODER_DIRECT_BUFFER_ALIGN % linesizeAlign[i] != 0)
+        {
+            return false;
+        }
+    }
+
+    const amf_int64 hPitch = FFALIGN(width * (bRGBA ? 4 : 1), VIDEO_DECODER_DIRECT_BUFFER_ALIGN);
+    const amf_int64 vPitch = FFALIGN(height, 2);
+    const amf_int64 chromaPitch = bPlanar ? FFALIGN((width + 1) / 2, VIDEO_DECODER_DIRECT_BUFFER_ALIGN) : 0;
+    const amf_int64 lumaSize = hPitch * vPitch;
+    const amf_int64 uvSize = bRGBA ? 0 : lumaSize / 2;
+    const amf_int64 chromaSize = chromaPitch * vPitch / 2;
+    // trailing padding covers SIMD over-reads past the last line
+    const amf_int64 size = lumaSize + uvSize + 2 * chromaSize + VIDEO_DECODER_DIRECT_BUFFER_ALIGN;
+    if (size > INT_MAX)
+    {
+        return false;
+    }
+
+    AVBufferRef* pBuffer = NULL;
+    {
+        AMFLock lock(&m_DirectSync);
+        if (m_pDirectPool == NULL || m_iDirectPoolSize != (amf_int32)size)
+        {
+            av_buffer_pool_uninit(&m_pDirectPool);
+            m_pDirectPool = av_buffer_pool_init((int)size, NULL);
+            m_iDirectPoolSize = m_pDirectPool != NULL ? (amf_int32)size : 0;
+        }
+        if (m_pDirectPool != NULL)
+        {
+            pBuffer = av_buffer_pool_get(m_pDirectPool);
+        }
+    }
+    if (pBuffer == NULL)
+    {
+        return false;
+    }
+    AVBufferRef* pLayoutBuffer = av_buffer_alloc(sizeof(AMFDirectFrameLayout));
+    if (pLayoutBuffer == NULL)
+    {
+        av_buffer_unref(&pBuffer);
+        return false;
+    }
+    AMFDirectFrameLayout* pLayout = reinterpret_cast<AMFDirectFrameLayout*>(pLayoutBuffer->data);
+    pLayout->pOwner = this;
+    pLayout->hPitch = (amf_int32)hPitch;
+    pLayout->vPitch = (amf_int32)vPitch;
+
+    pFrame->buf[0] = pBuffer;
+    pFrame->opaque_ref = pLayoutBuffer;
+    pFrame->data[0] = pBuffer->data;
+    pFrame->linesize[0] = (int)hPitch;
+    if (bNV12)
+    {
+        pFrame->data[1] = pFrame->data[0] + lumaSize;
+        pFrame->linesize[1] = (int)hPitch;
+    }
+    else if (bPlanar)
+    {
+        pFrame->data[1] = pFrame->data[0] + lumaSize + uvSize;
+        pFrame->data[2] = pFrame->data[1] + chromaSize;
+        pFrame->linesize[1] = (int)chromaPitch;
+        pFrame->linesize[2] = (int)chromaPitch;
+    }
+    pFrame->extended_data = pFrame->data;
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::IsDirectFrame(const AVFrame* pFrame) const
+{
+    if (pFrame->opaque_ref == NULL || pFrame->opaque_ref->size != sizeof(AMFDirectFrameLayout) ||
+        reinterpret_cast<const AMFDirectFrameLayout*>(pFrame->opaque_ref->data)->pOwner != this)
+    {
+        return false;
+    }
+    // left / top cropping moves the plane pointers away from the surface layout
+    return pFrame->buf[0] != NULL && pFrame->data[0] == pFrame->buf[0]->data;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::WrapDirectFrame(AVFrame* pFrame, AMFSurface** ppSurface)
+{
+    const AMFDirectFrameLayout* pLayout = reinterpret_cast<const AMFDirectFrameLayout*>(pFrame->opaque_ref->data);
+
+    // the decoder may still read the picture as a reference, the buffer goes back
+    // to the pool once both the decoder and the surface have let go of it
+    AVBufferRef* pBuffer = av_buffer_ref(pFrame->buf[0]);
+    AMF_RETURN_IF_FALSE(pBuffer != NULL, AMF_OUT_OF_MEMORY, L"av_buffer_ref() failed");
+
+    AMFDirectFrameObserver* pObserver = new AMFDirectFrameObserver(pBuffer);
+    AMF_RESULT err = m_pContext->CreateSurfaceFromHostNative(m_eFormat, pFrame->width, pFrame->height,
+                                                             pLayout->hPitch, pLayout->vPitch, pFrame->data[0], ppSurface, pObserver);
+    if (err != AMF_OK)
+    {
+        delete pObserver;
+        av_buffer_unref(&pBuffer);
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
+AMFBufferPtr AMF_STD_CALL AMFVideoDecoderFFMPEGImpl::TakeInputBuffer(amf_int64 packetIndex)
+{
+    AMFBufferPtr pBuffer;
+    InputBufferMap::iterator it = m_InputBuffers.find(packetIndex);
+    if (it != m_InputBuffers.end())
+    {
+        pBuffer = it->second;
+        m_InputBuffers.erase(it);
+    }
+    return pBuffer;
+}
 //-------------------------------------------------------------------------------------------------
 bool AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::ReadAVPacketInfo(AMFBuffer* pBuffer, AVPacket *pPacket)
 {
@@ -1016,38 +1135,29 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameRGB_FP16(
     amf_size   uHeight)       //frame height
 {
     AMF_RESULT ret = AMF_OK;
+    const AMFPlaneCopyKernels& kernels = GetPlaneCopyKernels();
 
     if (m_eFormat == AMF_SURFACE_RGBA)
     {
         amf_uint8 *pSrc = (amf_uint8 *)pMemIn;
         amf_uint8 *pDst = (amf_uint8 *)pMemOut;
-        amf_uint16 temp = 0;
         for (amf_size y = 0; y < uHeight; y++)
         {
-            for (amf_size x = 0; x < uWidth; x++)
+            if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
             {
-                if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 0];
-                    pDst[4 * x + 1] = pSrc[6 * x + 2];
-                    pDst[4 * x + 2] = pSrc[6 * x + 4];
-                    pDst[4 * x + 3] = 255;
-                }
-                else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 1];
-                    pDst[4 * x + 1] = pSrc[6 * x + 3];
-                    pDst[4 * x + 2] = pSrc[6 * x + 5];
-                    pDst[4 * x + 3] = 255;
-                }
-                else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
-                {
-                    pDst[4 * x + 0] = pSrc[8 * x + 1];
-                    pDst[4 * x + 1] = pSrc[8 * x + 3];
-                    pDst[4 * x + 2] = pSrc[8 * x + 5];
-                    pDst[4 * x + 3] = pSrc[8 * x + 7];
-                }
-                else
+                kernels.RGB48ToRGBA8(pDst, pSrc, uWidth, true);
+            }
+            else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
+            {
+                kernels.RGB48ToRGBA8(pDst, pSrc, uWidth, false);
+            }
+            else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
+            {
+                kernels.RGBA64ToRGBA8(pDst, pSrc, uWidth);
+            }
+            else
+            {
+                for (amf_size x = 0; x < uWidth; x++)
                 {
                     pDst[4 * x + 0] = pSrc[6 * x + 1];
                     pDst[4 * x + 1] = pSrc[6 * x + 3];
@@ -1072,39 +1182,12 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameRGB_FP16(
                 pSrc += uPitchIn / sizeof(amf_uint16);
             }
         }
-        else
+        else if (iPixelFormat == AV_PIX_FMT_RGB48BE || //png
+                 iPixelFormat == AV_PIX_FMT_RGB48LE)   //EXR
         {
-            amf_uint8* pTemp = 0;
             for (amf_size y = 0; y < uHeight; y++)
             {
-                for (amf_size x = 0; x < uWidth; x++)
-                {
-
-                    if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
-                    {
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 0];
-                        pDst[4 * x + 0] = (pTemp[0] << 8) | pTemp[1];
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 1];
-                        pDst[4 * x + 1] = (pTemp[0] << 8) | pTemp[1];
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 2];
-                        pDst[4 * x + 2] = (pTemp[0] << 8) | pTemp[1];
-                        pDst[4 * x + 3] = 65535;
-                    }
-                    else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
-                    {
-                        pDst[4 * x + 0] = pSrc[3 * x + 0];
-                        pDst[4 * x + 1] = pSrc[3 * x + 1];
-                        pDst[4 * x + 2] = pSrc[3 * x + 2];
-                        pDst[4 * x + 3] = 65535;
-                    }
-                    else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
-                    {
-                        pDst[4 * x + 0] = pSrc[4 * x + 0];
-                        pDst[4 * x + 1] = pSrc[4 * x + 1];
-                        pDst[4 * x + 2] = pSrc[4 * x + 2];
-                        pDst[4 * x + 3] = pSrc[4 * x + 3];
-                    }
-                }
+                kernels.RGB48ToRGBA16(pDst, (amf_uint8*)pSrc, uWidth, iPixelFormat == AV_PIX_FMT_RGB48BE);
                 pDst += uPitchOut / sizeof(amf_uint16);
                 pSrc += uPitchIn / sizeof(amf_uint16);
             }
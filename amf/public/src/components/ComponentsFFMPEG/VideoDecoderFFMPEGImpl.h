@@ -35,7 +35,9 @@
 #include "public/include/components/Component.h"
 #include "public/include/components/FFMPEGVideoDecoder.h"
 #include "public/common/PropertyStorageExImpl.h"
+#include "public/common/ParallelExecutor.h"
 #include "public/include/core/Context.h"
+#include "PlaneCopyKernels.h"
 
 extern "C"
 {
@@ -52,6 +54,10 @@ extern "C"
 #endif
 }
 
+#define VIDEO_DECODER_PARALLEL_COPY_THRESHOLD_DEFAULT   (1280 * 720)
+#define VIDEO_DECODER_COPY_MIN_LINES_PER_BAND           32
+#define VIDEO_DECODER_DIRECT_BUFFER_ALIGN               64
+#define VIDEO_DECODER_MAX_PACKETS_IN_FLIGHT             128
 
 namespace amf
 {
@@ -94,11 +100,33 @@ namespace amf
 
 
     protected:
+        // libavcodec get_buffer2 hook - hands out host buffers laid out as the output surface
+        static int AMF_CDECL_CALL GetBufferCallback(AVCodecContext* pCodecContext, AVFrame* pFrame, int flags);
+        bool       AMF_STD_CALL  GetDirectBuffer(AVCodecContext* pCodecContext, AVFrame* pFrame);
+        bool       AMF_STD_CALL  IsDirectFrame(const AVFrame* pFrame) const;
+        AMF_RESULT AMF_STD_CALL  WrapDirectFrame(AVFrame* pFrame, AMFSurface** ppSurface);
+
+        AMFBufferPtr AMF_STD_CALL TakeInputBuffer(amf_int64 packetIndex);
+
         bool       AMF_STD_CALL  ReadAVPacketInfo(AMFBuffer* pBuffer, AVPacket *pPacket);
         amf_pts    AMF_STD_CALL  GetPtsFromFFMPEG(AMFBuffer* pBuffer, AVFrame *pFrame);
         AMF_RESULT AMF_STD_CALL  CopyFrameRGB_FP16(amf_uint8* pMemOut, amf_uint8* pMemIn, amf_int32 iPixelFormat,
                                     amf_size uPitchIn, amf_size uPitchOut, amf_size uWidth, amf_size uHeight);
 
+        // runs func(lineStart, lineEnd) over all rows, split into bands on the copy executor when bParallel is set
+        template<typename _Func>
+        void AMF_STD_CALL  CopyRows(bool bParallel, amf_int32 lineCount, _Func func)
+        {
+            if (bParallel && m_pCopyExecutor != NULL)
+            {
+                m_pCopyExecutor->ForEachBand(lineCount, VIDEO_DECODER_COPY_MIN_LINES_PER_BAND, func);
+            }
+            else
+            {
+                func(0, lineCount);
+            }
+        }
+
     private:
         mutable AMFCriticalSection  m_sync;
 
@@ -109,11 +137,14 @@ namespace amf
         AVPacket                m_avpkt;
         AVCodecContext*         m_pCodecContext;
         amf_pts                 m_SeekPts;
+        bool                    m_bDrainSent;
 
         AMFBufferPtr            pExtraData;
-        AMFBufferPtr            m_pInputData;
-        amf_size                m_iLastDataOffset;
-        amf_pts                 m_ptsLastDataOffset;
+
+        // packets sent to the decoder, keyed by the reordered_opaque their pictures come back with
+        typedef amf_map<amf_int64, AMFBufferPtr> InputBufferMap;
+        InputBufferMap          m_InputBuffers;
+        amf_int64               m_iPacketIndex;
 
         amf_int64               m_videoFrameSubmitCount;
         amf_int64               m_videoFrameQueryCount;
@@ -123,77 +154,14 @@ namespace amf
 
         AMFDataAllocatorCBPtr       m_pOutputDataCallback;
 
-        struct CopyTask
-        {
-            amf_uint8 *pSrc;
-            amf_uint8 *pSrc1;
-            amf_uint8 *pDst;
-            amf_size   SrcLineSize;
-            amf_size   DstLineSize;
-            amf_int    lineStart;
-            amf_int    lineEnd;
-            AMFEvent*  pEvent;
-            amf_long*  pCounter;
-
-            void Run()
-            {
-
-                if (pSrc1 == nullptr)
-                {
-                    amf_size   toCopy = AMF_MIN(SrcLineSize, DstLineSize);
-                    for (amf_int i = lineStart; i < lineEnd; i++)
-                    {
-                        memcpy(pDst + i * DstLineSize, pSrc + i * SrcLineSize, toCopy);
-                    }
-                }
-                else
-                {
-                    amf_size   toCopy = SrcLineSize;
-
-                    for (amf_int i = lineStart; i < lineEnd; i++)
-                    {
-                        amf_uint8 *pLineMemOut = pDst + i * DstLineSize;
-                        amf_uint8 *pLineMemIn1 = pSrc + i * SrcLineSize;
-                        amf_uint8 *pLineMemIn2 = pSrc1 + i * SrcLineSize;
-
-                        for (amf_size x = 0; x < toCopy; x++)
-                        {
-                            *pLineMemOut++ = *pLineMemIn1++;
-                            *pLineMemOut++ = *pLineMemIn2++;
-                        }
-                    }
-                }
-                if (amf_atomic_dec(pCounter) == 0)
-                {
-                    pEvent->SetEvent();
-                }
-            }
-        };
-        AMFQueue<CopyTask> m_InputQueue;
-
-        class CopyThread : public AMFQueueThread<CopyTask, int>
-        {
-        public:
-            CopyThread(AMFQueue<CopyTask>* pInputQueue, AMFQueue<int>* pOutputQueue, int param) :
-                AMFQueueThread<CopyTask, int>(pInputQueue, pOutputQueue) {}
-            virtual bool Process(amf_ulong& ulID, CopyTask& inData, int& outData)
-            {
-                inData.Run();
-                return true;
-            }
-        };
+        amf_int64               m_iParallelCopyThreshold;
+        AMFParallelExecutor*    m_pCopyExecutor;
 
-        class CopyPipeline : public AMFQueueThreadPipeline<CopyTask, int, CopyThread, int>
-        {
-        public:
-            CopyPipeline(AMFQueue<CopyTask>* pInputQueue) :
-                AMFQueueThreadPipeline<CopyTask, int, CopyThread, int>(pInputQueue, nullptr),
-                m_endEvent(false, false)
-            {
-            }
-            AMFEvent m_endEvent;
-        };
-        CopyPipeline m_CopyPipeline;
+        // decode-in-place buffers, get_buffer2 can be called from the frame threads
+        AMFCriticalSection      m_DirectSync;
+        bool                    m_bDirectOutput;
+        AVBufferPool*           m_pDirectPool;
+        amf_int32               m_iDirectPoolSize;
 
         AMFVideoDecoderFFMPEGImpl(const AMFVideoDecoderFFMPEGImpl&);
         AMFVideoDecoderFFMPEGImpl& operator=(const AMFVideoDecoderFFMPEGImpl&);
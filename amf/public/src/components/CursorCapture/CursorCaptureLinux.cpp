@@ -42,6 +42,8 @@ using namespace amf;
 
 typedef std::unique_ptr<XFixesCursorImage, decltype(&XFree)> XFixesCursorImagePtr;
 
+static const amf_size MAX_CACHED_CURSORS = 32;
+
 AMFCursorCaptureLinux::AMFCursorCaptureLinux(AMFContext* pContext) : m_pContext(pContext)
 {
     XInitThreads();
@@ -90,12 +92,32 @@ AMF_RESULT AMF_STD_CALL AMFCursorCaptureLinux::AcquireCursor(AMFSurface** pSurfa
 
     XDisplayPtr display(m_pDisplay);
 
+    // only the latest of several pending notifications matters
     XEvent event;
-    if (m_bFirstCursor == true && XCheckTypedEvent(display, m_iXfixesEventBase + XFixesCursorNotify, &event) == false)
+    bool bNotified = false;
+    unsigned long serial = 0;
+    while (XCheckTypedEvent(display, m_iXfixesEventBase + XFixesCursorNotify, &event) == True)
+    {
+        serial = reinterpret_cast<XFixesCursorNotifyEvent*>(&event)->cursor_serial;
+        bNotified = true;
+    }
+    if (m_bFirstCursor == true && bNotified == false)
     {
         return AMF_REPEAT;
     }
 
+    // the caller gets a copy of the cached surface, it may set pts or properties or draw into it
+    if (bNotified == true)
+    {
+        amf_map<unsigned long, CachedCursor>::iterator it = m_CursorCache.find(serial);
+        if (it != m_CursorCache.end())
+        {
+            it->second.lastUse = ++m_iCursorUseCount;
+            m_bFirstCursor = true;
+            return DuplicateCursorSurface(it->second.pSurface, pSurface);
+        }
+    }
+
     //this is a unique_ptr with custom XFree deleter so we don't have to worry about calling XFree ourselves
     XFixesCursorImagePtr cursor = XFixesCursorImagePtr(XFixesGetCursorImage(display), &XFree);
 
@@ -107,14 +129,54 @@ AMF_RESULT AMF_STD_CALL AMFCursorCaptureLinux::AcquireCursor(AMFSurface** pSurfa
 
     AMFTraceInfo(AMF_FACILITY, L"w: %d, h: %d, atom: %d", cursor->width, cursor->height, cursor->atom);
 
-    AMF_RESULT res = m_pContext->AllocSurface(AMF_MEMORY_HOST, AMF_SURFACE_ARGB, cursor->width, cursor->height, pSurface);
+    AMFSurfacePtr pCursorSurface;
+    AMF_RESULT res = CreateCursorSurface(cursor.get(), &pCursorSurface);
+    AMF_RETURN_IF_FAILED(res, L"CreateCursorSurface failed");
+
+    if (m_CursorCache.size() >= MAX_CACHED_CURSORS)
+    {
+        amf_map<unsigned long, CachedCursor>::iterator oldest = m_CursorCache.begin();
+        for (amf_map<unsigned long, CachedCursor>::iterator it = m_CursorCache.begin(); it != m_CursorCache.end(); it++)
+        {
+            if (it->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = it;
+            }
+        }
+        m_CursorCache.erase(oldest);
+    }
+    CachedCursor& cached = m_CursorCache[cursor->cursor_serial];
+    cached.pSurface = pCursorSurface;
+    cached.lastUse = ++m_iCursorUseCount;
+
+    m_bFirstCursor = true;
+
+    return DuplicateCursorSurface(pCursorSurface, pSurface);
+}
+
+AMF_RESULT AMFCursorCaptureLinux::DuplicateCursorSurface(AMFSurface* pCached, AMFSurface** ppSurface)
+{
+    AMFDataPtr pData;
+    AMF_RESULT res = pCached->Duplicate(AMF_MEMORY_HOST, &pData);
+    AMF_RETURN_IF_FAILED(res, L"Duplicate failed");
+
+    AMFSurfacePtr pSurface(pData);
+    AMF_RETURN_IF_FALSE(pSurface != NULL, AMF_FAIL, L"Duplicate did not return a surface");
+
+    *ppSurface = pSurface.Detach();
+    return AMF_OK;
+}
+
+AMF_RESULT AMFCursorCaptureLinux::CreateCursorSurface(XFixesCursorImage* pCursor, AMFSurface** ppSurface)
+{
+    AMF_RESULT res = m_pContext->AllocSurface(AMF_MEMORY_HOST, AMF_SURFACE_ARGB, pCursor->width, pCursor->height, ppSurface);
     AMF_RETURN_IF_FAILED(res, L"AllocSurface failed");
 
-    unsigned long* src = cursor->pixels;
-    amf_uint32* dst = reinterpret_cast<amf_uint32*>((*pSurface)->GetPlaneAt(0)->GetNative());
-    amf_int32 width = cursor->width;
-    amf_int32 height = cursor->height;
-    amf_int32 dstPitch = (*pSurface)->GetPlaneAt(0)->GetHPitch();
+    unsigned long* src = pCursor->pixels;
+    amf_uint32* dst = reinterpret_cast<amf_uint32*>((*ppSurface)->GetPlaneAt(0)->GetNative());
+    amf_int32 width = pCursor->width;
+    amf_int32 height = pCursor->height;
+    amf_int32 dstPitch = (*ppSurface)->GetPlaneAt(0)->GetHPitch();
     // cursor->pixels is 32-bit values stored in a 64-bit unsigned longs, so we can't just use memcpy
     for (int y = 0; y < height; y++)
     {
@@ -125,12 +187,10 @@ AMF_RESULT AMF_STD_CALL AMFCursorCaptureLinux::AcquireCursor(AMFSurface** pSurfa
     }
 
     AMFPoint hotspot;
-    hotspot.x = cursor->xhot;
-    hotspot.y = cursor->yhot;
-
-    (*pSurface)->SetProperty(L"Hotspot", hotspot);
+    hotspot.x = pCursor->xhot;
+    hotspot.y = pCursor->yhot;
 
-    m_bFirstCursor = true;
+    (*ppSurface)->SetProperty(L"Hotspot", hotspot);
 
     return AMF_OK;
 }
@@ -140,6 +200,7 @@ AMF_RESULT AMF_STD_CALL AMFCursorCaptureLinux::Reset()
     AMFLock lock(&m_Sect);
 
     m_bFirstCursor = false;
+    m_CursorCache.clear();
 
     return AMF_OK;
 }
@@ -33,9 +33,11 @@
 #include "public/common/InterfaceImpl.h"
 #include "public/common/PropertyStorageImpl.h"
 #include "public/common/ByteArray.h"
+#include "public/common/AMFSTL.h"
 #include "public/common/Linux/XDisplay.h"
 #include "public/include/components/CursorCapture.h"
 #include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
 
 namespace amf
 {
@@ -48,12 +50,25 @@ namespace amf
         virtual AMF_RESULT AMF_STD_CALL AcquireCursor(amf::AMFSurface** pSurface) override;
         virtual AMF_RESULT AMF_STD_CALL Reset() override;
     private:
+        AMF_RESULT CreateCursorSurface(XFixesCursorImage* pCursor, AMFSurface** ppSurface);
+        AMF_RESULT DuplicateCursorSurface(AMFSurface* pCached, AMFSurface** ppSurface);
+
         AMFContextPtr           m_pContext;
         AMFCriticalSection      m_Sect;
 
         XDisplay::Ptr           m_pDisplay;
         bool                    m_bFirstCursor = false;
         int                     m_iXfixesEventBase = 0;
+
+        // converted cursors keyed by the XFixes cursor serial - switching back to a known shape
+        // does not fetch or convert the image again; the least recently used entry is evicted
+        struct CachedCursor
+        {
+            AMFSurfacePtr       pSurface;
+            amf_uint64          lastUse;
+        };
+        amf_map<unsigned long, CachedCursor>    m_CursorCache;
+        amf_uint64                              m_iCursorUseCount = 0;
     };
 
     typedef AMFInterfacePtr_T<AMFCursorCaptureLinux>    AMFCursorCaptureLinuxPtr;
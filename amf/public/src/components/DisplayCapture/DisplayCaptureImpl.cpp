@@ -129,7 +129,11 @@ AMF_RESULT AMF_STD_CALL  AMFDisplayCaptureImpl::Init(AMF_SURFACE_FORMAT /*format
 	res = Terminate();
 	AMF_RETURN_IF_FAILED(res, L"Terminate() failed");
 
+#if defined(_WIN32)
 	m_pDesktopDuplication = new AMFDDAPISourceImpl(m_pContext);
+#else
+	m_pDesktopDuplication = new AMFX11ShmSourceImpl(m_pContext);
+#endif
 	AMF_RETURN_IF_INVALID_POINTER(m_pDesktopDuplication);
 
 	// Get the display adapter index
@@ -360,6 +364,7 @@ amf_pts AMFDisplayCaptureImpl::GetCurrentPts() const
 	}
 	return result;
 }
+#if defined(_WIN32)
 #if defined( _M_AMD64)
 #include "DrawRectsBGRA_64.h"
 #else 
@@ -469,4 +474,65 @@ AMF_RESULT  AMFDisplayCaptureImpl::DrawDirtyRects(AMFSurfacePtr& surface)
     surface = surfaceOut;
     return AMF_OK;
 }
+#else
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMFDisplayCaptureImpl::InitDrawDirtyRects()
+{
+    // the X11 source outputs host surfaces - rectangles are drawn in place on the CPU
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMFDisplayCaptureImpl::TerminateDrawDirtyRects()
+{
+    return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMFDisplayCaptureImpl::DrawDirtyRects(AMFSurfacePtr& surface)
+{
+    AMFVariant var;
+    surface->GetProperty(AMF_DISPLAYCAPTURE_DIRTY_RECTS, &var);
+    if (var.type != AMF_VARIANT_INTERFACE || var.pInterface == nullptr)
+    {
+        return AMF_NOT_FOUND;
+    }
+    AMFBufferPtr pBuffer(var.pInterface);
+    amf_uint count = amf_uint(pBuffer->GetSize() / sizeof(AMFRect));
+    if (count == 0)
+    {
+        return AMF_NOT_FOUND;
+    }
+    AMF_RETURN_IF_FALSE(surface->GetMemoryType() == AMF_MEMORY_HOST, AMF_NOT_SUPPORTED, L"DrawDirtyRects() - host surface expected");
+
+    // same as DrawRectsBGRA.hlsl: saturate the red channel inside every rectangle
+    amf_int32 redOffset = 0;
+    switch (surface->GetFormat())
+    {
+    case AMF_SURFACE_BGRA: redOffset = 2; break;
+    case AMF_SURFACE_RGBA: redOffset = 0; break;
+    default:
+        AMF_RETURN_IF_FALSE(false, AMF_NOT_SUPPORTED, L"DrawDirtyRects() - unsupported format %d", surface->GetFormat());
+    }
+
+    AMFPlane* pPlane = surface->GetPlane(AMF_PLANE_PACKED);
+    amf_uint8* pBits = static_cast<amf_uint8*>(pPlane->GetNative());
+    const AMFRect* pRects = static_cast<const AMFRect*>(pBuffer->GetNative());
+    for (amf_uint i = 0; i < count; i++)
+    {
+        const amf_int32 left = AMF_MAX(pRects[i].left, 0);
+        const amf_int32 top = AMF_MAX(pRects[i].top, 0);
+        const amf_int32 right = AMF_MIN(pRects[i].right, pPlane->GetWidth());
+        const amf_int32 bottom = AMF_MIN(pRects[i].bottom, pPlane->GetHeight());
+        for (amf_int32 y = top; y < bottom; y++)
+        {
+            amf_uint8* pRow = pBits + amf_size(y) * pPlane->GetHPitch() + redOffset;
+            for (amf_int32 x = left; x < right; x++)
+            {
+                pRow[x * 4] = 0xFF;
+            }
+        }
+    }
+    return AMF_OK;
+}
+#endif
 
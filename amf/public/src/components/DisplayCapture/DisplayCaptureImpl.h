@@ -27,10 +27,19 @@
 #include "../../../include/core/Context.h"
 #include "../../../common/ByteArray.h"
 #include "../../../include/core/CurrentTime.h"
+#if defined(_WIN32)
 #include "DDAPISource.h"
+#else
+#include "X11ShmSource.h"
+#endif
 
 namespace amf
 {
+#if defined(_WIN32)
+	typedef AMFDDAPISourceImplPtr       AMFDisplayCaptureSourcePtr;
+#else
+	typedef AMFX11ShmSourceImplPtr      AMFDisplayCaptureSourcePtr;
+#endif
 	//-------------------------------------------------------------------------------
 	typedef AMFPropertyStorageExImpl <AMFComponent> baseclassCompositorProperty;
 	//-------------------------------------------------------------------------------
@@ -77,7 +86,7 @@ namespace amf
         bool GetEOF() const { return m_eof; }
         mutable AMFCriticalSection				m_sync;
 		AMFContext1Ptr							m_pContext;
-		AMFDDAPISourceImplPtr                   m_pDesktopDuplication;
+		AMFDisplayCaptureSourcePtr              m_pDesktopDuplication;
 		AMFCurrentTimePtr						m_pCurrentTime;
 		bool									m_eof;
 		amf_pts									m_lastStartPts;
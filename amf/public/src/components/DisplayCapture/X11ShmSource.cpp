@@ -0,0 +1,578 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "X11ShmSource.h"
+#include "public/common/TraceAdapter.h"
+#include "public/common/Linux/XrandrPtrs.h"
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+using namespace amf;
+
+#define AMF_FACILITY L"AMFX11ShmSourceImpl"
+
+namespace
+{
+    // Xlib reports protocol errors through a process wide handler and the default one exits the
+    // process. MIT-SHM requests are expected to fail on remote displays and while the screen is resized.
+    class X11ErrorTrap
+    {
+    public:
+        X11ErrorTrap() : m_pPrevious(NULL)
+        {
+            s_bError = false;
+            m_pPrevious = XSetErrorHandler(&X11ErrorTrap::Handler);
+        }
+        ~X11ErrorTrap()
+        {
+            XSetErrorHandler(m_pPrevious);
+        }
+        bool Failed(Display* display)
+        {
+            XSync(display, False);
+            return s_bError;
+        }
+    private:
+        static int Handler(Display* /*display*/, XErrorEvent* /*pEvent*/)
+        {
+            s_bError = true;
+            return 0;
+        }
+        static volatile bool    s_bError;
+        XErrorHandler           m_pPrevious;
+    };
+    volatile bool X11ErrorTrap::s_bError = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMFX11ShmSourceImpl::AMFX11ShmSourceImpl(AMFContext* pContext) :
+    m_pContext(pContext),
+    m_root(None),
+    m_pVisual(NULL),
+    m_iDepth(0),
+    m_eFormat(AMF_SURFACE_BGRA),
+    m_bRandR(false),
+    m_iRandREventBase(0),
+    m_damage(None),
+    m_damageRegion(None),
+    m_iDamageEventBase(0),
+    m_iMonitorIndex(0),
+    m_desktopRect(AMFConstructRect(0, 0, 0, 0)),
+    m_eRotation(AMF_ROTATION_NONE),
+    m_bFullFrame(true),
+    m_frameDuration(0),
+    m_lastPts(-1LL),
+    m_iFrameCount(0),
+    m_bEnableDirtyRects(false),
+    m_eCaptureMode(AMF_DISPLAYCAPTURE_MODE_KEEP_FRAMERATE)
+{
+    XInitThreads();
+}
+
+//-------------------------------------------------------------------------------------------------
+AMFX11ShmSourceImpl::~AMFX11ShmSourceImpl()
+{
+    TerminateDisplayCapture();
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFX11ShmSourceImpl::InitDisplayCapture(uint32_t displayMonitorIndex, amf_pts frameDuration, bool bEnableDirtyRects)
+{
+    AMFLock lock(&m_sync);
+
+    m_frameDuration = frameDuration;
+    m_bEnableDirtyRects = bEnableDirtyRects;
+    m_iMonitorIndex = displayMonitorIndex;
+
+    // $DISPLAY selects the server - this works the same against Xvfb
+    m_pDisplay = XDisplay::Ptr(new XDisplay);
+    AMF_RETURN_IF_FALSE(m_pDisplay->IsValid(), AMF_NOT_INITIALIZED, L"Couldn't connect to XDisplay");
+
+    XDisplayPtr display(m_pDisplay);
+    AMF_RETURN_IF_FALSE(XShmQueryExtension(display) == True, AMF_NOT_SUPPORTED, L"MIT-SHM not available on display");
+
+    const int screen = DefaultScreen((Display*)display);
+    m_root = RootWindow((Display*)display, screen);
+    m_pVisual = DefaultVisual((Display*)display, screen);
+    m_iDepth = DefaultDepth((Display*)display, screen);
+
+    int error = 0;
+    int major = 0;
+    int minor = 0;
+    m_bRandR = XRRQueryExtension(display, &m_iRandREventBase, &error) && XRRQueryVersion(display, &major, &minor) &&
+        (major > 1 || (major == 1 && minor >= 3));
+    if (m_bRandR)
+    {
+        XRRSelectInput(display, m_root, RRScreenChangeNotifyMask);
+    }
+    AMF_RETURN_IF_FAILED(UpdateMonitorGeometry(display), L"UpdateMonitorGeometry() failed");
+
+    int fixesEventBase = 0;
+    int fixesMajor = 0;
+    int fixesMinor = 0;
+    if (XDamageQueryExtension(display, &m_iDamageEventBase, &error) && XDamageQueryVersion(display, &major, &minor) &&
+        XFixesQueryExtension(display, &fixesEventBase, &error) && XFixesQueryVersion(display, &fixesMajor, &fixesMinor) && fixesMajor >= 2)
+    {
+        m_damage = XDamageCreate(display, m_root, XDamageReportNonEmpty);
+        m_damageRegion = XFixesCreateRegion(display, NULL, 0);
+    }
+    else
+    {
+        AMFTraceWarning(AMF_FACILITY, L"XDamage not available on display - every frame is captured");
+    }
+
+    // the first segment also checks that the server can attach our memory, which fails for remote displays
+    ShmBuffer* pBuffer = NULL;
+    AMF_RETURN_IF_FAILED(AllocShmBuffer(display, &pBuffer), L"AllocShmBuffer() failed");
+    m_freeBuffers.push_back(pBuffer);
+
+    m_bFullFrame = true;
+    m_lastPts = -1LL;
+    m_iFrameCount = 0;
+    return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFX11ShmSourceImpl::TerminateDisplayCapture()
+{
+    AMFLock lock(&m_sync);
+
+    // segments still wrapped by surfaces are freed in OnSurfaceDataRelease()
+    if (m_pDisplay != nullptr && m_pDisplay->IsValid())
+    {
+        XDisplayPtr display(m_pDisplay);
+        FreeIdleShmBuffers(display);
+        if (m_damageRegion != None)
+        {
+            XFixesDestroyRegion(display, m_damageRegion);
+        }
+        if (m_damage != None)
+        {
+            XDamageDestroy(display, m_damage);
+        }
+        XFlush(display);
+    }
+    m_damageRegion = None;
+    m_damage = None;
+    m_pContext.Release();
+
+    return AMF_OK;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFX11ShmSourceImpl::AcquireSurface(bool bCopyOutputSurface, amf::AMFSurface** ppSurface)
+{
+    AMFLock lock(&m_sync);
+
+    AMF_RETURN_IF_FALSE(m_pContext != nullptr && m_pDisplay != nullptr && m_pDisplay->IsValid(), AMF_NOT_INITIALIZED,
+        L"AcquireSurface() - display capture is not initialized");
+
+    bool bWait = m_frameDuration != 0 && m_eCaptureMode == AMF_DISPLAYCAPTURE_MODE_KEEP_FRAMERATE;
+    if (bWait)
+    {
+        amf_pts startTime = 0;
+        if (m_lastPts == -1LL)
+        {
+            m_lastPts = amf_high_precision_clock() - m_frameDuration;
+        }
+
+        while (true)
+        {
+            startTime = amf_high_precision_clock();
+            amf_pts passedTime = startTime - m_lastPts;
+            amf_pts waitTime = m_frameDuration - passedTime;
+            if (waitTime < AMF_MILLISECOND)
+            {
+                break;
+            }
+            amf_sleep(1);
+        }
+        m_lastPts = startTime;
+    }
+
+    XDisplayPtr display(m_pDisplay);
+
+    // monitor layout changes arrive as RandR events selected on the root window
+    XEvent event;
+    bool bScreenChanged = false;
+    while (m_bRandR && XCheckTypedEvent(display, m_iRandREventBase + RRScreenChangeNotify, &event))
+    {
+        XRRUpdateConfiguration(&event);
+        bScreenChanged = true;
+    }
+    if (bScreenChanged)
+    {
+        const AMFRect oldRect = m_desktopRect;
+        AMF_RETURN_IF_FAILED(UpdateMonitorGeometry(display), L"UpdateMonitorGeometry() failed");
+        if (oldRect.Width() != m_desktopRect.Width() || oldRect.Height() != m_desktopRect.Height())
+        {
+            FreeIdleShmBuffers(display);
+        }
+        m_bFullFrame = true;
+    }
+
+    if (CollectDamage(display) == false && m_eCaptureMode != AMF_DISPLAYCAPTURE_MODE_GET_CURRENT_SURFACE)
+    {
+        // nothing on the monitor changed since the previous frame
+        return AMF_REPEAT;
+    }
+
+    ShmBuffer* pBuffer = NULL;
+    if (m_freeBuffers.empty() == false)
+    {
+        pBuffer = m_freeBuffers.front();
+        m_freeBuffers.pop_front();
+    }
+    else
+    {
+        AMF_RETURN_IF_FAILED(AllocShmBuffer(display, &pBuffer), L"AllocShmBuffer() failed. FrameCount = %lld", m_iFrameCount);
+    }
+
+    Bool grabbed = False;
+    {
+        X11ErrorTrap trap;
+        grabbed = XShmGetImage(display, m_root, pBuffer->pImage, m_desktopRect.left, m_desktopRect.top, AllPlanes);
+    }
+    if (grabbed == False)
+    {
+        // the monitor is partially outside of the root window while a mode change is in progress
+        AMFTraceWarning(AMF_FACILITY, L"XShmGetImage() failed. FrameCount = %lld", m_iFrameCount);
+        m_freeBuffers.push_back(pBuffer);
+        m_bFullFrame = true;
+        return AMF_REPEAT;
+    }
+
+    AMFSurfacePtr pSurface;
+    AMF_RESULT res = m_pContext->CreateSurfaceFromHostNative(m_eFormat, pBuffer->pImage->width, pBuffer->pImage->height,
+        pBuffer->pImage->bytes_per_line, pBuffer->pImage->height, pBuffer->pImage->data, &pSurface, this);
+    if (res != AMF_OK)
+    {
+        m_freeBuffers.push_back(pBuffer);
+    }
+    AMF_RETURN_IF_FAILED(res, L"CreateSurfaceFromHostNative() failed");
+
+    // released in OnSurfaceDataRelease() once the surface is gone
+    m_usedBuffers[pSurface] = pBuffer;
+    Acquire();
+
+    if (bCopyOutputSurface)
+    {
+        AMFDataPtr pDataCopy;
+        res = pSurface->Duplicate(pSurface->GetMemoryType(), &pDataCopy);
+        AMF_RETURN_IF_FAILED(res, L"Duplicate() failed. FrameCount = %lld", m_iFrameCount);
+
+        pSurface = AMFSurfacePtr(pDataCopy);
+    }
+
+    m_iFrameCount++;
+
+    if (m_bEnableDirtyRects && m_DirtyRects.empty() == false)
+    {
+        AMFBufferPtr pDirtyRectBuffer;
+        res = m_pContext->AllocBuffer(AMF_MEMORY_HOST, sizeof(AMFRect) * m_DirtyRects.size(), &pDirtyRectBuffer);
+        AMF_RETURN_IF_FAILED(res, L"AllocBuffer() failed");
+        memcpy(pDirtyRectBuffer->GetNative(), &m_DirtyRects[0], pDirtyRectBuffer->GetSize());
+
+        pSurface->SetProperty(AMF_DISPLAYCAPTURE_DIRTY_RECTS, (AMFInterface*)pDirtyRectBuffer);
+    }
+
+    *ppSurface = pSurface.Detach();
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFX11ShmSourceImpl::CollectDamage(Display* display)
+{
+    m_DirtyRects.clear();
+
+    if (m_damage == None || m_bFullFrame)
+    {
+        if (m_damage != None)
+        {
+            // start tracking from this grab
+            XEvent event;
+            while (XCheckTypedEvent(display, m_iDamageEventBase + XDamageNotify, &event))
+            {
+            }
+            XDamageSubtract(display, m_damage, None, None);
+        }
+        m_bFullFrame = false;
+        m_DirtyRects.push_back(AMFConstructRect(0, 0, m_desktopRect.Width(), m_desktopRect.Height()));
+        return true;
+    }
+
+    // XDamageReportNonEmpty sends a single event when the damage region stops being empty
+    XEvent event;
+    bool bNotified = false;
+    while (XCheckTypedEvent(display, m_iDamageEventBase + XDamageNotify, &event))
+    {
+        bNotified = true;
+    }
+    if (bNotified == false)
+    {
+        return false;
+    }
+
+    // move the accumulated damage into our region and reset it before the grab, so anything drawn
+    // after this point is reported with the next frame
+    XDamageSubtract(display, m_damage, None, m_damageRegion);
+
+    int count = 0;
+    XRectangle* pRects = XFixesFetchRegion(display, m_damageRegion, &count);
+    for (int i = 0; i < count; i++)
+    {
+        AMFRect rect = AMFConstructRect(
+            AMF_MAX(amf_int32(pRects[i].x), m_desktopRect.left) - m_desktopRect.left,
+            AMF_MAX(amf_int32(pRects[i].y), m_desktopRect.top) - m_desktopRect.top,
+            AMF_MIN(amf_int32(pRects[i].x) + amf_int32(pRects[i].width), m_desktopRect.right) - m_desktopRect.left,
+            AMF_MIN(amf_int32(pRects[i].y) + amf_int32(pRects[i].height), m_desktopRect.bottom) - m_desktopRect.top);
+        if (rect.Width() > 0 && rect.Height() > 0)
+        {
+            m_DirtyRects.push_back(rect);
+        }
+    }
+    if (pRects != NULL)
+    {
+        XFree(pRects);
+    }
+    return m_DirtyRects.empty() == false;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFX11ShmSourceImpl::UpdateMonitorGeometry(Display* display)
+{
+    XWindowAttributes attributes = {};
+    AMF_RETURN_IF_FALSE(XGetWindowAttributes(display, m_root, &attributes) != 0, AMF_FAIL, L"XGetWindowAttributes() failed");
+
+    // without RandR the whole root window is the only monitor
+    AMFRect rect = AMFConstructRect(0, 0, attributes.width, attributes.height);
+    AMF_ROTATION_ENUM rotation = AMF_ROTATION_NONE;
+
+    XRRScreenResources* pResources = m_bRandR ? XRRGetScreenResourcesCurrent(display, m_root) : NULL;
+    if (pResources != NULL)
+    {
+        XRRScreenResourcesPtr resources(pResources, &XRRFreeScreenResources);
+
+        amf_vector<XRRCrtcInfoPtr> monitors;
+        for (int i = 0; i < resources->ncrtc; i++)
+        {
+            XRRCrtcInfo* pCrtc = XRRGetCrtcInfo(display, pResources, resources->crtcs[i]);
+            if (pCrtc == NULL)
+            {
+                continue;
+            }
+            XRRCrtcInfoPtr crtc(pCrtc, &XRRFreeCrtcInfo);
+            if (crtc->mode != None && crtc->width > 0 && crtc->height > 0)
+            {
+                monitors.push_back(crtc);
+            }
+        }
+        if (monitors.empty() == false)
+        {
+            const XRRCrtcInfoPtr& crtc = monitors[m_iMonitorIndex % monitors.size()];
+            rect = AMFConstructRect(crtc->x, crtc->y, crtc->x + amf_int32(crtc->width), crtc->y + amf_int32(crtc->height));
+            switch (crtc->rotation & (RR_Rotate_0 | RR_Rotate_90 | RR_Rotate_180 | RR_Rotate_270))
+            {
+            case RR_Rotate_90:  rotation = AMF_ROTATION_90; break;
+            case RR_Rotate_180: rotation = AMF_ROTATION_180; break;
+            case RR_Rotate_270: rotation = AMF_ROTATION_270; break;
+            default:            rotation = AMF_ROTATION_NONE; break;
+            }
+        }
+    }
+
+    // XShmGetImage() fails for areas outside of the root window
+    rect.left = AMF_MAX(rect.left, 0);
+    rect.top = AMF_MAX(rect.top, 0);
+    rect.right = AMF_MIN(rect.right, amf_int32(attributes.width));
+    rect.bottom = AMF_MIN(rect.bottom, amf_int32(attributes.height));
+    AMF_RETURN_IF_FALSE(rect.Width() > 0 && rect.Height() > 0, AMF_FAIL, L"Monitor %u is outside of the root window", m_iMonitorIndex);
+
+    m_desktopRect = rect;
+    m_eRotation = rotation;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFX11ShmSourceImpl::AllocShmBuffer(Display* display, ShmBuffer** ppBuffer)
+{
+    ShmBuffer* pBuffer = new ShmBuffer();
+    pBuffer->shmInfo.shmid = -1;
+    pBuffer->shmInfo.shmaddr = (char*)-1;
+
+    pBuffer->pImage = XShmCreateImage(display, m_pVisual, m_iDepth, ZPixmap, NULL, &pBuffer->shmInfo,
+        m_desktopRect.Width(), m_desktopRect.Height());
+    if (pBuffer->pImage == NULL)
+    {
+        FreeShmBuffer(display, pBuffer);
+        AMF_RETURN_IF_FALSE(false, AMF_FAIL, L"XShmCreateImage() failed");
+    }
+
+    // only 32-bit little endian pixels map directly to an AMF format
+    const XImage* pImage = pBuffer->pImage;
+    AMF_SURFACE_FORMAT format = AMF_SURFACE_UNKNOWN;
+    if (pImage->bits_per_pixel == 32 && pImage->byte_order == LSBFirst && pImage->green_mask == 0xFF00)
+    {
+        if (pImage->red_mask == 0xFF0000 && pImage->blue_mask == 0xFF)
+        {
+            format = AMF_SURFACE_BGRA;
+        }
+        else if (pImage->red_mask == 0xFF && pImage->blue_mask == 0xFF0000)
+        {
+            format = AMF_SURFACE_RGBA;
+        }
+    }
+    if (format == AMF_SURFACE_UNKNOWN)
+    {
+        const int depth = pImage->depth;
+        const int bitsPerPixel = pImage->bits_per_pixel;
+        FreeShmBuffer(display, pBuffer);
+        AMF_RETURN_IF_FALSE(false, AMF_NOT_SUPPORTED, L"Unsupported X visual: depth %d, %d bits per pixel", depth, bitsPerPixel);
+    }
+    m_eFormat = format;
+
+    pBuffer->shmInfo.shmid = shmget(IPC_PRIVATE, size_t(pImage->bytes_per_line) * pImage->height, IPC_CREAT | 0600);
+    if (pBuffer->shmInfo.shmid == -1)
+    {
+        FreeShmBuffer(display, pBuffer);
+        AMF_RETURN_IF_FALSE(false, AMF_OUT_OF_MEMORY, L"shmget() failed");
+    }
+    pBuffer->shmInfo.shmaddr = pBuffer->pImage->data = (char*)shmat(pBuffer->shmInfo.shmid, NULL, 0);
+    pBuffer->shmInfo.readOnly = False;
+    if (pBuffer->shmInfo.shmaddr == (char*)-1)
+    {
+        FreeShmBuffer(display, pBuffer);
+        AMF_RETURN_IF_FALSE(false, AMF_OUT_OF_MEMORY, L"shmat() failed");
+    }
+
+    {
+        X11ErrorTrap trap;
+        pBuffer->bAttached = XShmAttach(display, &pBuffer->shmInfo) != False && trap.Failed(display) == false;
+    }
+    // the segment is destroyed as soon as both we and the server detach from it
+    shmctl(pBuffer->shmInfo.shmid, IPC_RMID, NULL);
+    pBuffer->shmInfo.shmid = -1;
+    if (pBuffer->bAttached == false)
+    {
+        FreeShmBuffer(display, pBuffer);
+        AMF_RETURN_IF_FALSE(false, AMF_NOT_SUPPORTED, L"XShmAttach() failed - the X server cannot access shared memory of this process");
+    }
+
+    *ppBuffer = pBuffer;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFX11ShmSourceImpl::FreeShmBuffer(Display* display, ShmBuffer* pBuffer)
+{
+    if (pBuffer->bAttached)
+    {
+        XShmDetach(display, &pBuffer->shmInfo);
+    }
+    if (pBuffer->pImage != NULL)
+    {
+        // the data belongs to the segment - XDestroyImage() of an MIT-SHM image does not free it
+        XDestroyImage(pBuffer->pImage);
+    }
+    if (pBuffer->shmInfo.shmaddr != (char*)-1)
+    {
+        shmdt(pBuffer->shmInfo.shmaddr);
+    }
+    if (pBuffer->shmInfo.shmid != -1)
+    {
+        shmctl(pBuffer->shmInfo.shmid, IPC_RMID, NULL);
+    }
+    delete pBuffer;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFX11ShmSourceImpl::FreeIdleShmBuffers(Display* display)
+{
+    for (amf_list< ShmBuffer* >::iterator it = m_freeBuffers.begin(); it != m_freeBuffers.end(); it++)
+    {
+        FreeShmBuffer(display, *it);
+    }
+    m_freeBuffers.clear();
+}
+//-------------------------------------------------------------------------------------------------
+AMFSize     AMFX11ShmSourceImpl::GetResolution()
+{
+    AMFLock lock(&m_sync);
+    //
+    AMFSize resolution = {1920, 1080};
+    if (m_desktopRect.Width() > 0 && m_desktopRect.Height() > 0)
+    {
+        resolution.width = m_desktopRect.Width();
+        resolution.height = m_desktopRect.Height();
+    }
+    return resolution;
+}
+//-------------------------------------------------------------------------------------------------
+AMFRect AMFX11ShmSourceImpl::GetDesktopRect()
+{
+    AMFLock lock(&m_sync);
+    return m_desktopRect;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL AMFX11ShmSourceImpl::OnSurfaceDataRelease(amf::AMFSurface* pSurface)
+{
+    {
+        AMFLock lock(&m_sync);
+        amf_map< AMFSurface*, ShmBuffer* >::iterator it = m_usedBuffers.find(pSurface);
+        if (it == m_usedBuffers.end())
+        {
+            return;
+        }
+        ShmBuffer* pBuffer = it->second;
+        m_usedBuffers.erase(it);
+
+        // keep the segment for the next grab unless capture stopped or the monitor size changed
+        if (m_pContext != nullptr && pBuffer->pImage->width == m_desktopRect.Width() && pBuffer->pImage->height == m_desktopRect.Height())
+        {
+            m_freeBuffers.push_back(pBuffer);
+        }
+        else
+        {
+            XDisplayPtr display(m_pDisplay);
+            FreeShmBuffer(display, pBuffer);
+        }
+    }
+    // reference taken in AcquireSurface() - may destroy this object
+    Release();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_ROTATION_ENUM               AMFX11ShmSourceImpl::GetRotation()
+{
+    AMFLock lock(&m_sync);
+    return m_eRotation;
+}
+//-------------------------------------------------------------------------------------------------
+void                            AMFX11ShmSourceImpl::SetMode(AMF_DISPLAYCAPTURE_MODE_ENUM mode)
+{
+    m_eCaptureMode = mode;
+}
+//-------------------------------------------------------------------------------------------------
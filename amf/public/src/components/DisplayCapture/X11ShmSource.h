@@ -0,0 +1,125 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2017 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "../../../include/core/Context.h"
+#include "../../../common/InterfaceImpl.h"
+#include "../../../common/AMFSTL.h"
+#include "../../../common/Linux/XDisplay.h"
+#include "public/include/components/DisplayCapture.h"
+
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xdamage.h>
+
+namespace amf
+{
+    // Linux counterpart of AMFDDAPISourceImpl: grabs one RandR monitor of the X root window with
+    // MIT-SHM into pooled shared memory segments which are handed out as host surfaces without a copy.
+    // XDamage tells which areas changed since the last grab - frames without damage are skipped
+    // and the damaged areas are attached as AMF_DISPLAYCAPTURE_DIRTY_RECTS.
+    class AMFX11ShmSourceImpl : public 
+        AMFInterfaceImpl< AMFInterface >,
+        public amf::AMFSurfaceObserver
+    {
+    public:
+        AMFX11ShmSourceImpl(AMFContext* pContext);
+        ~AMFX11ShmSourceImpl();
+
+        AMF_RESULT                      InitDisplayCapture(uint32_t displayMonitorIndex, amf_pts frameDuration, bool bEnableDirtyRects);
+        AMF_RESULT                      TerminateDisplayCapture();
+
+        AMF_RESULT                      AcquireSurface(bool bCopyOutputSurface, amf::AMFSurface **pSurface);
+
+        AMFSize                         GetResolution();
+
+        AMFRect                         GetDesktopRect();
+        AMF_ROTATION_ENUM               GetRotation();
+        void                            SetMode(AMF_DISPLAYCAPTURE_MODE_ENUM mode);
+
+        // AMFSurfaceObserver interface
+        virtual void        AMF_STD_CALL OnSurfaceDataRelease(AMFSurface* pSurface);
+
+    private:
+        struct ShmBuffer
+        {
+            XImage*                             pImage;
+            XShmSegmentInfo                     shmInfo;
+            bool                                bAttached;
+        };
+
+        // Utility methods - called with m_sync held and the display locked
+        AMF_RESULT                      UpdateMonitorGeometry(Display* display);
+        AMF_RESULT                      AllocShmBuffer(Display* display, ShmBuffer** ppBuffer);
+        void                            FreeShmBuffer(Display* display, ShmBuffer* pBuffer);
+        void                            FreeIdleShmBuffers(Display* display);
+        bool                            CollectDamage(Display* display);
+
+        // A segment stays in m_usedBuffers while the surface wrapping it is alive; every such surface
+        // holds a reference to this object so Terminate() cannot unmap memory still in use
+        amf_list< ShmBuffer* >                  m_freeBuffers;
+        amf_map< AMFSurface*, ShmBuffer* >      m_usedBuffers;
+
+        AMFContextPtr                           m_pContext;
+
+        mutable AMFCriticalSection              m_sync;
+
+        XDisplay::Ptr                           m_pDisplay;
+        Window                                  m_root;
+        Visual*                                 m_pVisual;
+        int                                     m_iDepth;
+        AMF_SURFACE_FORMAT                      m_eFormat;
+
+        bool                                    m_bRandR;
+        int                                     m_iRandREventBase;
+        Damage                                  m_damage;
+        XserverRegion                           m_damageRegion;
+        int                                     m_iDamageEventBase;
+
+        uint32_t                                m_iMonitorIndex;
+        AMFRect                                 m_desktopRect;   // captured monitor in root window coordinates
+        AMF_ROTATION_ENUM                       m_eRotation;
+        bool                                    m_bFullFrame;    // next grab reports the whole monitor as dirty
+
+        amf_pts                                 m_frameDuration; // in 100 of nanosec
+        amf_pts                                 m_lastPts;
+
+        amf_int64                               m_iFrameCount;
+
+        amf_vector<AMFRect>                     m_DirtyRects;
+
+        bool                                    m_bEnableDirtyRects;
+        AMF_DISPLAYCAPTURE_MODE_ENUM            m_eCaptureMode;
+    };
+    typedef AMFInterfacePtr_T<AMFX11ShmSourceImpl>    AMFX11ShmSourceImplPtr;
+} //namespace amf